@@ -391,7 +391,7 @@ bool CG_NewFrameSnap( snapshot_t *frame, snapshot_t *lerpframe ) {
 	CG_UpdateEntities();
 	CG_CheckPredictionError();
 
-	cg.predictFrom = 0; // force the prediction to be restarted from the new snapshot
+	CG_ValidatePredictionCheckpoints(); // restart the prediction from the new snapshot if it disagrees with predicted states
 	cg.fireEvents = true;
 
 	for( i = 0; i < cg.frame.numgamecommands; i++ ) {
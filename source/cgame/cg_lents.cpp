@@ -23,8 +23,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "cg_local.h"
 #include "../client/snd_public.h"
 #include "../ref/frontend.h"
+#include "cg_lentsimulation.h"
 
-#define MAX_LOCAL_ENTITIES  512
+#define MAX_LOCAL_ENTITIES  32768
 
 static vec3_t debris_maxs = { 4, 4, 8 };
 static vec3_t debris_mins = { -4, -4, 0 };
@@ -42,13 +43,15 @@ typedef enum
 	LE_EXPLOSION_TRACER,
 	LE_DASH_SCALE,
 	LE_PUFF_SCALE,
-	LE_PUFF_SHRINK
+	LE_PUFF_SHRINK,
+
+	LE_NUM_TYPES
 } letype_t;
 
+// Properties that are not needed for the simulation itself.
+// Spawning code sets initial motion parameters here too, they are transferred to the simulation on the next update.
 typedef struct lentity_s
 {
-	struct lentity_s *prev, *next;
-
 	letype_t type;
 
 	entity_t ent;
@@ -73,23 +76,93 @@ typedef struct lentity_s
 	bonepose_t *static_boneposes;
 } lentity_t;
 
-lentity_t cg_localents[MAX_LOCAL_ENTITIES];
-lentity_t cg_localents_headnode, *cg_free_lents;
+// Properties of local entities live in slots that never move.
+// The last slot is a scratch one for simulated entities that have been replaced during an update.
+#define LENTS_SCRATCH_SLOT  MAX_LOCAL_ENTITIES
+static lentity_t cg_localents[MAX_LOCAL_ENTITIES + 1];
+static uint32_t cg_freeLocalEntSlots[MAX_LOCAL_ENTITIES];
+static int cg_numFreeLocalEntSlots;
+
+// Simulated entities are kept densely in [0, cg_numLocalEnts) in order of spawning.
+// Only the simulation state and a slot number are moved on compaction.
+static LocalEntitiesSimulation<MAX_LOCAL_ENTITIES> cg_lentsSimulation;
+static uint32_t cg_lentSlots[MAX_LOCAL_ENTITIES];
+static int cg_numLocalEnts;
+
+// A ring of slots of entities that were spawned since the last simulation update, oldest first.
+// These entities are newer than any simulated one.
+static uint32_t cg_spawnedLocalEnts[MAX_LOCAL_ENTITIES];
+static int cg_spawnedLocalEntsHead;
+static int cg_numSpawnedLocalEnts;
+
+// Entities of the same type are processed together
+static uint32_t cg_lentsByType[MAX_LOCAL_ENTITIES];
+static int cg_lentsTypeOffsets[LE_NUM_TYPES + 1];
+
+static uint32_t cg_bouncingLocalEnts[MAX_LOCAL_ENTITIES];
+
+// A next simulated entity to replace if there is no free slot.
+// Simulated entities are stored in order of spawning so the replacement starts from the oldest ones.
+static int cg_lentsReplacementCursor;
+
+static inline lentity_t *CG_SimulatedLocalEntity( int index ) {
+	return &cg_localents[cg_lentSlots[index]];
+}
+
+/*
+* CG_ReleaseLocalEntity
+*/
+static void CG_ReleaseLocalEntity( lentity_t *le ) {
+	if( le->static_boneposes ) {
+		Q_free(   le->static_boneposes );
+		le->static_boneposes = NULL;
+	}
+	le->type = LE_FREE;
+}
 
 /*
 * CG_ClearLocalEntities
 */
 void CG_ClearLocalEntities( void ) {
-	int i;
-
 	memset( cg_localents, 0, sizeof( cg_localents ) );
+	for( int i = 0; i < MAX_LOCAL_ENTITIES; i++ ) {
+		cg_freeLocalEntSlots[i] = MAX_LOCAL_ENTITIES - 1 - i;
+	}
+	cg_numFreeLocalEntSlots = MAX_LOCAL_ENTITIES;
+	cg_numLocalEnts = 0;
+	cg_spawnedLocalEntsHead = 0;
+	cg_numSpawnedLocalEnts = 0;
+	cg_lentsReplacementCursor = 0;
+}
+
+/*
+* CG_ReplaceOldestLocalEntity
+*
+* Releases the oldest entity and returns its slot
+*/
+static uint32_t CG_ReplaceOldestLocalEntity( void ) {
+	uint32_t slot;
+
+	// simulated entities are older than spawned ones
+	while( cg_lentsReplacementCursor < cg_numLocalEnts ) {
+		const int index = cg_lentsReplacementCursor++;
+		slot = cg_lentSlots[index];
+		if( slot != LENTS_SCRATCH_SLOT ) {
+			// the simulation state is dropped on the next compaction
+			cg_lentsSimulation.removed[index] = 1;
+			cg_lentSlots[index] = LENTS_SCRATCH_SLOT;
+			CG_ReleaseLocalEntity( &cg_localents[slot] );
+			return slot;
+		}
+	}
 
-	// link local entities
-	cg_free_lents = cg_localents;
-	cg_localents_headnode.prev = &cg_localents_headnode;
-	cg_localents_headnode.next = &cg_localents_headnode;
-	for( i = 0; i < MAX_LOCAL_ENTITIES - 1; i++ )
-		cg_localents[i].next = &cg_localents[i + 1];
+	// all simulated entities have been replaced, so some entities are waiting for admission
+	assert( cg_numSpawnedLocalEnts > 0 );
+	slot = cg_spawnedLocalEnts[cg_spawnedLocalEntsHead];
+	cg_spawnedLocalEntsHead = ( cg_spawnedLocalEntsHead + 1 ) % MAX_LOCAL_ENTITIES;
+	cg_numSpawnedLocalEnts--;
+	CG_ReleaseLocalEntity( &cg_localents[slot] );
+	return slot;
 }
 
 /*
@@ -97,16 +170,20 @@ void CG_ClearLocalEntities( void ) {
 */
 static lentity_t *CG_AllocLocalEntity( letype_t type, float r, float g, float b, float a ) {
 	lentity_t *le;
+	uint32_t slot;
 
-	if( cg_free_lents ) { // take a free decal if possible
-		le = cg_free_lents;
-		cg_free_lents = le->next;
-	} else {              // grab the oldest one otherwise
-		le = cg_localents_headnode.prev;
-		le->prev->next = le->next;
-		le->next->prev = le->prev;
+	if( cg_numFreeLocalEntSlots ) { // take a free slot if possible
+		slot = cg_freeLocalEntSlots[--cg_numFreeLocalEntSlots];
+	} else {              // replace the oldest one otherwise
+		slot = CG_ReplaceOldestLocalEntity();
 	}
 
+	// the simulation state gets initialized by the spawned entity properties on the next update
+	assert( cg_numSpawnedLocalEnts < MAX_LOCAL_ENTITIES );
+	cg_spawnedLocalEnts[( cg_spawnedLocalEntsHead + cg_numSpawnedLocalEnts ) % MAX_LOCAL_ENTITIES] = slot;
+	cg_numSpawnedLocalEnts++;
+
+	le = &cg_localents[slot];
 	memset( le, 0, sizeof( *le ) );
 	le->type = type;
 	le->start = cg.time;
@@ -144,33 +221,9 @@ static lentity_t *CG_AllocLocalEntity( letype_t type, float r, float g, float b,
 			break;
 	}
 
-	// put the decal at the start of the list
-	le->prev = &cg_localents_headnode;
-	le->next = cg_localents_headnode.next;
-	le->next->prev = le;
-	le->prev->next = le;
-
 	return le;
 }
 
-/*
-* CG_FreeLocalEntity
-*/
-static void CG_FreeLocalEntity( lentity_t *le ) {
-	if( le->static_boneposes ) {
-		Q_free(   le->static_boneposes );
-		le->static_boneposes = NULL;
-	}
-
-	// remove from linked active list
-	le->prev->next = le->next;
-	le->next->prev = le->prev;
-
-	// insert into linked free list
-	le->next = cg_free_lents;
-	cg_free_lents = le;
-}
-
 /*
 * CG_AllocModel
 */
@@ -1579,135 +1632,177 @@ void CG_SmallPileOfGibs( const vec3_t origin, int damage, const vec3_t initialVe
 }
 
 /*
-* CG_AddLocalEntities
+* CG_CompactLocalEntities
+*
+* Drops simulated entities that are marked as removed preserving the order of other ones
 */
-void CG_AddLocalEntities( void ) {
-#define FADEINFRAMES 2
-	int f;
-	lentity_t *le, *next, *hnode;
-	entity_t *ent;
-	float scale, frac, fade, time, scaleIn, fadeIn;
-	float backlerp;
-	vec3_t angles;
+static void CG_CompactLocalEntities( void ) {
+	cg_numLocalEnts = cg_lentsSimulation.compact( cg_numLocalEnts, []( unsigned from, unsigned to ) {
+		cg_lentSlots[to] = cg_lentSlots[from];
+	} );
+	cg_lentsReplacementCursor = 0;
+}
 
-	time = (float)cg.frameTime * 0.001f;
-	backlerp = 1.0f - cg.lerpfrac;
+/*
+* CG_AdmitSpawnedLocalEntities
+*
+* Transfers initial motion parameters of entities that have been spawned since the last update to the simulation
+*/
+static void CG_AdmitSpawnedLocalEntities( void ) {
+	if( !cg_numSpawnedLocalEnts ) {
+		return;
+	}
 
-	hnode = &cg_localents_headnode;
-	for( le = hnode->next; le != hnode; le = next ) {
-		next = le->next;
+	// make room for spawned entities if some simulated ones have been replaced
+	if( cg_numLocalEnts + cg_numSpawnedLocalEnts > MAX_LOCAL_ENTITIES ) {
+		CG_CompactLocalEntities();
+	}
 
-		frac = ( cg.time - le->start ) * 0.01f;
-		f = ( int )floor( frac );
-		clamp_low( f, 0 );
+	for( int i = 0; i < cg_numSpawnedLocalEnts; i++ ) {
+		const uint32_t slot = cg_spawnedLocalEnts[( cg_spawnedLocalEntsHead + i ) % MAX_LOCAL_ENTITIES];
+		const lentity_t *le = &cg_localents[slot];
+		const int index = cg_numLocalEnts++;
+		cg_lentSlots[index] = slot;
+		cg_lentsSimulation.set( index, le->ent.origin, le->velocity, le->accel, (int32_t)le->start, le->frames );
+	}
 
-		// it's time to DIE
-		if( f >= le->frames - 1 ) {
-			le->type = LE_FREE;
-			CG_FreeLocalEntity( le );
-			continue;
-		}
+	cg_spawnedLocalEntsHead = 0;
+	cg_numSpawnedLocalEnts = 0;
+}
 
-		if( le->frames > 1 ) {
-			scale = 1.0f - frac / ( le->frames - 1 );
-			scale = bound( 0.0f, scale, 1.0f );
-			fade = scale * 255.0f;
+/*
+* CG_GroupLocalEntitiesByType
+*/
+static void CG_GroupLocalEntitiesByType( int numEnts ) {
+	int counts[LE_NUM_TYPES];
+	int i;
 
-			// quick fade in, if time enough
-			if( le->frames > FADEINFRAMES * 2 ) {
-				scaleIn = frac / (float)FADEINFRAMES;
-				Q_clamp( scaleIn, 0.0f, 1.0f );
-				fadeIn = scaleIn * 255.0f;
-			} else {
-				fadeIn = 255.0f;
-			}
-		} else {
-			scale = 1.0f;
-			fade = 255.0f;
-			fadeIn = 255.0f;
+	memset( counts, 0, sizeof( counts ) );
+	for( i = 0; i < numEnts; i++ ) {
+		if( !cg_lentsSimulation.removed[i] ) {
+			counts[CG_SimulatedLocalEntity( i )->type]++;
 		}
+	}
 
-		ent = &le->ent;
+	cg_lentsTypeOffsets[0] = 0;
+	for( i = 0; i < LE_NUM_TYPES; i++ ) {
+		cg_lentsTypeOffsets[i + 1] = cg_lentsTypeOffsets[i] + counts[i];
+		counts[i] = cg_lentsTypeOffsets[i];
+	}
 
-		if( le->light && scale ) {
-			RF_AddLightToScene( le->lightOrigin, le->light * scale, 0, le->lightcolor[0], le->lightcolor[1], le->lightcolor[2] );
+	for( i = 0; i < numEnts; i++ ) {
+		if( !cg_lentsSimulation.removed[i] ) {
+			cg_lentsByType[counts[CG_SimulatedLocalEntity( i )->type]++] = (uint32_t)i;
 		}
+	}
+}
 
-		if( le->type == LE_LASER ) {
-			CG_QuickPolyBeam( ent->origin, ent->origin2, ent->radius, ent->customShader ); // wsw : jalfixme: missing the color (comes inside ent->skinnum)
-			continue;
-		}
+#define FOR_EACH_LOCAL_ENTITY_OF_TYPE( type, indexVar ) \
+	for( int indexVar##Num = cg_lentsTypeOffsets[type], indexVar; \
+		 indexVar##Num < cg_lentsTypeOffsets[type + 1] && ( ( indexVar = cg_lentsByType[indexVar##Num] ), true ); indexVar##Num++ )
 
-		if( le->type == LE_DASH_SCALE ) {
-			if( f < 1 ) {
-				ent->scale = 0.15 * frac;
-			} else {
-				VecToAngles( &ent->axis[AXIS_RIGHT], angles );
-				ent->axis[1 * 3 + 1] += 0.005f * sin( DEG2RAD( angles[YAW] ) ); //length
-				ent->axis[1 * 3 + 0] += 0.005f * cos( DEG2RAD( angles[YAW] ) ); //length
-				ent->axis[0 * 3 + 1] += 0.008f * cos( DEG2RAD( angles[YAW] ) ); //width
-				ent->axis[0 * 3 + 0] -= 0.008f * sin( DEG2RAD( angles[YAW] ) ); //width
-				ent->axis[2 * 3 + 2] -= 0.052f;              //height
-
-				if( ent->axis[AXIS_UP + 2] <= 0 ) {
-					le->type = LE_FREE;
-					CG_FreeLocalEntity( le );
-				}
+/*
+* CG_UpdateLocalEntitiesOfType
+*
+* Applies type-specific scale and color changes
+*/
+static void CG_UpdateLocalEntitiesOfType( void ) {
+	auto *const sim = &cg_lentsSimulation;
+	vec3_t angles;
+
+	FOR_EACH_LOCAL_ENTITY_OF_TYPE( LE_DASH_SCALE, i ) {
+		entity_t *ent = &CG_SimulatedLocalEntity( i )->ent;
+		if( sim->frac[i] < 1.0f ) {
+			ent->scale = 0.15 * sim->frac[i];
+		} else {
+			VecToAngles( &ent->axis[AXIS_RIGHT], angles );
+			ent->axis[1 * 3 + 1] += 0.005f * sin( DEG2RAD( angles[YAW] ) ); //length
+			ent->axis[1 * 3 + 0] += 0.005f * cos( DEG2RAD( angles[YAW] ) ); //length
+			ent->axis[0 * 3 + 1] += 0.008f * cos( DEG2RAD( angles[YAW] ) ); //width
+			ent->axis[0 * 3 + 0] -= 0.008f * sin( DEG2RAD( angles[YAW] ) ); //width
+			ent->axis[2 * 3 + 2] -= 0.052f;              //height
+
+			if( ent->axis[AXIS_UP + 2] <= 0 ) {
+				sim->removed[i] = 1;
 			}
 		}
-		if( le->type == LE_PUFF_SCALE ) {
-			if( le->frames - f < 4 ) {
-				ent->scale = 1.0f - 1.0f * ( frac - abs( 4 - le->frames ) ) / 4;
-			}
+	}
+
+	FOR_EACH_LOCAL_ENTITY_OF_TYPE( LE_PUFF_SCALE, i ) {
+		const int frames = CG_SimulatedLocalEntity( i )->frames;
+		const float frac = sim->frac[i];
+		if( frames - (int)frac < 4 ) {
+			CG_SimulatedLocalEntity( i )->ent.scale = 1.0f - 1.0f * ( frac - abs( 4 - frames ) ) / 4;
 		}
-		if( le->type == LE_PUFF_SHRINK ) {
-			if( frac < 3 ) {
-				ent->scale = 1.0f - 0.2f * frac / 4;
-			} else {
-				ent->scale = 0.8 - 0.8 * ( frac - 3 ) / 3;
-				VectorScale( le->velocity, 0.85f, le->velocity );
-			}
+	}
+
+	FOR_EACH_LOCAL_ENTITY_OF_TYPE( LE_PUFF_SHRINK, i ) {
+		const float frac = sim->frac[i];
+		if( frac < 3 ) {
+			CG_SimulatedLocalEntity( i )->ent.scale = 1.0f - 0.2f * frac / 4;
+		} else {
+			CG_SimulatedLocalEntity( i )->ent.scale = 0.8 - 0.8 * ( frac - 3 ) / 3;
+			sim->velocityX[i] *= 0.85f;
+			sim->velocityY[i] *= 0.85f;
+			sim->velocityZ[i] *= 0.85f;
 		}
+	}
 
-		if( le->type == LE_EXPLOSION_TRACER ) {
-			if( cg.time - ent->rotation > 10.0f ) {
-				ent->rotation = cg.time;
-				if( ent->radius - 16 * frac > 4 ) {
-					CG_Explosion_Puff( ent->origin, ent->radius - 16 * frac, le->frames - f );
-				}
+	FOR_EACH_LOCAL_ENTITY_OF_TYPE( LE_EXPLOSION_TRACER, i ) {
+		entity_t *ent = &CG_SimulatedLocalEntity( i )->ent;
+		if( cg.time - ent->rotation > 10.0f ) {
+			const float frac = sim->frac[i];
+			ent->rotation = cg.time;
+			if( ent->radius - 16 * frac > 4 ) {
+				const vec3_t origin = { sim->originX[i], sim->originY[i], sim->originZ[i] };
+				// this spawns new entities which are going to be simulated on the next update
+				CG_Explosion_Puff( origin, ent->radius - 16 * frac, CG_SimulatedLocalEntity( i )->frames - (int)frac );
 			}
 		}
+	}
 
-		switch( le->type ) {
-			case LE_NO_FADE:
-				break;
-			case LE_RGB_FADE:
-				fade = std::min( fade, fadeIn );
-				ent->shaderRGBA[0] = ( uint8_t )( fade * le->color[0] );
-				ent->shaderRGBA[1] = ( uint8_t )( fade * le->color[1] );
-				ent->shaderRGBA[2] = ( uint8_t )( fade * le->color[2] );
-				break;
-			case LE_SCALE_ALPHA_FADE:
-				fade = std::min( fade, fadeIn );
-				ent->scale = 1.0f + 1.0f / scale;
-				ent->scale = std::min( ent->scale, 5.0f );
-				ent->shaderRGBA[3] = ( uint8_t )( fade * le->color[3] );
-				break;
-			case LE_INVERSESCALE_ALPHA_FADE:
-				fade = std::min( fade, fadeIn );
-				ent->scale = scale + 0.1f;
-				Q_clamp( ent->scale, 0.1f, 1.0f );
-				ent->shaderRGBA[3] = ( uint8_t )( fade * le->color[3] );
-				break;
-			case LE_ALPHA_FADE:
-				fade = std::min( fade, fadeIn );
-				ent->shaderRGBA[3] = ( uint8_t )( fade * le->color[3] );
-				break;
-			default:
-				break;
-		}
+	FOR_EACH_LOCAL_ENTITY_OF_TYPE( LE_RGB_FADE, i ) {
+		lentity_t *le = CG_SimulatedLocalEntity( i );
+		const float fade = 255.0f * std::min( sim->scale[i], sim->fadeIn[i] );
+		le->ent.shaderRGBA[0] = ( uint8_t )( fade * le->color[0] );
+		le->ent.shaderRGBA[1] = ( uint8_t )( fade * le->color[1] );
+		le->ent.shaderRGBA[2] = ( uint8_t )( fade * le->color[2] );
+	}
 
-		ent->backlerp = backlerp;
+	FOR_EACH_LOCAL_ENTITY_OF_TYPE( LE_SCALE_ALPHA_FADE, i ) {
+		lentity_t *le = CG_SimulatedLocalEntity( i );
+		const float fade = 255.0f * std::min( sim->scale[i], sim->fadeIn[i] );
+		le->ent.scale = 1.0f + 1.0f / sim->scale[i];
+		le->ent.scale = std::min( le->ent.scale, 5.0f );
+		le->ent.shaderRGBA[3] = ( uint8_t )( fade * le->color[3] );
+	}
+
+	FOR_EACH_LOCAL_ENTITY_OF_TYPE( LE_INVERSESCALE_ALPHA_FADE, i ) {
+		lentity_t *le = CG_SimulatedLocalEntity( i );
+		const float fade = 255.0f * std::min( sim->scale[i], sim->fadeIn[i] );
+		le->ent.scale = sim->scale[i] + 0.1f;
+		Q_clamp( le->ent.scale, 0.1f, 1.0f );
+		le->ent.shaderRGBA[3] = ( uint8_t )( fade * le->color[3] );
+	}
+
+	FOR_EACH_LOCAL_ENTITY_OF_TYPE( LE_ALPHA_FADE, i ) {
+		lentity_t *le = CG_SimulatedLocalEntity( i );
+		const float fade = 255.0f * std::min( sim->scale[i], sim->fadeIn[i] );
+		le->ent.shaderRGBA[3] = ( uint8_t )( fade * le->color[3] );
+	}
+}
+
+/*
+* CG_RotateLocalEntities
+*/
+static void CG_RotateLocalEntities( int numEnts, float time ) {
+	const float adj = 100 * 6 * time; // magic constants here
+
+	for( int i = 0; i < numEnts; i++ ) {
+		lentity_t *le = CG_SimulatedLocalEntity( i );
+		if( cg_lentsSimulation.removed[i] ) {
+			continue;
+		}
 
 		if( le->avelocity[0] || le->avelocity[1] || le->avelocity[2] ) {
 			VectorMA( le->angles, time, le->avelocity, le->angles );
@@ -1716,109 +1811,177 @@ void CG_AddLocalEntities( void ) {
 
 		// apply rotational friction
 		if( le->bounce ) { // FIXME?
-			int i;
-			const float adj = 100 * 6 * time; // magic constants here
-
-			for( i = 0; i < 3; i++ ) {
-				if( le->avelocity[i] > 0.0f ) {
-					le->avelocity[i] -= adj;
-					if( le->avelocity[i] < 0.0f ) {
-						le->avelocity[i] = 0.0f;
+			for( int j = 0; j < 3; j++ ) {
+				if( le->avelocity[j] > 0.0f ) {
+					le->avelocity[j] -= adj;
+					if( le->avelocity[j] < 0.0f ) {
+						le->avelocity[j] = 0.0f;
 					}
-				} else if( le->avelocity[i] < 0.0f ) {
-					le->avelocity[i] += adj;
-					if( le->avelocity[i] > 0.0f ) {
-						le->avelocity[i] = 0.0f;
+				} else if( le->avelocity[j] < 0.0f ) {
+					le->avelocity[j] += adj;
+					if( le->avelocity[j] > 0.0f ) {
+						le->avelocity[j] = 0.0f;
 					}
 				}
 			}
 		}
+	}
+}
 
-		if( le->bounce ) {
-			trace_t trace;
-			vec3_t next_origin;
+/*
+* CG_BounceLocalEntities
+*
+* Traces predicted moves of bouncing entities in a batch and corrects ones that have hit something
+*/
+static void CG_BounceLocalEntities( int numEnts, float time ) {
+	auto *const sim = &cg_lentsSimulation;
+	int numBouncing = 0;
 
-			VectorMA( ent->origin, time, le->velocity, next_origin );
+	for( int i = 0; i < numEnts; i++ ) {
+		if( CG_SimulatedLocalEntity( i )->bounce && !sim->removed[i] ) {
+			cg_bouncingLocalEnts[numBouncing++] = (uint32_t)i;
+		}
+	}
 
-			CG_Trace( &trace, ent->origin, debris_mins, debris_maxs, next_origin, 0, MASK_SOLID );
+	for( int j = 0; j < numBouncing; j++ ) {
+		const int i = cg_bouncingLocalEnts[j];
+		lentity_t *le = CG_SimulatedLocalEntity( i );
+		trace_t trace;
+		vec3_t origin = { sim->originX[i], sim->originY[i], sim->originZ[i] };
+		vec3_t next_origin = { sim->nextX[i], sim->nextY[i], sim->nextZ[i] };
 
-			// remove the particle when going out of the map
-			if( ( trace.contents & CONTENTS_NODROP ) || ( trace.surfFlags & SURF_SKY ) ) {
-				le->frames = 0;
-			} else if( trace.fraction != 1.0 ) {   // found solid
-				float dot;
-				float xyzspeed, orig_xyzspeed;
-				float bounce;
+		CG_Trace( &trace, origin, debris_mins, debris_maxs, next_origin, 0, MASK_SOLID );
 
-				orig_xyzspeed = VectorLength( le->velocity );
+		// remove the particle when going out of the map
+		if( ( trace.contents & CONTENTS_NODROP ) || ( trace.surfFlags & SURF_SKY ) ) {
+			sim->frames[i] = 0;
+		} else if( trace.fraction != 1.0 ) {   // found solid
+			vec3_t velocity = { sim->velocityX[i], sim->velocityY[i], sim->velocityZ[i] };
+			float dot;
+			float xyzspeed, orig_xyzspeed;
+			float bounce;
 
-				// Reflect velocity
-				dot = DotProduct( le->velocity, trace.plane.normal );
-				VectorMA( le->velocity, -2.0f * dot, trace.plane.normal, le->velocity );
+			orig_xyzspeed = VectorLength( velocity );
 
-				//put new origin in the impact point, but move it out a bit along the normal
-				VectorMA( trace.endpos, 1, trace.plane.normal, ent->origin );
+			// Reflect velocity
+			dot = DotProduct( velocity, trace.plane.normal );
+			VectorMA( velocity, -2.0f * dot, trace.plane.normal, velocity );
 
-				// make sure we don't gain speed from bouncing off
-				bounce = 2.0f * le->bounce * 0.01f;
-				if( bounce < 1.5f ) {
-					bounce = 1.5f;
-				}
-				xyzspeed = orig_xyzspeed / bounce;
-
-				VectorNormalize( le->velocity );
-				VectorScale( le->velocity, xyzspeed, le->velocity );
-
-				//the entity has not speed enough. Stop checks
-				if( xyzspeed * time < 1.0f ) {
-					trace_t traceground;
-					vec3_t ground_origin;
-
-					//see if we have ground
-					VectorCopy( ent->origin, ground_origin );
-					ground_origin[2] += ( debris_mins[2] - 4 );
-					CG_Trace( &traceground, ent->origin, debris_mins, debris_maxs, ground_origin, 0, MASK_SOLID );
-					if( traceground.fraction != 1.0 ) {
-						le->bounce = 0;
-						VectorClear( le->velocity );
-						VectorClear( le->accel );
-						VectorClear( le->avelocity );
-						if( le->type == LE_EXPLOSION_TRACER ) {
-							// blx
-							le->type = LE_FREE;
-							CG_FreeLocalEntity( le );
-						}
+			//put new origin in the impact point, but move it out a bit along the normal
+			VectorMA( trace.endpos, 1, trace.plane.normal, origin );
+
+			// make sure we don't gain speed from bouncing off
+			bounce = 2.0f * le->bounce * 0.01f;
+			if( bounce < 1.5f ) {
+				bounce = 1.5f;
+			}
+			xyzspeed = orig_xyzspeed / bounce;
+
+			VectorNormalize( velocity );
+			VectorScale( velocity, xyzspeed, velocity );
+
+			//the entity has not speed enough. Stop checks
+			if( xyzspeed * time < 1.0f ) {
+				trace_t traceground;
+				vec3_t ground_origin;
+
+				//see if we have ground
+				VectorCopy( origin, ground_origin );
+				ground_origin[2] += ( debris_mins[2] - 4 );
+				CG_Trace( &traceground, origin, debris_mins, debris_maxs, ground_origin, 0, MASK_SOLID );
+				if( traceground.fraction != 1.0 ) {
+					le->bounce = 0;
+					VectorClear( velocity );
+					sim->accelX[i] = sim->accelY[i] = sim->accelZ[i] = 0.0f;
+					VectorClear( le->avelocity );
+					if( le->type == LE_EXPLOSION_TRACER ) {
+						// blx
+						sim->removed[i] = 1;
 					}
 				}
-
-			} else {
-				VectorCopy( ent->origin, ent->origin2 );
-				VectorCopy( next_origin, ent->origin );
 			}
-		} else {
-			VectorCopy( ent->origin, ent->origin2 );
-			VectorMA( ent->origin, time, le->velocity, ent->origin );
+
+			sim->nextX[i] = origin[0], sim->nextY[i] = origin[1], sim->nextZ[i] = origin[2];
+			sim->velocityX[i] = velocity[0], sim->velocityY[i] = velocity[1], sim->velocityZ[i] = velocity[2];
+		}
+	}
+}
+
+/*
+* CG_AddLocalEntities
+*/
+void CG_AddLocalEntities( void ) {
+	auto *const sim = &cg_lentsSimulation;
+	float time, backlerp;
+	int i, numEnts;
+
+	time = (float)cg.frameTime * 0.001f;
+	backlerp = 1.0f - cg.lerpfrac;
+
+	CG_AdmitSpawnedLocalEntities();
+
+	// entities that are spawned during the update are added after this range
+	numEnts = cg_numLocalEnts;
+
+	sim->updateLifetimes( numEnts, (int32_t)cg.time );
+
+	for( i = 0; i < numEnts; i++ ) {
+		lentity_t *le = CG_SimulatedLocalEntity( i );
+		if( le->light && sim->scale[i] && !sim->removed[i] ) {
+			RF_AddLightToScene( le->lightOrigin, le->light * sim->scale[i], 0, le->lightcolor[0], le->lightcolor[1], le->lightcolor[2] );
+		}
+	}
+
+	CG_GroupLocalEntitiesByType( numEnts );
+
+	FOR_EACH_LOCAL_ENTITY_OF_TYPE( LE_LASER, i ) {
+		entity_t *ent = &CG_SimulatedLocalEntity( i )->ent;
+		CG_QuickPolyBeam( ent->origin, ent->origin2, ent->radius, ent->customShader ); // wsw : jalfixme: missing the color (comes inside ent->skinnum)
+	}
+
+	CG_UpdateLocalEntitiesOfType();
+
+	CG_RotateLocalEntities( numEnts, time );
+
+	sim->predictOrigins( numEnts, time );
+	CG_BounceLocalEntities( numEnts, time );
+	sim->commitOrigins( numEnts, time );
+
+	for( i = 0; i < numEnts; i++ ) {
+		lentity_t *le = CG_SimulatedLocalEntity( i );
+		entity_t *ent = &le->ent;
+		if( sim->removed[i] || le->type == LE_LASER ) {
+			continue;
 		}
 
+		VectorSet( ent->origin2, sim->oldOriginX[i], sim->oldOriginY[i], sim->oldOriginZ[i] );
+		VectorSet( ent->origin, sim->originX[i], sim->originY[i], sim->originZ[i] );
 		VectorCopy( ent->origin, ent->lightingOrigin );
-		VectorMA( le->velocity, time, le->accel, le->velocity );
+		ent->backlerp = backlerp;
 
 		CG_AddEntityToScene( ent );
 	}
+
+	for( i = 0; i < numEnts; i++ ) {
+		const uint32_t slot = cg_lentSlots[i];
+		if( sim->removed[i] && slot != LENTS_SCRATCH_SLOT ) {
+			CG_ReleaseLocalEntity( &cg_localents[slot] );
+			cg_freeLocalEntSlots[cg_numFreeLocalEntSlots++] = slot;
+		}
+	}
+
+	CG_CompactLocalEntities();
+
+	// entities spawned during the update are appended after the simulated ones
+	CG_AdmitSpawnedLocalEntities();
 }
 
 /*
 * CG_FreeLocalEntities
 */
 void CG_FreeLocalEntities( void ) {
-	lentity_t *le, *next, *hnode;
-
-	hnode = &cg_localents_headnode;
-	for( le = hnode->next; le != hnode; le = next ) {
-		next = le->next;
-
-		le->type = LE_FREE;
-		CG_FreeLocalEntity( le );
+	for( int i = 0; i < MAX_LOCAL_ENTITIES; i++ ) {
+		CG_ReleaseLocalEntity( &cg_localents[i] );
 	}
 
 	CG_ClearLocalEntities();
@@ -0,0 +1,144 @@
+#ifndef WSW_CG_LENTSIMULATION_H
+#define WSW_CG_LENTSIMULATION_H
+
+#include <cstdint>
+
+/**
+ * A motion and lifetime state of local entities stored as a structure of arrays.
+ * Entities are kept densely in [0, numEntities) so all updates are plain loops over arrays
+ * that get vectorized by a compiler. Type-specific and collision logic is left to a caller.
+ * @note entity indices are the same as indices of a caller-side storage of entity properties
+ * that are not needed for the simulation, and {@code compact()} reports moves to keep them in sync.
+ */
+template <unsigned Capacity>
+class LocalEntitiesSimulation {
+public:
+	alignas( 16 ) float originX[Capacity];
+	alignas( 16 ) float originY[Capacity];
+	alignas( 16 ) float originZ[Capacity];
+	alignas( 16 ) float oldOriginX[Capacity];
+	alignas( 16 ) float oldOriginY[Capacity];
+	alignas( 16 ) float oldOriginZ[Capacity];
+	alignas( 16 ) float nextX[Capacity];
+	alignas( 16 ) float nextY[Capacity];
+	alignas( 16 ) float nextZ[Capacity];
+	alignas( 16 ) float velocityX[Capacity];
+	alignas( 16 ) float velocityY[Capacity];
+	alignas( 16 ) float velocityZ[Capacity];
+	alignas( 16 ) float accelX[Capacity];
+	alignas( 16 ) float accelY[Capacity];
+	alignas( 16 ) float accelZ[Capacity];
+	// A number of 100 ms frames an entity lives for
+	alignas( 16 ) float frames[Capacity];
+	alignas( 16 ) int32_t startTime[Capacity];
+
+	// Outputs of updateLifetimes()
+	alignas( 16 ) float frac[Capacity];
+	alignas( 16 ) float scale[Capacity];
+	alignas( 16 ) float fadeIn[Capacity];
+	alignas( 16 ) uint8_t removed[Capacity];
+
+	static constexpr float kFadeInFrames = 2.0f;
+
+	void set( unsigned index, const float *origin, const float *velocity, const float *accel, int32_t time, int numFrames ) {
+		originX[index] = oldOriginX[index] = nextX[index] = origin[0];
+		originY[index] = oldOriginY[index] = nextY[index] = origin[1];
+		originZ[index] = oldOriginZ[index] = nextZ[index] = origin[2];
+		velocityX[index] = velocity[0];
+		velocityY[index] = velocity[1];
+		velocityZ[index] = velocity[2];
+		accelX[index] = accel[0];
+		accelY[index] = accel[1];
+		accelZ[index] = accel[2];
+		frames[index] = (float)numFrames;
+		startTime[index] = time;
+		frac[index] = 0.0f;
+		scale[index] = 1.0f;
+		fadeIn[index] = 1.0f;
+		removed[index] = 0;
+	}
+
+	/**
+	 * Computes a lifetime fraction in frames, a fade-out scale and a fade-in scale.
+	 * Marks expired entities as removed.
+	 */
+	void updateLifetimes( unsigned numEntities, int32_t time ) {
+		for( unsigned i = 0; i < numEntities; ++i ) {
+			const float entFrac = 0.01f * (float)( time - startTime[i] );
+			const float lastFrame = frames[i] - 1.0f;
+			// Entities die once the integral part of the fraction reaches the last frame
+			removed[i] |= (uint8_t)( entFrac >= lastFrame );
+			float entScale = lastFrame > 0.0f ? 1.0f - entFrac / lastFrame : 1.0f;
+			entScale = entScale < 0.0f ? 0.0f : ( entScale > 1.0f ? 1.0f : entScale );
+			// Do a quick fade in, if there is enough time
+			float entFadeIn = frames[i] > 2.0f * kFadeInFrames ? entFrac * ( 1.0f / kFadeInFrames ) : 1.0f;
+			entFadeIn = entFadeIn < 0.0f ? 0.0f : ( entFadeIn > 1.0f ? 1.0f : entFadeIn );
+			frac[i] = entFrac;
+			scale[i] = entScale;
+			fadeIn[i] = entFadeIn;
+		}
+	}
+
+	/**
+	 * Computes positions for the end of the frame assuming there are no obstacles.
+	 * A caller is free to modify next positions and velocities of colliding entities before committing.
+	 */
+	void predictOrigins( unsigned numEntities, float seconds ) {
+		for( unsigned i = 0; i < numEntities; ++i ) {
+			nextX[i] = originX[i] + velocityX[i] * seconds;
+			nextY[i] = originY[i] + velocityY[i] * seconds;
+			nextZ[i] = originZ[i] + velocityZ[i] * seconds;
+		}
+	}
+
+	void commitOrigins( unsigned numEntities, float seconds ) {
+		for( unsigned i = 0; i < numEntities; ++i ) {
+			oldOriginX[i] = originX[i];
+			oldOriginY[i] = originY[i];
+			oldOriginZ[i] = originZ[i];
+			originX[i] = nextX[i];
+			originY[i] = nextY[i];
+			originZ[i] = nextZ[i];
+			velocityX[i] += accelX[i] * seconds;
+			velocityY[i] += accelY[i] * seconds;
+			velocityZ[i] += accelZ[i] * seconds;
+		}
+	}
+
+	void move( unsigned from, unsigned to ) {
+		originX[to] = originX[from], originY[to] = originY[from], originZ[to] = originZ[from];
+		oldOriginX[to] = oldOriginX[from], oldOriginY[to] = oldOriginY[from], oldOriginZ[to] = oldOriginZ[from];
+		nextX[to] = nextX[from], nextY[to] = nextY[from], nextZ[to] = nextZ[from];
+		velocityX[to] = velocityX[from], velocityY[to] = velocityY[from], velocityZ[to] = velocityZ[from];
+		accelX[to] = accelX[from], accelY[to] = accelY[from], accelZ[to] = accelZ[from];
+		frames[to] = frames[from];
+		startTime[to] = startTime[from];
+		frac[to] = frac[from];
+		scale[to] = scale[from];
+		fadeIn[to] = fadeIn[from];
+		removed[to] = removed[from];
+	}
+
+	/**
+	 * Removes entities that are marked as removed preserving an order of other ones.
+	 * @param onMove a function that gets called with (from, to) indices of every moved entity
+	 * @return a new number of entities
+	 */
+	template <typename OnMove>
+	unsigned compact( unsigned numEntities, OnMove &&onMove ) {
+		unsigned numKept = 0;
+		for( unsigned i = 0; i < numEntities; ++i ) {
+			if( removed[i] ) {
+				continue;
+			}
+			if( i != numKept ) {
+				move( i, numKept );
+				onMove( i, numKept );
+			}
+			numKept++;
+		}
+		return numKept;
+	}
+};
+
+#endif
@@ -545,11 +545,6 @@ typedef struct {
 	int predictedGroundEntity;
 	gs_laserbeamtrail_t weaklaserTrail;
 
-	// prediction optimization (don't run all ucmds in not needed)
-	int64_t predictFrom;
-	entity_state_t predictFromEntityState;
-	player_state_t predictFromPlayerState;
-
 	int lastWeapon;
 	unsigned int lastCrossWeapons; // bitfield containing the last weapons selected from the cross
 
@@ -705,6 +700,8 @@ void CG_PredictedEvent( int entNum, int ev, int parm );
 void CG_Predict_ChangeWeapon( int new_weapon );
 void CG_PredictMovement( void );
 void CG_CheckPredictionError( void );
+void CG_ValidatePredictionCheckpoints( void );
+void CG_ClearPredictionCheckpoints( void );
 void CG_BuildSolidList( void );
 void CG_Trace( trace_t *t, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int ignore, int contentmask );
 int CG_PointContents( const vec3_t point );
@@ -923,7 +923,7 @@ void CG_Reset( void ) {
 	chaseCam.cmd_mode_delay = 0; // cg.time
 
 	// reset prediction optimization
-	cg.predictFrom = 0;
+	CG_ClearPredictionCheckpoints();
 
 	memset( cg_entities, 0, sizeof( cg_entities ) );
 }
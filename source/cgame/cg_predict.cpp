@@ -19,6 +19,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 */
 
 #include "cg_local.h"
+#include "cg_predictioncheckpoints.h"
+#include "../qcommon/wswaabbtree.h"
 
 int cg_numSolids;
 static entity_state_t *cg_solidList[MAX_PARSE_ENTITIES];
@@ -26,6 +28,8 @@ static entity_state_t *cg_solidList[MAX_PARSE_ENTITIES];
 int cg_numTriggers;
 static entity_state_t *cg_triggersList[MAX_PARSE_ENTITIES];
 static bool cg_triggersListTriggered[MAX_PARSE_ENTITIES];
+// Triggers are touched for every predicted command, so their bounds are put in a tree once per snapshot
+static wsw::AabbTree<MAX_PARSE_ENTITIES> cg_triggersTree;
 
 static bool ucmdReady = false;
 
@@ -106,6 +110,35 @@ void CG_CheckPredictionError( void ) {
 	}
 }
 
+/*
+* CG_BuildTriggersTree
+*/
+static void CG_BuildTriggersTree( void ) {
+	int i;
+	vec3_t mins, maxs;
+
+	cg_triggersTree.clear();
+	for( i = 0; i < cg_numTriggers; i++ ) {
+		const entity_state_t *state = cg_triggersList[i];
+		const cmodel_s *cmodel = CG_CModelForEntity( state->number );
+		if( !cmodel ) {
+			continue;
+		}
+
+		CG_InlineModelBounds( cmodel, mins, maxs );
+		if( state->angles[0] || state->angles[1] || state->angles[2] ) {
+			// expand for rotation
+			const float radius = RadiusFromBounds( mins, maxs );
+			VectorSet( mins, -radius, -radius, -radius );
+			VectorSet( maxs, radius, radius, radius );
+		}
+		VectorAdd( state->origin, mins, mins );
+		VectorAdd( state->origin, maxs, maxs );
+		cg_triggersTree.add( i, mins, maxs );
+	}
+	cg_triggersTree.build();
+}
+
 /*
 * CG_BuildSolidList
 */
@@ -149,6 +182,8 @@ void CG_BuildSolidList( void ) {
 			}
 		}
 	}
+
+	CG_BuildTriggersTree();
 }
 
 /*
@@ -201,7 +236,9 @@ static bool CG_ClipEntityContact( const vec3_t origin, const vec3_t mins, const
 * CG_Predict_TouchTriggers
 */
 void CG_Predict_TouchTriggers( pmove_t *pm, const vec3_t previous_origin ) {
-	int i;
+	int i, num;
+	int touch[MAX_PARSE_ENTITIES];
+	vec3_t mins, maxs;
 	entity_state_t *state;
 
 	// fixme: more accurate check for being able to touch or not
@@ -209,7 +246,19 @@ void CG_Predict_TouchTriggers( pmove_t *pm, const vec3_t previous_origin ) {
 		return;
 	}
 
-	for( i = 0; i < cg_numTriggers; i++ ) {
+	VectorAdd( pm->playerState->pmove.origin, pm->mins, mins );
+	VectorAdd( pm->playerState->pmove.origin, pm->maxs, maxs );
+
+	num = 0;
+	cg_triggersTree.query( mins, maxs, [&]( unsigned index ) {
+		touch[num++] = (int)index;
+	});
+
+	// touch triggers in the same order as the server does
+	std::sort( touch, touch + num );
+
+	for( int j = 0; j < num; j++ ) {
+		i = touch[j];
 		state = cg_triggersList[i];
 
 		if( state->type == ET_PUSH_TRIGGER ) {
@@ -336,6 +385,98 @@ int CG_PointContents( const vec3_t point ) {
 
 
 static float predictedSteps[CMD_BACKUP]; // for step smoothing
+
+typedef struct {
+	player_state_t playerState;
+	int weapon;                 // the weapon of the POV entity is predicted too
+} cg_predictedstate_t;
+
+// prediction optimization (don't run all ucmds if not needed)
+static PredictionCheckpoints<cg_predictedstate_t, CMD_BACKUP> predictionCheckpoints;
+
+/*
+* CG_CopyPredictedFields
+*
+* Copies player state fields that are modified by Pmove() and GS_ThinkPlayerWeapon()
+*/
+static void CG_CopyPredictedFields( const player_state_t *from, player_state_t *to ) {
+	to->pmove = from->pmove;
+	VectorCopy( from->viewangles, to->viewangles );
+	to->viewheight = from->viewheight;
+	to->weaponState = from->weaponState;
+	to->stats[STAT_WEAPON] = from->stats[STAT_WEAPON];
+	to->stats[STAT_PENDING_WEAPON] = from->stats[STAT_PENDING_WEAPON];
+	to->stats[STAT_WEAPON_TIME] = from->stats[STAT_WEAPON_TIME];
+	memcpy( to->inventory, from->inventory, sizeof( to->inventory ) );
+}
+
+/*
+* CG_PredictedStatesMatch
+*/
+static bool CG_PredictedStatesMatch( const cg_predictedstate_t &predicted, const cg_predictedstate_t &received ) {
+	const player_state_t *p = &predicted.playerState;
+	const player_state_t *r = &received.playerState;
+
+	if( predicted.weapon != received.weapon ) {
+		return false;
+	}
+
+	const pmove_state_t *pp = &p->pmove;
+	const pmove_state_t *rp = &r->pmove;
+	if( pp->pm_type != rp->pm_type || pp->pm_flags != rp->pm_flags || pp->pm_time != rp->pm_time ) {
+		return false;
+	}
+	if( pp->gravity != rp->gravity || memcmp( pp->stats, rp->stats, sizeof( pp->stats ) ) ) {
+		return false;
+	}
+	if( !VectorCompare( pp->delta_angles, rp->delta_angles ) ) {
+		return false;
+	}
+
+	// Tolerate differences caused by a network transmission of floats
+	for( int i = 0; i < 3; i++ ) {
+		if( fabsf( pp->origin[i] - rp->origin[i] ) > 0.125f || fabsf( pp->velocity[i] - rp->velocity[i] ) > 1.0f ) {
+			return false;
+		}
+	}
+
+	if( p->weaponState != r->weaponState || p->stats[STAT_WEAPON_TIME] != r->stats[STAT_WEAPON_TIME] ) {
+		return false;
+	}
+	if( p->stats[STAT_WEAPON] != r->stats[STAT_WEAPON] || p->stats[STAT_PENDING_WEAPON] != r->stats[STAT_PENDING_WEAPON] ) {
+		return false;
+	}
+
+	return !memcmp( p->inventory, r->inventory, sizeof( p->inventory ) );
+}
+
+/*
+* CG_ValidatePredictionCheckpoints
+*
+* Should be called on every new snapshot. Keeps predicted states as long as the server agrees with them.
+*/
+void CG_ValidatePredictionCheckpoints( void ) {
+	if( !cg_predict_optimize->integer ) {
+		predictionCheckpoints.clear();
+		return;
+	}
+
+	cg_predictedstate_t received;
+	received.playerState = cg.frame.playerState;
+	received.weapon = cg_entities[cg.frame.playerState.POVnum].current.weapon;
+	if( !predictionCheckpoints.validate( cg.frame.ucmdExecuted, received, CG_PredictedStatesMatch ) ) {
+		if( cg_showMiss->integer > 1 ) {
+			Com_Printf( "prediction rollback on %" PRIi64 "\n", cg.frame.ucmdExecuted );
+		}
+	}
+}
+
+/*
+* CG_ClearPredictionCheckpoints
+*/
+void CG_ClearPredictionCheckpoints( void ) {
+	predictionCheckpoints.clear();
+}
 /*
 * CG_PredictAddStep
 */
@@ -402,36 +543,18 @@ static void CG_PredictSmoothSteps( void ) {
 */
 void CG_PredictMovement( void ) {
 	int64_t ucmdExecuted, ucmdHead;
-	int64_t frame;
 	pmove_t pm;
 
 	NET_GetCurrentState( NULL, &ucmdHead, NULL );
 	ucmdExecuted = cg.frame.ucmdExecuted;
 
-	if( !cg_predict_optimize->integer || ( ucmdHead - cg.predictFrom >= CMD_BACKUP ) ) {
-		cg.predictFrom = 0;
-	}
-
-	if( cg.predictFrom > 0 ) {
-		ucmdExecuted = cg.predictFrom;
-		cg.predictedPlayerState = cg.predictFromPlayerState;
-		cg_entities[cg.frame.playerState.POVnum].current = cg.predictFromEntityState;
-	} else {
-		cg.predictedPlayerState = cg.frame.playerState; // start from the final position
+	if( !cg_predict_optimize->integer ) {
+		predictionCheckpoints.clear();
 	}
 
+	cg.predictedPlayerState = cg.frame.playerState; // start from the final position
 	cg.predictedPlayerState.POVnum = cgs.playerNum + 1;
 
-	// if we are too far out of date, just freeze
-	if( ucmdHead - ucmdExecuted >= CMD_BACKUP ) {
-		if( cg_showMiss->integer ) {
-			Com_Printf( "exceeded CMD_BACKUP\n" );
-		}
-
-		cg.predictingTimeStamp = cg.time;
-		return;
-	}
-
 	// copy current state to pmove
 	memset( &pm, 0, sizeof( pm ) );
 	pm.playerState = &cg.predictedPlayerState;
@@ -439,9 +562,14 @@ void CG_PredictMovement( void ) {
 	// clear the triggered toggles for this prediction round
 	memset( &cg_triggersListTriggered, false, sizeof( cg_triggersListTriggered ) );
 
-	// run frames
-	while( ++ucmdExecuted <= ucmdHead ) {
-		frame = ucmdExecuted & CMD_MASK;
+	// resume from the latest checkpoint if it has been confirmed by snapshots
+	auto restore = []( const cg_predictedstate_t &checkpoint ) {
+		CG_CopyPredictedFields( &checkpoint.playerState, &cg.predictedPlayerState );
+		cg_entities[cg.frame.playerState.POVnum].current.weapon = checkpoint.weapon;
+	};
+
+	auto apply = [&]( int64_t ucmdNum ) {
+		const int64_t frame = ucmdNum & CMD_MASK;
 		NET_GetUserCmd( frame, &pm.cmd );
 
 		ucmdReady = ( pm.cmd.serverTimeStamp != 0 );
@@ -455,7 +583,7 @@ void CG_PredictMovement( void ) {
 		predictedSteps[frame] = pm.step;
 
 		if( ucmdReady ) { // hmm fixme: the wip command may not be run enough time to get proper key presses
-			if( ucmdExecuted >= ucmdHead - 1 ) {
+			if( ucmdNum >= ucmdHead - 1 ) {
 				GS_AddLaserbeamPoint( &cg.weaklaserTrail, &cg.predictedPlayerState, pm.cmd.serverTimeStamp );
 			}
 
@@ -464,15 +592,25 @@ void CG_PredictMovement( void ) {
 
 		// save for debug checking
 		VectorCopy( cg.predictedPlayerState.pmove.origin, cg.predictedOrigins[frame] ); // store for prediction error checks
-
-		// backup the last predicted ucmd which has a timestamp (it's closed)
-		if( cg_predict_optimize->integer && ucmdExecuted == ucmdHead - 1 ) {
-			if( ucmdExecuted != cg.predictFrom ) {
-				cg.predictFrom = ucmdExecuted;
-				cg.predictFromPlayerState = cg.predictedPlayerState;
-				cg.predictFromEntityState = cg_entities[cg.frame.playerState.POVnum].current;
-			}
+	};
+
+	// backup predicted ucmds which have a timestamp (they're closed)
+	auto capture = []() {
+		cg_predictedstate_t checkpoint;
+		checkpoint.playerState = cg.predictedPlayerState;
+		checkpoint.weapon = cg_entities[cg.frame.playerState.POVnum].current.weapon;
+		return checkpoint;
+	};
+
+	const bool addCheckpoints = cg_predict_optimize->integer != 0;
+	if( predictionCheckpoints.predict( ucmdExecuted, ucmdHead, addCheckpoints, restore, apply, capture ) < 0 ) {
+		// if we are too far out of date, just freeze
+		if( cg_showMiss->integer ) {
+			Com_Printf( "exceeded CMD_BACKUP\n" );
 		}
+
+		cg.predictingTimeStamp = cg.time;
+		return;
 	}
 
 	cg.predictedGroundEntity = pm.groundentity;
@@ -0,0 +1,114 @@
+#ifndef WSW_CG_PREDICTIONCHECKPOINTS_H
+#define WSW_CG_PREDICTIONCHECKPOINTS_H
+
+#include <cstdint>
+
+/**
+ * A ring of predicted states keyed by numbers of usercmds that have been applied to get a state.
+ * Checkpoints always form a contiguous range of usercmd numbers.
+ * A prediction resumes from the latest checkpoint as long as the chain is confirmed by snapshots.
+ * The chain is discarded only if a snapshot disagrees with a checkpoint for an acknowledged usercmd.
+ * This keeps a prediction cost constant regardless of a number of usercmds that are not acknowledged yet.
+ */
+template <typename State, unsigned Capacity>
+class PredictionCheckpoints {
+	static_assert( Capacity && !( Capacity & ( Capacity - 1 ) ), "The capacity must be a power of 2" );
+
+	State states[Capacity];
+	// The valid range is [oldestNum, latestNum]. Zero latestNum means there are no checkpoints.
+	int64_t oldestNum { 0 };
+	int64_t latestNum { 0 };
+public:
+	void clear() { oldestNum = latestNum = 0; }
+
+	[[nodiscard]]
+	bool empty() const { return !latestNum; }
+
+	[[nodiscard]]
+	int64_t latest() const { return latestNum; }
+
+	[[nodiscard]]
+	const State *get( int64_t ucmdNum ) const {
+		if( !latestNum || ucmdNum < oldestNum || ucmdNum > latestNum ) {
+			return nullptr;
+		}
+		return &states[ucmdNum & ( Capacity - 1 )];
+	}
+
+	[[nodiscard]]
+	const State *getLatest() const { return get( latestNum ); }
+
+	/**
+	 * Adds a checkpoint for a state that is a result of applying the usercmd.
+	 * Checkpoints for later usercmds (if any) get discarded as they have been derived from an overwritten state.
+	 * A checkpoint that does not continue the existing range starts a new range.
+	 */
+	void add( int64_t ucmdNum, const State &state ) {
+		if( !latestNum || ucmdNum < oldestNum || ucmdNum > latestNum + 1 ) {
+			oldestNum = ucmdNum;
+		}
+		latestNum = ucmdNum;
+		if( latestNum - oldestNum >= (int64_t)Capacity ) {
+			oldestNum = latestNum - Capacity + 1;
+		}
+		states[ucmdNum & ( Capacity - 1 )] = state;
+	}
+
+	/**
+	 * Checks whether the chain of checkpoints agrees with an authoritative state.
+	 * Checkpoints before the acknowledged usercmd are dropped as they are not going to be needed anymore.
+	 * @param ucmdNum a number of the last usercmd that has been applied to get the authoritative state
+	 * @param authoritativeState a state received from a server
+	 * @param matches a predicate that tells whether a predicted state is close enough to an authoritative one
+	 * @return true if the chain is kept, false if all checkpoints have been discarded
+	 */
+	template <typename Matcher>
+	bool validate( int64_t ucmdNum, const State &authoritativeState, Matcher &&matches ) {
+		if( const State *predictedState = get( ucmdNum ) ) {
+			if( matches( *predictedState, authoritativeState ) ) {
+				oldestNum = ucmdNum;
+				return true;
+			}
+		}
+		clear();
+		return false;
+	}
+
+	/**
+	 * Predicts a state for the head usercmd.
+	 * The prediction starts from the authoritative state of the acknowledged usercmd (that is current for callbacks),
+	 * or resumes from the latest checkpoint if it lies between the acknowledged usercmd and the head one.
+	 * Every closed usercmd (all usercmds but the head one) gets a checkpoint if {@code addCheckpoints} is set.
+	 * @param ucmdExecuted a number of the last usercmd that has been applied to get the authoritative state
+	 * @param ucmdHead a number of the usercmd that is still in progress
+	 * @param restore makes a checkpoint passed as an argument current
+	 * @param apply applies a usercmd of the passed number to the current state
+	 * @param capture returns the current state
+	 * @return a number of applied usercmds, -1 if there are too many usercmds that are not acknowledged yet
+	 */
+	template <typename Restore, typename Apply, typename Capture>
+	int predict( int64_t ucmdExecuted, int64_t ucmdHead, bool addCheckpoints,
+				 Restore &&restore, Apply &&apply, Capture &&capture ) {
+		if( latestNum > ucmdExecuted && latestNum < ucmdHead ) {
+			restore( *getLatest() );
+			ucmdExecuted = latestNum;
+		}
+
+		if( ucmdHead - ucmdExecuted >= (int64_t)Capacity ) {
+			return -1;
+		}
+
+		int numApplied = 0;
+		while( ++ucmdExecuted <= ucmdHead ) {
+			apply( ucmdExecuted );
+			numApplied++;
+			if( addCheckpoints && ucmdExecuted < ucmdHead ) {
+				add( ucmdExecuted, capture() );
+			}
+		}
+
+		return numApplied;
+	}
+};
+
+#endif
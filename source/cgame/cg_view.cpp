@@ -967,7 +967,7 @@ static void CG_SetupViewDef( cg_viewdef_t *view, int type ) {
 			}
 		} else {
 			cg.predictingTimeStamp = cg.time;
-			cg.predictFrom = 0;
+			CG_ClearPredictionCheckpoints();
 
 			// we don't run prediction, but we still set cg.predictedPlayerState with the interpolation
 			CG_InterpolatePlayerState( &cg.predictedPlayerState );
@@ -21,6 +21,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "client.h"
 #include "../ref/frontend.h"
+#include "../qcommon/wswallocators.h"
 
 #define CON_MAXLINES    500
 typedef struct {
@@ -40,6 +41,23 @@ typedef struct {
 
 static console_t con;
 
+static void *Con_AllocateLinesChunk( size_t size ) {
+	return Q_TagMalloc( size, MEMTAG_CONSOLE );
+}
+
+// scrollback lines grow by few characters at once, so keep them in size classes guarded by con.mutex
+static wsw::SizeClassAllocator con_linesAllocator( { &Con_AllocateLinesChunk, &Q_TagFree } );
+
+/*
+* Con_FreeLine
+*/
+static void Con_FreeLine( char **line ) {
+	if( *line ) {
+		con_linesAllocator.deallocate( *line, strlen( *line ) + 1 );
+		*line = NULL;
+	}
+}
+
 volatile bool con_initialized;
 
 static bool con_hasKeyboardFocus;
@@ -169,8 +187,7 @@ void Con_Clear_f( void ) {
 	QMutex_Lock( con.mutex );
 
 	for( i = 0; i < CON_MAXLINES; i++ ) {
-		Q_free( con.text[i] );
-		con.text[i] = NULL;
+		Con_FreeLine( &con.text[i] );
 	}
 	con.numlines = 0;
 	con.display = 0;
@@ -429,7 +446,7 @@ void Con_Shutdown( void ) {
 static void Con_Linefeed( bool notify ) {
 	// shift scrollback text up in the buffer to make room for a new line
 	if( con.numlines == con.totallines ) {
-		Q_free( con.text[con.numlines - 1] );
+		Con_FreeLine( &con.text[con.numlines - 1] );
 	}
 	memmove( con.text + 1, con.text, sizeof( con.text[0] ) * std::min( con.numlines, con.totallines - 1 ) );
 	con.text[0] = NULL;
@@ -467,7 +484,7 @@ static void addcharstostr( char **s, const char *c, size_t num ) {
 		num--;
 	}
 
-	newstr = (char *)Q_realloc( *s, len + addlen + 1 );
+	newstr = (char *)con_linesAllocator.reallocate( *s, *s ? len + 1 : 0, len + addlen + 1 );
 	memcpy( newstr + len, c, addlen );
 	newstr[len + addlen] = '\0';
 	*s = newstr;
@@ -998,7 +1015,7 @@ static void Con_CompleteCommandLine() {
 			size_t temp_size;
 
 			temp_size = sizeof( key_lines[edit_line] );
-			cmd_temp = (char *)Q_malloc( temp_size );
+			cmd_temp = (char *)Com_FrameAlloc( temp_size );
 
 			Q_strncpyz( cmd_temp, key_lines[edit_line] + skip, temp_size );
 			p = strstr( cmd_temp, " " );
@@ -1020,10 +1037,6 @@ static void Con_CompleteCommandLine() {
 			key_linepos++;
 		}
 		key_lines[edit_line][key_linepos] = 0;
-
-		if( cmd == cmd_temp ) {
-			Q_free( cmd );
-		}
 	}
 
 	for( i = 0; i < 5; ++i ) {
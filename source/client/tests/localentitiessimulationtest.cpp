@@ -0,0 +1,179 @@
+#include "localentitiessimulationtest.h"
+#include "../../cgame/cg_lentsimulation.h"
+
+#include <cmath>
+#include <memory>
+
+namespace {
+
+constexpr unsigned kCapacity = 32768;
+using Simulation = LocalEntitiesSimulation<kCapacity>;
+
+const float kZero[3] = { 0.0f, 0.0f, 0.0f };
+
+// Mimics the random number helpers of the game
+struct Random {
+	uint32_t seed { 1 };
+	float next() {
+		seed = seed * 1664525u + 1013904223u;
+		return (float)( seed >> 8 ) * ( 1.0f / 16777216.0f );
+	}
+	float nextSigned() { return 2.0f * next() - 1.0f; }
+};
+
+// Matches CG_RocketExplosionMode() with the dust enabled: an explosion sprite, a ring sprite and a dust circle
+unsigned spawnRocketExplosion( Simulation *sim, unsigned numEntities, const float *origin, int32_t time, Random *random ) {
+	const float velocity[3] = { 8.0f * random->nextSigned(), 8.0f * random->nextSigned(), 8.0f + 8.0f * random->nextSigned() };
+	sim->set( numEntities++, origin, velocity, kZero, time, 8 );
+	sim->set( numEntities++, origin, kZero, kZero, time, 3 );
+	for( int i = 0; i < 32; ++i ) {
+		const float angle = 6.2831f / 32.0f * (float)i;
+		const float speed = 8.0f * random->nextSigned() + 64.0f + 16.0f;
+		const float dustVelocity[3] = { speed * std::sin( angle ), speed * std::cos( angle ), 0.0f };
+		sim->set( numEntities++, origin, dustVelocity, kZero, time, 10 );
+	}
+	return numEntities;
+}
+
+// Matches CG_SmallPileOfGibs() for the maximal number of gibs. Returns a number of gibs.
+unsigned spawnPileOfGibs( Simulation *sim, unsigned numEntities, const float *origin, int32_t time, Random *random ) {
+	const float accel[3] = { -0.2f, -0.2f, -900.0f };
+	for( int i = 0; i < 128; ++i ) {
+		const float velocity[3] = { 150.0f * random->nextSigned(), 150.0f * random->nextSigned(), 300.0f + 250.0f * random->next() };
+		sim->set( numEntities++, origin, velocity, accel, time, 50 + (int)( 50.0f * random->next() ) );
+	}
+	return 128;
+}
+
+// Stands for CG_Trace() against a flat floor at zero height
+void bounceOffFloor( Simulation *sim, const uint32_t *bouncing, unsigned numBouncing, float seconds ) {
+	for( unsigned j = 0; j < numBouncing; ++j ) {
+		const unsigned i = bouncing[j];
+		if( sim->nextZ[i] >= 0.0f ) {
+			continue;
+		}
+		sim->nextZ[i] = 1.0f;
+		sim->velocityZ[i] = -sim->velocityZ[i] / 1.5f;
+		if( std::fabs( sim->velocityZ[i] ) * seconds < 1.0f ) {
+			sim->velocityX[i] = sim->velocityY[i] = sim->velocityZ[i] = 0.0f;
+			sim->accelX[i] = sim->accelY[i] = sim->accelZ[i] = 0.0f;
+		}
+	}
+}
+
+}
+
+void LocalEntitiesSimulationTest::test_updateLifetimes() {
+	auto sim = std::make_unique<Simulation>();
+	const float origin[3] = { 0.0f, 0.0f, 0.0f };
+	sim->set( 0, origin, kZero, kZero, 1000, 8 );
+	sim->set( 1, origin, kZero, kZero, 1000, 1 );
+	sim->set( 2, origin, kZero, kZero, 1000, 3 );
+
+	sim->updateLifetimes( 3, 1000 );
+	QVERIFY( !sim->removed[0] );
+	// Single-frame entities are removed on a first update
+	QVERIFY( sim->removed[1] );
+	QVERIFY( !sim->removed[2] );
+	QCOMPARE( sim->scale[0], 1.0f );
+	// Fading in requires more than 4 frames
+	QCOMPARE( sim->fadeIn[0], 0.0f );
+	QCOMPARE( sim->fadeIn[2], 1.0f );
+
+	sim->updateLifetimes( 3, 1350 );
+	QVERIFY( !sim->removed[0] );
+	QVERIFY( qFuzzyCompare( sim->frac[0], 3.5f ) );
+	QVERIFY( qFuzzyCompare( sim->scale[0], 0.5f ) );
+	QCOMPARE( sim->fadeIn[0], 1.0f );
+	QVERIFY( sim->removed[2] );
+
+	sim->updateLifetimes( 3, 1699 );
+	QVERIFY( !sim->removed[0] );
+	sim->updateLifetimes( 3, 1700 );
+	QVERIFY( sim->removed[0] );
+}
+
+void LocalEntitiesSimulationTest::test_predictAndCommitOrigins() {
+	auto sim = std::make_unique<Simulation>();
+	const float origin[3] = { 1.0f, 2.0f, 3.0f };
+	const float velocity[3] = { 10.0f, 0.0f, -20.0f };
+	const float accel[3] = { 0.0f, 0.0f, -100.0f };
+	sim->set( 0, origin, velocity, accel, 0, 10 );
+
+	sim->predictOrigins( 1, 0.5f );
+	QCOMPARE( sim->nextX[0], 6.0f );
+	QCOMPARE( sim->nextZ[0], -7.0f );
+	// Predicted origins are not committed yet
+	QCOMPARE( sim->originX[0], 1.0f );
+
+	sim->nextZ[0] = 0.0f;
+	sim->commitOrigins( 1, 0.5f );
+	QCOMPARE( sim->originX[0], 6.0f );
+	QCOMPARE( sim->originZ[0], 0.0f );
+	QCOMPARE( sim->oldOriginX[0], 1.0f );
+	QCOMPARE( sim->oldOriginZ[0], 3.0f );
+	QCOMPARE( sim->velocityZ[0], -70.0f );
+}
+
+void LocalEntitiesSimulationTest::test_compactPreservesOrder() {
+	auto sim = std::make_unique<Simulation>();
+	for( int i = 0; i < 10; ++i ) {
+		const float origin[3] = { (float)i, 0.0f, 0.0f };
+		sim->set( i, origin, kZero, kZero, 0, 10 );
+	}
+
+	sim->removed[0] = sim->removed[3] = sim->removed[4] = sim->removed[9] = 1;
+
+	QVector<QPair<unsigned, unsigned>> moves;
+	const unsigned numLeft = sim->compact( 10, [&]( unsigned from, unsigned to ) {
+		moves.append( qMakePair( from, to ) );
+	});
+
+	QCOMPARE( numLeft, 6u );
+	const float expectedOrigins[] = { 1.0f, 2.0f, 5.0f, 6.0f, 7.0f, 8.0f };
+	for( unsigned i = 0; i < numLeft; ++i ) {
+		QCOMPARE( sim->originX[i], expectedOrigins[i] );
+		QVERIFY( !sim->removed[i] );
+	}
+
+	QCOMPARE( moves.size(), 6 );
+	QCOMPARE( moves.front(), qMakePair( 1u, 0u ) );
+	QCOMPARE( moves.back(), qMakePair( 8u, 5u ) );
+}
+
+void LocalEntitiesSimulationTest::benchmark_explosionAndGibsBursts() {
+	auto sim = std::make_unique<Simulation>();
+	auto bouncing = std::make_unique<uint32_t[]>( kCapacity );
+	Random random;
+
+	// Fill the simulation by simultaneous bursts
+	unsigned numEntities = 0;
+	unsigned numBouncing = 0;
+	for( int burstNum = 0; numEntities + 34 + 128 <= kCapacity; ++burstNum ) {
+		const float origin[3] = { 64.0f * (float)( burstNum % 16 ), 64.0f * (float)( burstNum / 16 ), 32.0f };
+		numEntities = spawnRocketExplosion( sim.get(), numEntities, origin, 0, &random );
+		const unsigned numGibs = spawnPileOfGibs( sim.get(), numEntities, origin, 0, &random );
+		for( unsigned i = 0; i < numGibs; ++i ) {
+			bouncing[numBouncing++] = numEntities + i;
+		}
+		numEntities += numGibs;
+	}
+
+	QVERIFY( numEntities > kCapacity - 34 - 128 );
+
+	// Simulate frames of a 125 fps client until the explosions are over but gibs are still alive
+	constexpr float seconds = 0.008f;
+	int32_t time = 0;
+	QBENCHMARK {
+		time = ( time + 8 ) % 500;
+		sim->updateLifetimes( numEntities, time );
+		sim->predictOrigins( numEntities, seconds );
+		bounceOffFloor( sim.get(), bouncing.get(), numBouncing, seconds );
+		sim->commitOrigins( numEntities, seconds );
+	}
+
+	// Gibs should have fallen to the floor
+	for( unsigned j = 0; j < numBouncing; ++j ) {
+		QVERIFY( sim->originZ[bouncing[j]] >= 0.0f );
+	}
+}
@@ -0,0 +1,16 @@
+#ifndef WSW_LOCALENTITIESSIMULATIONTEST_H
+#define WSW_LOCALENTITIESSIMULATIONTEST_H
+
+#include <QtTest/QtTest>
+
+class LocalEntitiesSimulationTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_updateLifetimes();
+	void test_predictAndCommitOrigins();
+	void test_compactPreservesOrder();
+	void benchmark_explosionAndGibsBursts();
+};
+
+#endif
@@ -1,6 +1,9 @@
 #include <QCoreApplication>
+#include "localentitiessimulationtest.h"
+#include "materialfilecontentstest.h"
 #include "materialifevaluatortest.h"
 #include "materialsourcetest.h"
+#include "predictioncheckpointstest.h"
 #include "tokensplittertest.h"
 #include "tokenstreamtest.h"
 
@@ -30,6 +33,21 @@ int main( int argc, char **argv ) {
 		result |= QTest::qExec( &materialIfEvaluatorTest, argc, argv );
 	}
 
+	{
+		PredictionCheckpointsTest predictionCheckpointsTest;
+		result |= QTest::qExec( &predictionCheckpointsTest, argc, argv );
+	}
+
+	{
+		LocalEntitiesSimulationTest localEntitiesSimulationTest;
+		result |= QTest::qExec( &localEntitiesSimulationTest, argc, argv );
+	}
+
+	{
+		MaterialFileContentsTest materialFileContentsTest;
+		result |= QTest::qExec( &materialFileContentsTest, argc, argv );
+	}
+
 	return result;
 }
 
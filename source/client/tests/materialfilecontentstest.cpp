@@ -0,0 +1,198 @@
+#include "materialfilecontentstest.h"
+#include "../../ref/materiallocal.h"
+#include "../../qcommon/wswjobpool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char *const kExampleData =
+	"\xEF\xBB\xBF"
+	"// A comment\n"
+	"textures/base/floor\n"
+	"{\n"
+	"	qer_editorimage textures/base/floor.tga\n"
+	"	if deluxe\n"
+	"	{\n"
+	"		map $lightmap\n"
+	"		rgbGen identity /* an inline comment */\n"
+	"	}\n"
+	"	endif\n"
+	"	{\n"
+	"		map textures/base/floor.tga\n"
+	"		blendFunc filter\n"
+	"		tcMod scroll 0.1 -0.25\n"
+	"	}\n"
+	"}\n";
+
+struct Token {
+	std::string text;
+	uint32_t line;
+
+	bool operator==( const Token &that ) const { return text == that.text && line == that.line; }
+};
+
+std::vector<Token> getSplitterTokens( const char *data, size_t dataSize ) {
+	std::vector<Token> result;
+	TokenSplitter splitter( data, dataSize );
+	uint32_t line = 0;
+	while( !splitter.isAtEof() ) {
+		while( auto maybeToken = splitter.fetchNextTokenInLine() ) {
+			auto [off, len] = *maybeToken;
+			result.push_back( Token { std::string( data + off, len ), line } );
+		}
+		line++;
+	}
+	return result;
+}
+
+std::vector<Token> getContentsTokens( const MaterialFileContents *contents ) {
+	std::vector<Token> result;
+	for( unsigned i = 0; i < contents->numSpans; ++i ) {
+		const TokenSpan &span = contents->spans[i];
+		result.push_back( Token { std::string( contents->data + span.offset, span.len ), span.line } );
+	}
+	return result;
+}
+
+void release( MaterialFileContents *contents ) {
+	contents->~MaterialFileContents();
+	::free( contents );
+}
+
+/**
+ * Makes contents of a file that resembles a big material file of a map pack
+ */
+std::string makeBigFile( unsigned numMaterials ) {
+	std::string result;
+	for( unsigned i = 0; i < numMaterials; ++i ) {
+		const std::string name = "textures/pack/surface" + std::to_string( i );
+		result += "// " + name + "\n" + name + "\n{\n";
+		result += "\tqer_editorimage " + name + ".tga\n\tsurfaceparm nomarks\n";
+		result += "\t{\n\t\tmap $lightmap\n\t\trgbGen identity\n\t}\n";
+		result += "\t{\n\t\tmap " + name + ".tga\n\t\tblendFunc filter\n\t\ttcMod scroll 0.05 0\n\t}\n}\n\n";
+	}
+	return result;
+}
+
+// A directory of material files that are read by readRawContents()
+std::string scriptsDir;
+
+const wsw::String *readRawContents( const wsw::StringView &fileName, MaterialFileContents::LoadingBuffers *buffers ) {
+	wsw::String &pathName = buffers->pathName;
+	pathName.clear();
+	pathName.append( scriptsDir.data(), scriptsDir.size() );
+	pathName.append( "/" );
+	pathName.append( fileName.data(), fileName.size() );
+
+	std::ifstream stream( pathName.c_str(), std::ios::binary );
+	if( !stream ) {
+		return nullptr;
+	}
+
+	std::stringstream contents;
+	contents << stream.rdbuf();
+	const std::string data = contents.str();
+	wsw::String &rawContents = buffers->rawContents;
+	rawContents.assign( data.data(), data.size() );
+	rawContents.push_back( '\0' );
+	return &rawContents;
+}
+
+bool equals( const MaterialFileContents *a, const MaterialFileContents *b ) {
+	if( !a || !b ) {
+		return a == b;
+	}
+	if( a->dataSize != b->dataSize || a->numSpans != b->numSpans ) {
+		return false;
+	}
+	if( std::memcmp( a->data, b->data, a->dataSize ) != 0 ) {
+		return false;
+	}
+	return std::equal( a->spans, a->spans + a->numSpans, b->spans, []( const TokenSpan &lhs, const TokenSpan &rhs ) {
+		return lhs.offset == rhs.offset && lhs.len == rhs.len && lhs.line == rhs.line;
+	});
+}
+
+}
+
+void MaterialFileContentsTest::test_tokenizeMatchesSplitter() {
+	const size_t dataSize = std::strlen( kExampleData );
+	wsw::Vector<TokenSpan> spansBuffer;
+	MaterialFileContents *contents = MaterialFileContents::tokenize( kExampleData, dataSize, &spansBuffer );
+	QVERIFY( contents );
+
+	// The BOM must be skipped
+	const auto expected = getSplitterTokens( kExampleData + 3, dataSize - 3 );
+	QVERIFY( getContentsTokens( contents ) == expected );
+	QCOMPARE( expected.front().text, std::string( "textures/base/floor" ) );
+
+	// Characters of tokens are kept without gaps
+	size_t dataSizeOfTokens = 0;
+	for( const Token &token: expected ) {
+		dataSizeOfTokens += token.text.size();
+	}
+	QCOMPARE( contents->dataSize, dataSizeOfTokens );
+
+	release( contents );
+}
+
+void MaterialFileContentsTest::benchmark_loadFile_tokenize() {
+	const std::string bigFile = makeBigFile( 2000 );
+	wsw::Vector<TokenSpan> spansBuffer;
+	unsigned numSpans = 0;
+	QBENCHMARK {
+		MaterialFileContents *contents = MaterialFileContents::tokenize( bigFile.data(), bigFile.size(), &spansBuffer );
+		numSpans = contents->numSpans;
+		release( contents );
+	}
+	QVERIFY( numSpans > 2000 * 20 );
+}
+
+void MaterialFileContentsTest::test_loadFiles_parallelMatchesSerial() {
+	QTemporaryDir dir;
+	QVERIFY( dir.isValid() );
+	scriptsDir = dir.path().toStdString();
+
+	// Files of different sizes, so ranges of jobs take different time
+	wsw::Vector<wsw::String> fileNames;
+	for( unsigned i = 0; i < 32; ++i ) {
+		const std::string fileName = "pack" + std::to_string( i ) + ".shader";
+		std::ofstream stream( scriptsDir + "/" + fileName, std::ios::binary );
+		stream << ( i % 2 ? makeBigFile( 50 + 25 * i ) : std::string( kExampleData ) );
+		QVERIFY( stream.good() );
+		fileNames.emplace_back( wsw::String( fileName.data(), fileName.size() ) );
+	}
+	// A missing file must be reported as missing in both modes
+	fileNames.emplace_back( wsw::String( "missing.shader" ) );
+
+	wsw::Vector<MaterialFileContents *> serialContents( fileNames.size(), nullptr );
+	MaterialFileContents::loadFiles( fileNames, &readRawContents, nullptr, serialContents.data() );
+
+	wsw::Vector<MaterialFileContents *> parallelContents( fileNames.size(), nullptr );
+	wsw::JobPool jobPool( 4 );
+	MaterialFileContents::loadFiles( fileNames, &readRawContents, &jobPool, parallelContents.data() );
+
+	QVERIFY( !serialContents.back() );
+	for( size_t i = 0; i < fileNames.size(); ++i ) {
+		QVERIFY( i + 1 == fileNames.size() || serialContents[i] );
+		QVERIFY( equals( serialContents[i], parallelContents[i] ) );
+	}
+
+	for( MaterialFileContents *contents: serialContents ) {
+		if( contents ) {
+			release( contents );
+		}
+	}
+	for( MaterialFileContents *contents: parallelContents ) {
+		if( contents ) {
+			release( contents );
+		}
+	}
+}
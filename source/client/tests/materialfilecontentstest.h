@@ -0,0 +1,15 @@
+#ifndef WSW_MATERIALFILECONTENTSTEST_H
+#define WSW_MATERIALFILECONTENTSTEST_H
+
+#include <QtTest/QtTest>
+
+class MaterialFileContentsTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_tokenizeMatchesSplitter();
+	void test_loadFiles_parallelMatchesSerial();
+	void benchmark_loadFile_tokenize();
+};
+
+#endif
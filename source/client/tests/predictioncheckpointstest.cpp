@@ -0,0 +1,238 @@
+#include "predictioncheckpointstest.h"
+#include "../../cgame/cg_predictioncheckpoints.h"
+
+#include <iterator>
+#include <vector>
+
+namespace {
+
+struct State {
+	float origin;
+	float velocity;
+	int weaponTime;
+
+	[[nodiscard]]
+	bool operator==( const State &that ) const {
+		return origin == that.origin && velocity == that.velocity && weaponTime == that.weaponTime;
+	}
+};
+
+struct UserCmd {
+	int msec;
+	int forward;
+	bool fire;
+};
+
+constexpr unsigned kCapacity = 64;
+using Checkpoints = PredictionCheckpoints<State, kCapacity>;
+
+// A toy deterministic movement that stands for Pmove() and the weapon think
+void applyCmd( State *state, const UserCmd &cmd ) {
+	const float seconds = 0.001f * (float)cmd.msec;
+	state->velocity += ( 320.0f * (float)cmd.forward - 4.0f * state->velocity ) * seconds;
+	state->origin += state->velocity * seconds;
+	if( state->weaponTime > 0 ) {
+		state->weaponTime = std::max( 0, state->weaponTime - cmd.msec );
+	} else if( cmd.fire ) {
+		state->weaponTime = 100;
+	}
+}
+
+// Usercmds of a scripted input: a client running at about 60 fps that alternates running forward,
+// stopping and backpedaling and fires from time to time. Usercmd numbers start from 1.
+std::vector<UserCmd> recordUserCmds( int numCmds ) {
+	static const int frameMsecs[] = { 16, 17, 17, 16, 17, 15 };
+	static const int moves[] = { 1, 1, 1, 0, -1, 1, 0, 1 };
+	std::vector<UserCmd> cmds( numCmds + 1 );
+	for( int i = 1; i <= numCmds; ++i ) {
+		cmds[i].msec = frameMsecs[i % std::size( frameMsecs )];
+		cmds[i].forward = moves[( i / 20 ) % std::size( moves )];
+		cmds[i].fire = ( i % 40 ) < 3;
+	}
+	return cmds;
+}
+
+// Authoritative states after applying each usercmd. An unpredictable kick is applied at the specified usercmd.
+std::vector<State> simulateServer( const std::vector<UserCmd> &cmds, int kickAtCmd = -1 ) {
+	std::vector<State> states( cmds.size() );
+	State state { 0.0f, 0.0f, 0 };
+	states[0] = state;
+	for( int i = 1; i < (int)cmds.size(); ++i ) {
+		applyCmd( &state, cmds[i] );
+		if( i == kickAtCmd ) {
+			state.velocity += 500.0f;
+		}
+		states[i] = state;
+	}
+	return states;
+}
+
+// Predicts like CG_PredictMovement() does. Returns a number of applied usercmds.
+int predict( Checkpoints *checkpoints, const std::vector<UserCmd> &cmds,
+			 int64_t ucmdExecuted, const State &snapshotState, int64_t ucmdHead, State *result ) {
+	State state = snapshotState;
+	const int numMoves = checkpoints->predict( ucmdExecuted, ucmdHead, true,
+		[&]( const State &checkpoint ) { state = checkpoint; },
+		[&]( int64_t ucmdNum ) { applyCmd( &state, cmds[ucmdNum] ); },
+		[&]() { return state; } );
+	*result = state;
+	return numMoves;
+}
+
+State replayFully( const std::vector<UserCmd> &cmds, int64_t ucmdExecuted, const State &snapshotState, int64_t ucmdHead ) {
+	State state = snapshotState;
+	while( ++ucmdExecuted <= ucmdHead ) {
+		applyCmd( &state, cmds[ucmdExecuted] );
+	}
+	return state;
+}
+
+bool statesMatch( const State &predicted, const State &received ) {
+	return predicted == received;
+}
+
+struct ReplayStats {
+	int maxMovesAfterWarmup { 0 };
+	int numRollbacks { 0 };
+	int numMismatchesWithFullReplay { 0 };
+	int numMismatchesWithServer { 0 };
+};
+
+// Replays usercmds producing one usercmd per client frame and receiving a snapshot every few frames
+ReplayStats replay( const std::vector<UserCmd> &cmds, const std::vector<State> &serverStates,
+					int latencyInCmds, int snapshotPeriod ) {
+	ReplayStats stats;
+	Checkpoints checkpoints;
+	int64_t ucmdExecuted = 0;
+	const int64_t warmupFrames = latencyInCmds + 2 * snapshotPeriod;
+
+	for( int64_t ucmdHead = 1; ucmdHead < (int64_t)cmds.size(); ++ucmdHead ) {
+		if( !( ucmdHead % snapshotPeriod ) && ucmdHead > latencyInCmds ) {
+			ucmdExecuted = ucmdHead - latencyInCmds;
+			if( !checkpoints.validate( ucmdExecuted, serverStates[ucmdExecuted], statesMatch ) ) {
+				stats.numRollbacks++;
+			}
+		}
+
+		State predicted;
+		const State &snapshotState = serverStates[ucmdExecuted];
+		const int numMoves = predict( &checkpoints, cmds, ucmdExecuted, snapshotState, ucmdHead, &predicted );
+		if( ucmdHead > warmupFrames ) {
+			stats.maxMovesAfterWarmup = std::max( stats.maxMovesAfterWarmup, numMoves );
+		}
+		if( !( predicted == replayFully( cmds, ucmdExecuted, snapshotState, ucmdHead ) ) ) {
+			stats.numMismatchesWithFullReplay++;
+		}
+		if( !( predicted == serverStates[ucmdHead] ) ) {
+			stats.numMismatchesWithServer++;
+		}
+	}
+
+	return stats;
+}
+
+}
+
+void PredictionCheckpointsTest::test_addAndWrapAround() {
+	Checkpoints checkpoints;
+	QVERIFY( checkpoints.empty() );
+	QVERIFY( !checkpoints.getLatest() );
+
+	for( int i = 1; i <= 100; ++i ) {
+		checkpoints.add( i, State { (float)i, 0.0f, 0 } );
+	}
+
+	QCOMPARE( checkpoints.latest(), (int64_t)100 );
+	QVERIFY( !checkpoints.get( 100 - kCapacity ) );
+	QVERIFY( !checkpoints.get( 101 ) );
+	for( int i = 100 - kCapacity + 1; i <= 100; ++i ) {
+		const State *state = checkpoints.get( i );
+		QVERIFY( state );
+		QCOMPARE( state->origin, (float)i );
+	}
+
+	// A gap starts a new range
+	checkpoints.add( 200, State { 200.0f, 0.0f, 0 } );
+	QCOMPARE( checkpoints.latest(), (int64_t)200 );
+	QVERIFY( !checkpoints.get( 100 ) );
+	QVERIFY( !checkpoints.get( 199 ) );
+	QVERIFY( checkpoints.get( 200 ) );
+
+	checkpoints.clear();
+	QVERIFY( checkpoints.empty() );
+	QVERIFY( !checkpoints.get( 200 ) );
+}
+
+void PredictionCheckpointsTest::test_addDiscardsLaterCheckpoints() {
+	Checkpoints checkpoints;
+	for( int i = 1; i <= 10; ++i ) {
+		checkpoints.add( i, State { (float)i, 0.0f, 0 } );
+	}
+
+	// Overwriting a state in the middle invalidates states that have been derived from it
+	checkpoints.add( 5, State { -5.0f, 0.0f, 0 } );
+	QCOMPARE( checkpoints.latest(), (int64_t)5 );
+	QCOMPARE( checkpoints.get( 5 )->origin, -5.0f );
+	QCOMPARE( checkpoints.get( 4 )->origin, 4.0f );
+	QVERIFY( !checkpoints.get( 6 ) );
+
+	// Validation drops checkpoints before the acknowledged one
+	QVERIFY( checkpoints.validate( 3, State { 3.0f, 0.0f, 0 }, statesMatch ) );
+	QVERIFY( !checkpoints.get( 2 ) );
+	QVERIFY( checkpoints.get( 3 ) );
+	QCOMPARE( checkpoints.latest(), (int64_t)5 );
+
+	// A disagreement discards everything
+	QVERIFY( !checkpoints.validate( 4, State { 0.0f, 0.0f, 0 }, statesMatch ) );
+	QVERIFY( checkpoints.empty() );
+
+	// There is nothing to validate against
+	QVERIFY( !checkpoints.validate( 4, State { 4.0f, 0.0f, 0 }, statesMatch ) );
+}
+
+void PredictionCheckpointsTest::test_predictionCostDoesNotDependOnLatency() {
+	const auto cmds = recordUserCmds( 1000 );
+	const auto serverStates = simulateServer( cmds );
+
+	for( int latency: { 2, 8, 24, 48 } ) {
+		const ReplayStats stats = replay( cmds, serverStates, latency, 3 );
+		QCOMPARE( stats.numMismatchesWithFullReplay, 0 );
+		QCOMPARE( stats.numMismatchesWithServer, 0 );
+		QCOMPARE( stats.numRollbacks, 0 );
+		// Only the new usercmd and the usercmd that is still in progress are applied
+		QVERIFY( stats.maxMovesAfterWarmup <= 2 );
+	}
+}
+
+void PredictionCheckpointsTest::test_rollbackOnMismatch() {
+	const auto cmds = recordUserCmds( 1000 );
+	const int kickAtCmd = 500;
+	const auto serverStates = simulateServer( cmds, kickAtCmd );
+
+	for( int latency: { 2, 8, 24, 48 } ) {
+		const ReplayStats stats = replay( cmds, serverStates, latency, 3 );
+		// The prediction is always the same as if all usercmds have been replayed from the last snapshot
+		QCOMPARE( stats.numMismatchesWithFullReplay, 0 );
+		// Predictions disagree with the server only until the kick gets acknowledged
+		QVERIFY( stats.numMismatchesWithServer > 0 );
+		QVERIFY( stats.numMismatchesWithServer <= latency + 3 );
+		QCOMPARE( stats.numRollbacks, 1 );
+	}
+}
+
+void PredictionCheckpointsTest::test_freezeWhenTooFarOutOfDate() {
+	const auto cmds = recordUserCmds( 2 * kCapacity );
+	const State snapshotState { 0.0f, 0.0f, 0 };
+	Checkpoints checkpoints;
+	State predicted;
+
+	QCOMPARE( predict( &checkpoints, cmds, 0, snapshotState, kCapacity, &predicted ), -1 );
+	QVERIFY( checkpoints.empty() );
+
+	QCOMPARE( predict( &checkpoints, cmds, 0, snapshotState, kCapacity - 1, &predicted ), (int)kCapacity - 1 );
+	QCOMPARE( checkpoints.latest(), (int64_t)kCapacity - 2 );
+
+	// The latest checkpoint is close enough to the head
+	QCOMPARE( predict( &checkpoints, cmds, 0, snapshotState, kCapacity + 1, &predicted ), 3 );
+	QVERIFY( predicted == replayFully( cmds, 0, snapshotState, kCapacity + 1 ) );
+}
@@ -0,0 +1,17 @@
+#ifndef WSW_PREDICTIONCHECKPOINTSTEST_H
+#define WSW_PREDICTIONCHECKPOINTSTEST_H
+
+#include <QtTest/QtTest>
+
+class PredictionCheckpointsTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_addAndWrapAround();
+	void test_addDiscardsLaterCheckpoints();
+	void test_predictionCostDoesNotDependOnLatency();
+	void test_rollbackOnMismatch();
+	void test_freezeWhenTooFarOutOfDate();
+};
+
+#endif
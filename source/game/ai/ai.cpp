@@ -1,10 +1,11 @@
 #include "bot.h"
 #include "ai_manager.h"
-#include "ai_ground_trace_cache.h"
+#include "ai_frame_query_cache.h"
 #include "teamplay/ObjectiveBasedTeam.h"
 #include "combat/TacticalSpotsRegistry.h"
 
 const cvar_t *ai_evolution;
+const cvar_t *ai_evolutionWorker;
 const cvar_t *ai_debugOutput;
 const cvar_t *ai_shareRoutingCache;
 
@@ -162,14 +163,16 @@ static wsw::StaticVector<int, 16> hubAreas;
 //==========================================
 void AI_InitLevel( void ) {
 	ai_evolution = trap_Cvar_Get( "ai_evolution", "0", CVAR_ARCHIVE );
+	// Should be set to distinct values for parallel evolution processes that share the data directory
+	ai_evolutionWorker = trap_Cvar_Get( "ai_evolutionWorker", "0", 0 );
 	ai_debugOutput = trap_Cvar_Get( "ai_debugOutput", "0", CVAR_ARCHIVE );
 	// We think values for this var should not be archived
 	ai_shareRoutingCache = trap_Cvar_Get( "ai_shareRoutingCache", "1", 0 );
 
 	AiAasWorld::Init( level.mapname );
 	AiAasRouteCache::Init( *AiAasWorld::Instance() );
+	AiFrameQueryCache::Init();
 	TacticalSpotsRegistry::Init( level.mapname );
-	AiGroundTraceCache::Init();
 	HazardsSelectorCache::Init();
 
 	AiManager::Init( g_gametype->string, level.mapname );
@@ -197,8 +200,8 @@ void AI_AfterLevelScriptShutdown() {
 
 	NavEntitiesRegistry::Shutdown();
 	HazardsSelectorCache::Shutdown();
-	AiGroundTraceCache::Shutdown();
 	TacticalSpotsRegistry::Shutdown();
+	AiFrameQueryCache::Shutdown();
 	AiAasRouteCache::Shutdown();
 	AiAasWorld::Shutdown();
 }
@@ -210,6 +213,8 @@ void AI_JoinedTeam( edict_t *ent, int team ) {
 void AI_CommonFrame() {
 	AiAasWorld::Instance()->Frame();
 
+	AiFrameQueryCache::Instance()->Frame();
+
 	EntitiesPvsCache::Instance()->Update();
 
 	NavEntitiesRegistry::Instance()->Update();
@@ -435,3 +440,19 @@ void AI_Cheat_NoTarget( edict_t *ent ) {
 		G_PrintMsg( ent, "Bot Notarget OFF\n" );
 	}
 }
+
+void AI_Cmd_QueryCacheStats_f( void ) {
+	// The cache is available only if a level is loaded
+	if( !AiFrameQueryCache::IsInitialized() ) {
+		G_Printf( "The AI query cache is not initialized\n" );
+		return;
+	}
+
+	auto *const cache = AiFrameQueryCache::Instance();
+	if( !Q_stricmp( trap_Cmd_Argv( 1 ), "reset" ) ) {
+		cache->ResetStats();
+		return;
+	}
+
+	cache->PrintStats();
+}
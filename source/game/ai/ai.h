@@ -113,4 +113,7 @@ void        AI_Respawn( edict_t *ent );
 
 void        AI_Cheat_NoTarget( edict_t *ent );
 
+// Prints (or resets if "reset" is supplied as an argument) hit/miss statistics of the shared bots query cache
+void        AI_Cmd_QueryCacheStats_f( void );
+
 #endif
\ No newline at end of file
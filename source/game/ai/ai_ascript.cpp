@@ -1289,7 +1289,7 @@ protected:
 
     inline asIScriptContext *CallForContext(asIScriptContext *preparedContext)
     {
-        int error = preparedContext->Execute();
+        int error = G_asExecute(preparedContext, nullptr);
         // Put likely case first
         if (!G_ExecutionErrorReport(error))
             return preparedContext;
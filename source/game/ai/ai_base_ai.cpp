@@ -1,6 +1,5 @@
 #include "ai_base_ai.h"
 #include "planning/Planner.h"
-#include "ai_ground_trace_cache.h"
 
 Ai::Ai( edict_t *self_,
 		AiPlanner *planner_,
@@ -0,0 +1,292 @@
+#include "ai_frame_query_cache.h"
+#include "../../qcommon/wswstaticvector.h"
+
+/**
+ * A tiny spinlock guard. Critical sections are just few memory accesses.
+ */
+class SpinLockGuard {
+	std::atomic_flag *flag;
+public:
+	explicit SpinLockGuard( std::atomic_flag *flag_ ): flag( flag_ ) {
+		while( flag->test_and_set( std::memory_order_acquire ) ) {}
+	}
+	~SpinLockGuard() {
+		flag->clear( std::memory_order_release );
+	}
+};
+
+/**
+ * A fixed-capacity hash table of plain values keyed by short arrays of words.
+ * Each bucket has few slots. Slots that were filled on another frame are considered free.
+ * If all slots of a bucket are in use, an arbitrary (but deterministic) slot gets evicted.
+ */
+template <unsigned NumKeyWords, typename Value = int32_t>
+class FrameQueryTable {
+	static constexpr unsigned NUM_BUCKETS = 512;
+	static constexpr unsigned NUM_BUCKET_SLOTS = 4;
+	static constexpr unsigned NUM_LOCKS = 32;
+
+	struct Slot {
+		int64_t frameNum;
+		uint32_t key[NumKeyWords];
+		Value value;
+	};
+
+	struct Bucket {
+		Slot slots[NUM_BUCKET_SLOTS];
+	};
+
+	Bucket buckets[NUM_BUCKETS];
+	std::atomic_flag locks[NUM_LOCKS];
+
+	static uint32_t Hash( const uint32_t *key ) {
+		// FNV-1a applied to words
+		uint32_t hash = 2166136261u;
+		for( unsigned i = 0; i < NumKeyWords; ++i ) {
+			hash ^= key[i];
+			hash *= 16777619u;
+		}
+		// Mix high bits to low ones as the bucket is selected by low bits
+		return hash ^ ( hash >> 15 );
+	}
+public:
+	FrameQueryTable() {
+		memset( buckets, 0, sizeof( buckets ) );
+		for( auto &lock: locks ) {
+			lock.clear();
+		}
+	}
+
+	bool TryGet( int64_t frameNum, const uint32_t *key, Value *value ) {
+		const uint32_t hash = Hash( key );
+		const unsigned bucketNum = hash % NUM_BUCKETS;
+		SpinLockGuard guard( &locks[bucketNum % NUM_LOCKS] );
+		for( const Slot &slot: buckets[bucketNum].slots ) {
+			if( slot.frameNum == frameNum && !memcmp( slot.key, key, sizeof( slot.key ) ) ) {
+				*value = slot.value;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Put( int64_t frameNum, const uint32_t *key, const Value &value ) {
+		const uint32_t hash = Hash( key );
+		const unsigned bucketNum = hash % NUM_BUCKETS;
+		SpinLockGuard guard( &locks[bucketNum % NUM_LOCKS] );
+		Slot *slots = buckets[bucketNum].slots;
+		Slot *chosenSlot = &slots[( hash >> 16 ) % NUM_BUCKET_SLOTS];
+		for( unsigned i = 0; i < NUM_BUCKET_SLOTS; ++i ) {
+			// Prefer a stale slot or a slot for the same key (that could have been put concurrently)
+			if( slots[i].frameNum != frameNum || !memcmp( slots[i].key, key, sizeof( slots[i].key ) ) ) {
+				chosenSlot = &slots[i];
+				break;
+			}
+		}
+		chosenSlot->frameNum = frameNum;
+		memcpy( chosenSlot->key, key, sizeof( chosenSlot->key ) );
+		chosenSlot->value = value;
+	}
+};
+
+// An entity number, an origin, absolute bounds
+typedef FrameQueryTable<10> EntityAreaNumsTable;
+// A point
+typedef FrameQueryTable<3> PointAreaNumsTable;
+// A spot number and a view origin
+typedef FrameQueryTable<4> SpotVisibilityTable;
+
+struct CachedGroundTrace {
+	trace_t trace;
+	float depth;
+};
+
+// An entity number and an origin
+typedef FrameQueryTable<4, CachedGroundTrace> GroundTracesTable;
+
+template <typename T>
+static inline T *NewTable() {
+	return new( Q_malloc( sizeof( T ) ) )T;
+}
+
+template <typename T>
+static inline void DeleteTable( void *table ) {
+	if( table ) {
+		( (T *)table )->~T();
+		Q_free( table );
+	}
+}
+
+static inline uint32_t *AddFloats( uint32_t *key, const float *values, int numValues ) {
+	memcpy( key, values, numValues * sizeof( float ) );
+	return key + numValues;
+}
+
+AiFrameQueryCache::AiFrameQueryCache() {
+	entityAreaNumsTable = NewTable<EntityAreaNumsTable>();
+	pointAreaNumsTable = NewTable<PointAreaNumsTable>();
+	spotVisibilityTable = NewTable<SpotVisibilityTable>();
+	groundTracesTable = NewTable<GroundTracesTable>();
+	ResetStats();
+}
+
+AiFrameQueryCache::~AiFrameQueryCache() {
+	DeleteTable<EntityAreaNumsTable>( entityAreaNumsTable );
+	DeleteTable<PointAreaNumsTable>( pointAreaNumsTable );
+	DeleteTable<SpotVisibilityTable>( spotVisibilityTable );
+	DeleteTable<GroundTracesTable>( groundTracesTable );
+}
+
+AiFrameQueryCache *AiFrameQueryCache::instance = nullptr;
+static wsw::StaticVector<AiFrameQueryCache, 1> instanceHolder;
+
+void AiFrameQueryCache::Init() {
+	assert( instanceHolder.empty() );
+	instance = new( instanceHolder.unsafe_grow_back() )AiFrameQueryCache;
+}
+
+void AiFrameQueryCache::Shutdown() {
+	if( instance ) {
+		instance = nullptr;
+		instanceHolder.clear();
+	}
+}
+
+int AiFrameQueryCache::FindAreaNum( const edict_t *ent ) {
+	uint32_t key[10];
+	key[0] = (uint32_t)ENTNUM( ent );
+	AddFloats( AddFloats( AddFloats( key + 1, ent->s.origin, 3 ), ent->r.absmin, 3 ), ent->r.absmax, 3 );
+
+	auto *const table = (EntityAreaNumsTable *)entityAreaNumsTable;
+	int32_t areaNum;
+	if( table->TryGet( frameNum, key, &areaNum ) ) {
+		AddHit( ENTITY_AREA_NUM );
+		return areaNum;
+	}
+
+	AddMiss( ENTITY_AREA_NUM );
+	areaNum = AiAasWorld::Instance()->FindAreaNum( ent );
+	table->Put( frameNum, key, areaNum );
+	return areaNum;
+}
+
+int AiFrameQueryCache::FindAreaNum( const vec3_t point ) {
+	uint32_t key[3];
+	AddFloats( key, point, 3 );
+
+	auto *const table = (PointAreaNumsTable *)pointAreaNumsTable;
+	int32_t areaNum;
+	if( table->TryGet( frameNum, key, &areaNum ) ) {
+		AddHit( POINT_AREA_NUM );
+		return areaNum;
+	}
+
+	AddMiss( POINT_AREA_NUM );
+	areaNum = AiAasWorld::Instance()->FindAreaNum( point );
+	table->Put( frameNum, key, areaNum );
+	return areaNum;
+}
+
+bool AiFrameQueryCache::IsSpotVisible( const vec3_t viewOrigin, int spotNum, const vec3_t spotOrigin ) {
+	uint32_t key[4];
+	key[0] = (uint32_t)spotNum;
+	AddFloats( key + 1, viewOrigin, 3 );
+
+	auto *const table = (SpotVisibilityTable *)spotVisibilityTable;
+	int32_t value;
+	if( table->TryGet( frameNum, key, &value ) ) {
+		AddHit( SPOT_VISIBILITY );
+		return value != 0;
+	}
+
+	AddMiss( SPOT_VISIBILITY );
+	trace_t trace;
+	SolidWorldTrace( &trace, viewOrigin, spotOrigin );
+	const bool result = trace.fraction == 1.0f;
+	table->Put( frameNum, key, result ? 1 : 0 );
+	return result;
+}
+
+/**
+ * Gets a trace of the ground under the entity from the table or computes it.
+ * A deeper trace is reused as is, so callers must rescale the fraction.
+ */
+static void FindGroundTrace( GroundTracesTable *table, int64_t frameNum,
+							 const edict_t *ent, float depth, CachedGroundTrace *result ) {
+	uint32_t key[4];
+	key[0] = (uint32_t)ENTNUM( ent );
+	AddFloats( key + 1, ent->s.origin, 3 );
+
+	auto *const cache = AiFrameQueryCache::Instance();
+	if( table->TryGet( frameNum, key, result ) && result->depth >= depth ) {
+		cache->AddHit( AiFrameQueryCache::GROUND_TRACE );
+		return;
+	}
+
+	cache->AddMiss( AiFrameQueryCache::GROUND_TRACE );
+	edict_t *entRef = const_cast<edict_t *>( ent );
+	vec3_t end = { ent->s.origin[0], ent->s.origin[1], ent->s.origin[2] - depth };
+	G_Trace( &result->trace, entRef->s.origin, nullptr, nullptr, end, entRef, MASK_AISOLID );
+	result->depth = depth;
+	table->Put( frameNum, key, *result );
+}
+
+void AiFrameQueryCache::GetGroundTrace( const edict_t *ent, float depth, trace_t *trace ) {
+	CachedGroundTrace cachedTrace;
+	FindGroundTrace( (GroundTracesTable *)groundTracesTable, frameNum, ent, depth, &cachedTrace );
+
+	trace->startsolid = cachedTrace.trace.startsolid;
+	if( cachedTrace.trace.fraction == 1.0f ) {
+		trace->fraction = 1.0f;
+		return;
+	}
+	float cachedHitDepth = cachedTrace.depth * cachedTrace.trace.fraction;
+	if( cachedHitDepth > depth ) {
+		trace->fraction = 1.0f;
+		return;
+	}
+	// Copy trace data
+	*trace = cachedTrace.trace;
+	// Recalculate result fraction
+	trace->fraction = cachedHitDepth / depth;
+}
+
+bool AiFrameQueryCache::TryDropToFloor( const edict_t *ent, float depth, vec3_t result ) {
+	CachedGroundTrace cachedTrace;
+	FindGroundTrace( (GroundTracesTable *)groundTracesTable, frameNum, ent, depth, &cachedTrace );
+
+	VectorCopy( ent->s.origin, result );
+	if( cachedTrace.trace.fraction == 1.0f ) {
+		return false;
+	}
+	float cachedHitDepth = cachedTrace.depth * cachedTrace.trace.fraction;
+	if( cachedHitDepth > depth ) {
+		return false;
+	}
+
+	VectorCopy( cachedTrace.trace.endpos, result );
+	result[2] += 16.0f; // Add some delta
+	return true;
+}
+
+void AiFrameQueryCache::PrintStats() const {
+	static const char *names[NUM_QUERY_KINDS] = {
+		"Entity area num", "Point area num", "Spot visibility", "Ground trace"
+	};
+
+	G_Printf( "%-20s %12s %12s %8s\n", "Query", "Hits", "Misses", "Hit %" );
+	for( int i = 0; i < NUM_QUERY_KINDS; ++i ) {
+		const uint64_t numHits = hits[i].load( std::memory_order_relaxed );
+		const uint64_t numMisses = misses[i].load( std::memory_order_relaxed );
+		const uint64_t total = numHits + numMisses;
+		const double hitRatio = total ? ( 100.0 * numHits ) / total : 0.0;
+		G_Printf( "%-20s %12" PRIu64 " %12" PRIu64 " %7.2f%%\n", names[i], numHits, numMisses, hitRatio );
+	}
+}
+
+void AiFrameQueryCache::ResetStats() {
+	for( int i = 0; i < NUM_QUERY_KINDS; ++i ) {
+		hits[i].store( 0, std::memory_order_relaxed );
+		misses[i].store( 0, std::memory_order_relaxed );
+	}
+}
@@ -0,0 +1,98 @@
+#ifndef QFUSION_AI_FRAME_QUERY_CACHE_H
+#define QFUSION_AI_FRAME_QUERY_CACHE_H
+
+#include "ai_local.h"
+
+#include <atomic>
+
+/**
+ * A memoization layer for world queries that are asked by many bots during the same frame
+ * (area numbers of entities and points, visibility of tactical spots from enemies, ground traces).
+ * All entries expire on a next frame so there is no need to track world changes.
+ * Keys include entity origins so a result is not reused if an entity has moved during the frame.
+ * Lookups and insertions are safe to perform concurrently but computations of missing values are up to callers.
+ */
+class AiFrameQueryCache {
+public:
+	enum QueryKind {
+		ENTITY_AREA_NUM,
+		POINT_AREA_NUM,
+		SPOT_VISIBILITY,
+		GROUND_TRACE,
+		NUM_QUERY_KINDS
+	};
+private:
+	/**
+	 * Declare untyped pointers in order to keep the table definition private
+	 */
+	void *entityAreaNumsTable;
+	void *pointAreaNumsTable;
+	void *spotVisibilityTable;
+	void *groundTracesTable;
+
+	int64_t frameNum { 1 };
+
+	std::atomic<uint64_t> hits[NUM_QUERY_KINDS];
+	std::atomic<uint64_t> misses[NUM_QUERY_KINDS];
+
+	static AiFrameQueryCache *instance;
+public:
+	AiFrameQueryCache();
+	~AiFrameQueryCache();
+
+	static void Init();
+	static void Shutdown();
+
+	static AiFrameQueryCache *Instance() {
+		assert( instance );
+		return instance;
+	}
+
+	static bool IsInitialized() { return instance != nullptr; }
+
+	/**
+	 * Invalidates all cached results. Should be called once at the beginning of every game frame.
+	 */
+	void Frame() { frameNum++; }
+
+	/**
+	 * A cached equivalent of {@code AiAasWorld::FindAreaNum(const edict_t *)}
+	 */
+	int FindAreaNum( const edict_t *ent );
+	/**
+	 * A cached equivalent of {@code AiAasWorld::FindAreaNum(const vec3_t)}
+	 */
+	int FindAreaNum( const vec3_t point );
+
+	/**
+	 * Tests whether a tactical spot is visible from a point using a solid world trace.
+	 * The result depends only on the spot and the point so it is shared by all bots
+	 * that test the same spot against the same (last seen) enemy view origin.
+	 * @param viewOrigin an enemy view origin
+	 * @param spotNum a number of the spot in the tactical spots registry
+	 * @param spotOrigin an origin of the spot
+	 */
+	bool IsSpotVisible( const vec3_t viewOrigin, int spotNum, const vec3_t spotOrigin );
+
+	/**
+	 * Traces the ground under the entity origin.
+	 * A trace computed during this frame for the same entity and origin is reused if it is not shallower.
+	 */
+	void GetGroundTrace( const edict_t *ent, float depth, trace_t *trace );
+	/**
+	 * Uses the same algorithm as {@code GetGroundTrace()} but avoids trace result copying.
+	 * @return true if the ground has been found, {@code result} is set to a point slightly above it in this case.
+	 */
+	bool TryDropToFloor( const edict_t *ent, float depth, vec3_t result );
+
+	/**
+	 * Allows external caches that are shared by all bots to contribute to the common statistics
+	 */
+	void AddHit( QueryKind kind ) { hits[kind].fetch_add( 1, std::memory_order_relaxed ); }
+	void AddMiss( QueryKind kind ) { misses[kind].fetch_add( 1, std::memory_order_relaxed ); }
+
+	void PrintStats() const;
+	void ResetStats();
+};
+
+#endif
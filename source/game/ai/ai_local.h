@@ -361,6 +361,7 @@ public:
 };
 
 extern const cvar_t *ai_evolution;
+extern const cvar_t *ai_evolutionWorker;
 extern const cvar_t *ai_debugOutput;
 extern const cvar_t *ai_shareRoutingCache;
 
@@ -9,6 +9,7 @@
 class HazardsDetector {
 	friend class BotAwarenessModule;
 	friend class HazardsSelector;
+	friend class ProjectilePredictionsTable;
 
 	static constexpr float DETECT_ROCKET_SQ_RADIUS = 650 * 650;
 	static constexpr float DETECT_WAVE_RADIUS = 500;
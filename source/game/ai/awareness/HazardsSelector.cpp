@@ -1,5 +1,6 @@
 #include "HazardsSelector.h"
 #include "AwarenessModule.h"
+#include "ProjectilePredictionsTable.h"
 #include "../bot.h"
 #include "../../../qcommon/links.h"
 
@@ -397,7 +398,7 @@ void HazardsSelector::FindWaveHazards( const EntNumsVector &entNums ) {
 	auto *const gameEdicts = game.edicts;
 	const auto *weaponDef = GS_GetWeaponDef( WEAP_SHOCKWAVE );
 	const edict_t *self = game.edicts + bot->EntNum();
-	trace_t trace;
+	auto *const predictionsTable = ProjectilePredictionsTable::Instance();
 	for( auto entNum: entNums ) {
 		edict_t *wave = gameEdicts + entNum;
 		float hazardRadius;
@@ -420,7 +421,6 @@ void HazardsSelector::FindWaveHazards( const EntNumsVector &entNums ) {
 			continue;
 		}
 
-		float waveSpeed = Q_Sqrt( squareSpeed );
 		Vec3 botToLinePoint( wave->s.origin );
 		botToLinePoint -= self->s.origin;
 		Vec3 projection( lineDir );
@@ -435,16 +435,14 @@ void HazardsSelector::FindWaveHazards( const EntNumsVector &entNums ) {
 		// We're sure the wave is in PVS and is visible by bot, that's what HazardsDetector yields
 		// Now check whether the wave hits an obstacle on a safe distance.
 
-		Vec3 traceEnd( lineDir );
-		traceEnd *= HazardsDetector::DETECT_WAVE_RADIUS / waveSpeed;
-		traceEnd += wave->s.origin;
-		G_Trace( &trace, wave->s.origin, nullptr, nullptr, traceEnd.Data(), wave, MASK_SHOT );
+		// The obstacle test is shared by all bots, see ProjectilePredictionsTable
+		const auto *const impact = predictionsTable->GetImpact( wave );
 		bool isDirectHit = false;
-		if( trace.fraction != 1.0f ) {
-			if( DistanceSquared( trace.endpos, self->s.origin ) > hazardRadius * hazardRadius ) {
+		if( impact->fraction != 1.0f ) {
+			if( DistanceSquared( impact->endPos, self->s.origin ) > hazardRadius * hazardRadius ) {
 				continue;
 			}
-			isDirectHit = ( trace.ent == ENTNUM( self ) );
+			isDirectHit = ( impact->hitEntNum == ENTNUM( self ) );
 		}
 		// Put the likely case first
 		float damage = wave->projectileInfo.maxDamage;
@@ -459,7 +457,7 @@ void HazardsSelector::FindWaveHazards( const EntNumsVector &entNums ) {
 			hitDir *= 1.0f / distance;
 			TryAddHazard( damageScore, hitPoint.Data(), hitDir.Data(), gameEdicts + wave->s.ownerNum, hazardRadius );
 		} else {
-			TryAddHazard( 3.0f * damage, trace.endpos, lineDir.Data(), gameEdicts + wave->s.ownerNum, hazardRadius );
+			TryAddHazard( 3.0f * damage, impact->endPos, lineDir.Data(), gameEdicts + wave->s.ownerNum, hazardRadius );
 		}
 	}
 }
@@ -529,21 +527,21 @@ void HazardsSelector::FindLaserHazards( const EntNumsVector &entNums ) {
 }
 
 void HazardsSelector::FindProjectileHazards( const EntNumsVector &entNums ) {
-	trace_t trace;
 	float minPrjFraction = 1.0f;
 	float minDamageScore = 0.0f;
 	edict_t *const gameEdicts = game.edicts;
+	auto *const predictionsTable = ProjectilePredictionsTable::Instance();
 
 	for( unsigned i = 0; i < entNums.size(); ++i ) {
 		edict_t *target = gameEdicts + entNums[i];
-		Vec3 end = Vec3( target->s.origin ) + 2.0f * Vec3( target->velocity );
-		G_Trace( &trace, target->s.origin, target->r.mins, target->r.maxs, end.Data(), target, MASK_AISOLID );
-		if( trace.fraction >= minPrjFraction ) {
+		// Impacts are predicted once per frame for all bots
+		const auto *const impact = predictionsTable->GetImpact( target );
+		if( impact->fraction >= minPrjFraction ) {
 			continue;
 		}
 
-		minPrjFraction = trace.fraction;
-		float hitVecLen = DistanceFast( bot->Origin(), trace.endpos );
+		minPrjFraction = impact->fraction;
+		float hitVecLen = DistanceFast( bot->Origin(), impact->endPos );
 		if( hitVecLen >= 1.25f * target->projectileInfo.radius ) {
 			continue;
 		}
@@ -562,7 +560,7 @@ void HazardsSelector::FindProjectileHazards( const EntNumsVector &entNums ) {
 		} else {
 			direction = Vec3( &axis_identity[AXIS_UP] );
 		}
-		if( TryAddHazard( damageScore, trace.endpos, direction.Data(),
+		if( TryAddHazard( damageScore, impact->endPos, direction.Data(),
 						  gameEdicts + target->s.ownerNum,
 						  1.25f * target->projectileInfo.radius ) ) {
 			minDamageScore = damageScore;
@@ -0,0 +1,140 @@
+#include "ProjectilePredictionsTable.h"
+#include "HazardsDetector.h"
+
+ProjectilePredictionsTable ProjectilePredictionsTable::instance;
+
+bool ProjectilePredictionsTable::IsPredictedType( const edict_t *ent ) {
+	switch( ent->s.type ) {
+		case ET_ROCKET:
+		case ET_GRENADE:
+		case ET_BLASTER:
+		case ET_WAVE:
+			return true;
+		default:
+			return false;
+	}
+}
+
+void ProjectilePredictionsTable::AddProjectile( const edict_t *ent ) {
+	assert( numProjectiles < MAX_PROJECTILES );
+	const unsigned i = numProjectiles++;
+
+	entNums[i] = (uint16_t)ENTNUM( ent );
+	originX[i] = ent->s.origin[0];
+	originY[i] = ent->s.origin[1];
+	originZ[i] = ent->s.origin[2];
+	velocityX[i] = ent->velocity[0];
+	velocityY[i] = ent->velocity[1];
+	velocityZ[i] = ent->velocity[2];
+	stepsDone[i] = 0;
+
+	VectorCopy( ent->s.origin, impacts[entNums[i]].origin );
+
+	if( ent->s.type == ET_WAVE ) {
+		// Waves are tested only for hitting an obstacle on the detection distance
+		const float squareSpeed = VectorLengthSquared( ent->velocity );
+		gravity[i] = 0.0f;
+		stepSeconds[i] = squareSpeed > 1 ? HazardsDetector::DETECT_WAVE_RADIUS / sqrtf( squareSpeed ) : 0.0f;
+		stepsLeft[i] = 1;
+		return;
+	}
+
+	const int movetype = ent->movetype;
+	const bool isTossed = movetype == MOVETYPE_TOSS || movetype == MOVETYPE_BOUNCE || movetype == MOVETYPE_BOUNCEGRENADE;
+	if( isTossed && !ent->groundentity ) {
+		// A curved trajectory requires several steps
+		gravity[i] = ent->gravity * level.gravity;
+		stepSeconds[i] = 0.001f * TOSS_STEP_MILLIS;
+		stepsLeft[i] = (uint8_t)( ( 1000 * PREDICTION_SECONDS ) / TOSS_STEP_MILLIS );
+	} else {
+		// A single step is exact for a straight line
+		gravity[i] = 0.0f;
+		stepSeconds[i] = PREDICTION_SECONDS;
+		stepsLeft[i] = 1;
+	}
+}
+
+void ProjectilePredictionsTable::RunBatch() {
+	edict_t *const gameEdicts = game.edicts;
+	const int64_t frameNum = level.framenum;
+	trace_t trace;
+
+	while( numProjectiles ) {
+		const unsigned n = numProjectiles;
+		// Advance all projectiles at once. There are no dependencies between lanes so this loop is vectorized.
+		for( unsigned i = 0; i < n; ++i ) {
+			const float t = stepSeconds[i];
+			nextX[i] = originX[i] + velocityX[i] * t;
+			nextY[i] = originY[i] + velocityY[i] * t;
+			nextZ[i] = originZ[i] + velocityZ[i] * t - 0.5f * gravity[i] * t * t;
+			velocityZ[i] -= gravity[i] * t;
+		}
+
+		unsigned numLeft = 0;
+		for( unsigned i = 0; i < n; ++i ) {
+			edict_t *const ent = gameEdicts + entNums[i];
+			vec3_t start = { originX[i], originY[i], originZ[i] };
+			vec3_t end = { nextX[i], nextY[i], nextZ[i] };
+			if( ent->s.type == ET_WAVE ) {
+				G_Trace( &trace, start, nullptr, nullptr, end, ent, MASK_SHOT );
+			} else {
+				G_Trace( &trace, start, ent->r.mins, ent->r.maxs, end, ent, MASK_AISOLID );
+			}
+
+			stepsDone[i]++;
+			stepsLeft[i]--;
+			if( trace.fraction != 1.0f || !stepsLeft[i] ) {
+				auto *const impact = &impacts[entNums[i]];
+				const float numSteps = stepsDone[i] + stepsLeft[i];
+				impact->fraction = ( ( stepsDone[i] - 1 ) + trace.fraction ) / numSteps;
+				VectorCopy( trace.endpos, impact->endPos );
+				impact->hitEntNum = trace.ent;
+				impact->computedAtFrame = frameNum;
+				continue;
+			}
+
+			// Compact lanes of projectiles that are still in flight
+			const unsigned j = numLeft++;
+			entNums[j] = entNums[i];
+			originX[j] = nextX[i];
+			originY[j] = nextY[i];
+			originZ[j] = nextZ[i];
+			velocityX[j] = velocityX[i];
+			velocityY[j] = velocityY[i];
+			velocityZ[j] = velocityZ[i];
+			gravity[j] = gravity[i];
+			stepSeconds[j] = stepSeconds[i];
+			stepsLeft[j] = stepsLeft[i];
+			stepsDone[j] = stepsDone[i];
+		}
+
+		numProjectiles = numLeft;
+	}
+}
+
+const PredictedProjectileImpact *ProjectilePredictionsTable::GetImpact( const edict_t *projectile ) {
+	assert( IsPredictedType( projectile ) );
+
+	if( lastBatchFrame != level.framenum ) {
+		lastBatchFrame = level.framenum;
+		numProjectiles = 0;
+		const edict_t *gameEdicts = game.edicts;
+		for( int i = gs.maxclients + 1, end = game.numentities; i < end; ++i ) {
+			const edict_t *ent = gameEdicts + i;
+			if( ent->r.inuse && IsPredictedType( ent ) ) {
+				AddProjectile( ent );
+			}
+		}
+		RunBatch();
+	}
+
+	auto *const impact = &impacts[ENTNUM( projectile )];
+	// The projectile could have been spawned or moved after the batch was computed
+	if( impact->computedAtFrame != level.framenum || !VectorCompare( impact->origin, projectile->s.origin ) ) {
+		numProjectiles = 0;
+		AddProjectile( projectile );
+		RunBatch();
+	}
+
+	return impact;
+}
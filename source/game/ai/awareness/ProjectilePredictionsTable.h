@@ -0,0 +1,66 @@
+#ifndef QFUSION_PROJECTILEPREDICTIONSTABLE_H
+#define QFUSION_PROJECTILEPREDICTIONSTABLE_H
+
+#include "../ai_local.h"
+
+/**
+ * A predicted impact of a live projectile (rocket, grenade, blast, wave).
+ * Predictions do not depend of a bot that looks at a projectile so they are shared by all bots.
+ */
+struct PredictedProjectileImpact {
+	vec3_t origin;
+	// A point where the projectile is going to hit something or its last predicted position
+	vec3_t endPos;
+	// A part of the prediction time horizon that has been passed before the hit (1.0 if nothing has been hit)
+	float fraction;
+	int hitEntNum;
+	int64_t computedAtFrame;
+};
+
+/**
+ * Advances all live projectiles once per frame in a batch and publishes predicted impacts.
+ * Predictions are computed lazily on a first request during a frame.
+ */
+class ProjectilePredictionsTable {
+	static constexpr unsigned MAX_PROJECTILES = MAX_EDICTS - MAX_CLIENTS;
+	static constexpr float PREDICTION_SECONDS = 2.0f;
+	static constexpr unsigned TOSS_STEP_MILLIS = 250;
+
+	PredictedProjectileImpact impacts[MAX_EDICTS];
+
+	// SoA state of projectiles that are being advanced
+	alignas( 16 ) float originX[MAX_PROJECTILES];
+	alignas( 16 ) float originY[MAX_PROJECTILES];
+	alignas( 16 ) float originZ[MAX_PROJECTILES];
+	alignas( 16 ) float velocityX[MAX_PROJECTILES];
+	alignas( 16 ) float velocityY[MAX_PROJECTILES];
+	alignas( 16 ) float velocityZ[MAX_PROJECTILES];
+	alignas( 16 ) float gravity[MAX_PROJECTILES];
+	alignas( 16 ) float stepSeconds[MAX_PROJECTILES];
+	alignas( 16 ) float nextX[MAX_PROJECTILES];
+	alignas( 16 ) float nextY[MAX_PROJECTILES];
+	alignas( 16 ) float nextZ[MAX_PROJECTILES];
+	uint16_t entNums[MAX_PROJECTILES];
+	uint8_t stepsLeft[MAX_PROJECTILES];
+	uint8_t stepsDone[MAX_PROJECTILES];
+	unsigned numProjectiles { 0 };
+
+	int64_t lastBatchFrame { -1 };
+
+	static ProjectilePredictionsTable instance;
+
+	static bool IsPredictedType( const edict_t *ent );
+
+	void AddProjectile( const edict_t *ent );
+	void RunBatch();
+public:
+	static ProjectilePredictionsTable *Instance() { return &instance; }
+
+	/**
+	 * Gets a predicted impact of the projectile for this frame.
+	 * @param projectile a live rocket, grenade, blast or wave entity
+	 */
+	const PredictedProjectileImpact *GetImpact( const edict_t *projectile );
+};
+
+#endif
@@ -16,14 +16,24 @@ class DefaultBotEvolutionManager : public BotEvolutionManager
 {
 	BotWeightConfig referenceConfig;
 
+	// Used for measuring the simulation throughput
+	int64_t matchStartLevelTime;
+	int64_t matchStartRealTime;
+
 	// Returns score of the reference config (greater than zero if it has been found).
 	float DefaultEvolutionScore( const edict_t *ent ) const;
 
 	void LoadReferenceWeightConfig();
 
+	void ReportThroughput() const;
+
+	bool SaveWeightConfig( BotWeightConfig &weightConfig, const char *fileName ) const;
+
 public:
 	DefaultBotEvolutionManager()
-		: referenceConfig( nullptr ) {
+		: referenceConfig( nullptr ),
+		matchStartLevelTime( level.time ),
+		matchStartRealTime( trap_Milliseconds() ) {
 		LoadReferenceWeightConfig();
 	}
 
@@ -239,8 +249,8 @@ void DefaultBotEvolutionManager::SaveEvolutionResults() {
 		return;
 	}
 
-	const edict_t *bestEnt = nullptr;
-	float bestScore = 0.0f;
+	const edict_t *bestMutatedEnt = nullptr;
+	float bestMutatedScore = 0.0f;
 	float bestReferenceScore = 0.0f;
 	unsigned numRatedBots = 0;
 
@@ -252,32 +262,76 @@ void DefaultBotEvolutionManager::SaveEvolutionResults() {
 		}
 
 		numRatedBots++;
-		if( score > bestScore ) {
-			bestScore = score;
-			bestEnt = ent;
-		}
-
-		// Do this cheap test first, AiWeightConfig::operator==() is expensive
-		if( score > bestReferenceScore ) {
-			if( ent->ai->botRef->WeightConfig() == referenceConfig ) {
-				bestReferenceScore = score;
-			}
+		// This is done once per match for few bots, so AiWeightConfig::operator==() is affordable
+		if( ent->ai->botRef->WeightConfig() == referenceConfig ) {
+			bestReferenceScore = std::max( score, bestReferenceScore );
+		} else if( score > bestMutatedScore ) {
+			bestMutatedScore = score;
+			bestMutatedEnt = ent;
 		}
 	}
 
+	ReportThroughput();
+
 	constexpr const char *tag = "DefaultBotEvolutionManager::SaveEvolutionResults()";
 	if( numRatedBots < ( GS_InvidualGameType() ? 2u : 3u ) ) {
 		G_Printf( S_COLOR_YELLOW "%s: There were too few (%d) rated bots. No results to save.\n", tag, numRatedBots );
 		return;
 	}
 
-	if( bestReferenceScore == 0.0f ) {
+	if( bestReferenceScore <= 0.0f ) {
 		G_Printf( S_COLOR_YELLOW "%s: Looks like the reference weight config was not contested. No results to save.\n", tag );
 		return;
 	}
 
+	// Other evolution processes could have saved an improved config since this match has been started.
+	// Do not overwrite it by the (outdated) reference one. A tie does not prove anything either.
+	if( !bestMutatedEnt || bestMutatedScore <= bestReferenceScore ) {
+		G_Printf( "%s: The reference weight config has won (score %.1f). No results to save.\n", tag, bestReferenceScore );
+		return;
+	}
+
+	G_Printf( "%s: A mutated weight config has won (score %.1f vs %.1f of the reference one)\n", tag, bestMutatedScore, bestReferenceScore );
 	const char *fileName = va( "ai/%s%s_%s.weights", ( GS_Instagib() ? "i" : "" ), g_gametype->string, level.mapname );
-	if( !bestEnt->ai->botRef->WeightConfig().Save( fileName ) ) {
+	if( !SaveWeightConfig( bestMutatedEnt->ai->botRef->WeightConfig(), fileName ) ) {
 		G_Printf( S_COLOR_RED "%s: Can't save weights file `%s`\n", tag, fileName );
 	}
 }
+
+bool DefaultBotEvolutionManager::SaveWeightConfig( BotWeightConfig &weightConfig, const char *fileName ) const {
+	// Write a worker-specific file first and move it over the shared one,
+	// so parallel evolution processes never read a partially written file.
+	char tmpFileName[MAX_QPATH];
+	Q_snprintfz( tmpFileName, sizeof( tmpFileName ), "%s.%d.tmp", fileName, ai_evolutionWorker->integer );
+
+	if( !weightConfig.Save( tmpFileName ) ) {
+		return false;
+	}
+
+	if( !trap_FS_MoveFile( tmpFileName, fileName ) ) {
+		trap_FS_RemoveFile( tmpFileName );
+		return false;
+	}
+
+	return true;
+}
+
+// The game module is not reloaded on map restarts so these totals are accumulated for all matches of an evolution run
+static int64_t totalSimulatedMillis = 0;
+static int64_t totalRealMillis = 0;
+static int totalMatches = 0;
+
+void DefaultBotEvolutionManager::ReportThroughput() const {
+	const int64_t simulatedMillis = level.time - matchStartLevelTime;
+	const int64_t realMillis = std::max( (int64_t)1, trap_Milliseconds() - matchStartRealTime );
+
+	totalSimulatedMillis += simulatedMillis;
+	totalRealMillis += realMillis;
+	totalMatches++;
+
+	constexpr const char *format = "%s: %.1f simulated match-seconds in %.1f wall-seconds (%.2f per wall-second)\n";
+	const char *tag = va( "Evolution worker #%d match #%d", ai_evolutionWorker->integer, totalMatches );
+	G_Printf( format, tag, 0.001 * simulatedMillis, 0.001 * realMillis, simulatedMillis / (double)realMillis );
+	tag = va( "Evolution worker #%d total", ai_evolutionWorker->integer );
+	G_Printf( format, tag, 0.001 * totalSimulatedMillis, 0.001 * totalRealMillis, totalSimulatedMillis / (double)totalRealMillis );
+}
@@ -14,8 +14,7 @@ AdvantageProblemSolver::AdvantageProblemSolver( const OriginParams &originParams
 }
 
 int AdvantageProblemSolver::findMany( vec3_t *spots, int maxSpots ) {
-	uint16_t insideSpotNum;
-	SpotsQueryVector &spotsFromQuery = tacticalSpotsRegistry->FindSpotsInRadius( originParams, &insideSpotNum );
+	SpotsQueryVector &spotsFromQuery = tacticalSpotsRegistry->FindSpotsInRadius( originParams, &originSpotNum );
 	// Cut off some raw spots from query by vis tables
 	pruneByVisTables( spotsFromQuery );
 	SpotsAndScoreVector &candidateSpots = tacticalSpotsRegistry->cleanAndGetSpotsAndScoreVector();
@@ -63,42 +62,34 @@ void AdvantageProblemSolver::selectCandidateSpots( const SpotsQueryVector &spots
 
 	const auto *const spots = tacticalSpotsRegistry->spots;
 
-	for( auto spotNum: spotsFromQuery ) {
-		const TacticalSpot &spot = spots[spotNum];
-
-		float heightOverOrigin = spot.absMins[2] - originZ;
-		if( heightOverOrigin < minHeightAdvantageOverOrigin ) {
-			continue;
-		}
-
-		float heightOverEntity = spot.absMins[2] - entityZ;
-		if( heightOverEntity < minHeightAdvantageOverEntity ) {
-			continue;
-		}
-
-		float squareDistanceToOrigin = DistanceSquared( origin.Data(), spot.origin );
-		if( squareDistanceToOrigin > searchRadius * searchRadius ) {
-			continue;
-		}
-
-		float squareDistanceToEntity = DistanceSquared( entityOrigin.Data(), spot.origin );
-		if( squareDistanceToEntity < minSquareDistanceToEntity ) {
-			continue;
-		}
-		if( squareDistanceToEntity > maxSquareDistanceToEntity ) {
-			continue;
-		}
-
-		auto [criteriaScores, scoresIndex] = this->addNextScores();
-		float originAdvantageScore = ( heightOverOrigin - minHeightAdvantageOverOrigin );
-		originAdvantageScore = std::min( originAdvantageScore, rangeOfAdvantageOverOrigin );
-		originAdvantageScore *= originAdvantageNormalizer;
-		float entityAdvantageScore = ( heightOverEntity - minHeightAdvantageOverEntity );
-		entityAdvantageScore = std::min( entityAdvantageScore, rangeOfAdvantageOverEntity );
-		entityAdvantageScore *= entityAdvantageNormalizer;
-		criteriaScores->set( SpotSortCriterion::HeightOverOrigin, originAdvantageScore );
-		criteriaScores->set( SpotSortCriterion::HeightOverEntity, entityAdvantageScore );
-		candidateSpots.emplace_back( SpotAndScore( spotNum, scoresIndex ) );
+	SpotsSoAChunk chunk;
+	for( unsigned chunkStart = 0; chunkStart < spotsFromQuery.size(); chunkStart += SpotsSoAChunk::kMaxSize ) {
+		const uint16_t *chunkSpotNums = spotsFromQuery.begin() + chunkStart;
+		const unsigned chunkSize = std::min( SpotsSoAChunk::kMaxSize, spotsFromQuery.size() - chunkStart );
+		chunk.gather( tacticalSpotsRegistry, chunkSpotNums, chunkSize, []( uint16_t spotNum ) { return spotNum; } );
+
+		uint64_t mask = chunk.testHeightOver( originZ, minHeightAdvantageOverOrigin );
+		mask &= chunk.testHeightOver( entityZ, minHeightAdvantageOverEntity );
+		mask &= chunk.testSquareDistance( origin.Data(), 0.0f, searchRadius * searchRadius );
+		mask &= chunk.testSquareDistance( entityOrigin.Data(), minSquareDistanceToEntity, maxSquareDistanceToEntity );
+
+		ForEachSetBit( mask, [&]( unsigned i ) {
+			const uint16_t spotNum = chunkSpotNums[i];
+			const TacticalSpot &spot = spots[spotNum];
+			const float heightOverOrigin = spot.absMins[2] - originZ;
+			const float heightOverEntity = spot.absMins[2] - entityZ;
+
+			auto [criteriaScores, scoresIndex] = this->addNextScores();
+			float originAdvantageScore = ( heightOverOrigin - minHeightAdvantageOverOrigin );
+			originAdvantageScore = std::min( originAdvantageScore, rangeOfAdvantageOverOrigin );
+			originAdvantageScore *= originAdvantageNormalizer;
+			float entityAdvantageScore = ( heightOverEntity - minHeightAdvantageOverEntity );
+			entityAdvantageScore = std::min( entityAdvantageScore, rangeOfAdvantageOverEntity );
+			entityAdvantageScore *= entityAdvantageNormalizer;
+			criteriaScores->set( SpotSortCriterion::HeightOverOrigin, originAdvantageScore );
+			criteriaScores->set( SpotSortCriterion::HeightOverEntity, entityAdvantageScore );
+			candidateSpots.emplace_back( SpotAndScore( spotNum, scoresIndex ) );
+		});
 	}
 }
 
@@ -157,9 +148,22 @@ void AdvantageProblemSolver::checkOriginVisibility( SpotsAndScoreVector &candida
 	const edict_t *gameEdicts = game.edicts;
 	const auto *const spots = tacticalSpotsRegistry->spots;
 	const float spotZOffset = -playerbox_stand_mins[2] + playerbox_stand_viewheight;
+	const auto *const registry = tacticalSpotsRegistry;
+	// Check whether we can use the precomputed spots visibility for the "keep visible" origin
+	const uint16_t keepVisibleSpotNum = registry->FindSpotContainingPoint( problemParams.keepVisibleOrigin );
+	const uint32_t *keepVisibleSpotVisBits = nullptr;
+	if( keepVisibleSpotNum < registry->numSpots ) {
+		keepVisibleSpotVisBits = registry->SpotVisBitsRow( keepVisibleSpotNum );
+	}
 
 	unsigned numKeptSpots = 0;
 	for( const SpotAndScore &spotAndScore : candidateSpots ) {
+		const unsigned spotNum = spotAndScore.spotNum;
+		// Reject spots that are certainly invisible in the solid world without making a trace
+		if( keepVisibleSpotVisBits && !( ( keepVisibleSpotVisBits[spotNum / 32] >> ( spotNum % 32 ) ) & 1u ) ) {
+			continue;
+		}
+
 		//.Spot origins are dropped to floor (only few units above)
 		// Check whether we can hit standing on this spot (having the gun at viewheight)
 		Vec3 from( spots[spotAndScore.spotNum].origin );
@@ -198,15 +202,16 @@ void AdvantageProblemSolver::applyVisAndOtherFactors( SpotsAndScoreVector &candi
 		// Get address of the visibility table row
 		const uint8_t *spotVisForSpotNum = spotVisibilityTable + testedSpotNum * numSpots;
 
+		// Note: the row is addressed by spot numbers and not by candidate indices
 		unsigned visSum = 0;
 		for( unsigned j = 0; j < i; ++j ) {
-			visSum += spotVisForSpotNum[j];
+			visSum += spotVisForSpotNum[candidateSpots[j].spotNum];
 		}
 
 		// Skip i-th index
 
 		for( unsigned j = i + 1; j < candidateSpots.size(); ++j ) {
-			visSum += spotVisForSpotNum[j];
+			visSum += spotVisForSpotNum[candidateSpots[j].spotNum];
 		}
 
 		const TacticalSpot &testedSpot = spots[testedSpotNum];
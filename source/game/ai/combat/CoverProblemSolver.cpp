@@ -9,8 +9,7 @@ CoverProblemSolver::CoverProblemSolver( const OriginParams &originParams_, const
 }
 
 int CoverProblemSolver::findMany( vec3_t *spots, int maxSpots ) {
-	uint16_t insideSpotNum;
-	const SpotsQueryVector &spotsFromQuery = tacticalSpotsRegistry->FindSpotsInRadius( originParams, &insideSpotNum );
+	const SpotsQueryVector &spotsFromQuery = tacticalSpotsRegistry->FindSpotsInRadius( originParams, &originSpotNum );
 	SpotsAndScoreVector &candidateSpots = tacticalSpotsRegistry->cleanAndGetSpotsAndScoreVector();
 	selectCandidateSpots( spotsFromQuery, candidateSpots );
 	// Use these cheap calls to cut off as many spots as possible before a first collision filter
@@ -181,11 +180,25 @@ void CoverProblemSolver::pruneByCoarseRayTests( SpotsAndScoreVector &spotsAndSco
 												int collisionTopNodeHint,
 												const EntNumsVector &entNums ) {
 	const auto *const spots = tacticalSpotsRegistry->spots;
+	const auto *const registry = tacticalSpotsRegistry;
+	// Check whether we can use the precomputed spots visibility for the attacker
+	const uint16_t attackerSpotNum = registry->FindSpotContainingPoint( problemParams.attackerOrigin );
+	const uint32_t *attackerSpotVisBits = nullptr;
+	if( attackerSpotNum < registry->numSpots ) {
+		attackerSpotVisBits = registry->SpotVisBitsRow( attackerSpotNum );
+	}
 
 	unsigned numFeasibleSpots = 0;
 	// Filter spots in-place
 	for( const SpotAndScore &spotAndScore: spotsAndScores ) {
-		const TacticalSpot &spot = spots[spotAndScore.spotNum];
+		const unsigned spotNum = spotAndScore.spotNum;
+		// If the spot is certainly invisible from the attacker spot in the solid world,
+		// it is not certainly visible (that's what the coarse test checks) and should be kept.
+		if( attackerSpotVisBits && !( ( attackerSpotVisBits[spotNum / 32] >> ( spotNum % 32 ) ) & 1u ) ) {
+			spotsAndScores[numFeasibleSpots++] = spotAndScore;
+			continue;
+		}
+		const TacticalSpot &spot = spots[spotNum];
 		// Check whether spot is certainly visible
 		if( castRay( problemParams.attackerOrigin, spot.origin, collisionTopNodeHint, entNums ) ) {
 			continue;
@@ -8,8 +8,7 @@ DodgeHazardProblemSolver::DodgeHazardProblemSolver( const OriginParams &originPa
 }
 
 int DodgeHazardProblemSolver::findMany( vec3_t *spotOrigins, int maxSpots ) {
-	uint16_t insideSpotNum;
-	const SpotsQueryVector &spotsFromQuery = tacticalSpotsRegistry->FindSpotsInRadius( originParams, &insideSpotNum );
+	const SpotsQueryVector &spotsFromQuery = tacticalSpotsRegistry->FindSpotsInRadius( originParams, &originSpotNum );
 	SpotsAndScoreVector &candidateSpots = tacticalSpotsRegistry->cleanAndGetSpotsAndScoreVector();
 	selectCandidateSpots( spotsFromQuery, candidateSpots );
 
@@ -117,6 +116,11 @@ void DodgeHazardProblemSolver::selectCandidateSpots( const SpotsQueryVector &spo
 			}
 		}
 
+		// Cut off spots that are certainly invisible from the origin spot without making a trace
+		if( hasOriginSpot() && !tacticalSpotsRegistry->MayBeSpotsMutuallyVisible( originSpotNum, spotNum ) ) {
+			continue;
+		}
+
 		StaticWorldTrace( &trace, origin, spot.origin, CONTENTS_SOLID, vec3_origin, vec3_origin, topNodeHint );
 		if( trace.fraction != 1.0f ) {
 			continue;
@@ -3,6 +3,7 @@
 #include "../navigation/AasAreasWalker.h"
 #include "../ai_trajectory_predictor.h"
 #include "../bot.h"
+#include "../ai_frame_query_cache.h"
 
 class ClosestFacePointSolver final : public SharedFaceAreasWalker<ArrayBasedFringe<>> {
 	const aas_vertex_t *const __restrict aasVertices;
@@ -27,7 +28,7 @@ public:
 							const edict_t *ignoreEnt_,
 							const edict_t *targetEnt_ )
 		: SharedFaceAreasWalker(
-			AiAasWorld::Instance()->FindAreaNum( fireTarget_ ),
+			AiFrameQueryCache::Instance()->FindAreaNum( fireTarget_ ),
 			AasElementsMask::AreasMask(),
 			AasElementsMask::FacesMask() )
 		, aasVertices( aasWorld->Vertexes() )
@@ -28,6 +28,204 @@ inline const float *SpotOriginOf( const TacticalSpotsProblemSolver::OriginAndSco
 	return spotLike.origin.Data();
 }
 
+// Consider SSE2 instruction set always available for x86 targets
+#if ( defined ( __i386__ ) || defined ( __x86_64__ ) || defined( _M_IX86 ) || defined( _M_AMD64 ) || defined( _M_X64 ) )
+#define SPOTS_SOLVERS_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+/**
+ * A chunk of spot attributes gathered by spot numbers from the registry structure-of-arrays data.
+ * Tests over the chunk are performed for 4 spots at once
+ * and produce a bit mask of chunk elements that have passed a test.
+ */
+struct alignas( 16 ) SpotsSoAChunk {
+	static constexpr unsigned kMaxSize = 64;
+
+	float x[kMaxSize];
+	float y[kMaxSize];
+	float z[kMaxSize];
+	float minZ[kMaxSize];
+	unsigned size { 0 };
+
+	/**
+	 * @param spotNums a range of spot numbers or spot-like elements
+	 * @param spotNumOf a function that retrieves a spot number of a range element
+	 */
+	template <typename T, typename SpotNumOf>
+	void gather( const TacticalSpotsRegistry *registry, const T *spotNums, unsigned size_, SpotNumOf &&spotNumOf ) {
+		assert( size_ <= kMaxSize );
+		const float *__restrict originsX = registry->SpotOriginsX();
+		const float *__restrict originsY = registry->SpotOriginsY();
+		const float *__restrict originsZ = registry->SpotOriginsZ();
+		const float *__restrict absMinsZ = registry->SpotAbsMinsZ();
+		for( unsigned i = 0; i < size_; ++i ) {
+			const unsigned spotNum = spotNumOf( spotNums[i] );
+			x[i] = originsX[spotNum];
+			y[i] = originsY[spotNum];
+			z[i] = originsZ[spotNum];
+			minZ[i] = absMinsZ[spotNum];
+		}
+		// Make sure values of SIMD lanes past the chunk size are defined
+		for( unsigned i = size_; i < ( ( size_ + 3 ) & ~3u ); ++i ) {
+			x[i] = y[i] = z[i] = minZ[i] = 0.0f;
+		}
+		size = size_;
+	}
+
+	[[nodiscard]]
+	uint64_t sizeMask() const {
+		return size < 64 ? ( (uint64_t)1 << size ) - 1 : ~(uint64_t)0;
+	}
+
+	/**
+	 * Tests whether {@code minZ - baseZ >= minHeight} for chunk spots
+	 */
+	[[nodiscard]]
+	uint64_t testHeightOver( float baseZ, float minHeight ) const {
+		uint64_t result = 0;
+#ifdef SPOTS_SOLVERS_USE_SSE2
+		const __m128 xmmThreshold = _mm_set1_ps( baseZ + minHeight );
+		for( unsigned i = 0; i < size; i += 4 ) {
+			const __m128 xmmCmp = _mm_cmpge_ps( _mm_load_ps( minZ + i ), xmmThreshold );
+			result |= (uint64_t)_mm_movemask_ps( xmmCmp ) << i;
+		}
+#else
+		for( unsigned i = 0; i < size; ++i ) {
+			result |= (uint64_t)( minZ[i] - baseZ >= minHeight ) << i;
+		}
+#endif
+		return result & sizeMask();
+	}
+
+	/**
+	 * Tests whether a squared distance from the point to a spot origin is within the given range
+	 */
+	[[nodiscard]]
+	uint64_t testSquareDistance( const float *point, float minSquareDistance, float maxSquareDistance ) const {
+		uint64_t result = 0;
+#ifdef SPOTS_SOLVERS_USE_SSE2
+		const __m128 xmmPointX = _mm_set1_ps( point[0] );
+		const __m128 xmmPointY = _mm_set1_ps( point[1] );
+		const __m128 xmmPointZ = _mm_set1_ps( point[2] );
+		const __m128 xmmMinSquareDistance = _mm_set1_ps( minSquareDistance );
+		const __m128 xmmMaxSquareDistance = _mm_set1_ps( maxSquareDistance );
+		for( unsigned i = 0; i < size; i += 4 ) {
+			const __m128 xmmDX = _mm_sub_ps( _mm_load_ps( x + i ), xmmPointX );
+			const __m128 xmmDY = _mm_sub_ps( _mm_load_ps( y + i ), xmmPointY );
+			const __m128 xmmDZ = _mm_sub_ps( _mm_load_ps( z + i ), xmmPointZ );
+			__m128 xmmSquareDistance = _mm_mul_ps( xmmDX, xmmDX );
+			xmmSquareDistance = _mm_add_ps( xmmSquareDistance, _mm_mul_ps( xmmDY, xmmDY ) );
+			xmmSquareDistance = _mm_add_ps( xmmSquareDistance, _mm_mul_ps( xmmDZ, xmmDZ ) );
+			const __m128 xmmCmpMin = _mm_cmpge_ps( xmmSquareDistance, xmmMinSquareDistance );
+			const __m128 xmmCmpMax = _mm_cmple_ps( xmmSquareDistance, xmmMaxSquareDistance );
+			result |= (uint64_t)_mm_movemask_ps( _mm_and_ps( xmmCmpMin, xmmCmpMax ) ) << i;
+		}
+#else
+		for( unsigned i = 0; i < size; ++i ) {
+			const float dx = x[i] - point[0], dy = y[i] - point[1], dz = z[i] - point[2];
+			const float squareDistance = dx * dx + dy * dy + dz * dz;
+			result |= (uint64_t)( squareDistance >= minSquareDistance && squareDistance <= maxSquareDistance ) << i;
+		}
+#endif
+		return result & sizeMask();
+	}
+};
+
+/**
+ * A chunk of table travel times gathered by spot numbers.
+ * A zero travel time means that there is no route.
+ */
+struct alignas( 16 ) TravelTimesChunk {
+	static constexpr unsigned kMaxSize = SpotsSoAChunk::kMaxSize;
+
+	uint16_t times[kMaxSize];
+	unsigned size { 0 };
+
+	template <typename Fn>
+	void gather( unsigned size_, Fn &&timeForIndex ) {
+		assert( size_ <= kMaxSize );
+		for( unsigned i = 0; i < size_; ++i ) {
+			times[i] = (uint16_t)timeForIndex( i );
+		}
+		for( unsigned i = size_; i < ( ( size_ + 7 ) & ~7u ); ++i ) {
+			times[i] = 0;
+		}
+		size = size_;
+	}
+
+	[[nodiscard]]
+	uint64_t sizeMask() const {
+		return size < 64 ? ( (uint64_t)1 << size ) - 1 : ~(uint64_t)0;
+	}
+
+	/**
+	 * Tests whether travel times are non-zero and do not exceed the given value
+	 */
+	[[nodiscard]]
+	uint64_t testFeasible( int maxTime ) const {
+		return testFeasibleSum( nullptr, maxTime );
+	}
+
+	/**
+	 * Tests whether travel times of this and that chunk are non-zero
+	 * and their sum does not exceed the given value.
+	 * @param that another chunk of the same size (if any)
+	 */
+	[[nodiscard]]
+	uint64_t testFeasibleSum( const TravelTimesChunk *that, int maxSumTime ) const {
+		assert( !that || that->size == size );
+		const auto maxValue = (uint16_t)std::min( maxSumTime, (int)std::numeric_limits<uint16_t>::max() );
+		uint64_t result = 0;
+#ifdef SPOTS_SOLVERS_USE_SSE2
+		const __m128i xmmZero = _mm_setzero_si128();
+		const __m128i xmmMax = _mm_set1_epi16( (int16_t)maxValue );
+		for( unsigned i = 0; i < size; i += 8 ) {
+			__m128i xmmTimes = _mm_load_si128( (const __m128i *)( times + i ) );
+			// Lanes that are set if there is no route
+			__m128i xmmRejected = _mm_cmpeq_epi16( xmmTimes, xmmZero );
+			if( that ) {
+				const __m128i xmmThatTimes = _mm_load_si128( (const __m128i *)( that->times + i ) );
+				xmmRejected = _mm_or_si128( xmmRejected, _mm_cmpeq_epi16( xmmThatTimes, xmmZero ) );
+				// Use a saturating addition so an overflow is still greater than the max value
+				xmmTimes = _mm_adds_epu16( xmmTimes, xmmThatTimes );
+			}
+			// There's no unsigned 16-bit comparison in SSE2.
+			// A saturating subtraction yields zero only if the time does not exceed the max value.
+			const __m128i xmmExcess = _mm_subs_epu16( xmmTimes, xmmMax );
+			const __m128i xmmFeasible = _mm_cmpeq_epi16( xmmExcess, xmmZero );
+			const __m128i xmmKept = _mm_andnot_si128( xmmRejected, xmmFeasible );
+			// Pack 16-bit masks to 8-bit ones so the movemask yields a bit per lane
+			const auto laneBits = (unsigned)_mm_movemask_epi8( _mm_packs_epi16( xmmKept, xmmZero ) );
+			result |= (uint64_t)laneBits << i;
+		}
+#else
+		for( unsigned i = 0; i < size; ++i ) {
+			unsigned time = times[i];
+			bool rejected = !time;
+			if( that ) {
+				rejected |= !that->times[i];
+				time += that->times[i];
+			}
+			result |= (uint64_t)( !rejected && time <= maxValue ) << i;
+		}
+#endif
+		return result & sizeMask();
+	}
+};
+
+/**
+ * Calls the function for indices of set bits of the mask in ascending order
+ */
+template <typename Fn>
+inline void ForEachSetBit( uint64_t mask, Fn &&fn ) {
+	for( unsigned i = 0; mask; ++i, mask >>= 1 ) {
+		if( mask & 1 ) {
+			fn( i );
+		}
+	}
+}
+
 inline float ComputeDistanceFactor( float distance, float weightFalloffDistanceRatio, float searchRadius ) {
 	float weightFalloffRadius = weightFalloffDistanceRatio * searchRadius;
 	if( distance < weightFalloffRadius ) {
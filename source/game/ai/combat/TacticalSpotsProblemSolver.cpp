@@ -1,7 +1,7 @@
 #include "TacticalSpotsProblemSolver.h"
 #include "SpotsProblemSolversLocal.h"
 #include "../navigation/AasElementsMask.h"
-#include "../ai_ground_trace_cache.h"
+#include "../ai_frame_query_cache.h"
 
 void TacticalSpotsProblemSolver::selectCandidateSpots( const SpotsQueryVector &spotsFromQuery,
 													   SpotsAndScoreVector &candidates ) {
@@ -12,52 +12,72 @@ void TacticalSpotsProblemSolver::selectCandidateSpots( const SpotsQueryVector &s
 	// Copy to stack for faster access
 	Vec3 origin( originParams.origin );
 
-	for( auto spotNum: spotsFromQuery ) {
-		const TacticalSpot &spot = spots[spotNum];
-
-		float heightOverOrigin = spot.absMins[2] - originZ;
-		if( heightOverOrigin < minHeightAdvantageOverOrigin ) {
-			continue;
-		}
-
-		float squareDistanceToOrigin = DistanceSquared( origin.Data(), spot.origin );
-		if( squareDistanceToOrigin > searchRadius * searchRadius ) {
-			continue;
-		}
-
-		auto [criteriaScores, scoresIndex] = addNextScores();
-		float heightAdvantage = heightOverOrigin - minHeightAdvantageOverOrigin;
-		float advantageFactor = BoundedFraction( heightAdvantage, searchRadius );
-		criteriaScores->set( SpotSortCriterion::HeightOverOrigin, advantageFactor );
-		candidates.emplace_back( SpotAndScore( spotNum, scoresIndex ) );
+	SpotsSoAChunk chunk;
+	for( unsigned chunkStart = 0; chunkStart < spotsFromQuery.size(); chunkStart += SpotsSoAChunk::kMaxSize ) {
+		const uint16_t *chunkSpotNums = spotsFromQuery.begin() + chunkStart;
+		const unsigned chunkSize = std::min( SpotsSoAChunk::kMaxSize, spotsFromQuery.size() - chunkStart );
+		chunk.gather( tacticalSpotsRegistry, chunkSpotNums, chunkSize, []( uint16_t spotNum ) { return spotNum; } );
+
+		uint64_t mask = chunk.testHeightOver( originZ, minHeightAdvantageOverOrigin );
+		mask &= chunk.testSquareDistance( origin.Data(), 0.0f, searchRadius * searchRadius );
+
+		ForEachSetBit( mask, [&]( unsigned i ) {
+			const uint16_t spotNum = chunkSpotNums[i];
+			auto [criteriaScores, scoresIndex] = addNextScores();
+			float heightAdvantage = spots[spotNum].absMins[2] - originZ - minHeightAdvantageOverOrigin;
+			float advantageFactor = BoundedFraction( heightAdvantage, searchRadius );
+			criteriaScores->set( SpotSortCriterion::HeightOverOrigin, advantageFactor );
+			candidates.emplace_back( SpotAndScore( spotNum, scoresIndex ) );
+		});
 	}
 }
 
-void TacticalSpotsProblemSolver::pruneByReachTablesFromOrigin( SpotsAndScoreVector &candidates ) {
-	// AAS uses travel time in centiseconds
-	const int maxFeasibleTravelTimeCentis = problemParams.maxFeasibleTravelTimeMillis / 10;
-	const int originAreaNum = originParams.originAreaNum;
+template <typename Fn>
+void TacticalSpotsProblemSolver::pruneByTableTravelTimes( SpotsAndScoreVector &candidates, Fn &&testChunk ) {
 	const auto *const routeCache = originParams.routeCache;
 	const auto *const spots = tacticalSpotsRegistry->spots;
 
 	unsigned numKeptSpots = 0;
-	for( const auto &spotAndScore: candidates ) {
-		const int spotNum = spotAndScore.spotNum;
-		const int tableTravelTime = tacticalSpotsRegistry->TravelTimeFromAreaToSpot( originAreaNum, spotNum );
-		if( !tableTravelTime || tableTravelTime > maxFeasibleTravelTimeCentis ) {
-			continue;
-		}
-		// Cut off blocked spots early without draining the router cache by making requests
-		if( routeCache->AreaDisabled( spots[spotNum].aasAreaNum ) ) {
-			continue;
-		}
-
-		candidates[numKeptSpots++] = spotAndScore;
+	for( unsigned chunkStart = 0; chunkStart < candidates.size(); chunkStart += TravelTimesChunk::kMaxSize ) {
+		const unsigned chunkSize = std::min( TravelTimesChunk::kMaxSize, candidates.size() - chunkStart );
+		const uint64_t mask = testChunk( candidates.begin() + chunkStart, chunkSize );
+		ForEachSetBit( mask, [&]( unsigned i ) {
+			const SpotAndScore spotAndScore = candidates[chunkStart + i];
+			// Cut off blocked spots early without draining the router cache by making requests
+			if( !routeCache->AreaDisabled( spots[spotAndScore.spotNum].aasAreaNum ) ) {
+				// Kept spots are never ahead of the tested ones so this is safe
+				candidates[numKeptSpots++] = spotAndScore;
+			}
+		});
 	}
 
 	candidates.truncate( numKeptSpots );
 }
 
+void TacticalSpotsProblemSolver::pruneByReachTablesFromOrigin( SpotsAndScoreVector &candidates ) {
+	// AAS uses travel time in centiseconds
+	const int maxFeasibleTravelTimeCentis = problemParams.maxFeasibleTravelTimeMillis / 10;
+	const auto *const registry = tacticalSpotsRegistry;
+
+	TravelTimesChunk toTimes;
+	if( hasOriginSpot() ) {
+		// Use a dense row of the spot-to-spot table
+		const uint16_t *__restrict row = registry->spotsTravelTimeTable + originSpotNum * registry->numSpots;
+		pruneByTableTravelTimes( candidates, [&]( const SpotAndScore *chunk, unsigned chunkSize ) {
+			toTimes.gather( chunkSize, [&]( unsigned i ) { return row[chunk[i].spotNum]; } );
+			return toTimes.testFeasible( maxFeasibleTravelTimeCentis );
+		});
+	} else {
+		const int originAreaNum = originParams.originAreaNum;
+		pruneByTableTravelTimes( candidates, [&]( const SpotAndScore *chunk, unsigned chunkSize ) {
+			toTimes.gather( chunkSize, [&]( unsigned i ) {
+				return registry->TravelTimeFromAreaToSpot( originAreaNum, chunk[i].spotNum );
+			});
+			return toTimes.testFeasible( maxFeasibleTravelTimeCentis );
+		});
+	}
+}
+
 void TacticalSpotsProblemSolver::checkSpotsReachFromOrigin( SpotsAndScoreVector &candidates, int maxResultSpots ) {
 	const auto *const routeCache = originParams.routeCache;
 	const auto *const spots = tacticalSpotsRegistry->spots;
@@ -91,32 +111,30 @@ void TacticalSpotsProblemSolver::checkSpotsReachFromOrigin( SpotsAndScoreVector
 void TacticalSpotsProblemSolver::pruneByReachTablesFromOriginAndBack( SpotsAndScoreVector &spotsAndScores ) {
 	// A round trip time can't be 2x larger
 	const int maxFeasibleSumTravelTimeCentis = 2 * ( problemParams.maxFeasibleTravelTimeMillis / 10 );
-	const int originAreaNum = originParams.originAreaNum;
-	const auto *const routeCache = originParams.routeCache;
-	const auto *const spots = tacticalSpotsRegistry->spots;
-
-	unsigned numKeptSpots = 0;
-	for( const auto &spotAndScore: spotsAndScores ) {
-		const auto spotNum = spotAndScore.spotNum;
-		const int tableToTravelTime = tacticalSpotsRegistry->TravelTimeFromAreaToSpot( originAreaNum, spotNum );
-		if( !tableToTravelTime ) {
-			continue;
-		}
-		const int tableBackTravelTime = tacticalSpotsRegistry->TravelTimeFromSpotToArea( spotNum, originAreaNum );
-		if( !tableBackTravelTime ) {
-			continue;
-		}
-		if( tableToTravelTime + tableBackTravelTime > maxFeasibleSumTravelTimeCentis ) {
-			continue;
-		}
-		// Cut off blocked spots early without draining the router cache by making requests
-		if( routeCache->AreaDisabled( spots[spotNum].aasAreaNum ) ) {
-			continue;
-		}
-		spotsAndScores[numKeptSpots++] = spotAndScore;
+	const auto *const registry = tacticalSpotsRegistry;
+
+	TravelTimesChunk toTimes, backTimes;
+	if( hasOriginSpot() ) {
+		const unsigned numSpots = registry->numSpots;
+		const uint16_t *__restrict toRow = registry->spotsTravelTimeTable + originSpotNum * numSpots;
+		const uint16_t *__restrict backColumn = registry->spotsTravelTimeTable + originSpotNum;
+		pruneByTableTravelTimes( spotsAndScores, [&]( const SpotAndScore *chunk, unsigned chunkSize ) {
+			toTimes.gather( chunkSize, [&]( unsigned i ) { return toRow[chunk[i].spotNum]; } );
+			backTimes.gather( chunkSize, [&]( unsigned i ) { return backColumn[chunk[i].spotNum * numSpots]; } );
+			return toTimes.testFeasibleSum( &backTimes, maxFeasibleSumTravelTimeCentis );
+		});
+	} else {
+		const int originAreaNum = originParams.originAreaNum;
+		pruneByTableTravelTimes( spotsAndScores, [&]( const SpotAndScore *chunk, unsigned chunkSize ) {
+			toTimes.gather( chunkSize, [&]( unsigned i ) {
+				return registry->TravelTimeFromAreaToSpot( originAreaNum, chunk[i].spotNum );
+			});
+			backTimes.gather( chunkSize, [&]( unsigned i ) {
+				return registry->TravelTimeFromSpotToArea( chunk[i].spotNum, originAreaNum );
+			});
+			return toTimes.testFeasibleSum( &backTimes, maxFeasibleSumTravelTimeCentis );
+		});
 	}
-
-	spotsAndScores.truncate( numKeptSpots );
 }
 
 void TacticalSpotsProblemSolver::checkSpotsReachFromOriginAndBack( SpotsAndScoreVector &candidates, int maxResultSpots ) {
@@ -216,10 +234,10 @@ void TacticalSpotsProblemSolver::applyEnemiesInfluence( SpotsAndScoreVector &can
 		} else {
 			vec3_t tmpOrigin;
 			const float *testedOrigin = enemyOrigin.Data();
-			if( AiGroundTraceCache::Instance()->TryDropToFloor( enemy->ent, 64.0f, tmpOrigin ) ) {
+			if( AiFrameQueryCache::Instance()->TryDropToFloor( enemy->ent, 64.0f, tmpOrigin ) ) {
 				testedOrigin = tmpOrigin;
 			}
-			enemyData->groundedAreaNum = aasWorld->FindAreaNum( testedOrigin );
+			enemyData->groundedAreaNum = AiFrameQueryCache::Instance()->FindAreaNum( testedOrigin );
 		}
 
 		enemyData->areaVisRow = aasWorld->DecompressAreaVis( enemyData->groundedAreaNum, areaVisRow );
@@ -242,6 +260,7 @@ void TacticalSpotsProblemSolver::applyEnemiesInfluence( SpotsAndScoreVector &can
 
 	const float scoreNormalizationMultiplier = Q_Rcp( (float)cachedEnemyData.size() + 0.001f );
 	const auto *const spots = tacticalSpotsRegistry->spots;
+	auto *const queryCache = AiFrameQueryCache::Instance();
 	for( auto &spotAndScore: candidates ) {
 		const auto &__restrict spot = spots[spotAndScore.spotNum];
 		const int spotFloorClusterNum = aasWorld->AreaFloorClusterNums()[spot.aasAreaNum];
@@ -280,12 +299,8 @@ void TacticalSpotsProblemSolver::applyEnemiesInfluence( SpotsAndScoreVector &can
 				if( !aasWorld->IsAreaWalkableInFloorCluster( enemyData.groundedAreaNum, spotFloorClusterNum ) ) {
 					continue;
 				}
-			} else {
-				trace_t trace;
-				SolidWorldTrace( &trace, enemyData.viewOrigin, spot.origin );
-				if( trace.fraction != 1.0f ) {
-					continue;
-				}
+			} else if( !queryCache->IsSpotVisible( enemyData.viewOrigin, spotAndScore.spotNum, spot.origin ) ) {
+				continue;
 			}
 
 			// Just add a unit on influence for every enemy.
@@ -74,6 +74,12 @@ protected:
 	const OriginParams &originParams;
 	TacticalSpotsRegistry *const tacticalSpotsRegistry;
 	TacticalSpotsRegistry::CriteriaScoresVector &scores;
+	// A spot the origin is inside (if any), an illegal spot number otherwise.
+	// Should be set by a query of spots in radius.
+	// Precomputed spot-to-spot tables are used instead of origin area ones if it is valid.
+	uint16_t originSpotNum { MAX_SPOTS + 1 };
+
+	bool hasOriginSpot() const { return originSpotNum < tacticalSpotsRegistry->numSpots; }
 
 	std::pair<CriteriaScores *, unsigned> addNextScores() {
 		auto *criteriaScores = new( scores.unsafe_grow_back() )CriteriaScores();
@@ -82,6 +88,13 @@ protected:
 
 	virtual void selectCandidateSpots( const SpotsQueryVector &spotsFromQuery, SpotsAndScoreVector &spots );
 
+	/**
+	 * Tests candidates in chunks by the supplied function that yields a mask of kept chunk elements.
+	 * Also cuts off candidates in areas that are disabled for the origin route cache.
+	 */
+	template <typename Fn>
+	void pruneByTableTravelTimes( SpotsAndScoreVector &spots, Fn &&testChunk );
+
 	virtual void pruneByReachTablesFromOrigin( SpotsAndScoreVector &spots );
 
 	virtual void checkSpotsReachFromOrigin( SpotsAndScoreVector &spots, int maxSpots );
@@ -40,6 +40,8 @@ class TacticalSpotsBuilder {
 
 	uint8_t *spotVisibilityTable { nullptr };
 	uint16_t *spotsAndAreasTravelTimeTable { nullptr };
+	uint32_t *spotVisBitMatrix { nullptr };
+	uint16_t *spotsTravelTimeTable { nullptr };
 
 	TacticalSpotsRegistry::SpotsGridBuilder gridBuilder;
 
@@ -77,7 +79,9 @@ class TacticalSpotsBuilder {
 
 	void PickTacticalSpots();
 	void ComputeMutualSpotsVisibility();
+	void ComputeSpotVisBitMatrix();
 	void ComputeTravelTimeTable();
+	void ComputeSpotsTravelTimeTable();
 public:
 	explicit TacticalSpotsBuilder( TacticalSpotsRegistry *registry ): gridBuilder( registry ) {}
 
@@ -89,20 +93,23 @@ public:
 };
 
 bool TacticalSpotsRegistry::Load( const char *mapname ) {
-	if( TryLoadPrecomputedData( mapname ) ) {
-		return true;
-	}
-
-	TacticalSpotsBuilder builder( this );
-	if( !builder.Build() ) {
-		return false;
+	if( !TryLoadPrecomputedData( mapname ) ) {
+		TacticalSpotsBuilder builder( this );
+		if( !builder.Build() ) {
+			return false;
+		}
+		builder.CopyTo( this );
 	}
 
-	builder.CopyTo( this );
+	BuildSpotsSoAData();
 	return true;
 }
 
-constexpr const uint32_t PRECOMPUTED_DATA_VERSION = 0x1337A001;
+constexpr const uint32_t PRECOMPUTED_DATA_VERSION = 0x1337A003;
+
+static inline unsigned SpotVisRowWordsForNumSpots( unsigned numSpots ) {
+	return ( numSpots + 31 ) / 32;
+}
 
 static void *SpotsAlloc( size_t size ) {
 	return Q_malloc( size );
@@ -192,6 +199,37 @@ bool TacticalSpotsRegistry::TryLoadPrecomputedData( const char *mapName ) {
 	// Spot visibility does not need neither byte swap nor validation being just an unsigned byte
 	static_assert( sizeof( *spotVisibilityTable ) == 1, "" );
 
+	// Read spots visibility bit matrix
+	if( !reader.ReadLengthAndData( &data, &dataLength ) ) {
+		return false;
+	}
+
+	spotVisRowWords = SpotVisRowWordsForNumSpots( numSpots );
+	spotVisBitMatrix = (uint32_t *)data;
+	if( dataLength / sizeof( uint32_t ) != numSpots * spotVisRowWords ) {
+		G_Printf( S_COLOR_RED "%s: Spots visibility bit matrix size does not match the number of spots\n", function );
+		return false;
+	}
+
+	for( unsigned i = 0, end = numSpots * spotVisRowWords; i < end; ++i ) {
+		spotVisBitMatrix[i] = LittleLong( spotVisBitMatrix[i] );
+	}
+
+	// Read spot-to-spot travel time table
+	if( !reader.ReadLengthAndData( &data, &dataLength ) ) {
+		return false;
+	}
+
+	spotsTravelTimeTable = (uint16_t *)data;
+	if( dataLength / sizeof( uint16_t ) != numSpots * numSpots ) {
+		G_Printf( S_COLOR_RED "%s: Spots travel time table size does not match the number of spots\n", function );
+		return false;
+	}
+
+	for( unsigned i = 0, end = numSpots * numSpots; i < end; ++i ) {
+		spotsTravelTimeTable[i] = LittleShort( spotsTravelTimeTable[i] );
+	}
+
 	spotsGrid.AttachSpots( spots, numSpots );
 	if( !spotsGrid.Load( reader ) ) {
 		return false;
@@ -276,8 +314,8 @@ void TacticalSpotsRegistry::SavePrecomputedData( const char *mapName ) {
 		spot.aasAreaNum = LittleLong( spot.aasAreaNum );
 		for( int j = 0; j < 3; ++j ) {
 			spot.origin[j] = LittleFloat( spot.origin[j] );
-			spot.absMins[j] = LittleFloat( spot.origin[j] );
-			spot.absMaxs[j] = LittleFloat( spot.origin[j] );
+			spot.absMins[j] = LittleFloat( spot.absMins[j] );
+			spot.absMaxs[j] = LittleFloat( spot.absMaxs[j] );
 		}
 	}
 
@@ -317,6 +355,36 @@ void TacticalSpotsRegistry::SavePrecomputedData( const char *mapName ) {
 	Q_free( spotVisibilityTable );
 	spotVisibilityTable = nullptr;
 
+	// Byte swap the visibility bit matrix
+	static_assert( sizeof( *spotVisBitMatrix ) == 4, "LittleLong() is not applicable" );
+	for( unsigned i = 0, end = numSpots * spotVisRowWords; i < end; ++i ) {
+		spotVisBitMatrix[i] = LittleLong( spotVisBitMatrix[i] );
+	}
+
+	dataLength = numSpots * spotVisRowWords * sizeof( *spotVisBitMatrix );
+	if( !writer.WriteLengthAndData( (const uint8_t *)spotVisBitMatrix, dataLength ) ) {
+		return;
+	}
+
+	// Prevent using the byte-swapped bit matrix
+	Q_free( spotVisBitMatrix );
+	spotVisBitMatrix = nullptr;
+
+	// Byte swap spot-to-spot travel times
+	static_assert( sizeof( *spotsTravelTimeTable ) == 2, "LittleShort() is not applicable" );
+	for( unsigned i = 0, end = numSpots * numSpots; i < end; ++i ) {
+		spotsTravelTimeTable[i] = LittleShort( spotsTravelTimeTable[i] );
+	}
+
+	dataLength = numSpots * numSpots * sizeof( *spotsTravelTimeTable );
+	if( !writer.WriteLengthAndData( (const uint8_t *)spotsTravelTimeTable, dataLength ) ) {
+		return;
+	}
+
+	// Prevent using byte-swapped travel times table
+	Q_free( spotsTravelTimeTable );
+	spotsTravelTimeTable = nullptr;
+
 	spotsGrid.Save( writer );
 
 	G_Printf( "The precomputed tactical spots data has been saved successfully to %s\n", fileName );
@@ -384,6 +452,33 @@ TacticalSpotsRegistry::~TacticalSpotsRegistry() {
 	if( spotsAndAreasTravelTimeTable ) {
 		Q_free( spotsAndAreasTravelTimeTable );
 	}
+	if( spotVisBitMatrix ) {
+		Q_free( spotVisBitMatrix );
+	}
+	if( spotsTravelTimeTable ) {
+		Q_free( spotsTravelTimeTable );
+	}
+	if( spotsSoAData ) {
+		Q_free( spotsSoAData );
+	}
+}
+
+void TacticalSpotsRegistry::BuildSpotsSoAData() {
+	// Pad arrays so full SIMD vectors could be loaded for the last spots
+	spotsSoAStride = ( numSpots + 3 ) & ~3u;
+	spotsSoAData = (float *)Q_malloc( 4 * spotsSoAStride * sizeof( float ) );
+
+	float *const originsX = spotsSoAData + 0 * spotsSoAStride;
+	float *const originsY = spotsSoAData + 1 * spotsSoAStride;
+	float *const originsZ = spotsSoAData + 2 * spotsSoAStride;
+	float *const absMinsZ = spotsSoAData + 3 * spotsSoAStride;
+	for( unsigned i = 0; i < numSpots; ++i ) {
+		const TacticalSpot &spot = spots[i];
+		originsX[i] = spot.origin[0];
+		originsY[i] = spot.origin[1];
+		originsZ[i] = spot.origin[2];
+		absMinsZ[i] = spot.absMins[2];
+	}
 }
 
 void TacticalSpotsBuilder::ComputeMutualSpotsVisibility() {
@@ -459,6 +554,25 @@ void TacticalSpotsBuilder::ComputeMutualSpotsVisibility() {
 			spotVisibilityTable[j * numSpots + i] = visibility;
 		}
 	}
+
+	ComputeSpotVisBitMatrix();
+}
+
+void TacticalSpotsBuilder::ComputeSpotVisBitMatrix() {
+	const unsigned uNumSpots = (unsigned)numSpots;
+	const unsigned rowWords = SpotVisRowWordsForNumSpots( uNumSpots );
+	// Q_malloc() returns zeroed memory
+	spotVisBitMatrix = (uint32_t *)Q_malloc( uNumSpots * rowWords * sizeof( uint32_t ) );
+
+	for( unsigned i = 0; i < uNumSpots; ++i ) {
+		const uint8_t *__restrict visRow = spotVisibilityTable + i * uNumSpots;
+		uint32_t *__restrict bitsRow = spotVisBitMatrix + i * rowWords;
+		for( unsigned j = 0; j < uNumSpots; ++j ) {
+			if( visRow[j] ) {
+				bitsRow[j / 32] |= 1u << ( j % 32 );
+			}
+		}
+	}
 }
 
 void TacticalSpotsBuilder::ComputeTravelTimeTable() {
@@ -492,6 +606,24 @@ void TacticalSpotsBuilder::ComputeTravelTimeTable() {
 			spotsAndAreasTravelTimeTable[rowOffset++] = (uint16_t)std::min( areaToSpotTime, maxVal );
 		}
 	}
+
+	ComputeSpotsTravelTimeTable();
+}
+
+void TacticalSpotsBuilder::ComputeSpotsTravelTimeTable() {
+	const unsigned uNumSpots = (unsigned)numSpots;
+	spotsTravelTimeTable = (uint16_t *)Q_malloc( sizeof( uint16_t ) * uNumSpots * uNumSpots );
+
+	// Spot-to-spot travel times are just spot-to-area ones for areas of spots.
+	// Transpose these values to dense rows addressed by spot numbers.
+	for( unsigned toSpotNum = 0; toSpotNum < uNumSpots; ++toSpotNum ) {
+		const unsigned areaNum = (unsigned)spots[toSpotNum].aasAreaNum;
+		const uint16_t *__restrict areaRow = spotsAndAreasTravelTimeTable + 2 * areaNum * uNumSpots;
+		for( unsigned fromSpotNum = 0; fromSpotNum < uNumSpots; ++fromSpotNum ) {
+			// Use the "spot to area" value of the cell
+			spotsTravelTimeTable[fromSpotNum * uNumSpots + toSpotNum] = areaRow[2 * fromSpotNum + 0];
+		}
+	}
 }
 
 TacticalSpotsBuilder::~TacticalSpotsBuilder() {
@@ -510,6 +642,12 @@ TacticalSpotsBuilder::~TacticalSpotsBuilder() {
 	if( spotsAndAreasTravelTimeTable ) {
 		Q_free( spotsAndAreasTravelTimeTable );
 	}
+	if( spotVisBitMatrix ) {
+		Q_free( spotVisBitMatrix );
+	}
+	if( spotsTravelTimeTable ) {
+		Q_free( spotsTravelTimeTable );
+	}
 }
 
 bool TacticalSpotsBuilder::Build() {
@@ -906,6 +1044,13 @@ void TacticalSpotsBuilder::CopyTo( TacticalSpotsRegistry *registry ) {
 	registry->spotsAndAreasTravelTimeTable = this->spotsAndAreasTravelTimeTable;
 	this->spotsAndAreasTravelTimeTable = nullptr;
 
+	registry->spotVisBitMatrix = this->spotVisBitMatrix;
+	this->spotVisBitMatrix = nullptr;
+	registry->spotVisRowWords = SpotVisRowWordsForNumSpots( registry->numSpots );
+
+	registry->spotsTravelTimeTable = this->spotsTravelTimeTable;
+	this->spotsTravelTimeTable = nullptr;
+
 	registry->needsSavingPrecomputedData = true;
 }
 
@@ -1021,6 +1166,33 @@ TacticalSpotsRegistry::PrecomputedSpotsGrid::~PrecomputedSpotsGrid() {
 	}
 }
 
+uint16_t TacticalSpotsRegistry::BaseSpotsGrid::FindSpotContainingPoint( const vec3_t point ) const {
+	for( int i = 0; i < 3; ++i ) {
+		if( point[i] < worldMins[i] || point[i] > worldMaxs[i] ) {
+			return MAX_SPOTS + 1;
+		}
+	}
+
+	uint16_t numCellSpots;
+	const uint16_t *spotsList = GetCellSpotsList( PointGridCellNum( point ), &numCellSpots );
+	for( uint16_t i = 0; i < numCellSpots; ++i ) {
+		const uint16_t spotNum = spotsList[i];
+		const TacticalSpot &spot = spots[spotNum];
+		if( point[0] < spot.absMins[0] || point[0] > spot.absMaxs[0] ) {
+			continue;
+		}
+		if( point[1] < spot.absMins[1] || point[1] > spot.absMaxs[1] ) {
+			continue;
+		}
+		if( point[2] < spot.absMins[2] || point[2] > spot.absMaxs[2] ) {
+			continue;
+		}
+		return spotNum;
+	}
+
+	return MAX_SPOTS + 1;
+}
+
 SpotsQueryVector &TacticalSpotsRegistry::PrecomputedSpotsGrid::FindSpotsInRadius( const OriginParams &originParams,
 																				  uint16_t *insideSpotNum ) const {
 	if( !IsLoaded() ) {
@@ -2,6 +2,7 @@
 #define QFUSION_TACTICAL_SPOTS_DETECTOR_H
 
 #include "../ai_local.h"
+#include "../ai_frame_query_cache.h"
 #include "../navigation/AasRouteCache.h"
 #include "../../../qcommon/wswstaticvector.h"
 #include "../bot.h"
@@ -72,7 +73,7 @@ public:
 			: originEntity( originEntity_ ), searchRadius( searchRadius_ ), routeCache( routeCache_ ) {
 			VectorCopy( originEntity_->s.origin, this->origin );
 			const AiAasWorld *aasWorld = AiAasWorld::Instance();
-			originAreaNum = aasWorld->IsLoaded() ? aasWorld->FindAreaNum( originEntity ) : 0;
+			originAreaNum = aasWorld->IsLoaded() ? AiFrameQueryCache::Instance()->FindAreaNum( originEntity ) : 0;
 		}
 
 		OriginParams( const vec3_t origin_, float searchRadius_, const AiAasRouteCache *routeCache_ )
@@ -87,7 +88,7 @@ public:
 			: originEntity( originEntity_ ), searchRadius( searchRadius_ ), routeCache( routeCache_ ) {
 			VectorCopy( origin_, this->origin );
 			const AiAasWorld *aasWorld = AiAasWorld::Instance();
-			originAreaNum = aasWorld->IsLoaded() ? aasWorld->FindAreaNum( originEntity ) : 0;
+			originAreaNum = aasWorld->IsLoaded() ? AiFrameQueryCache::Instance()->FindAreaNum( originEntity ) : 0;
 		}
 
 		inline Vec3 MinBBoxBounds( float minHeightAdvantage = 0.0f ) const {
@@ -181,8 +182,24 @@ private:
 	// Regardless of that values of this table are very useful for cutting off
 	// non-feasible spots/areas before making expensive actual routing calls.
 	uint16_t *spotsAndAreasTravelTimeTable { nullptr };
+	// A compressed form of the spot visibility table (a bit matrix).
+	// For i-th spot a row of spotVisRowWords words starts at i * spotVisRowWords.
+	// A j-th bit of the row is set if the visibility of i-th and j-th spots is non-zero.
+	// Thus a zero bit means that spots are certainly invisible for each other in the solid world.
+	uint32_t *spotVisBitMatrix { nullptr };
+	// For i-th spot element # i * numSpots + j contains travel time from the i-th spot to the j-th spot.
+	// Zero values mean that the j-th spot is not reachable from the i-th spot.
+	// Travel times are computed the same way as spotsAndAreasTravelTimeTable values.
+	// Contrary to the spots and areas table rows are dense and thus are more cache-friendly.
+	uint16_t *spotsTravelTimeTable { nullptr };
+	// Spot origins and spot absMins[2] values in a structure-of-arrays form.
+	// Each array has spotsSoAStride elements (it is padded to 4-component SIMD vectors).
+	// These arrays are not saved but are built from spots on loading.
+	float *spotsSoAData { nullptr };
+	unsigned spotsSoAStride { 0 };
 
 	unsigned numSpots { 0 };
+	unsigned spotVisRowWords { 0 };
 
 	bool needsSavingPrecomputedData { false };
 
@@ -226,6 +243,13 @@ private:
 
 		virtual SpotsQueryVector &FindSpotsInRadius( const OriginParams &originParams, uint16_t *insideSpotNum ) const;
 
+		/**
+		 * Tries to find a spot that contains the point testing only spots of the point grid cell.
+		 * @return a number of the spot or {@code MAX_SPOTS + 1} if there is no such spot.
+		 * @note this call does not modify the shared spots query vector.
+		 */
+		uint16_t FindSpotContainingPoint( const vec3_t point ) const;
+
 		virtual uint16_t *GetCellSpotsList( unsigned gridCellNum, uint16_t *numCellSpots ) const = 0;
 	};
 
@@ -299,6 +323,8 @@ private:
 	bool TryLoadPrecomputedData( const char *mapname );
 	void SavePrecomputedData( const char *mapname );
 
+	void BuildSpotsSoAData();
+
 	SpotsQueryVector &FindSpotsInRadius( const OriginParams &originParams, uint16_t *insideSpotNum ) const {
 		return spotsGrid.FindSpotsInRadius( originParams, insideSpotNum );
 	}
@@ -335,6 +361,31 @@ public:
 		assert( (unsigned)spotNum < (unsigned)numSpots );
 		return spotsAndAreasTravelTimeTable[2 * ( areaNum * numSpots + spotNum ) + 0];
 	}
+
+	int TravelTimeFromSpotToSpot( int fromSpotNum, int toSpotNum ) const {
+		assert( (unsigned)fromSpotNum < (unsigned)numSpots );
+		assert( (unsigned)toSpotNum < (unsigned)numSpots );
+		return spotsTravelTimeTable[fromSpotNum * numSpots + toSpotNum];
+	}
+
+	const uint32_t *SpotVisBitsRow( int spotNum ) const {
+		assert( (unsigned)spotNum < (unsigned)numSpots );
+		return spotVisBitMatrix + spotNum * spotVisRowWords;
+	}
+
+	bool MayBeSpotsMutuallyVisible( int spotNum1, int spotNum2 ) const {
+		assert( (unsigned)spotNum2 < (unsigned)numSpots );
+		return ( SpotVisBitsRow( spotNum1 )[spotNum2 / 32] >> ( spotNum2 % 32 ) ) & 1u;
+	}
+
+	uint16_t FindSpotContainingPoint( const vec3_t point ) const {
+		return spotsGrid.FindSpotContainingPoint( point );
+	}
+
+	const float *SpotOriginsX() const { return spotsSoAData + 0 * spotsSoAStride; }
+	const float *SpotOriginsY() const { return spotsSoAData + 1 * spotsSoAStride; }
+	const float *SpotOriginsZ() const { return spotsSoAData + 2 * spotsSoAStride; }
+	const float *SpotAbsMinsZ() const { return spotsSoAData + 3 * spotsSoAStride; }
 };
 
 #endif
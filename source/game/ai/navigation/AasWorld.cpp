@@ -5,6 +5,7 @@
 #include "../../../qcommon/wswstaticvector.h"
 #include "../ai_local.h"
 #include "../ai_precomputed_file_handler.h"
+#include "../parallel_for.h"
 #include "../../../qcommon/md5.h"
 #include "../../../qcommon/base64.h"
 
@@ -441,36 +442,28 @@ int AiAasWorld::findTopNodeForSphere( const float *center, float radius ) const
 }
 
 void AiAasWorld::ComputeExtraAreaData() {
-	for( int areaNum = 1; areaNum < numareas; ++areaNum ) {
-		TrySetAreaLedgeFlags( areaNum );
-		TrySetAreaWallFlags( areaNum );
-		TrySetAreaJunkFlags( areaNum );
-		TrySetAreaRampFlags( areaNum );
-	}
-
-	// Call after all other flags have been set
-	TrySetAreaSkipCollisionFlags();
-
-	ComputeLogicalAreaClusters();
-	ComputeFace2DProjVertices();
-	ComputeAreasLeafsLists();
-
 	char strippedNameBuffer[MAX_QPATH];
 	const ArrayRange<char> strippedMapName( StripMapName( trap_GetConfigString( CS_WORLDMODEL ), strippedNameBuffer ) );
 
+	// Flags, clusters and area leaves do not depend of visibility and are cached separately
+	LoadExtraAreaData( strippedMapName );
+
 	// Assumes clusters and area leaves to be already computed
 	LoadAreaVisibility( strippedMapName );
 	// Depends of area visibility
 	LoadFloorClustersVisibility( strippedMapName );
+}
 
-	// These computations expect (are going to expect) that logical clusters are valid
+void AiAasWorld::ComputeExtraAreaFlags() {
 	for( int areaNum = 1; areaNum < numareas; ++areaNum ) {
-		TrySetAreaNoFallFlags( areaNum );
+		TrySetAreaLedgeFlags( areaNum );
+		TrySetAreaWallFlags( areaNum );
+		TrySetAreaJunkFlags( areaNum );
+		TrySetAreaRampFlags( areaNum );
 	}
 
-	BuildSpecificAreaTypesLists();
-
-	computeInnerBoundsForAreas();
+	// Call after all other flags have been set
+	TrySetAreaSkipCollisionFlags();
 }
 
 void AiAasWorld::TrySetAreaLedgeFlags( int areaNum ) {
@@ -2205,6 +2198,224 @@ const char *AiAasWorld::MakeFileName( const ArrayRange<char> &strippedName, cons
 	return buffer;
 }
 
+static constexpr uint32_t EXTRA_AREA_DATA_VERSION = 1339;
+static constexpr const char *EXTRA_AREA_DATA_TAG = "AasExtraAreaData";
+static constexpr const char *EXTRA_AREA_DATA_EXT = ".areaextra";
+
+void AiAasWorld::LoadExtraAreaData( const ArrayRange<char> &strippedMapName ) {
+	char filePath[MAX_QPATH];
+	MakeFileName( strippedMapName, EXTRA_AREA_DATA_EXT, filePath );
+
+	if( ReadExtraAreaData( filePath ) ) {
+		return;
+	}
+
+	G_Printf( "About to compute AAS extra area data...\n" );
+
+	ComputeExtraAreaFlags();
+
+	ComputeLogicalAreaClusters();
+	ComputeFace2DProjVertices();
+	ComputeAreasLeafsLists();
+
+	// These computations expect (are going to expect) that logical clusters are valid
+	for( int areaNum = 1; areaNum < numareas; ++areaNum ) {
+		TrySetAreaNoFallFlags( areaNum );
+	}
+
+	BuildSpecificAreaTypesLists();
+
+	computeInnerBoundsForAreas();
+
+	WriteExtraAreaData( filePath );
+}
+
+/**
+ * Returns a size in bytes of a joint data of lists (each one is prepended by the length) addressed by offsets.
+ * Relies on the last list being the last one in the data.
+ */
+template <typename T>
+static inline uint32_t JointListsDataSize( const int *offsets, int numOffsets, const T *data ) {
+	const int lastOffset = offsets[numOffsets - 1];
+	return (uint32_t)( ( lastOffset + data[lastOffset] + 1 ) * sizeof( T ) );
+}
+
+static inline uint32_t AreasListDataSize( const uint16_t *list ) {
+	return (uint32_t)( ( list[0] + 1 ) * sizeof( uint16_t ) );
+}
+
+enum ExtraAreaDataChunk {
+	EXTRA_AREA_FLAGS,
+	EXTRA_AREA_FLOOR_CLUSTER_NUMS,
+	EXTRA_AREA_STAIRS_CLUSTER_NUMS,
+	EXTRA_FLOOR_CLUSTER_OFFSETS,
+	EXTRA_FLOOR_CLUSTER_DATA,
+	EXTRA_STAIRS_CLUSTER_OFFSETS,
+	EXTRA_STAIRS_CLUSTER_DATA,
+	EXTRA_FACE_2D_PROJ_VERTICES,
+	EXTRA_AREA_LEAFS_OFFSETS,
+	EXTRA_AREA_LEAFS_DATA,
+	EXTRA_GROUNDED_PRINCIPAL_AREAS,
+	EXTRA_JUMPPAD_PASS_THROUGH_AREAS,
+	EXTRA_LADDER_PASS_THROUGH_AREAS,
+	EXTRA_ELEVATOR_PASS_THROUGH_AREAS,
+	EXTRA_WALK_OFF_LEDGE_AIR_AREAS,
+	EXTRA_AREA_INNER_BOUNDS,
+	NUM_EXTRA_AREA_DATA_CHUNKS
+};
+
+bool AiAasWorld::ReadExtraAreaData( const char *filePath ) {
+	AiPrecomputedFileReader reader( va( "%sReader", EXTRA_AREA_DATA_TAG ), EXTRA_AREA_DATA_VERSION );
+	if( reader.BeginReading( filePath ) != AiPrecomputedFileReader::SUCCESS ) {
+		return false;
+	}
+
+	uint8_t *chunks[NUM_EXTRA_AREA_DATA_CHUNKS];
+	uint32_t lengths[NUM_EXTRA_AREA_DATA_CHUNKS];
+	int numChunksRead = 0;
+	for(; numChunksRead < NUM_EXTRA_AREA_DATA_CHUNKS; ++numChunksRead ) {
+		if( !reader.ReadLengthAndData( &chunks[numChunksRead], &lengths[numChunksRead] ) ) {
+			break;
+		}
+		// Make sure the data could be safely dereferenced during validation
+		if( !lengths[numChunksRead] ) {
+			Q_free( chunks[numChunksRead] );
+			break;
+		}
+	}
+
+	bool isValid = false;
+	if( numChunksRead == NUM_EXTRA_AREA_DATA_CHUNKS ) {
+		const auto areasInts = (uint32_t)( numareas * sizeof( int ) );
+		const auto areasShorts = (uint32_t)( numareas * sizeof( uint16_t ) );
+		const uint32_t floorOffsetsLen = lengths[EXTRA_FLOOR_CLUSTER_OFFSETS];
+		const uint32_t stairsOffsetsLen = lengths[EXTRA_STAIRS_CLUSTER_OFFSETS];
+		isValid = lengths[EXTRA_AREA_FLAGS] == areasInts &&
+			lengths[EXTRA_AREA_FLOOR_CLUSTER_NUMS] == areasShorts &&
+			lengths[EXTRA_AREA_STAIRS_CLUSTER_NUMS] == areasShorts &&
+			!( floorOffsetsLen % sizeof( int ) ) && !( stairsOffsetsLen % sizeof( int ) ) &&
+			lengths[EXTRA_FACE_2D_PROJ_VERTICES] == (uint32_t)( 2 * numfaces * sizeof( int ) ) &&
+			lengths[EXTRA_AREA_LEAFS_OFFSETS] == areasInts &&
+			lengths[EXTRA_AREA_INNER_BOUNDS] == (uint32_t)( 6 * numareas * sizeof( int16_t ) );
+		for( int i = EXTRA_GROUNDED_PRINCIPAL_AREAS; isValid && i <= EXTRA_WALK_OFF_LEDGE_AIR_AREAS; ++i ) {
+			isValid = lengths[i] % sizeof( uint16_t ) == 0 && lengths[i] == AreasListDataSize( (uint16_t *)chunks[i] );
+		}
+		// Check joint lists data sizes (this also ensures the last offsets are within the data)
+		if( isValid ) {
+			const auto *floorOffsets = (const int *)chunks[EXTRA_FLOOR_CLUSTER_OFFSETS];
+			const auto *stairsOffsets = (const int *)chunks[EXTRA_STAIRS_CLUSTER_OFFSETS];
+			const auto *leafsOffsets = (const int *)chunks[EXTRA_AREA_LEAFS_OFFSETS];
+			const uint32_t floorDataLen = lengths[EXTRA_FLOOR_CLUSTER_DATA];
+			const uint32_t stairsDataLen = lengths[EXTRA_STAIRS_CLUSTER_DATA];
+			const uint32_t leafsDataLen = lengths[EXTRA_AREA_LEAFS_DATA];
+			const int numFloorOffsets = (int)( floorOffsetsLen / sizeof( int ) );
+			const int numStairsOffsets = (int)( stairsOffsetsLen / sizeof( int ) );
+			isValid = (uint32_t)floorOffsets[numFloorOffsets - 1] < floorDataLen / sizeof( uint16_t ) &&
+				(uint32_t)stairsOffsets[numStairsOffsets - 1] < stairsDataLen / sizeof( uint16_t ) &&
+				(uint32_t)leafsOffsets[numareas - 1] < leafsDataLen / sizeof( int );
+			if( isValid ) {
+				const auto *floorData = (const uint16_t *)chunks[EXTRA_FLOOR_CLUSTER_DATA];
+				const auto *stairsData = (const uint16_t *)chunks[EXTRA_STAIRS_CLUSTER_DATA];
+				const auto *leafsData = (const int *)chunks[EXTRA_AREA_LEAFS_DATA];
+				isValid = floorDataLen == JointListsDataSize( floorOffsets, numFloorOffsets, floorData ) &&
+					stairsDataLen == JointListsDataSize( stairsOffsets, numStairsOffsets, stairsData ) &&
+					leafsDataLen == JointListsDataSize( leafsOffsets, numareas, leafsData );
+			}
+		}
+	}
+
+	if( !isValid ) {
+		if( numChunksRead == NUM_EXTRA_AREA_DATA_CHUNKS ) {
+			G_Printf( S_COLOR_YELLOW "AiAasWorld::ReadExtraAreaData(): The data in %s is malformed\n", filePath );
+		}
+		for( int i = 0; i < numChunksRead; ++i ) {
+			Q_free( chunks[i] );
+		}
+		return false;
+	}
+
+	const auto *const areaFlags = (const int *)chunks[EXTRA_AREA_FLAGS];
+	for( int i = 0; i < numareas; ++i ) {
+		areasettings[i].areaflags = areaFlags[i];
+	}
+	Q_free( chunks[EXTRA_AREA_FLAGS] );
+
+	areaFloorClusterNums = (uint16_t *)chunks[EXTRA_AREA_FLOOR_CLUSTER_NUMS];
+	areaStairsClusterNums = (uint16_t *)chunks[EXTRA_AREA_STAIRS_CLUSTER_NUMS];
+	numFloorClusters = (int)( lengths[EXTRA_FLOOR_CLUSTER_OFFSETS] / sizeof( int ) );
+	floorClusterDataOffsets = (int *)chunks[EXTRA_FLOOR_CLUSTER_OFFSETS];
+	floorClusterData = (uint16_t *)chunks[EXTRA_FLOOR_CLUSTER_DATA];
+	numStairsClusters = (int)( lengths[EXTRA_STAIRS_CLUSTER_OFFSETS] / sizeof( int ) );
+	stairsClusterDataOffsets = (int *)chunks[EXTRA_STAIRS_CLUSTER_OFFSETS];
+	stairsClusterData = (uint16_t *)chunks[EXTRA_STAIRS_CLUSTER_DATA];
+	face2DProjVertexNums = (int *)chunks[EXTRA_FACE_2D_PROJ_VERTICES];
+	areaMapLeafListOffsets = (int *)chunks[EXTRA_AREA_LEAFS_OFFSETS];
+	areaMapLeafsData = (int *)chunks[EXTRA_AREA_LEAFS_DATA];
+	groundedPrincipalRoutingAreas = (uint16_t *)chunks[EXTRA_GROUNDED_PRINCIPAL_AREAS];
+	jumppadReachPassThroughAreas = (uint16_t *)chunks[EXTRA_JUMPPAD_PASS_THROUGH_AREAS];
+	ladderReachPassThroughAreas = (uint16_t *)chunks[EXTRA_LADDER_PASS_THROUGH_AREAS];
+	elevatorReachPassThroughAreas = (uint16_t *)chunks[EXTRA_ELEVATOR_PASS_THROUGH_AREAS];
+	walkOffLedgePassThroughAirAreas = (uint16_t *)chunks[EXTRA_WALK_OFF_LEDGE_AIR_AREAS];
+	areaInnerBounds = (int16_t *)chunks[EXTRA_AREA_INNER_BOUNDS];
+	return true;
+}
+
+void AiAasWorld::WriteExtraAreaData( const char *filePath ) {
+	AiPrecomputedFileWriter writer( va( "%sWriter", EXTRA_AREA_DATA_TAG ), EXTRA_AREA_DATA_VERSION );
+	if( !writer.BeginWriting( filePath ) ) {
+		return;
+	}
+
+	auto *const areaFlags = (int *)Q_malloc( numareas * sizeof( int ) );
+	for( int i = 0; i < numareas; ++i ) {
+		areaFlags[i] = areasettings[i].areaflags;
+	}
+
+	const uint8_t *chunks[NUM_EXTRA_AREA_DATA_CHUNKS];
+	uint32_t lengths[NUM_EXTRA_AREA_DATA_CHUNKS];
+
+	chunks[EXTRA_AREA_FLAGS] = (const uint8_t *)areaFlags;
+	lengths[EXTRA_AREA_FLAGS] = (uint32_t)( numareas * sizeof( int ) );
+	chunks[EXTRA_AREA_FLOOR_CLUSTER_NUMS] = (const uint8_t *)areaFloorClusterNums;
+	lengths[EXTRA_AREA_FLOOR_CLUSTER_NUMS] = (uint32_t)( numareas * sizeof( uint16_t ) );
+	chunks[EXTRA_AREA_STAIRS_CLUSTER_NUMS] = (const uint8_t *)areaStairsClusterNums;
+	lengths[EXTRA_AREA_STAIRS_CLUSTER_NUMS] = (uint32_t)( numareas * sizeof( uint16_t ) );
+	chunks[EXTRA_FLOOR_CLUSTER_OFFSETS] = (const uint8_t *)floorClusterDataOffsets;
+	lengths[EXTRA_FLOOR_CLUSTER_OFFSETS] = (uint32_t)( numFloorClusters * sizeof( int ) );
+	chunks[EXTRA_FLOOR_CLUSTER_DATA] = (const uint8_t *)floorClusterData;
+	lengths[EXTRA_FLOOR_CLUSTER_DATA] = JointListsDataSize( floorClusterDataOffsets, numFloorClusters, floorClusterData );
+	chunks[EXTRA_STAIRS_CLUSTER_OFFSETS] = (const uint8_t *)stairsClusterDataOffsets;
+	lengths[EXTRA_STAIRS_CLUSTER_OFFSETS] = (uint32_t)( numStairsClusters * sizeof( int ) );
+	chunks[EXTRA_STAIRS_CLUSTER_DATA] = (const uint8_t *)stairsClusterData;
+	lengths[EXTRA_STAIRS_CLUSTER_DATA] = JointListsDataSize( stairsClusterDataOffsets, numStairsClusters, stairsClusterData );
+	chunks[EXTRA_FACE_2D_PROJ_VERTICES] = (const uint8_t *)face2DProjVertexNums;
+	lengths[EXTRA_FACE_2D_PROJ_VERTICES] = (uint32_t)( 2 * numfaces * sizeof( int ) );
+	chunks[EXTRA_AREA_LEAFS_OFFSETS] = (const uint8_t *)areaMapLeafListOffsets;
+	lengths[EXTRA_AREA_LEAFS_OFFSETS] = (uint32_t)( numareas * sizeof( int ) );
+	chunks[EXTRA_AREA_LEAFS_DATA] = (const uint8_t *)areaMapLeafsData;
+	lengths[EXTRA_AREA_LEAFS_DATA] = JointListsDataSize( areaMapLeafListOffsets, numareas, areaMapLeafsData );
+
+	const uint16_t *const areaLists[] = {
+		groundedPrincipalRoutingAreas, jumppadReachPassThroughAreas, ladderReachPassThroughAreas,
+		elevatorReachPassThroughAreas, walkOffLedgePassThroughAirAreas
+	};
+	for( int i = 0; i < 5; ++i ) {
+		chunks[EXTRA_GROUNDED_PRINCIPAL_AREAS + i] = (const uint8_t *)areaLists[i];
+		lengths[EXTRA_GROUNDED_PRINCIPAL_AREAS + i] = AreasListDataSize( areaLists[i] );
+	}
+
+	chunks[EXTRA_AREA_INNER_BOUNDS] = (const uint8_t *)areaInnerBounds;
+	lengths[EXTRA_AREA_INNER_BOUNDS] = (uint32_t)( 6 * numareas * sizeof( int16_t ) );
+
+	for( int i = 0; i < NUM_EXTRA_AREA_DATA_CHUNKS; ++i ) {
+		if( !writer.WriteLengthAndData( chunks[i], lengths[i] ) ) {
+			break;
+		}
+	}
+
+	Q_free( areaFlags );
+}
+
 static constexpr uint32_t FLOOR_CLUSTERS_VIS_VERSION = 1337;
 static const char *FLOOR_CLUSTERS_VIS_TAG = "FloorClustersVis";
 static const char *FLOOR_CLUSTERS_VIS_EXT = ".floorvis";
@@ -2254,22 +2465,26 @@ uint32_t AiAasWorld::ComputeFloorClustersVisibility() {
 	floorClustersVisTable = (bool *)Q_malloc( dataSizeInBytes );
 	memset( floorClustersVisTable, 0, dataSizeInBytes );
 
-	// Start loops from 0 even if we skip the zero cluster for table addressing convenience
-	for( int i = 0; i < stride; ++i ) {
+	// Start loops from 0 even if we skip the zero cluster for table addressing convenience.
+	// Rows are processed in parallel. Every pair of distinct cells is written exactly by a single row task.
+	AiParallelFor( stride, [&]( int i ) {
+		// Each task needs its own buffer as the shared AasElementsMask rows are not reentrant
+		auto *const tmpVisRow = (bool *)Q_malloc( sizeof( bool ) * numareas );
 		floorClustersVisTable[i * stride + i] = true;
 		for( int j = i + 1; j < stride; ++j ) {
 			// We should shift indices to get actual cluster numbers
 			// (we use index 0 for a 1-st valid cluster)
-			bool visible = ComputeVisibilityForClustersPair( i + 1, j + 1 );
+			bool visible = ComputeVisibilityForClustersPair( i + 1, j + 1, tmpVisRow );
 			floorClustersVisTable[i * stride + j] = visible;
 			floorClustersVisTable[j * stride + i] = visible;
 		}
-	}
+		Q_free( tmpVisRow );
+	}, "AiAasWorld::ComputeFloorClustersVisibility()" );
 
 	return dataSizeInBytes;
 }
 
-bool AiAasWorld::ComputeVisibilityForClustersPair( int floorClusterNum1, int floorClusterNum2 ) {
+bool AiAasWorld::ComputeVisibilityForClustersPair( int floorClusterNum1, int floorClusterNum2, bool *tmpVisRow ) const {
 	assert( floorClusterNum1 != floorClusterNum2 );
 
 	const auto *const __restrict areaNums1 = FloorClusterData( floorClusterNum1 ) + 1;
@@ -2292,7 +2507,7 @@ bool AiAasWorld::ComputeVisibilityForClustersPair( int floorClusterNum1, int flo
 			continue;
 		}
 
-		const bool *__restrict visRow = DecompressAreaVis( outerAreaNums[i], AasElementsMask::TmpAreasVisRow() );
+		const bool *__restrict visRow = DecompressAreaVis( outerAreaNums[i], tmpVisRow );
 		// For every area in inner areas check whether it's set in the row
 		for( int j = 0; j < innerAreaNums[-1]; ++j ) {
 			if( visRow[innerAreaNums[j]] ) {
@@ -2422,12 +2637,29 @@ public:
 		Q_free( listSizes );
 	}
 
-	void MarkAsVisible( int area1, int area2 ) {
-		// The caller code is so expensive that we don't care about these scattered writes
+	/**
+	 * Marks the area2 as visible in the row of the area1 only.
+	 * This is safe to call concurrently for different rows.
+	 * {@code Symmetrize()} must be called after all rows have been filled.
+	 */
+	void MarkAsVisibleInRow( int area1, int area2 ) {
 		table[AreaRowOffset( area1 ) * rowSize + AreaRowOffset( area2 )] = true;
-		table[AreaRowOffset( area2 ) * rowSize + AreaRowOffset( area1 )] = true;
-		listSizes[area1]++;
-		listSizes[area2]++;
+	}
+
+	/**
+	 * Mirrors the upper triangle of the table to the lower one and computes list sizes.
+	 */
+	void Symmetrize() {
+		for( int i = 0; i < rowSize; ++i ) {
+			const bool *__restrict srcRow = &table[i * rowSize];
+			for( int j = i + 1; j < rowSize; ++j ) {
+				if( srcRow[j] ) {
+					table[j * rowSize + i] = true;
+					listSizes[AreaForOffset( i )]++;
+					listSizes[AreaForOffset( j )]++;
+				}
+			}
+		}
 	}
 
 	uint32_t ComputeDataSize() const {
@@ -2529,25 +2761,16 @@ void AiAasWorld::ComputeAreasVisibility( uint32_t *offsetsDataSize, uint32_t *li
 	assert( numAreas && numAreas <= std::numeric_limits<uint16_t>::max() );
 	SparseVisTable table( numAreas );
 
-	int numberSoFar = 0;
-	int lastReportedProgress = 0;
-	// Assuming side = numAreas - 1 the number of elements in the upper part is (side - 1) * side / 2
-	const double progressNormalizer = numAreas <= 1 ? 0 : 100.0 / ( ( numAreas - 2 ) * ( numAreas - 1 ) / 2.0 );
-
 	const auto *const __restrict aasAreas = areas;
-	for( int i = 1; i < numAreas; ++i ) {
+	// Rows of the upper triangle are independent and are computed in parallel.
+	// Area leafs lists and PVS are read-only at this stage, and world-only traces are reentrant.
+	AiParallelFor( numAreas - 1, [&]( int rowIndex ) {
+		const int i = rowIndex + 1;
 		for( int j = i + 1; j < numAreas; ++j ) {
-			numberSoFar++;
 			if( !AreAreasInPvs( i, j ) ) {
 				continue;
 			}
 
-			int maybeProgress = (int)( numberSoFar * progressNormalizer );
-			if( maybeProgress != lastReportedProgress ) {
-				G_Printf( "AiAasWorld::ComputeAreasVisibility(): %d%%\n", maybeProgress );
-				lastReportedProgress = maybeProgress;
-			}
-
 			trace_t trace;
 			// TODO: Add and use an optimized version that uses an early exit
 			SolidWorldTrace( &trace, aasAreas[i].center, aasAreas[j].center );
@@ -2555,9 +2778,11 @@ void AiAasWorld::ComputeAreasVisibility( uint32_t *offsetsDataSize, uint32_t *li
 				continue;
 			}
 
-			table.MarkAsVisible( i, j );
+			table.MarkAsVisibleInRow( i, j );
 		}
-	}
+	}, "AiAasWorld::ComputeAreasVisibility()" );
+
+	table.Symmetrize();
 
 	*listsDataSize = table.ComputeDataSize();
 	auto *const __restrict listsData = (uint16_t *)Q_malloc( *listsDataSize );
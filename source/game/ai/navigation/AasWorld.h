@@ -295,8 +295,10 @@ class AiAasWorld
 	void SwapData();
 	void CategorizePlanes();
 
-	// Computes extra Qfusion area flags based on loaded world data
+	// Loads or computes all extra Qfusion area data (flags, clusters, lists and visibility tables)
 	void ComputeExtraAreaData();
+	// Computes extra Qfusion area flags based on loaded world data
+	void ComputeExtraAreaFlags();
 	// Computes extra Qfusion area floor and stairs clusters
 	void ComputeLogicalAreaClusters();
     // Computes vertices of top 2D face projections
@@ -309,6 +311,10 @@ class AiAasWorld
 	static const ArrayRange<char> StripMapName( const char *rawMapName, char buffer[MAX_QPATH] );
 	static const char *MakeFileName( const ArrayRange<char> &strippedName, const char *extension, char buffer[MAX_QPATH] );
 
+	void LoadExtraAreaData( const ArrayRange<char> &strippedMapName );
+	bool ReadExtraAreaData( const char *filePath );
+	void WriteExtraAreaData( const char *filePath );
+
 	void LoadAreaVisibility( const ArrayRange<char> &strippedMapName );
 	void ComputeAreasVisibility( uint32_t *offsetsDataSize, uint32_t *listsDataSize );
 
@@ -316,7 +322,7 @@ class AiAasWorld
 	// Returns the actual data size in bytes
 	uint32_t ComputeFloorClustersVisibility();
 
-	bool ComputeVisibilityForClustersPair( int floorClusterNum1, int floorClusterNum2 );
+	bool ComputeVisibilityForClustersPair( int floorClusterNum1, int floorClusterNum2, bool *tmpVisRow ) const;
 
 	void computeInnerBoundsForAreas();
 
@@ -0,0 +1,77 @@
+#ifndef QFUSION_AI_PARALLEL_FOR_H
+#define QFUSION_AI_PARALLEL_FOR_H
+
+#include "ai_local.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * Runs {@code fn( itemNum )} for every item in [0, numItems) using all available hardware threads.
+ * Items are handed out dynamically so items of unequal cost are balanced well.
+ * The calling thread takes items too and is the only one that prints the progress (if a tag is supplied).
+ * This is intended to be used only for expensive precomputations on a map loading.
+ * @param numItems a number of items to process
+ * @param fn a function that processes a single item. It must be safe to call it concurrently for different items.
+ * @param progressTag a prefix for progress messages, no progress is reported if it's null
+ */
+template <typename Fn>
+void AiParallelFor( int numItems, Fn &&fn, const char *progressTag = nullptr ) {
+	if( numItems <= 0 ) {
+		return;
+	}
+
+	std::atomic<int> nextItem( 0 );
+	std::atomic<int> numItemsDone( 0 );
+
+	auto takeItems = [&]() {
+		for(;; ) {
+			const int itemNum = nextItem.fetch_add( 1, std::memory_order_relaxed );
+			if( itemNum >= numItems ) {
+				return;
+			}
+			fn( itemNum );
+			numItemsDone.fetch_add( 1, std::memory_order_relaxed );
+		}
+	};
+
+	// Leave a core for the calling thread
+	unsigned numWorkers = std::thread::hardware_concurrency();
+	numWorkers = numWorkers > 1 ? numWorkers - 1 : 0;
+	if( numWorkers > 31 ) {
+		numWorkers = 31;
+	}
+	if( numWorkers > (unsigned)numItems - 1 ) {
+		numWorkers = (unsigned)numItems - 1;
+	}
+
+	std::vector<std::thread> workers;
+	workers.reserve( numWorkers );
+	for( unsigned i = 0; i < numWorkers; ++i ) {
+		workers.emplace_back( takeItems );
+	}
+
+	int lastReportedProgress = 0;
+	for(;; ) {
+		const int itemNum = nextItem.fetch_add( 1, std::memory_order_relaxed );
+		if( itemNum >= numItems ) {
+			break;
+		}
+		fn( itemNum );
+		const int numDone = numItemsDone.fetch_add( 1, std::memory_order_relaxed ) + 1;
+		if( progressTag ) {
+			const int progress = (int)( ( 100.0 * numDone ) / numItems );
+			if( progress != lastReportedProgress ) {
+				G_Printf( "%s: %d%%\n", progressTag, progress );
+				lastReportedProgress = progress;
+			}
+		}
+	}
+
+	for( auto &worker: workers ) {
+		worker.join();
+	}
+}
+
+#endif
@@ -1,6 +1,5 @@
 #include "Actions.h"
 #include "../bot.h"
-#include "../ai_ground_trace_cache.h"
 #include "../combat/TacticalSpotsRegistry.h"
 
 BotActionRecord::BotActionRecord( PoolBase *pool_, Bot *self_, const char *name_ )
@@ -1,5 +1,4 @@
 #include "../bot.h"
-#include "../ai_ground_trace_cache.h"
 #include "../teamplay/SquadBasedTeam.h"
 #include "BotPlanner.h"
 #include "PlanningLocal.h"
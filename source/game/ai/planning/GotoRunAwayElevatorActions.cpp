@@ -1,6 +1,6 @@
 #include "PlanningLocal.h"
 #include "../bot.h"
-#include "../ai_ground_trace_cache.h"
+#include "../ai_frame_query_cache.h"
 
 PlannerNode *StartGotoRunAwayElevatorAction::TryApply( const WorldState &worldState ) {
 	if( !CheckCommonRunAwayPreconditions( worldState ) ) {
@@ -62,7 +62,7 @@ AiActionRecord::Status DoRunAwayViaElevatorActionRecord::UpdateStatus( const Wor
 	// We do not want to invalidate an action due to being a bit in air above the platform, don't check self->groundentity
 	trace_t selfTrace;
 	const edict_t *ent = game.edicts + Self()->EntNum();
-	AiGroundTraceCache::Instance()->GetGroundTrace( ent, 64.0f, &selfTrace );
+	AiFrameQueryCache::Instance()->GetGroundTrace( ent, 64.0f, &selfTrace );
 
 	if( selfTrace.fraction == 1.0f ) {
 		Debug( "Bot is too high above the ground (if any)\n" );
@@ -77,7 +77,7 @@ AiActionRecord::Status DoRunAwayViaElevatorActionRecord::UpdateStatus( const Wor
 	const auto &selectedEnemies = Self()->GetSelectedEnemies();
 	if( selectedEnemies.AreValid() ) {
 		trace_t enemyTrace;
-		AiGroundTraceCache::Instance()->GetGroundTrace( selectedEnemies.Ent(), 128.0f, &enemyTrace );
+		AiFrameQueryCache::Instance()->GetGroundTrace( selectedEnemies.Ent(), 128.0f, &enemyTrace );
 		if( enemyTrace.fraction != 1.0f && enemyTrace.ent == selfTrace.ent ) {
 			Debug( "Enemy is on the same platform!\n" );
 			return INVALID;
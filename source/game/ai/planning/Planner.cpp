@@ -3,7 +3,6 @@
 #include "../ai_manager.h"
 #include "../teamplay/BaseTeam.h"
 #include "../ai_base_ai.h"
-#include "../ai_ground_trace_cache.h"
 #include "../navigation/AasWorld.h"
 #include "../../../gameshared/q_collision.h"
 
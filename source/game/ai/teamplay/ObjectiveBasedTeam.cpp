@@ -1,4 +1,4 @@
-#include "../ai_ground_trace_cache.h"
+#include "../ai_frame_query_cache.h"
 #include "ObjectiveBasedTeam.h"
 #include "TeamplayLocal.h"
 #include "../navigation/AasRouteCache.h"
@@ -671,7 +671,7 @@ bool AiObjectiveBasedTeam::DefenceSpot::IsVisibleForDefenders() {
 }
 
 Bot *AiObjectiveBasedTeam::ObjectiveSpotImpl::FindBestByTravelTimeBot() {
-	const int spotAreaNum = AiAasWorld::Instance()->FindAreaNum( underlying->entity );
+	const int spotAreaNum = AiFrameQueryCache::Instance()->FindAreaNum( underlying->entity );
 	int bestTravelTime = std::numeric_limits<int>::max();
 	Bot *bestBot = nullptr;
 	for( Bot *bot = botsListHead; bot; bot = bot->NextInObjective() ) {
@@ -750,7 +750,7 @@ void AiObjectiveBasedTeam::DefenceSpot::UpdateBotsStatus() {
 
 	const auto *aasWorld = AiAasWorld::Instance();
 	const auto *aasFloorClusters = aasWorld->AreaFloorClusterNums();
-	const auto spotFloorClusterNum = aasFloorClusters[aasWorld->FindAreaNum( this->entity )];
+	const auto spotFloorClusterNum = aasFloorClusters[AiFrameQueryCache::Instance()->FindAreaNum( this->entity )];
 	const float *spotOrigin = this->entity->s.origin;
 	for( Bot *bot = botsListHead; bot; bot = bot->NextInObjective() ) {
 		if( bot == alreadyAssignedBot ) {
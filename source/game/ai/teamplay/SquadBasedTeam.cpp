@@ -1,7 +1,7 @@
 #include "SquadBasedTeam.h"
 #include "ObjectiveBasedTeam.h"
 #include "TeamplayLocal.h"
-#include "../ai_ground_trace_cache.h"
+#include "../ai_frame_query_cache.h"
 #include "../bot.h"
 #include "../../../qcommon/links.h"
 
@@ -120,8 +120,9 @@ int ClientToClientTable::FindTravelTime( int fromEntNum, int toEntNum ) const {
 
 int ClientToClientTable::FindEntityAreas( const edict_t *ent, int *areaNums ) const {
 	const auto *aasWorld = AiAasWorld::Instance();
+	auto *const queryCache = AiFrameQueryCache::Instance();
 	int numResultAreas = 0;
-	int areaNum = aasWorld->FindAreaNum( ent );
+	int areaNum = queryCache->FindAreaNum( ent );
 	if( areaNum ) {
 		areaNums[numResultAreas++] = areaNum;
 		// If the first area already has ground
@@ -131,8 +132,8 @@ int ClientToClientTable::FindEntityAreas( const edict_t *ent, int *areaNums ) co
 	}
 
 	vec3_t tmpOrigin;
-	if( AiGroundTraceCache::Instance()->TryDropToFloor( ent, 64.0f, tmpOrigin ) ) {
-		const int droppedAreaNum = aasWorld->FindAreaNum( tmpOrigin );
+	if( AiFrameQueryCache::Instance()->TryDropToFloor( ent, 64.0f, tmpOrigin ) ) {
+		const int droppedAreaNum = queryCache->FindAreaNum( tmpOrigin );
 		if( droppedAreaNum && droppedAreaNum != areaNum ) {
 			areaNums[numResultAreas++] = droppedAreaNum;
 		}
@@ -21,16 +21,25 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "../local.h"
 #include "addon_string.h"
+#include "../../../qcommon/wswpooledstrings.h"
 #include <string>
 #include <algorithm>
 
 #define CONST_STRING_BITFLAG    ( 1 << 31 )
 #define ENABLE_STRING_IMPLICIT_CASTS
 
-static inline asstring_t *objectString_Alloc( void ) {
-	static asstring_t *object;
+// Most of script strings are short-living temporaries of a HUD, scoreboard or message building code.
+// String objects are allocated from a freelist along with a small buffer that is sufficient for these strings.
+static wsw::PooledStrings<asstring_t> stringsPool;
 
-	object = new asstring_t;
+static_assert( wsw::PooledStrings<asstring_t>::kSizeMask == ~(unsigned)CONST_STRING_BITFLAG, "" );
+
+static inline void objectString_FreeBuffer( asstring_t *object ) {
+	stringsPool.freeBuffer( object );
+}
+
+static inline asstring_t *objectString_Alloc( unsigned int size ) {
+	asstring_t *object = stringsPool.allocate( size );
 	object->asRefCount = 1;
 	return object;
 }
@@ -40,17 +49,14 @@ asstring_t *objectString_FactoryBuffer( const char *buffer, unsigned int length
 	unsigned int size = ( length + 1 ) & ~CONST_STRING_BITFLAG;
 
 	length = size - 1;
-	object = objectString_Alloc();
-	object->buffer = new char[size];
-	object->len = length;
-	object->size = size;
+	object = objectString_Alloc( size );
 	if( buffer ) {
 		memcpy( object->buffer, buffer, length );
-		object->buffer[length] = '\0';
+		object->len = length;
 	} else {
 		object->len = 0;
-		object->buffer[0] = '\0';
 	}
+	object->buffer[object->len] = '\0';
 	return object;
 }
 
@@ -76,16 +82,16 @@ asstring_t *objectString_AssignString( asstring_t *self, const char *string, siz
 	unsigned int size;
 
 	if( strlen_ >= self->size ) {
-		delete[] self->buffer;
+		objectString_FreeBuffer( self );
 
 		size = ( strlen_ + 1 ) & ~CONST_STRING_BITFLAG;
-		self->size = size;
-		self->buffer = new char[size];
+		stringsPool.allocateBuffer( self, size );
 		strlen_ = size - 1;
 	}
 
 	self->len = strlen_;
-	memcpy( self->buffer, string, strlen_ );
+	// the string may be a part of the buffer
+	memmove( self->buffer, string, strlen_ );
 	self->buffer[strlen_] = '\0';
 
 	return self;
@@ -103,21 +109,7 @@ static asstring_t *objectString_AssignPattern( asstring_t *self, const char *pat
 }
 
 static asstring_t *objectString_AddAssignString( asstring_t *self, const char *string, size_t strlen_ ) {
-	if( strlen_ ) {
-		char *tem = self->buffer;
-		unsigned int length = strlen_ + self->len;
-		unsigned int size = ( length + 1 ) & ~CONST_STRING_BITFLAG;
-
-		length = size - 1;
-		self->len = length;
-		self->size = size;
-		self->buffer = new char[size];
-
-		Q_snprintfz( self->buffer, size, "%s%s", tem, string );
-
-		delete[] tem;
-	}
-
+	stringsPool.append( self, string, strlen_ );
 	return self;
 }
 
@@ -134,9 +126,13 @@ static asstring_t *objectString_AddAssignPattern( asstring_t *self, const char *
 
 static asstring_t *objectString_AddString( asstring_t *first, const char *second, size_t seclen ) {
 	asstring_t *self = objectString_FactoryBuffer( NULL, first->len + seclen );
+	unsigned int firstlen = std::min( first->len, self->size - 1 );
 
-	Q_snprintfz( self->buffer, self->size, "%s%s", first->buffer, second );
-	self->len = self->size - 1;
+	memcpy( self->buffer, first->buffer, firstlen );
+	seclen = std::min( (unsigned int)seclen, self->size - 1 - firstlen );
+	memcpy( self->buffer + firstlen, second, seclen );
+	self->len = firstlen + seclen;
+	self->buffer[self->len] = '\0';
 	return self;
 }
 
@@ -185,8 +181,7 @@ void objectString_Release( asstring_t *obj ) {
 
 	if( !obj->asRefCount ) {
 		if( ( obj->size & CONST_STRING_BITFLAG ) == 0 ) {
-			delete[] obj->buffer;
-			delete obj;
+			stringsPool.deallocate( obj );
 		} else {
 			uint8_t *rawmem = ( uint8_t * )obj;
 			delete[] rawmem;
@@ -35,10 +35,15 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "../../qcommon/qcommon.h"
 #include "../../qcommon/wswstringsplitter.h"
 #include "../../qcommon/wswstaticstring.h"
+#include "../../qcommon/md5.h"
 
 #define QAS_SECTIONS_SEPARATOR ';'
 #define QAS_FILE_EXTENSION     ".as"
 //
+#define QAS_BYTECODE_CACHE_DIRECTORY "cache/scripts"
+#define QAS_BYTECODE_CACHE_EXTENSION ".asbc"
+#define QAS_BYTECODE_CACHE_VERSION   1
+//
 #define QAS_MemAlloc( pool, size ) ::calloc( size, 1 )
 #define QAS_MemFree( mem ) ::free( mem )
 //
@@ -52,6 +57,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #define QAS_DELETEARRAY( ptr ) QAS_Free( ptr )
 
 #include <list>
+#include <vector>
 
 static void *qasAlloc( size_t size ) {
 	return QAS_Malloc( size );
@@ -175,7 +181,7 @@ void qasReleaseEngine( asIScriptEngine *engine ) {
 	engine->Release();
 }
 
-static asIScriptContext *qasCreateContext( asIScriptEngine *engine ) {
+static asIScriptContext *qasNewContext( asIScriptEngine *engine ) {
 	asIScriptContext *ctx;
 	int error;
 
@@ -201,12 +207,31 @@ static asIScriptContext *qasCreateContext( asIScriptEngine *engine ) {
 		return NULL;
 	}
 
+	return ctx;
+}
+
+static asIScriptContext *qasCreateContext( asIScriptEngine *engine ) {
+	asIScriptContext *ctx = qasNewContext( engine );
+	if( !ctx ) {
+		return NULL;
+	}
+
 	qasContextList &ctxList = contexts[engine];
 	ctxList.push_back( ctx );
 
 	return ctx;
 }
 
+/*
+* qasCreateDedicatedContext
+*
+* Creates a context that is never shared via qasAcquireContext().
+* The context must be released by qasReleaseContext() before the engine is released.
+*/
+asIScriptContext *qasCreateDedicatedContext( asIScriptEngine *engine ) {
+	return qasNewContext( engine );
+}
+
 void qasReleaseContext( asIScriptContext *ctx ) {
 	if( !ctx ) {
 		return;
@@ -282,6 +307,192 @@ static char *qasLoadScriptSection( const char *rootDir, const char *dir, const w
 	return (char *)data;
 }
 
+/*************************************
+* Bytecode cache
+**************************************/
+
+/*
+* qasFileBinaryStream
+*
+* A binary stream backed by an open file of the engine filesystem
+*/
+class qasFileBinaryStream : public asIBinaryStream {
+	int filenum;
+	bool failed { false };
+public:
+	explicit qasFileBinaryStream( int filenum_ ) : filenum( filenum_ ) {}
+
+	void Read( void *ptr, asUINT size ) override {
+		if( failed || FS_Read( ptr, size, filenum ) != (int)size ) {
+			// Make sure a partially read data never looks valid
+			memset( ptr, 0, size );
+			failed = true;
+		}
+	}
+
+	void Write( const void *ptr, asUINT size ) override {
+		if( !failed && FS_Write( ptr, size, filenum ) != (int)size ) {
+			failed = true;
+		}
+	}
+
+	bool Failed() const { return failed; }
+};
+
+typedef struct {
+	char magic[4];
+	int version;
+	md5_byte_t digest[16];
+} qasBytecodeHeader_t;
+
+static void qasHashString( md5_state_t *state, const char *string ) {
+	// Include the terminating zero to separate adjacent strings
+	md5_append( state, (const md5_byte_t *)( string ? string : "" ), string ? (int)strlen( string ) + 1 : 1 );
+}
+
+static void qasHashInt( md5_state_t *state, int value ) {
+	md5_append( state, (const md5_byte_t *)&value, sizeof( value ) );
+}
+
+static void qasHashFunction( md5_state_t *state, const asIScriptFunction *func ) {
+	qasHashString( state, func ? func->GetDeclaration( true, true, true ) : "" );
+}
+
+/*
+* qasHashEngineRegistrations
+*
+* Bytecode refers to registered application types and functions by their declarations
+* so the bytecode has to be invalidated if anything gets registered differently.
+*/
+static void qasHashEngineRegistrations( md5_state_t *state, asIScriptEngine *engine ) {
+	qasHashString( state, ANGELSCRIPT_VERSION_STRING );
+	qasHashString( state, asGetLibraryOptions() );
+
+	for( asUINT i = 0, numTypes = engine->GetObjectTypeCount(); i < numTypes; i++ ) {
+		asIObjectType *type = engine->GetObjectTypeByIndex( i );
+		qasHashString( state, type->GetNamespace() );
+		qasHashString( state, type->GetName() );
+		qasHashInt( state, type->GetSize() );
+		qasHashInt( state, (int)type->GetFlags() );
+		for( asUINT j = 0, numFactories = type->GetFactoryCount(); j < numFactories; j++ ) {
+			qasHashFunction( state, type->GetFactoryByIndex( j ) );
+		}
+		for( asUINT j = 0, numBehaviours = type->GetBehaviourCount(); j < numBehaviours; j++ ) {
+			asEBehaviours behaviour;
+			asIScriptFunction *func = type->GetBehaviourByIndex( j, &behaviour );
+			qasHashInt( state, (int)behaviour );
+			qasHashFunction( state, func );
+		}
+		for( asUINT j = 0, numMethods = type->GetMethodCount(); j < numMethods; j++ ) {
+			qasHashFunction( state, type->GetMethodByIndex( j ) );
+		}
+		for( asUINT j = 0, numProps = type->GetPropertyCount(); j < numProps; j++ ) {
+			qasHashString( state, type->GetPropertyDeclaration( j, true ) );
+		}
+	}
+
+	for( asUINT i = 0, numFuncs = engine->GetGlobalFunctionCount(); i < numFuncs; i++ ) {
+		qasHashFunction( state, engine->GetGlobalFunctionByIndex( i ) );
+	}
+
+	for( asUINT i = 0, numProps = engine->GetGlobalPropertyCount(); i < numProps; i++ ) {
+		const char *name, *nameSpace;
+		int typeId;
+		bool isConst;
+		engine->GetGlobalPropertyByIndex( i, &name, &nameSpace, &typeId, &isConst );
+		qasHashString( state, nameSpace );
+		qasHashString( state, name );
+		qasHashString( state, engine->GetTypeDeclaration( typeId, true ) );
+		qasHashInt( state, isConst ? 1 : 0 );
+	}
+
+	for( asUINT i = 0, numEnums = engine->GetEnumCount(); i < numEnums; i++ ) {
+		const char *nameSpace;
+		int typeId;
+		qasHashString( state, engine->GetEnumByIndex( i, &typeId, &nameSpace ) );
+		qasHashString( state, nameSpace );
+		for( int j = 0, numValues = engine->GetEnumValueCount( typeId ); j < numValues; j++ ) {
+			int value;
+			qasHashString( state, engine->GetEnumValueByIndex( typeId, j, &value ) );
+			qasHashInt( state, value );
+		}
+	}
+
+	for( asUINT i = 0, numFuncdefs = engine->GetFuncdefCount(); i < numFuncdefs; i++ ) {
+		qasHashFunction( state, engine->GetFuncdefByIndex( i ) );
+	}
+
+	for( asUINT i = 0, numTypedefs = engine->GetTypedefCount(); i < numTypedefs; i++ ) {
+		const char *nameSpace;
+		int typeId;
+		qasHashString( state, engine->GetTypedefByIndex( i, &typeId, &nameSpace ) );
+		qasHashString( state, nameSpace );
+		qasHashString( state, engine->GetTypeDeclaration( typeId, true ) );
+	}
+}
+
+/*
+* qasBytecodeCachePath
+*/
+static void qasBytecodeCachePath( const char *scriptName, char *path, size_t pathSize ) {
+	Q_snprintfz( path, pathSize, "%s/%s%s", QAS_BYTECODE_CACHE_DIRECTORY, scriptName, QAS_BYTECODE_CACHE_EXTENSION );
+	Q_strlwr( path );
+}
+
+/*
+* qasLoadCachedBytecode
+*/
+static bool qasLoadCachedBytecode( asIScriptModule *asModule, const char *cachePath, const md5_byte_t *digest ) {
+	int filenum;
+	if( FS_FOpenFile( cachePath, &filenum, FS_READ | FS_CACHE ) == -1 ) {
+		return false;
+	}
+
+	qasBytecodeHeader_t header;
+	if( FS_Read( &header, sizeof( header ), filenum ) != (int)sizeof( header ) ||
+		memcmp( header.magic, "QASB", 4 ) || header.version != QAS_BYTECODE_CACHE_VERSION ||
+		memcmp( header.digest, digest, sizeof( header.digest ) ) ) {
+		FS_FCloseFile( filenum );
+		return false;
+	}
+
+	qasFileBinaryStream stream( filenum );
+	const int error = asModule->LoadByteCode( &stream );
+	FS_FCloseFile( filenum );
+	return !error && !stream.Failed();
+}
+
+/*
+* qasSaveCachedBytecode
+*/
+static void qasSaveCachedBytecode( asIScriptModule *asModule, const char *cachePath, const md5_byte_t *digest ) {
+	// write to a temporary file first so a reader never sees a partially written cache
+	char tempPath[MAX_QPATH + 4];
+	Q_snprintfz( tempPath, sizeof( tempPath ), "%s.tmp", cachePath );
+
+	int filenum;
+	if( FS_FOpenFile( tempPath, &filenum, FS_WRITE | FS_CACHE ) == -1 ) {
+		Com_Printf( S_COLOR_YELLOW "* Couldn't open '%s' for writing\n", tempPath );
+		return;
+	}
+
+	qasBytecodeHeader_t header;
+	memcpy( header.magic, "QASB", 4 );
+	header.version = QAS_BYTECODE_CACHE_VERSION;
+	memcpy( header.digest, digest, sizeof( header.digest ) );
+
+	qasFileBinaryStream stream( filenum );
+	stream.Write( &header, sizeof( header ) );
+	// Keep the debug info so script exceptions still report sections and lines
+	const int error = asModule->SaveByteCode( &stream, false );
+	FS_FCloseFile( filenum );
+
+	// a broken temporary file is just going to be overwritten next time
+	if( error || stream.Failed() || !FS_MoveCacheFile( tempPath, cachePath ) ) {
+		Com_Printf( S_COLOR_YELLOW "* Couldn't save the bytecode to '%s'\n", cachePath );
+	}
+}
+
 /*
 * qasBuildScriptProject
 */
@@ -305,13 +516,19 @@ static asIScriptModule *qasBuildScriptProject( asIScriptEngine *asEngine, const
 
 	// load up the script sections
 
-	asIScriptModule *asModule = asEngine->GetModule( moduleName, asGM_CREATE_IF_NOT_EXISTS );
-	if( asModule == NULL ) {
-		Com_Printf( S_COLOR_RED "qasBuildGameScript: GetModule '%s' failed\n", moduleName );
-		return NULL;
-	}
+	std::vector<std::pair<wsw::StaticString<MAX_QPATH>, char *>> sections;
+	auto freeSections = [&]() {
+		for( auto &nameAndSection: sections ) {
+			qasFree( nameAndSection.second );
+		}
+	};
+
+	// the bytecode is valid only for the same sources and the same application interface
+	md5_state_t md5;
+	md5_init( &md5 );
+	qasHashEngineRegistrations( &md5, asEngine );
+	qasHashString( &md5, moduleName );
 
-	int error;
 	wsw::StringSplitter splitter( scriptView );
 	while( const auto maybeSectionName = splitter.getNext( QAS_SECTIONS_SEPARATOR ) ) {
 		wsw::StringView trimmedName( maybeSectionName->trim() );
@@ -319,20 +536,56 @@ static asIScriptModule *qasBuildScriptProject( asIScriptEngine *asEngine, const
 			continue;
 		}
 
-		const wsw::StaticString<MAX_QPATH> nameBuffer( trimmedName );
-
 		char *section = qasLoadScriptSection( rootDir, dir, trimmedName );
-		error = asModule->AddScriptSection( nameBuffer.data(), section, strlen( section ) );
+		if( !section ) {
+			Com_Printf( S_COLOR_RED "* Failed to load the script section %s\n", wsw::StaticString<MAX_QPATH>( trimmedName ).data() );
+			freeSections();
+			return NULL;
+		}
+
+		sections.emplace_back( std::make_pair( wsw::StaticString<MAX_QPATH>( trimmedName ), section ) );
+		qasHashString( &md5, sections.back().first.data() );
+		qasHashString( &md5, section );
+	}
+
+	md5_byte_t digest[16];
+	md5_finish( &md5, digest );
 
-		qasFree( section );
+	asIScriptModule *asModule = asEngine->GetModule( moduleName, asGM_ALWAYS_CREATE );
+	if( asModule == NULL ) {
+		Com_Printf( S_COLOR_RED "qasBuildGameScript: GetModule '%s' failed\n", moduleName );
+		freeSections();
+		return NULL;
+	}
+
+	char cachePath[MAX_QPATH];
+	qasBytecodeCachePath( scriptName, cachePath, sizeof( cachePath ) );
+
+	const cvar_t *bytecodeCache = Cvar_Get( "as_bytecodeCache", "1", CVAR_ARCHIVE );
+	if( bytecodeCache->integer ) {
+		if( qasLoadCachedBytecode( asModule, cachePath, digest ) ) {
+			Com_Printf( "* Loaded cached bytecode '%s'\n", cachePath );
+			freeSections();
+			return asModule;
+		}
 
+		// the module could have been partially loaded
+		asModule = asEngine->GetModule( moduleName, asGM_ALWAYS_CREATE );
+	}
+
+	int error;
+	for( const auto &[name, section]: sections ) {
+		error = asModule->AddScriptSection( name.data(), section, strlen( section ) );
 		if( error ) {
-			Com_Printf( S_COLOR_RED "* Failed to add the script section %s with error %i\n", nameBuffer.data(), error );
+			Com_Printf( S_COLOR_RED "* Failed to add the script section %s with error %i\n", name.data(), error );
 			asEngine->DiscardModule( moduleName );
+			freeSections();
 			return NULL;
 		}
 	}
 
+	freeSections();
+
 	error = asModule->Build();
 	if( error ) {
 		Com_Printf( S_COLOR_RED "* Failed to build script '%s'\n", scriptName );
@@ -340,6 +593,10 @@ static asIScriptModule *qasBuildScriptProject( asIScriptEngine *asEngine, const
 		return NULL;
 	}
 
+	if( bytecodeCache->integer ) {
+		qasSaveCachedBytecode( asModule, cachePath, digest );
+	}
+
 	return asModule;
 }
 
@@ -115,6 +115,7 @@ public:
 /******* C++ objects *******/
 asIScriptEngine *qasCreateEngine( bool *asMaxPortability );
 asIScriptContext *qasAcquireContext( asIScriptEngine *engine );
+asIScriptContext *qasCreateDedicatedContext( asIScriptEngine *engine );
 void qasReleaseContext( asIScriptContext *ctx );
 void qasReleaseEngine( asIScriptEngine *engine );
 asIScriptContext *qasGetActiveContext( void );
@@ -58,6 +58,8 @@ void GT_asShutdownScript( void ) {
 
 	GT_ResetScriptData();
 
+	G_asUnprepareCallSites();
+
 	GAME_AS_ENGINE()->DiscardModule( GAMETYPE_SCRIPTS_MODULE_NAME );
 }
 
@@ -77,7 +79,7 @@ void GT_asCallSpawn( void ) {
 		return;
 	}
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, NULL );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -99,7 +101,7 @@ void GT_asCallMatchStateStarted( void ) {
 		return;
 	}
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, NULL );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -125,7 +127,7 @@ bool GT_asCallMatchStateFinished( int incomingMatchState ) {
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgDWord( 0, incomingMatchState );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, NULL );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -145,14 +147,12 @@ void GT_asCallThinkRules( void ) {
 		return;
 	}
 
-	ctx = qasAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.thinkRulesFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallSite( AS_CALLSITE_GT_THINKRULES, static_cast<asIScriptFunction *>( level.gametype.thinkRulesFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, NULL );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -167,10 +167,8 @@ void GT_asCallPlayerRespawn( edict_t *ent, int old_team, int new_team ) {
 		return;
 	}
 
-	ctx = qasAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.playerRespawnFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallSite( AS_CALLSITE_GT_PLAYERRESPAWN, static_cast<asIScriptFunction *>( level.gametype.playerRespawnFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
@@ -179,7 +177,7 @@ void GT_asCallPlayerRespawn( edict_t *ent, int old_team, int new_team ) {
 	ctx->SetArgDWord( 1, old_team );
 	ctx->SetArgDWord( 2, new_team );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, ent );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -203,10 +201,8 @@ void GT_asCallScoreEvent( gclient_t *client, const char *score_event, const char
 		args = "";
 	}
 
-	ctx = qasAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.scoreEventFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallSite( AS_CALLSITE_GT_SCOREEVENT, static_cast<asIScriptFunction *>( level.gametype.scoreEventFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
@@ -218,7 +214,7 @@ void GT_asCallScoreEvent( gclient_t *client, const char *score_event, const char
 	ctx->SetArgObject( 1, s1 );
 	ctx->SetArgObject( 2, s2 );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, NULL );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -240,17 +236,15 @@ void GT_asCallScoreboardMessage( unsigned int maxlen ) {
 		return;
 	}
 
-	ctx = qasAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.scoreboardMessageFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallSite( AS_CALLSITE_GT_SCOREBOARDMESSAGE, static_cast<asIScriptFunction *>( level.gametype.scoreboardMessageFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgDWord( 0, maxlen );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, NULL );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -273,17 +267,15 @@ edict_t *GT_asCallSelectSpawnPoint( edict_t *ent ) {
 		return SelectDeathmatchSpawnPoint( ent ); // should have a hardcoded backup
 
 	}
-	ctx = qasAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.selectSpawnPointFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallSite( AS_CALLSITE_GT_SELECTSPAWNPOINT, static_cast<asIScriptFunction *>( level.gametype.selectSpawnPointFunc ) );
+	if( !ctx ) {
 		return SelectDeathmatchSpawnPoint( ent );
 	}
 
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgObject( 0, ent );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, ent );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -312,10 +304,8 @@ bool GT_asCallGameCommand( gclient_t *client, const char *cmd, const char *args,
 		return false;
 	}
 
-	ctx = qasAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( level.gametype.clientCommandFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallSite( AS_CALLSITE_GT_GAMECOMMAND, static_cast<asIScriptFunction *>( level.gametype.clientCommandFunc ) );
+	if( !ctx ) {
 		return false;
 	}
 
@@ -328,7 +318,7 @@ bool GT_asCallGameCommand( gclient_t *client, const char *cmd, const char *args,
 	ctx->SetArgObject( 2, s2 );
 	ctx->SetArgDWord( 3, argc );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, NULL );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -356,7 +346,7 @@ void GT_asCallShutdown( void ) {
 		return;
 	}
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, NULL );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -496,7 +486,7 @@ static bool G_asInitializeGametypeScript( asIScriptModule *asModule ) {
 		return false;
 	}
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, NULL );
 	if( G_ExecutionErrorReport( error ) ) {
 		return false;
 	}
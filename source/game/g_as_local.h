@@ -38,6 +38,35 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 asIScriptModule *G_LoadGameScript( const char *moduleName, const char *dir, const char *filename, const char *ext );
 bool G_ExecutionErrorReport( int error );
 
+// Script callbacks that are called regularly.
+// Every call site uses its own context that skips most of the preparation work if it gets prepared for the same function.
+typedef enum {
+	AS_CALLSITE_ENTITY_SPAWN,
+	AS_CALLSITE_ENTITY_THINK,
+	AS_CALLSITE_ENTITY_TOUCH,
+	AS_CALLSITE_ENTITY_USE,
+	AS_CALLSITE_ENTITY_PAIN,
+	AS_CALLSITE_ENTITY_DIE,
+	AS_CALLSITE_ENTITY_STOP,
+	AS_CALLSITE_GT_THINKRULES,
+	AS_CALLSITE_GT_PLAYERRESPAWN,
+	AS_CALLSITE_GT_SCOREEVENT,
+	AS_CALLSITE_GT_SCOREBOARDMESSAGE,
+	AS_CALLSITE_GT_SELECTSPAWNPOINT,
+	AS_CALLSITE_GT_GAMECOMMAND,
+	AS_CALLSITE_MAP_FUNCTION,
+
+	AS_NUM_CALLSITES
+} asCallSite_t;
+
+asIScriptContext *G_asPrepareCallSite( asCallSite_t callSite, asIScriptFunction *func );
+void G_asUnprepareCallSites( void );
+void G_asReleaseCallSites( void );
+
+// Executes a prepared context attributing the execution time to the function and the entity (if any) if profiling is enabled
+int G_asExecute( asIScriptContext *ctx, const edict_t *ent );
+void G_asProfilerDetachFunctions( void );
+
 typedef struct asEnumVal_s {
 	const char * name;
 	int value;
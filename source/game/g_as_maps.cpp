@@ -88,14 +88,12 @@ static void G_asCallMapFunction( void *func ) {
 		return;
 	}
 
-	ctx = qasAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( func ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallSite( AS_CALLSITE_MAP_FUNCTION, static_cast<asIScriptFunction *>( func ) );
+	if( !ctx ) {
 		return;
 	}
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, NULL );
 	if( G_ExecutionErrorReport( error ) ) {
 		G_asShutdownMapScript();
 	}
@@ -154,7 +152,7 @@ const char *G_asCallMapGametype( void ) {
 
 	ctx->SetArgObject( 0, s );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, NULL );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -217,5 +215,7 @@ void G_asShutdownMapScript( void ) {
 
 	G_ResetMapScriptData();
 
+	G_asUnprepareCallSites();
+
 	GAME_AS_ENGINE()->DiscardModule( MAP_SCRIPTS_MODULE_NAME );
 }
@@ -0,0 +1,233 @@
+#include "g_local.h"
+#include "g_as_local.h"
+
+#include <algorithm>
+#include <chrono>
+
+/**
+ * Accumulates execution times of script callbacks grouped by a function and an entity classname.
+ * Self times exclude nested script calls (e.g. a use callback triggered by a think one)
+ * so the sum of self times is the total time spent in scripts.
+ */
+class ScriptProfiler {
+	struct Entry {
+		const asIScriptFunction *func;
+		Entry *nextInBin;
+		uint64_t numCalls;
+		uint64_t totalMicros;
+		uint64_t selfMicros;
+		uint64_t maxMicros;
+		unsigned binIndex;
+		char classname[MAX_QPATH];
+		char decl[MAX_STRING_CHARS / 4];
+	};
+
+	static constexpr unsigned MAX_ENTRIES = 1024;
+	static constexpr unsigned NUM_BINS = 509;
+	static constexpr unsigned MAX_DEPTH = 32;
+
+	Entry entries[MAX_ENTRIES];
+	Entry *bins[NUM_BINS];
+	unsigned numEntries { 0 };
+
+	uint64_t childMicros[MAX_DEPTH];
+	unsigned depth { 0 };
+
+	int64_t startedAt { 0 };
+
+	static unsigned BinIndexFor( const asIScriptFunction *func, const char *classname );
+
+	void Link( Entry *entry, unsigned binIndex ) {
+		entry->binIndex = binIndex;
+		entry->nextInBin = bins[binIndex];
+		bins[binIndex] = entry;
+	}
+
+	void Unlink( Entry *entry );
+
+	Entry *FindOrAdd( const asIScriptFunction *func, const char *classname );
+public:
+	ScriptProfiler() { Reset(); }
+
+	void Reset() {
+		std::fill( std::begin( bins ), std::end( bins ), nullptr );
+		numEntries = 0;
+		// Game imports are not available yet if called on the module loading
+		startedAt = 0;
+	}
+
+	void DetachFunctions();
+
+	int Execute( asIScriptContext *ctx, const edict_t *ent );
+
+	void Dump( unsigned maxEntries );
+};
+
+static ScriptProfiler scriptProfiler;
+
+unsigned ScriptProfiler::BinIndexFor( const asIScriptFunction *func, const char *classname ) {
+	uint32_t hash = (uint32_t)( (uintptr_t)func >> 4 );
+	for( const char *s = classname; *s; ++s ) {
+		hash = ( hash ^ (uint8_t)*s ) * 16777619u;
+	}
+	return hash % NUM_BINS;
+}
+
+void ScriptProfiler::Unlink( Entry *entry ) {
+	for( Entry **link = &bins[entry->binIndex]; *link; link = &( *link )->nextInBin ) {
+		if( *link == entry ) {
+			*link = entry->nextInBin;
+			return;
+		}
+	}
+}
+
+/**
+ * Script functions get released on a script reload and their addresses may be reused by other functions.
+ * Entries keep their stats but get rebound to new functions with the same declaration on next calls.
+ */
+void ScriptProfiler::DetachFunctions() {
+	for( unsigned i = 0; i < numEntries; ++i ) {
+		if( entries[i].func ) {
+			Unlink( &entries[i] );
+			entries[i].func = nullptr;
+		}
+	}
+}
+
+ScriptProfiler::Entry *ScriptProfiler::FindOrAdd( const asIScriptFunction *func, const char *classname ) {
+	const unsigned binIndex = BinIndexFor( func, classname );
+	for( Entry *entry = bins[binIndex]; entry; entry = entry->nextInBin ) {
+		if( entry->func == func && !strcmp( entry->classname, classname ) ) {
+			return entry;
+		}
+	}
+
+	// This is a first call of the function for this classname since the script has been loaded
+	const char *decl = func->GetDeclaration( true, true, false );
+	for( unsigned i = 0; i < numEntries; ++i ) {
+		Entry *entry = &entries[i];
+		if( !entry->func && !strcmp( entry->classname, classname ) && !strcmp( entry->decl, decl ) ) {
+			entry->func = func;
+			Link( entry, binIndex );
+			return entry;
+		}
+	}
+
+	if( numEntries == MAX_ENTRIES ) {
+		return nullptr;
+	}
+
+	Entry *entry = &entries[numEntries++];
+	entry->func = func;
+	entry->numCalls = entry->totalMicros = entry->selfMicros = entry->maxMicros = 0;
+	Q_strncpyz( entry->classname, classname, sizeof( entry->classname ) );
+	Q_strncpyz( entry->decl, decl, sizeof( entry->decl ) );
+	Link( entry, binIndex );
+	return entry;
+}
+
+int ScriptProfiler::Execute( asIScriptContext *ctx, const edict_t *ent ) {
+	if( depth == MAX_DEPTH ) {
+		return ctx->Execute();
+	}
+
+	if( !startedAt ) {
+		startedAt = trap_Milliseconds();
+	}
+
+	// The function has to be retrieved before the execution while it's the only one on the context stack
+	const asIScriptFunction *func = ctx->GetFunction();
+	const char *classname = ( ent && ent->classname ) ? ent->classname : "";
+
+	childMicros[depth++] = 0;
+	const auto startTime = std::chrono::steady_clock::now();
+	const int error = ctx->Execute();
+	const auto endTime = std::chrono::steady_clock::now();
+	depth--;
+
+	const auto micros = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>( endTime - startTime ).count();
+	if( depth ) {
+		childMicros[depth - 1] += micros;
+	}
+
+	if( func ) {
+		if( Entry *entry = FindOrAdd( func, classname ) ) {
+			entry->numCalls++;
+			entry->totalMicros += micros;
+			entry->selfMicros += micros - std::min( micros, childMicros[depth] );
+			entry->maxMicros = std::max( entry->maxMicros, micros );
+		}
+	}
+
+	return error;
+}
+
+void ScriptProfiler::Dump( unsigned maxEntries ) {
+	Entry *sorted[MAX_ENTRIES];
+	uint64_t totalSelfMicros = 0;
+	for( unsigned i = 0; i < numEntries; ++i ) {
+		sorted[i] = &entries[i];
+		totalSelfMicros += entries[i].selfMicros;
+	}
+
+	std::sort( sorted, sorted + numEntries, []( const Entry *lhs, const Entry *rhs ) {
+		return lhs->selfMicros > rhs->selfMicros;
+	});
+
+	const int64_t millisElapsed = startedAt ? std::max( (int64_t)1, trap_Milliseconds() - startedAt ) : 1;
+	G_Printf( "Script time: %.1f ms of %.1f s (%.2f%%)\n", 0.001 * totalSelfMicros,
+			  0.001 * millisElapsed, 0.1 * (double)totalSelfMicros / (double)millisElapsed );
+	G_Printf( "%8s %10s %10s %8s %8s %-24s %s\n", "calls", "self ms", "total ms", "avg us", "max us", "classname", "function" );
+
+	for( unsigned i = 0, end = std::min( maxEntries, numEntries ); i < end; ++i ) {
+		const Entry *entry = sorted[i];
+		G_Printf( "%8" PRIu64 " %10.2f %10.2f %8.1f %8" PRIu64 " %-24s %s\n", entry->numCalls,
+				  0.001 * entry->selfMicros, 0.001 * entry->totalMicros,
+				  (double)entry->totalMicros / (double)std::max( (uint64_t)1, entry->numCalls ),
+				  entry->maxMicros, entry->classname[0] ? entry->classname : "-", entry->decl );
+	}
+}
+
+/*
+* G_asExecute
+*/
+int G_asExecute( asIScriptContext *ctx, const edict_t *ent ) {
+	if( !g_asProfile->integer ) {
+		return ctx->Execute();
+	}
+	return scriptProfiler.Execute( ctx, ent );
+}
+
+/*
+* G_asProfilerDetachFunctions
+*
+* Should be called when scripts are released
+*/
+void G_asProfilerDetachFunctions( void ) {
+	scriptProfiler.DetachFunctions();
+}
+
+/*
+* G_asProfile_f
+*/
+void G_asProfile_f( void ) {
+	const char *arg = trap_Cmd_Argv( 1 );
+	if( !Q_stricmp( arg, "reset" ) ) {
+		scriptProfiler.Reset();
+		G_Printf( "Script profile has been reset\n" );
+		return;
+	}
+
+	if( !g_asProfile->integer ) {
+		G_Printf( "Script profiling is disabled. Set g_asProfile 1 to enable it\n" );
+	}
+
+	const int maxEntries = *arg ? atoi( arg ) : 20;
+	if( maxEntries <= 0 ) {
+		G_Printf( "Usage: asprofile [<number of top entries>|reset]\n" );
+		return;
+	}
+
+	scriptProfiler.Dump( (unsigned)maxEntries );
+}
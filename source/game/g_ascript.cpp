@@ -1978,6 +1978,22 @@ static void objectGameEntity_SetVelocity( asvec3_t *vel, edict_t *self ) {
 	}
 }
 
+static int objectGameEntity_GetMoveType( edict_t *obj ) {
+	return obj->movetype;
+}
+
+static void objectGameEntity_SetMoveType( int movetype, edict_t *self ) {
+	self->movetype = movetype;
+}
+
+static int64_t objectGameEntity_GetNextThink( edict_t *obj ) {
+	return obj->nextThink;
+}
+
+static void objectGameEntity_SetNextThink( int64_t nextThink, edict_t *self ) {
+	self->nextThink = nextThink;
+}
+
 static asvec3_t objectGameEntity_GetAVelocity( edict_t *obj ) {
 	asvec3_t avelocity;
 
@@ -2307,6 +2323,10 @@ static const asMethod_t gedict_Methods[] =
 	{ ASLIB_FUNCTION_DECL( void, set_velocity, ( const Vec3 &in ) ), asFUNCTION( objectGameEntity_SetVelocity ), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL( Vec3, get_avelocity, ( ) const ), asFUNCTION( objectGameEntity_GetAVelocity ), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL( void, set_avelocity, ( const Vec3 &in ) ), asFUNCTION( objectGameEntity_SetAVelocity ), asCALL_CDECL_OBJLAST },
+	{ ASLIB_FUNCTION_DECL( int, get_moveType, ( ) const ), asFUNCTION( objectGameEntity_GetMoveType ), asCALL_CDECL_OBJLAST },
+	{ ASLIB_FUNCTION_DECL( void, set_moveType, ( int moveType ) ), asFUNCTION( objectGameEntity_SetMoveType ), asCALL_CDECL_OBJLAST },
+	{ ASLIB_FUNCTION_DECL( int64, get_nextThink, ( ) const ), asFUNCTION( objectGameEntity_GetNextThink ), asCALL_CDECL_OBJLAST },
+	{ ASLIB_FUNCTION_DECL( void, set_nextThink, ( int64 nextThink ) ), asFUNCTION( objectGameEntity_SetNextThink ), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL( Vec3, get_origin, ( ) const ), asFUNCTION( objectGameEntity_GetOrigin ), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL( void, set_origin, ( const Vec3 &in ) ), asFUNCTION( objectGameEntity_SetOrigin ), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL( Vec3, get_origin2, ( ) const ), asFUNCTION( objectGameEntity_GetOrigin2 ), asCALL_CDECL_OBJLAST },
@@ -2382,8 +2402,6 @@ static const asProperty_t gedict_Properties[] =
 	{ ASLIB_PROPERTY_DECL( int, clipMask ), ASLIB_FOFFSET( edict_t, r.clipmask ) },
 	{ ASLIB_PROPERTY_DECL( int, spawnFlags ), ASLIB_FOFFSET( edict_t, spawnflags ) },
 	{ ASLIB_PROPERTY_DECL( int, style ), ASLIB_FOFFSET( edict_t, style ) },
-	{ ASLIB_PROPERTY_DECL( int, moveType ), ASLIB_FOFFSET( edict_t, movetype ) },
-	{ ASLIB_PROPERTY_DECL( int64, nextThink ), ASLIB_FOFFSET( edict_t, nextThink ) },
 	{ ASLIB_PROPERTY_DECL( float, health ), ASLIB_FOFFSET( edict_t, health ) },
 	{ ASLIB_PROPERTY_DECL( int, maxHealth ), ASLIB_FOFFSET( edict_t, max_health ) },
 	{ ASLIB_PROPERTY_DECL( int, viewHeight ), ASLIB_FOFFSET( edict_t, viewheight ) },
@@ -3328,16 +3346,15 @@ bool G_asCallMapEntitySpawnScript( const char *classname, edict_t *ent ) {
 	G_asClearEntityBehaviors( ent );
 
 	// call the spawn function
-	asContext = qasAcquireContext( asEngine );
-	error = asContext->Prepare( asSpawnFunc );
-	if( error < 0 ) {
+	asContext = G_asPrepareCallSite( AS_CALLSITE_ENTITY_SPAWN, asSpawnFunc );
+	if( !asContext ) {
 		return false;
 	}
 
 	// Now we need to pass the parameters to the script function.
 	asContext->SetArgObject( 0, ent );
 
-	error = asContext->Execute();
+	error = G_asExecute( asContext, ent );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 		ent->asScriptModule = NULL;
@@ -3414,17 +3431,15 @@ void G_asCallMapEntityThink( edict_t *ent ) {
 		return;
 	}
 
-	ctx = qasAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( ent->asThinkFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallSite( AS_CALLSITE_ENTITY_THINK, static_cast<asIScriptFunction *>( ent->asThinkFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgObject( 0, ent );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, ent );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -3440,10 +3455,8 @@ void G_asCallMapEntityTouch( edict_t *ent, edict_t *other, cplane_t *plane, int
 		return;
 	}
 
-	ctx = qasAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( ent->asTouchFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallSite( AS_CALLSITE_ENTITY_TOUCH, static_cast<asIScriptFunction *>( ent->asTouchFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
@@ -3459,7 +3472,7 @@ void G_asCallMapEntityTouch( edict_t *ent, edict_t *other, cplane_t *plane, int
 	ctx->SetArgObject( 2, &normal );
 	ctx->SetArgDWord( 3, surfFlags );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, ent );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -3474,10 +3487,8 @@ void G_asCallMapEntityUse( edict_t *ent, edict_t *other, edict_t *activator ) {
 		return;
 	}
 
-	ctx = qasAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( ent->asUseFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallSite( AS_CALLSITE_ENTITY_USE, static_cast<asIScriptFunction *>( ent->asUseFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
@@ -3486,7 +3497,7 @@ void G_asCallMapEntityUse( edict_t *ent, edict_t *other, edict_t *activator ) {
 	ctx->SetArgObject( 1, other );
 	ctx->SetArgObject( 2, activator );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, ent );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -3501,10 +3512,8 @@ void G_asCallMapEntityPain( edict_t *ent, edict_t *other, float kick, float dama
 		return;
 	}
 
-	ctx = qasAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( ent->asPainFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallSite( AS_CALLSITE_ENTITY_PAIN, static_cast<asIScriptFunction *>( ent->asPainFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
@@ -3514,7 +3523,7 @@ void G_asCallMapEntityPain( edict_t *ent, edict_t *other, float kick, float dama
 	ctx->SetArgFloat( 2, kick );
 	ctx->SetArgFloat( 3, damage );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, ent );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -3529,10 +3538,8 @@ void G_asCallMapEntityDie( edict_t *ent, edict_t *inflicter, edict_t *attacker,
 		return;
 	}
 
-	ctx = qasAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( ent->asDieFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallSite( AS_CALLSITE_ENTITY_DIE, static_cast<asIScriptFunction *>( ent->asDieFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
@@ -3541,7 +3548,7 @@ void G_asCallMapEntityDie( edict_t *ent, edict_t *inflicter, edict_t *attacker,
 	ctx->SetArgObject( 1, inflicter );
 	ctx->SetArgObject( 2, attacker );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, ent );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -3556,17 +3563,15 @@ void G_asCallMapEntityStop( edict_t *ent ) {
 		return;
 	}
 
-	ctx = qasAcquireContext( GAME_AS_ENGINE() );
-
-	error = ctx->Prepare( static_cast<asIScriptFunction *>( ent->asStopFunc ) );
-	if( error < 0 ) {
+	ctx = G_asPrepareCallSite( AS_CALLSITE_ENTITY_STOP, static_cast<asIScriptFunction *>( ent->asStopFunc ) );
+	if( !ctx ) {
 		return;
 	}
 
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgObject( 0, ent );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx, ent );
 	if( G_ExecutionErrorReport( error ) ) {
 		GT_asShutdownScript();
 	}
@@ -3574,6 +3579,64 @@ void G_asCallMapEntityStop( edict_t *ent ) {
 
 // ======================================================================================
 
+static asIScriptContext *asCallSiteContexts[AS_NUM_CALLSITES];
+
+/*
+* G_asPrepareCallSite
+*
+* Gets the context of the call site prepared for the function.
+* Returns NULL if the context can't be prepared.
+*/
+asIScriptContext *G_asPrepareCallSite( asCallSite_t callSite, asIScriptFunction *func ) {
+	asIScriptContext *ctx = asCallSiteContexts[callSite];
+
+	if( !ctx ) {
+		ctx = asCallSiteContexts[callSite] = qasCreateDedicatedContext( GAME_AS_ENGINE() );
+	}
+
+	// a callback may lead to a call of the same kind (e.g. a use of an entity uses its targets),
+	// fall back to a shared context if the dedicated one is busy
+	if( !ctx || ctx->GetState() == asEXECUTION_ACTIVE || ctx->GetState() == asEXECUTION_SUSPENDED ) {
+		ctx = qasAcquireContext( GAME_AS_ENGINE() );
+		if( !ctx ) {
+			return NULL;
+		}
+	}
+
+	if( ctx->Prepare( func ) < 0 ) {
+		return NULL;
+	}
+
+	return ctx;
+}
+
+/*
+* G_asUnprepareCallSites
+*
+* Releases references to functions of the scripts that are going to be discarded
+*/
+void G_asUnprepareCallSites( void ) {
+	for( asIScriptContext *ctx: asCallSiteContexts ) {
+		if( ctx && ctx->GetState() != asEXECUTION_ACTIVE && ctx->GetState() != asEXECUTION_SUSPENDED ) {
+			ctx->Unprepare();
+		}
+	}
+
+	G_asProfilerDetachFunctions();
+}
+
+/*
+* G_asReleaseCallSites
+*/
+void G_asReleaseCallSites( void ) {
+	for( asIScriptContext *&ctx: asCallSiteContexts ) {
+		qasReleaseContext( ctx );
+		ctx = NULL;
+	}
+
+	G_asProfilerDetachFunctions();
+}
+
 /*
 * G_ExecutionErrorReport
 */
@@ -3670,6 +3733,7 @@ void G_asInitGameModuleEngine( void ) {
 */
 void G_asShutdownGameModuleEngine( void ) {
 	if( game.asEngine != NULL ) {
+		G_asReleaseCallSites();
 		qasReleaseEngine( static_cast<asIScriptEngine *>( game.asEngine ) );
 		G_ResetGameModuleScriptData();
 	}
@@ -18,6 +18,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 */
 #include "g_local.h"
+#include "../qcommon/wswsweepandprune.h"
+#include "../qcommon/wswaabbtree.h"
 
 //
 // g_clip.c - entity contact detection. (high level object sorting to reduce interaction tests)
@@ -58,6 +60,15 @@ typedef struct
 
 static areagrid_t g_areagrid;
 
+// An alternative broadphase backend that keeps compact entity bounds sorted along X
+static wsw::SweepAndPrune<MAX_EDICTS> g_sweepAndPrune;
+
+// Triggers that have not moved since the level has been spawned are kept in a tree that is built once.
+// Other triggers are kept in a separate broadphase index, so touch queries never check non-trigger entities.
+static wsw::AabbTree<MAX_EDICTS> g_staticTriggers;
+static vec3_t g_staticTriggerBounds[MAX_EDICTS][2];
+static wsw::SweepAndPrune<MAX_EDICTS> g_dynamicTriggers;
+
 extern cvar_t *g_antilag;
 extern cvar_t *g_antilag_maxtimedelta;
 
@@ -467,6 +478,109 @@ static int GClip_EntitiesInBox_AreaGrid( areagrid_t *areagrid, const vec3_t mins
 }
 
 
+/*
+* GClip_EntitiesInBox_SweepAndPrune
+*
+* Tests current entity bounds, so it should not be used for antilag queries
+*/
+static int GClip_EntitiesInBox_SweepAndPrune( const vec3_t mins, const vec3_t maxs, int *list, int maxcount, int areatype ) {
+	int numlist = 0;
+
+	g_sweepAndPrune.query( mins, maxs, [&]( unsigned entNum ) {
+		const edict_t *ent = game.edicts + entNum;
+		if( !ent->r.inuse ) {
+			return; // deactivated
+		}
+		if( areatype == AREA_TRIGGERS && ent->r.solid != SOLID_TRIGGER ) {
+			return;
+		}
+		if( areatype == AREA_SOLID && ( ent->r.solid == SOLID_TRIGGER || ent->r.solid == SOLID_NOT ) ) {
+			return;
+		}
+
+		// Bounds could have been modified since the entity has been linked
+		if( BoundsIntersect( mins, maxs, ent->r.absmin, ent->r.absmax ) ) {
+			if( numlist < maxcount ) {
+				list[numlist] = (int)entNum;
+			}
+			numlist++;
+		}
+	});
+
+	return numlist;
+}
+
+/*
+* GClip_LinkTrigger
+*
+* A static trigger that gets relinked at the same place (e.g. a respawned item) stays in the static tree
+*/
+static void GClip_LinkTrigger( edict_t *ent ) {
+	const int entNum = ENTNUM( ent );
+	if( ent->r.solid != SOLID_TRIGGER ) {
+		return;
+	}
+
+	if( g_staticTriggers.contains( entNum ) ) {
+		const vec3_t *bounds = g_staticTriggerBounds[entNum];
+		if( VectorCompare( bounds[0], ent->r.absmin ) && VectorCompare( bounds[1], ent->r.absmax ) ) {
+			g_staticTriggers.enable( entNum );
+			return;
+		}
+	}
+
+	g_dynamicTriggers.link( entNum, ent->r.absmin, ent->r.absmax );
+}
+
+/*
+* GClip_BuildStaticTriggers
+*
+* Should be called once map entities have been spawned
+*/
+void GClip_BuildStaticTriggers( void ) {
+	g_staticTriggers.clear();
+	for( int i = gs.maxclients + 1; i < game.numentities; i++ ) {
+		edict_t *ent = game.edicts + i;
+		if( !ent->r.inuse || !ent->linked || ent->r.solid != SOLID_TRIGGER || ent->movetype != MOVETYPE_NONE ) {
+			continue;
+		}
+		g_staticTriggers.add( i, ent->r.absmin, ent->r.absmax );
+		VectorCopy( ent->r.absmin, g_staticTriggerBounds[i][0] );
+		VectorCopy( ent->r.absmax, g_staticTriggerBounds[i][1] );
+		g_dynamicTriggers.unlink( i );
+	}
+	g_staticTriggers.build();
+}
+
+/*
+* GClip_TriggersInBox
+*
+* Returns triggers which bounds intersect the given box in the ascending order of their numbers
+*/
+static int GClip_TriggersInBox( const vec3_t mins, const vec3_t maxs, int *list, int maxcount ) {
+	if( !g_clip_broadphase->integer ) {
+		return GClip_AreaEdicts( mins, maxs, list, maxcount, AREA_TRIGGERS, 0 );
+	}
+
+	int numlist = 0;
+	auto addTrigger = [&]( unsigned entNum ) {
+		const edict_t *ent = game.edicts + entNum;
+		if( !ent->r.inuse || ent->r.solid != SOLID_TRIGGER ) {
+			return;
+		}
+		if( BoundsIntersect( mins, maxs, ent->r.absmin, ent->r.absmax ) && numlist < maxcount ) {
+			list[numlist++] = (int)entNum;
+		}
+	};
+
+	g_staticTriggers.query( mins, maxs, addTrigger );
+	g_dynamicTriggers.query( mins, maxs, addTrigger );
+
+	// Keep the order of touches independent of the order of items in the trees
+	std::sort( list, list + numlist );
+	return numlist;
+}
+
 /*
 * GClip_ClearWorld
 * called after the world model has been loaded, before linking any entities
@@ -479,6 +593,9 @@ void GClip_ClearWorld( void ) {
 	trap_CM_InlineModelBounds( world_model, world_mins, world_maxs );
 
 	GClip_Init_AreaGrid( &g_areagrid, world_mins, world_maxs );
+	g_sweepAndPrune.clear();
+	g_staticTriggers.clear();
+	g_dynamicTriggers.clear();
 }
 
 /*
@@ -491,6 +608,9 @@ void GClip_UnlinkEntity( edict_t *ent ) {
 		return; // not linked in anywhere
 	}
 	GClip_UnlinkEntity_AreaGrid( ent );
+	g_sweepAndPrune.unlink( ENTNUM( ent ) );
+	g_staticTriggers.disable( ENTNUM( ent ) );
+	g_dynamicTriggers.unlink( ENTNUM( ent ) );
 	ent->linked = false;
 }
 
@@ -645,6 +765,8 @@ void GClip_LinkEntity( edict_t *ent ) {
 	ent->linked = true;
 
 	GClip_LinkEntity_AreaGrid( &g_areagrid, ent );
+	g_sweepAndPrune.link( ENTNUM( ent ), ent->r.absmin, ent->r.absmax );
+	GClip_LinkTrigger( ent );
 }
 
 /*
@@ -678,8 +800,13 @@ int GClip_AreaEdicts( const vec3_t mins, const vec3_t maxs,
 					  int *list, int maxcount, int areatype, int timeDelta ) {
 	int count;
 
-	count = GClip_EntitiesInBox_AreaGrid( &g_areagrid, mins, maxs,
-										  list, maxcount, areatype, timeDelta );
+	// The area grid tests bounds of entities in the past for antilag queries
+	if( g_clip_broadphase->integer && !( timeDelta < 0 && g_antilag->integer ) ) {
+		count = GClip_EntitiesInBox_SweepAndPrune( mins, maxs, list, maxcount, areatype );
+	} else {
+		count = GClip_EntitiesInBox_AreaGrid( &g_areagrid, mins, maxs,
+											  list, maxcount, areatype, timeDelta );
+	}
 
 	return std::min( count, maxcount );
 }
@@ -889,9 +1016,12 @@ static void GClip_TraceBounds( const vec3_t start, const vec3_t mins, const vec3
 * to an open area
 
 * passedict is explicitly excluded from clipping checks (normally NULL)
+
+* worldTrace is a precomputed trace against the world with the same parameters (normally NULL)
 */
 static void GClip_Trace( trace_t *tr, const vec3_t start, const vec3_t mins, const vec3_t maxs,
-						 const vec3_t end, const edict_t *passedict, int contentmask, int timeDelta ) {
+						 const vec3_t end, const edict_t *passedict, int contentmask, int timeDelta,
+						 const trace_t *worldTrace = nullptr ) {
 	moveclip_t clip;
 
 	if( !tr ) {
@@ -911,7 +1041,11 @@ static void GClip_Trace( trace_t *tr, const vec3_t start, const vec3_t mins, con
 		tr->ent = -1;
 	} else {
 		// clip to world
-		trap_CM_TransformedBoxTrace( tr, start, end, mins, maxs, NULL, contentmask, NULL, NULL );
+		if( worldTrace ) {
+			*tr = *worldTrace;
+		} else {
+			trap_CM_TransformedBoxTrace( tr, start, end, mins, maxs, NULL, contentmask, NULL, NULL );
+		}
 		tr->ent = tr->fraction < 1.0 ? world->s.number : -1;
 		if( tr->fraction == 0 ) {
 			return; // blocked by the world
@@ -947,6 +1081,11 @@ void G_Trace4D( trace_t *tr, const vec3_t start, const vec3_t mins, const vec3_t
 	GClip_Trace( tr, start, mins, maxs, end, passedict, contentmask, timeDelta );
 }
 
+void G_Trace4DWithWorldTrace( trace_t *tr, const trace_t *worldTrace, const vec3_t start, const vec3_t mins, const vec3_t maxs,
+							  const vec3_t end, const edict_t *passedict, int contentmask, int timeDelta ) {
+	GClip_Trace( tr, start, mins, maxs, end, passedict, contentmask, timeDelta, worldTrace );
+}
+
 //===========================================================================
 
 
@@ -1040,7 +1179,7 @@ void GClip_TouchTriggers( edict_t *ent ) {
 	VectorAdd( ent->s.origin, ent->r.maxs, maxs );
 
 	// FIXME: should be s.origin + mins and s.origin + maxs because of absmin and absmax padding?
-	num = GClip_AreaEdicts( ent->r.absmin, ent->r.absmax, touch, MAX_EDICTS, AREA_TRIGGERS, 0 );
+	num = GClip_TriggersInBox( ent->r.absmin, ent->r.absmax, touch, MAX_EDICTS );
 
 	// be careful, it is possible to have an entity in this
 	// list removed before we get to it (killtriggered)
@@ -1118,7 +1257,7 @@ void G_PMoveTouchTriggers( pmove_t *pm, const vec3_t previous_origin ) {
 		}
 	}
 
-	num = GClip_AreaEdicts( mins, maxs, touch, MAX_EDICTS, AREA_TRIGGERS, 0 );
+	num = GClip_TriggersInBox( mins, maxs, touch, MAX_EDICTS );
 
 	// be careful, it is possible to have an entity in this
 	// list removed before we get to it (killtriggered)
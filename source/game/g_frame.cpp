@@ -614,13 +614,22 @@ static void G_UpdateFrameTime( unsigned int msec ) {
 
 /*
 * G_RunEntities
-* treat each object in turn
+* treat each object that thinks or moves in turn (see g_scheduler.cpp)
 * even the world and clients get a chance to think
 */
 static void G_RunEntities( void ) {
 	edict_t *ent;
 
-	for( ent = &game.edicts[0]; ENTNUM( ent ) < game.numentities; ent++ ) {
+	if( !level.canSpawnEntities ) { // don't try to think before map entities are spawned
+		return;
+	}
+
+	G_Scheduler_AdvanceTime( level.time );
+
+	// Trace projectiles against the world in parallel, impacts are applied when entities are run
+	G_PhysSweeps_Prepare();
+
+	for( ent = G_Scheduler_NextActiveEntity( NULL ); ent; ent = G_Scheduler_NextActiveEntity( ent ) ) {
 		if( !ent->r.inuse ) {
 			continue;
 		}
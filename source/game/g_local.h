@@ -368,6 +368,8 @@ extern cvar_t *g_deadbody_followkiller;
 extern cvar_t *g_deadbody_autogib_delay;
 extern cvar_t *g_antilag_timenudge;
 extern cvar_t *g_antilag_maxtimedelta;
+extern cvar_t *g_clip_broadphase;
+extern cvar_t *g_phys_parallel;
 
 extern cvar_t *g_teams_maxplayers;
 extern cvar_t *g_teams_allow_uneven;
@@ -381,6 +383,7 @@ extern cvar_t *g_instashield;
 
 extern cvar_t *g_asGC_stats;
 extern cvar_t *g_asGC_interval;
+extern cvar_t *g_asProfile;
 
 extern cvar_t *g_skillRating;
 
@@ -519,6 +522,7 @@ void G_asInitGameModuleEngine( void );
 void G_asShutdownGameModuleEngine( void );
 void G_asGarbageCollect( bool force );
 void G_asDumpAPI_f( void );
+void G_asProfile_f( void );
 
 #define world   ( (edict_t *)game.edicts )
 
@@ -801,11 +805,13 @@ int G_PointContents( const vec3_t p );
 void G_Trace( trace_t *tr, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, const edict_t *passedict, int contentmask );
 int G_PointContents4D( const vec3_t p, int timeDelta );
 void G_Trace4D( trace_t *tr, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, const edict_t *passedict, int contentmask, int timeDelta );
+void G_Trace4DWithWorldTrace( trace_t *tr, const trace_t *worldTrace, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, const edict_t *passedict, int contentmask, int timeDelta );
 void GClip_BackUpCollisionFrame( void );
 int GClip_FindInRadius4D( const vec3_t org, float rad, int *list, int maxcount, int timeDelta );
 void G_SplashFrac( int entNum, const vec3_t hitpoint, float maxradius, vec3_t pushdir, float *kickFrac, float *dmgFrac );
 void RS_SplashFrac( int entNum, const vec3_t hitpoint, float maxradius, vec3_t pushdir, float *kickFrac, float *dmgFrac, float splashFrac ); // racesow
 void GClip_ClearWorld( void );
+void GClip_BuildStaticTriggers( void );
 void GClip_SetBrushModel( edict_t *ent, const char *name );
 void GClip_SetAreaPortalState( edict_t *ent, bool open );
 void GClip_LinkEntity( edict_t *ent );
@@ -998,10 +1004,27 @@ void G_ScoreboardMessage_AddSpectators( void );
 void G_ScoreboardMessage_AddChasers( int entnum, int entnum_self );
 void G_UpdateScoreBoardMessages( void );
 
+//
+// g_scheduler.cpp
+//
+void G_Scheduler_Reset( void );
+void G_Scheduler_UnlinkEdict( const edict_t *ent );
+void G_Scheduler_AdvanceTime( int64_t time );
+edict_t *G_Scheduler_NextActiveEntity( const edict_t *after );
+edict_t *G_Scheduler_NextMover( const edict_t *after );
+
+//
+// g_phys_sweeps.cpp
+//
+void G_PhysSweeps_Prepare( void );
+const trace_t *G_PhysSweeps_Find( const edict_t *ent, const vec3_t start, const vec3_t end, int mask );
+void G_PhysSweeps_Shutdown( void );
+
 //
 // g_phys.c
 //
 void SV_Impact( edict_t *e1, trace_t *trace );
+void SV_LinearProjectileSegment( const edict_t *ent, int lookAheadTime, vec3_t start, vec3_t end );
 void G_RunEntity( edict_t *ent );
 int G_BoxSlideMove( edict_t *ent, int contentmask, float slideBounce, float friction );
 
@@ -1877,6 +1900,48 @@ typedef struct {
 	int frequency;
 } particles_edict_t;
 
+class EdictNextThink;
+class EdictMoveType;
+
+void G_Scheduler_OnNextThinkChanged( const EdictNextThink *field );
+void G_Scheduler_OnMoveTypeChanged( const EdictMoveType *field );
+
+/**
+ * A think time of an edict that notifies the entities scheduler on every assignment of a value (see g_scheduler.cpp).
+ * The owner edict is derived from the field address, so copies outside of game.edicts are not tracked.
+ * The type is kept trivially copyable so edicts may be cleared by memset(),
+ * an edict must be unlinked by {@code G_Scheduler_UnlinkEdict()} before that.
+ */
+class EdictNextThink {
+	int64_t value;
+public:
+	operator int64_t() const { return value; }
+
+	EdictNextThink &operator=( int64_t newValue ) {
+		value = newValue;
+		G_Scheduler_OnNextThinkChanged( this );
+		return *this;
+	}
+
+	EdictNextThink &operator+=( int64_t delta ) { return *this = value + delta; }
+};
+
+/**
+ * A movetype of an edict that notifies the entities scheduler on every assignment of a value (see g_scheduler.cpp).
+ * The type is kept trivially copyable for the same reasons as {@code EdictNextThink}.
+ */
+class EdictMoveType {
+	int value;
+public:
+	operator int() const { return value; }
+
+	EdictMoveType &operator=( int newValue ) {
+		value = newValue;
+		G_Scheduler_OnMoveTypeChanged( this );
+		return *this;
+	}
+};
+
 struct edict_s {
 	entity_state_t s;
 	entity_shared_t r;
@@ -1893,7 +1958,7 @@ struct edict_s {
 
 	entity_state_t olds; // state in the last sent frame snap
 
-	int movetype;
+	EdictMoveType movetype;
 	int flags;
 
 	const char *model;
@@ -1911,7 +1976,7 @@ struct edict_s {
 	const char *spawnString;            // keep track of string definition of this entity
 	int spawnflags;
 
-	int64_t nextThink;
+	EdictNextThink nextThink;
 
 	void ( *think )( edict_t *self );
 	void ( *touch )( edict_t *self, edict_t *other, cplane_t *plane, int surfFlags );
@@ -71,6 +71,8 @@ cvar_t *g_maxtimeouts;
 cvar_t *g_antilag;
 cvar_t *g_antilag_maxtimedelta;
 cvar_t *g_antilag_timenudge;
+cvar_t *g_clip_broadphase;
+cvar_t *g_phys_parallel;
 cvar_t *g_autorecord;
 cvar_t *g_autorecord_maxdemos;
 
@@ -104,6 +106,7 @@ cvar_t *g_allow_spectator_voting;
 
 cvar_t *g_asGC_stats;
 cvar_t *g_asGC_interval;
+cvar_t *g_asProfile;
 
 cvar_t *g_skillRating;
 
@@ -283,6 +286,8 @@ void G_Init( unsigned int seed, unsigned int framemsec, int protocol, const char
 	g_antilag_maxtimedelta->modified = true;
 	g_antilag_timenudge = trap_Cvar_Get( "g_antilag_timenudge", "0", CVAR_ARCHIVE );
 	g_antilag_timenudge->modified = true;
+	g_clip_broadphase = trap_Cvar_Get( "g_clip_broadphase", "1", CVAR_ARCHIVE );
+	g_phys_parallel = trap_Cvar_Get( "g_phys_parallel", "1", CVAR_ARCHIVE );
 
 	g_allow_spectator_voting = trap_Cvar_Get( "g_allow_spectator_voting", "1", CVAR_ARCHIVE );
 
@@ -332,6 +337,7 @@ void G_Init( unsigned int seed, unsigned int framemsec, int protocol, const char
 
 	g_asGC_stats = trap_Cvar_Get( "g_asGC_stats", "0", CVAR_ARCHIVE );
 	g_asGC_interval = trap_Cvar_Get( "g_asGC_interval", "10", CVAR_ARCHIVE );
+	g_asProfile = trap_Cvar_Get( "g_asProfile", "0", 0 );
 
 	g_skillRating = trap_Cvar_Get( "sv_skillRating", va( "%.0f", MM_RATING_DEFAULT ), CVAR_SERVERINFO | CVAR_READONLY );
 	// trap_Cvar_ForceSet( "sv_skillRating", va("%d", MM_RATING_DEFAULT) );
@@ -393,6 +399,8 @@ void G_Shutdown( void ) {
 
 	AI_Shutdown();
 
+	G_PhysSweeps_Shutdown();
+
 	G_RemoveCommands();
 
 	G_FreeCallvotes();
@@ -784,6 +792,10 @@ int FS_GetFileList( const char *dir, const char *extension, char *buf, size_t bu
 	return trap_FS_GetFileList( dir, extension, buf, bufsize, start, end );
 }
 
+bool FS_MoveCacheFile( const char *src, const char *dst ) {
+	return trap_FS_MoveCacheFile( src, dst );
+}
+
 int FS_Eof( int file ) {
 	return trap_FS_Eof( file );
 }
@@ -856,20 +856,15 @@ static void SV_Physics_Toss( edict_t *ent ) {
 
 //============================================================================
 
-void SV_Physics_LinearProjectile( edict_t *ent, int lookAheadTime ) {
-	// if not a team captain movement will be handled elsewhere
-	if( ent->flags & FL_TEAMSLAVE ) {
-		return;
-	}
-
-	const int old_waterLevel = ent->waterlevel;
-	const int mask = ( ent->r.clipmask ) ? ent->r.clipmask : MASK_SOLID;
-
+/*
+* SV_LinearProjectileSegment
+*
+* Computes a segment that a linear projectile passes in this frame
+*/
+void SV_LinearProjectileSegment( const edict_t *ent, int lookAheadTime, vec3_t start, vec3_t end ) {
 	const float startLineParam = ( ent->s.linearMovementPrevServerTime - ent->s.linearMovementTimeStamp ) * 0.001f;
-	ent->s.linearMovementPrevServerTime = game.serverTime;
 	const float endLineParam = ( lookAheadTime + game.serverTime - ent->s.linearMovementTimeStamp ) * 0.001f;
 
-	vec3_t start, end;
 	VectorMA( ent->s.linearMovementBegin, startLineParam, ent->s.linearMovementVelocity, start );
 	VectorMA( ent->s.linearMovementBegin, endLineParam, ent->s.linearMovementVelocity, end );
 
@@ -883,6 +878,23 @@ void SV_Physics_LinearProjectile( edict_t *ent, int lookAheadTime ) {
 		VectorSubtract( start, velocityDir, start );
 		VectorAdd( end, velocityDir, end );
 	}
+}
+
+void SV_Physics_LinearProjectile( edict_t *ent, int lookAheadTime ) {
+	// if not a team captain movement will be handled elsewhere
+	if( ent->flags & FL_TEAMSLAVE ) {
+		return;
+	}
+
+	const int old_waterLevel = ent->waterlevel;
+	const int mask = ( ent->r.clipmask ) ? ent->r.clipmask : MASK_SOLID;
+
+	vec3_t start, end;
+	SV_LinearProjectileSegment( ent, lookAheadTime, start, end );
+	ent->s.linearMovementPrevServerTime = game.serverTime;
+
+	// The world part of the trace may have been computed in parallel with other projectiles
+	const trace_t *worldTrace = G_PhysSweeps_Find( ent, start, end, mask );
 
 	trace_t trace;
 
@@ -890,7 +902,7 @@ void SV_Physics_LinearProjectile( edict_t *ent, int lookAheadTime ) {
 	if( ent->s.type == ET_ELECTRO_WEAK ) {
 		enableOldHitBox();
 	}
-	G_Trace4D( &trace, start, ent->r.mins, ent->r.maxs, end, ent, mask, ent->timeDelta );
+	G_Trace4DWithWorldTrace( &trace, worldTrace, start, ent->r.mins, ent->r.maxs, end, ent, mask, ent->timeDelta );
 	if( ent->s.type == ET_ELECTRO_WEAK ) {
 		disableOldHitBox();
 	}
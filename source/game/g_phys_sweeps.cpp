@@ -0,0 +1,216 @@
+#include "g_local.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Computes world collision sweeps of linear projectiles in parallel before entities are run.
+ * Entities are still run serially in the order of their numbers and apply impacts and touches as before,
+ * but the projectile physics reuses a precomputed world trace instead of tracing the world again.
+ * A world trace is a pure function of its inputs as the world does not change during a level,
+ * so a precomputed trace is used only if the actual segment, bounds and mask match exactly.
+ * This keeps results deterministic regardless of a number of threads and of changes made by preceding entities.
+ * @note World traces are reentrant (the collision model keeps the trace state in a stack-allocated context),
+ * traces against entities are not (they use shared box hulls) and are performed serially.
+ */
+class ProjectileSweeps {
+	struct Sweep {
+		vec3_t start, end;
+		vec3_t mins, maxs;
+		int mask;
+		unsigned frameNum;
+		trace_t trace;
+	};
+
+	// Running workers costs more than tracing the world for few projectiles
+	static constexpr int kMinParallelSweeps = 24;
+	static constexpr unsigned kMaxWorkers = 7;
+
+	Sweep sweeps[MAX_EDICTS];
+	int entNums[MAX_EDICTS];
+	int numEntNums { 0 };
+	unsigned frameNum { 0 };
+
+	std::atomic<int> nextItem { 0 };
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	std::condition_variable allDone;
+	unsigned generation { 0 };
+	unsigned numBusyWorkers { 0 };
+	bool quit { false };
+
+	void ComputeSweep( int entNum );
+	void TakeItems();
+	void WorkerLoop();
+	void StartWorkers();
+public:
+	void Prepare();
+	void StopWorkers();
+
+	const trace_t *Find( const edict_t *ent, const vec3_t start, const vec3_t end, int mask ) const;
+};
+
+static ProjectileSweeps projectileSweeps;
+
+void ProjectileSweeps::ComputeSweep( int entNum ) {
+	Sweep *sweep = &sweeps[entNum];
+	trap_CM_TransformedBoxTrace( &sweep->trace, sweep->start, sweep->end, sweep->mins, sweep->maxs, NULL, sweep->mask, NULL, NULL );
+	sweep->frameNum = frameNum;
+}
+
+void ProjectileSweeps::TakeItems() {
+	for(;; ) {
+		const int itemNum = nextItem.fetch_add( 1, std::memory_order_relaxed );
+		if( itemNum >= numEntNums ) {
+			return;
+		}
+		ComputeSweep( entNums[itemNum] );
+	}
+}
+
+void ProjectileSweeps::WorkerLoop() {
+	unsigned seenGeneration = 0;
+	for(;; ) {
+		{
+			std::unique_lock<std::mutex> lock( mutex );
+			wakeUp.wait( lock, [&]() { return quit || generation != seenGeneration; } );
+			if( quit ) {
+				return;
+			}
+			seenGeneration = generation;
+		}
+
+		TakeItems();
+
+		std::lock_guard<std::mutex> lock( mutex );
+		if( !--numBusyWorkers ) {
+			allDone.notify_one();
+		}
+	}
+}
+
+void ProjectileSweeps::StartWorkers() {
+	// Leave a core for the calling thread
+	unsigned numWorkers = std::thread::hardware_concurrency();
+	numWorkers = numWorkers > 1 ? numWorkers - 1 : 0;
+	if( numWorkers > kMaxWorkers ) {
+		numWorkers = kMaxWorkers;
+	}
+
+	quit = false;
+	workers.reserve( numWorkers );
+	for( unsigned i = 0; i < numWorkers; ++i ) {
+		workers.emplace_back( [this]() { WorkerLoop(); } );
+	}
+}
+
+void ProjectileSweeps::StopWorkers() {
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		quit = true;
+	}
+	wakeUp.notify_all();
+	for( auto &worker: workers ) {
+		worker.join();
+	}
+	workers.clear();
+	// Make sure sweeps of this level are never used again
+	frameNum++;
+}
+
+/**
+ * Collects linear projectiles that are going to be run this frame and computes their world sweeps.
+ * Sweeps are computed only if there are enough projectiles, entities trace the world on their own otherwise.
+ */
+void ProjectileSweeps::Prepare() {
+	frameNum++;
+	numEntNums = 0;
+
+	if( !g_phys_parallel->integer ) {
+		return;
+	}
+
+	// Projectiles are movers, visit only entities that are known to have physics movetypes
+	for( const edict_t *ent = G_Scheduler_NextMover( game.edicts + gs.maxclients ); ent; ent = G_Scheduler_NextMover( ent ) ) {
+		const int i = ENTNUM( ent );
+		if( !ent->r.inuse || ent->movetype != MOVETYPE_LINEARPROJECTILE ) {
+			continue;
+		}
+		if( ( ent->flags & FL_TEAMSLAVE ) || ISEVENTENTITY( &ent->s ) ) {
+			continue;
+		}
+
+		Sweep *sweep = &sweeps[i];
+		SV_LinearProjectileSegment( ent, 0, sweep->start, sweep->end );
+		VectorCopy( ent->r.mins, sweep->mins );
+		VectorCopy( ent->r.maxs, sweep->maxs );
+		sweep->mask = ent->r.clipmask ? ent->r.clipmask : MASK_SOLID;
+		entNums[numEntNums++] = i;
+	}
+
+	if( numEntNums < kMinParallelSweeps ) {
+		numEntNums = 0;
+		return;
+	}
+
+	if( workers.empty() ) {
+		StartWorkers();
+	}
+
+	nextItem.store( 0, std::memory_order_relaxed );
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		numBusyWorkers = (unsigned)workers.size();
+		generation++;
+	}
+	wakeUp.notify_all();
+
+	TakeItems();
+
+	std::unique_lock<std::mutex> lock( mutex );
+	allDone.wait( lock, [&]() { return !numBusyWorkers; } );
+}
+
+const trace_t *ProjectileSweeps::Find( const edict_t *ent, const vec3_t start, const vec3_t end, int mask ) const {
+	const Sweep *sweep = &sweeps[ENTNUM( ent )];
+	if( sweep->frameNum != frameNum || !numEntNums ) {
+		return nullptr;
+	}
+	if( sweep->mask != mask || !VectorCompare( sweep->start, start ) || !VectorCompare( sweep->end, end ) ) {
+		return nullptr;
+	}
+	if( !VectorCompare( sweep->mins, ent->r.mins ) || !VectorCompare( sweep->maxs, ent->r.maxs ) ) {
+		return nullptr;
+	}
+	return &sweep->trace;
+}
+
+/*
+* G_PhysSweeps_Prepare
+*
+* Should be called before entities are run every frame
+*/
+void G_PhysSweeps_Prepare( void ) {
+	projectileSweeps.Prepare();
+}
+
+/*
+* G_PhysSweeps_Find
+*
+* Returns a precomputed world trace for the projectile movement (if any)
+*/
+const trace_t *G_PhysSweeps_Find( const edict_t *ent, const vec3_t start, const vec3_t end, int mask ) {
+	return projectileSweeps.Find( ent, start, end, mask );
+}
+
+/*
+* G_PhysSweeps_Shutdown
+*/
+void G_PhysSweeps_Shutdown( void ) {
+	projectileSweeps.StopWorkers();
+}
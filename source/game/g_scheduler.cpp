@@ -0,0 +1,246 @@
+#include "g_local.h"
+#include "../qcommon/wswtimerwheel.h"
+
+#include <type_traits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * Tracks edicts that have to be visited by G_RunEntities() so a frame cost scales with
+ * a number of entities that actually think or move instead of a number of all entities.
+ * Entities with physics movetypes are always active, other ones become active only when their think is due.
+ * Think times are kept in a timer wheel and are rescheduled on every assignment of an edict nextThink field.
+ * Active entities are visited in the ascending order of their numbers like before,
+ * including ones that get activated or spawned with greater numbers during the frame.
+ * @note The scheduler produces a superset of entities that have to be run.
+ * Edicts must be unlinked before they get cleared by memset() that bypasses field setters.
+ * Other stale entries (if any) get dropped when visited, as G_RunEntity() checks actual think times and movetypes anyway.
+ */
+class EntitiesScheduler {
+	static constexpr unsigned kNumWords = MAX_EDICTS / 64;
+
+	wsw::TimerWheel<MAX_EDICTS> thinksWheel;
+	uint64_t dueBits[kNumWords];
+	uint64_t moverBits[kNumWords];
+
+	static bool HasPhysics( int movetype ) {
+		return movetype != MOVETYPE_NONE && movetype != MOVETYPE_PLAYER && movetype != MOVETYPE_NOCLIP;
+	}
+
+	static int EntNumOfField( const void *field ) {
+		if( !game.edicts ) {
+			return -1;
+		}
+		const ptrdiff_t offset = (const uint8_t *)field - (const uint8_t *)game.edicts;
+		if( offset < 0 || offset >= (ptrdiff_t)( game.maxentities * sizeof( edict_t ) ) ) {
+			return -1;
+		}
+		return (int)( offset / sizeof( edict_t ) );
+	}
+
+	static unsigned LowestSetBit( uint64_t bits ) {
+#ifndef _MSC_VER
+		return (unsigned)__builtin_ctzll( bits );
+#else
+		unsigned long index;
+		_BitScanForward64( &index, bits );
+		return (unsigned)index;
+#endif
+	}
+
+	void SetBit( uint64_t *bits, int entNum ) { bits[entNum >> 6] |= (uint64_t)1 << ( entNum & 63 ); }
+	void ClearBit( uint64_t *bits, int entNum ) { bits[entNum >> 6] &= ~( (uint64_t)1 << ( entNum & 63 ) ); }
+
+	void MarkDue( int entNum );
+public:
+	EntitiesScheduler() { Reset( 0 ); }
+
+	void Reset( int64_t time ) {
+		thinksWheel.clear( time );
+		memset( dueBits, 0, sizeof( dueBits ) );
+		memset( moverBits, 0, sizeof( moverBits ) );
+	}
+
+	void OnNextThinkChanged( const EdictNextThink *field );
+	void OnMoveTypeChanged( const EdictMoveType *field );
+
+	void Unlink( int entNum ) {
+		thinksWheel.cancel( (unsigned)entNum );
+		ClearBit( dueBits, entNum );
+		ClearBit( moverBits, entNum );
+	}
+
+	void AdvanceTime( int64_t time ) {
+		thinksWheel.advance( time, [this]( unsigned entNum ) { MarkDue( (int)entNum ); } );
+	}
+
+	edict_t *NextActiveEntity( const edict_t *after );
+	edict_t *NextMover( const edict_t *after );
+};
+
+static EntitiesScheduler entitiesScheduler;
+
+static_assert( std::is_trivially_copyable<EdictNextThink>::value, "Edicts must remain clearable by memset()" );
+static_assert( std::is_trivially_copyable<EdictMoveType>::value, "Edicts must remain clearable by memset()" );
+
+/**
+ * Team members do not think on their own but their captain runs their thinks, so the captain has to be visited too.
+ */
+void EntitiesScheduler::MarkDue( int entNum ) {
+	SetBit( dueBits, entNum );
+	const edict_t *ent = game.edicts + entNum;
+	if( ( ent->flags & FL_TEAMSLAVE ) && ent->teammaster ) {
+		SetBit( dueBits, ENTNUM( ent->teammaster ) );
+	}
+}
+
+void EntitiesScheduler::OnNextThinkChanged( const EdictNextThink *field ) {
+	const int entNum = EntNumOfField( field );
+	if( entNum < 0 ) {
+		return;
+	}
+
+	const int64_t nextThink = *field;
+	if( nextThink <= 0 ) {
+		thinksWheel.cancel( (unsigned)entNum );
+	} else if( !thinksWheel.schedule( (unsigned)entNum, nextThink ) ) {
+		// The think is due already, an entity is going to be visited during the current
+		// or the next G_RunEntities() call depending of whether it has been passed in this frame
+		MarkDue( entNum );
+	}
+}
+
+void EntitiesScheduler::OnMoveTypeChanged( const EdictMoveType *field ) {
+	const int entNum = EntNumOfField( field );
+	if( entNum < 0 ) {
+		return;
+	}
+
+	if( HasPhysics( *field ) ) {
+		SetBit( moverBits, entNum );
+	} else {
+		ClearBit( moverBits, entNum );
+	}
+}
+
+/**
+ * Returns an active entity with the lowest number greater than a number of the given one (if any).
+ * Bits are reloaded on every call as running an entity may activate and spawn other entities.
+ */
+edict_t *EntitiesScheduler::NextActiveEntity( const edict_t *after ) {
+	unsigned entNum = after ? (unsigned)ENTNUM( after ) + 1 : 0;
+	while( entNum < (unsigned)game.numentities ) {
+		const unsigned wordNum = entNum >> 6;
+		const uint64_t mask = ~(uint64_t)0 << ( entNum & 63 );
+		const uint64_t bits = ( dueBits[wordNum] | moverBits[wordNum] ) & mask;
+		if( !bits ) {
+			entNum = ( wordNum + 1 ) << 6;
+			continue;
+		}
+
+		entNum = ( wordNum << 6 ) + LowestSetBit( bits );
+		if( entNum >= (unsigned)game.numentities ) {
+			break;
+		}
+
+		edict_t *ent = game.edicts + entNum;
+		const bool isDue = ( dueBits[wordNum] >> ( entNum & 63 ) ) & 1;
+		ClearBit( dueBits, (int)entNum );
+		// Drop stale bits of edicts that have been cleared by memset()
+		if( !HasPhysics( ent->movetype ) ) {
+			ClearBit( moverBits, (int)entNum );
+		}
+
+		// Teams may get formed after the think has been scheduled
+		if( isDue && ( ent->flags & FL_TEAMSLAVE ) && ent->teammaster && ent->nextThink > 0 && ent->nextThink <= level.time ) {
+			SetBit( dueBits, ENTNUM( ent->teammaster ) );
+		}
+
+		return ent;
+	}
+
+	return nullptr;
+}
+
+/**
+ * Returns an entity that has a physics movetype with the lowest number greater than a number of the given one (if any).
+ * Due thinks are not affected by this call.
+ */
+edict_t *EntitiesScheduler::NextMover( const edict_t *after ) {
+	unsigned entNum = after ? (unsigned)ENTNUM( after ) + 1 : 0;
+	while( entNum < (unsigned)game.numentities ) {
+		const unsigned wordNum = entNum >> 6;
+		const uint64_t bits = moverBits[wordNum] & ( ~(uint64_t)0 << ( entNum & 63 ) );
+		if( !bits ) {
+			entNum = ( wordNum + 1 ) << 6;
+			continue;
+		}
+
+		entNum = ( wordNum << 6 ) + LowestSetBit( bits );
+		return entNum < (unsigned)game.numentities ? game.edicts + entNum : nullptr;
+	}
+
+	return nullptr;
+}
+
+/*
+* G_Scheduler_OnNextThinkChanged
+*/
+void G_Scheduler_OnNextThinkChanged( const EdictNextThink *field ) {
+	entitiesScheduler.OnNextThinkChanged( field );
+}
+
+/*
+* G_Scheduler_OnMoveTypeChanged
+*/
+void G_Scheduler_OnMoveTypeChanged( const EdictMoveType *field ) {
+	entitiesScheduler.OnMoveTypeChanged( field );
+}
+
+/*
+* G_Scheduler_UnlinkEdict
+*
+* Should be called before the edict gets cleared by memset()
+*/
+void G_Scheduler_UnlinkEdict( const edict_t *ent ) {
+	entitiesScheduler.Unlink( ENTNUM( ent ) );
+}
+
+/*
+* G_Scheduler_Reset
+*
+* Should be called once edicts have been cleared for a new level
+*/
+void G_Scheduler_Reset( void ) {
+	entitiesScheduler.Reset( level.time );
+
+	// Client edicts are not cleared between levels
+	for( int i = 0; i < game.numentities; i++ ) {
+		edict_t *ent = game.edicts + i;
+		ent->nextThink = (int64_t)ent->nextThink;
+		ent->movetype = (int)ent->movetype;
+	}
+}
+
+/*
+* G_Scheduler_AdvanceTime
+*/
+void G_Scheduler_AdvanceTime( int64_t time ) {
+	entitiesScheduler.AdvanceTime( time );
+}
+
+/*
+* G_Scheduler_NextActiveEntity
+*/
+edict_t *G_Scheduler_NextActiveEntity( const edict_t *after ) {
+	return entitiesScheduler.NextActiveEntity( after );
+}
+
+/*
+* G_Scheduler_NextMover
+*/
+edict_t *G_Scheduler_NextMover( const edict_t *after ) {
+	return entitiesScheduler.NextMover( after );
+}
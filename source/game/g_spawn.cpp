@@ -710,6 +710,8 @@ static void G_FreeEntities( void ) {
 	}
 
 	game.numentities = gs.maxclients + 1;
+
+	G_Scheduler_Reset();
 }
 
 /*
@@ -803,6 +805,8 @@ static void G_SpawnEntities( void ) {
 
 	// items need brush model entities spawned before they are linked
 	G_Items_FinishSpawningItems();
+
+	GClip_BuildStaticTriggers();
 }
 
 /*
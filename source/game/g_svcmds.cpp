@@ -1291,8 +1291,11 @@ void G_AddServerCommands( void ) {
 #endif
 
 	trap_Cmd_AddCommand( "dumpASapi", G_asDumpAPI_f );
+	trap_Cmd_AddCommand( "asprofile", G_asProfile_f );
 
 	trap_Cmd_AddCommand( "listlocations", Cmd_ListLocations_f );
+
+	trap_Cmd_AddCommand( "aiquerycachestats", AI_Cmd_QueryCacheStats_f );
 }
 
 /*
@@ -1317,6 +1320,9 @@ void G_RemoveCommands( void ) {
 #endif
 
 	trap_Cmd_RemoveCommand( "dumpASapi" );
+	trap_Cmd_RemoveCommand( "asprofile" );
+
+	trap_Cmd_RemoveCommand( "aiquerycachestats" );
 
 	trap_Cmd_RemoveCommand( "listlocations" );
 }
@@ -246,6 +246,10 @@ static inline bool trap_FS_MoveFile( const char *src, const char *dst ) {
 	return GAME_IMPORT.FS_MoveFile( src, dst ) == true;
 }
 
+static inline bool trap_FS_MoveCacheFile( const char *src, const char *dst ) {
+	return GAME_IMPORT.FS_MoveCacheFile( src, dst ) == true;
+}
+
 static inline bool trap_ML_Update( void ) {
 	return GAME_IMPORT.ML_Update() == true;
 }
@@ -385,6 +385,7 @@ void G_FreeEdict( edict_t *ed ) {
 
 	G_asReleaseEntityBehaviors( ed );
 
+	G_Scheduler_UnlinkEdict( ed );
 	memset( ed, 0, sizeof( *ed ) );
 	ed->r.inuse = false;
 	ed->s.number = ENTNUM( ed );
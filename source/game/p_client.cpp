@@ -200,6 +200,7 @@ static edict_t *CopyToBodyQue( edict_t *ent, edict_t *attacker, int damage ) {
 	}
 
 	GClip_UnlinkEntity( body );
+	G_Scheduler_UnlinkEdict( body );
 
 	memset( body, 0, sizeof( edict_t ) ); //clean up garbage
 
@@ -21,6 +21,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "qcommon.h"
 #include "../qcommon/q_trie.h"
+#include "wswinternedstrings.h"
 #include "../client/console.h"
 
 #include <algorithm>
@@ -37,7 +38,10 @@ typedef struct cmdalias_s {
 static bool cmd_preinitialized = false;
 static bool cmd_initialized = false;
 
+// a secondary index for listing and completion by prefixes
 static trie_t *cmd_alias_trie = NULL;
+// exact lookups by names go through the global interned strings table
+static wsw::InternedStringMap<cmd_alias_t> cmd_alias_map;
 static const trie_casing_t CMD_ALIAS_TRIE_CASING = CON_CASE_SENSITIVE ? TRIE_CASE_SENSITIVE : TRIE_CASE_INSENSITIVE;;
 
 static bool cmd_wait;
@@ -95,7 +99,7 @@ void Cbuf_Init( void ) {
 	assert( !cbuf_initialized );
 
 	cbuf_text_size = MIN_CMD_TEXT_SIZE;
-	cbuf_text = (char *)Q_malloc( cbuf_text_size );
+	cbuf_text = (char *)Q_TagMalloc( cbuf_text_size, MEMTAG_COMMANDS );
 	cbuf_text_head = 0;
 	cbuf_text_tail = 0;
 
@@ -110,7 +114,7 @@ void Cbuf_Shutdown( void ) {
 		return;
 	}
 
-	Q_free( cbuf_text );
+	Q_TagFree( cbuf_text );
 	cbuf_text = NULL;
 	cbuf_text_size = 0;
 	cbuf_text_head = 0;
@@ -139,7 +143,7 @@ static void Q_freeSpace( void ) {
 		old_size = cbuf_text_size;
 
 		cbuf_text_size = used + MIN_CMD_TEXT_SIZE;
-		cbuf_text = (char *)Q_malloc( cbuf_text_size );
+		cbuf_text = (char *)Q_TagMalloc( cbuf_text_size, MEMTAG_COMMANDS );
 
 		if( cbuf_text_head >= cbuf_text_tail ) {
 			memcpy( cbuf_text, old + cbuf_text_tail, used );
@@ -150,7 +154,7 @@ static void Q_freeSpace( void ) {
 		cbuf_text_tail = 0;
 		cbuf_text_head = used;
 
-		Q_free( old );
+		Q_TagFree( old );
 	}
 }
 
@@ -173,7 +177,7 @@ static void Cbuf_EnsureSpace( size_t size ) {
 
 	diff = ( size - free ) + MIN_CMD_TEXT_SIZE;
 	cbuf_text_size += diff;
-	cbuf_text = (char *)Q_realloc( cbuf_text, cbuf_text_size );
+	cbuf_text = (char *)Q_TagRealloc( cbuf_text, cbuf_text_size, MEMTAG_COMMANDS );
 
 	if( cbuf_text_head < cbuf_text_tail ) {
 		memmove( cbuf_text + cbuf_text_tail + diff, cbuf_text + cbuf_text_tail, cbuf_text_size - diff - cbuf_text_tail );
@@ -382,7 +386,7 @@ bool Cbuf_AddLateCommands( void ) {
 	}
 
 	text_size += 2; // '\n' and '\0' at the end
-	text = (char *)Q_malloc( (int)text_size );
+	text = (char *)Com_FrameAlloc( text_size );
 	text[0] = 0;
 	for( i = 1; i < COM_Argc(); i++ ) {
 		if( COM_Argv( i )[0] == 0 ) {
@@ -399,7 +403,6 @@ bool Cbuf_AddLateCommands( void ) {
 	Q_strncatz( text, "\n", text_size );
 
 	Cbuf_AddText( text );
-	Q_free( text );
 
 	return true;
 }
@@ -550,7 +553,7 @@ static void Cmd_Alias_f_( bool archive ) {
 	}
 
 	assert( cmd_alias_trie );
-	Trie_Find( cmd_alias_trie, s, TRIE_EXACT_MATCH, (void **)&a );
+	a = cmd_alias_map.get( Com_FindInternedString( s ) );
 	if( a ) {
 		if( Cmd_Argc() == 2 ) {
 			if( archive ) {
@@ -564,6 +567,7 @@ static void Cmd_Alias_f_( bool archive ) {
 		a = (cmd_alias_t *)Q_malloc( (int) ( sizeof( cmd_alias_t ) + len + 1 ) );
 		a->name = (char *) ( (uint8_t *)a + sizeof( cmd_alias_t ) );
 		strcpy( a->name, s );
+		cmd_alias_map.set( Com_InternString( s ), a );
 		Trie_Insert( cmd_alias_trie, s, a );
 	}
 
@@ -620,6 +624,7 @@ static void Cmd_Unalias_f( void ) {
 
 	assert( cmd_alias_trie );
 	if( Trie_Remove( cmd_alias_trie, s, (void **)&a ) == TRIE_OK ) {
+		cmd_alias_map.remove( Com_FindInternedString( s ) );
 		Q_free( a->value );
 		Q_free( a );
 	} else {
@@ -645,6 +650,7 @@ static void Cmd_UnaliasAll_f( void ) {
 	}
 	Trie_FreeDump( dump );
 	Trie_Clear( cmd_alias_trie );
+	cmd_alias_map.clear();
 }
 
 /*
@@ -691,7 +697,10 @@ static size_t cmd_argv_sizes[MAX_STRING_TOKENS];
 static char cmd_null_string[1] = { '\0' };
 static char cmd_args[MAX_STRING_CHARS];
 
+// a secondary index for listing and completion by prefixes
 static trie_t *cmd_function_trie = NULL;
+// exact lookups by names go through the global interned strings table
+static wsw::InternedStringMap<cmd_function_t> cmd_function_map;
 static const trie_casing_t CMD_FUNCTION_TRIE_CASING = CON_CASE_SENSITIVE ? TRIE_CASE_SENSITIVE : TRIE_CASE_INSENSITIVE;
 
 static int Cmd_PatternMatchesFunction( void *cmd, void *pattern ) {
@@ -789,9 +798,9 @@ void Cmd_TokenizeString( const char *text ) {
 			if( cmd_argv_sizes[cmd_argc] < size ) {
 				cmd_argv_sizes[cmd_argc] = std::min( size + 64, (size_t)MAX_TOKEN_CHARS );
 				if( cmd_argv[cmd_argc] ) {
-					Q_free( cmd_argv[cmd_argc] );
+					Q_TagFree( cmd_argv[cmd_argc] );
 				}
-				cmd_argv[cmd_argc] = (char *)Q_malloc( cmd_argv_sizes[cmd_argc] );
+				cmd_argv[cmd_argc] = (char *)Q_TagMalloc( cmd_argv_sizes[cmd_argc], MEMTAG_COMMANDS );
 			}
 			strcpy( cmd_argv[cmd_argc], com_token );
 			cmd_argc++;
@@ -825,7 +834,7 @@ void Cmd_AddCommand( const char *cmd_name, xcommand_t function ) {
 	// fail if the command already exists
 	assert( cmd_function_trie );
 	assert( cmd_name );
-	if( Trie_Find( cmd_function_trie, cmd_name, TRIE_EXACT_MATCH, (void **)&cmd ) == TRIE_OK ) {
+	if( ( cmd = cmd_function_map.get( Com_FindInternedString( cmd_name ) ) ) ) {
 		cmd->function = function;
 		cmd->completion_func = NULL;
 		Com_DPrintf( "Cmd_AddCommand: %s already defined\n", cmd_name );
@@ -837,6 +846,7 @@ void Cmd_AddCommand( const char *cmd_name, xcommand_t function ) {
 	strcpy( cmd->name, cmd_name );
 	cmd->function = function;
 	cmd->completion_func = NULL;
+	cmd_function_map.set( Com_InternString( cmd_name ), cmd );
 	Trie_Insert( cmd_function_trie, cmd_name, cmd );
 }
 
@@ -853,6 +863,7 @@ void Cmd_RemoveCommand( const char *cmd_name ) {
 	assert( cmd_function_trie );
 	assert( cmd_name );
 	if( Trie_Remove( cmd_function_trie, cmd_name, (void **)&cmd ) == TRIE_OK ) {
+		cmd_function_map.remove( Com_FindInternedString( cmd_name ) );
 		Q_free( cmd );
 	} else {
 		Com_Printf( "Cmd_RemoveCommand: %s not added\n", cmd_name );
@@ -864,11 +875,9 @@ void Cmd_RemoveCommand( const char *cmd_name ) {
 * // used by the cvar code to check for cvar / command name overlap
 */
 bool Cmd_Exists( const char *cmd_name ) {
-	cmd_function_t *cmd;
-
 	assert( cmd_function_trie );
 	assert( cmd_name );
-	return Trie_Find( cmd_function_trie, cmd_name, TRIE_EXACT_MATCH, (void **)&cmd ) == TRIE_OK;
+	return cmd_function_map.get( Com_FindInternedString( cmd_name ) ) != NULL;
 }
 
 /*
@@ -882,7 +891,7 @@ void Cmd_SetCompletionFunc( const char *cmd_name, xcompletionf_t completion_func
 		return;
 	}
 
-	if( Trie_Find( cmd_function_trie, cmd_name, TRIE_EXACT_MATCH, (void **)&cmd ) == TRIE_OK ) {
+	if( ( cmd = cmd_function_map.get( Com_FindInternedString( cmd_name ) ) ) ) {
 		cmd->completion_func = completion_func;
 		return;
 	}
@@ -943,9 +952,9 @@ char **Cmd_CompleteBuildList( const char *partial ) {
 * Find a possible single matching command
 */
 char **Cmd_CompleteBuildArgListExt( const char *command, const char *arguments ) {
-	cmd_function_t *cmd = NULL;
+	cmd_function_t *cmd = cmd_function_map.get( Com_FindInternedString( command ) );
 
-	if( Trie_Find( cmd_function_trie, command, TRIE_EXACT_MATCH, (void **)&cmd ) != TRIE_OK ) {
+	if( !cmd ) {
 		return NULL;
 	}
 	if( cmd->completion_func ) {
@@ -1177,7 +1186,6 @@ char **Cmd_CompleteAliasBuildList( const char *partial ) {
 */
 bool Cmd_CheckForCommand( char *text ) {
 	char cmd[MAX_STRING_CHARS];
-	cmd_alias_t *a;
 	int i;
 
 	// this is not exactly what cbuf does when extracting lines
@@ -1197,7 +1205,7 @@ bool Cmd_CheckForCommand( char *text ) {
 	if( Cvar_Find( cmd ) ) {
 		return true;
 	}
-	if( Trie_Find( cmd_alias_trie, cmd, TRIE_EXACT_MATCH, (void **)&a ) == TRIE_OK ) {
+	if( cmd_alias_map.get( Com_FindInternedString( cmd ) ) ) {
 		return true;
 	}
 
@@ -1208,7 +1216,6 @@ bool Cmd_CheckForCommand( char *text ) {
 * Cmd_ExecuteString
 * // Parses a single line of text into arguments and tries to execute it
 * // as if it was typed at the console
-* FIXME: lookupnoadd the token to speed search?
 */
 void Cmd_ExecuteString( const char *text ) {
 	char *str;
@@ -1231,9 +1238,12 @@ void Cmd_ExecuteString( const char *text ) {
 	// that does not break seperation of concerns.
 	// Aiwa, 07-14-2006
 
+	// a name that has never been interned is neither a command nor an alias nor a cvar
+	const wsw::InternedString *name = Com_FindInternedString( str );
+
 	assert( cmd_function_trie );
 	assert( cmd_alias_trie );
-	if( Trie_Find( cmd_function_trie, str, TRIE_EXACT_MATCH, (void **)&cmd ) == TRIE_OK ) {
+	if( ( cmd = cmd_function_map.get( name ) ) ) {
 		// check functions
 		if( !cmd->function ) {
 			// forward to server command
@@ -1241,7 +1251,7 @@ void Cmd_ExecuteString( const char *text ) {
 		} else {
 			cmd->function();
 		}
-	} else if( Trie_Find( cmd_alias_trie, str, TRIE_EXACT_MATCH, (void **)&a ) == TRIE_OK ) {
+	} else if( ( a = cmd_alias_map.get( name ) ) ) {
 		// check alias
 		if( ++alias_count == ALIAS_LOOP_COUNT ) {
 			Com_Printf( "ALIAS_LOOP_COUNT\n" );
@@ -1352,7 +1362,7 @@ void Cmd_Shutdown( void ) {
 
 		// this is somewhat ugly IMO
 		for( i = 0; i < MAX_STRING_TOKENS && cmd_argv_sizes[i]; i++ ) {
-			Q_free( cmd_argv[i] );
+			Q_TagFree( cmd_argv[i] );
 			cmd_argv_sizes[i] = 0;
 		}
 
@@ -1375,8 +1385,10 @@ void Cmd_Shutdown( void ) {
 
 		Trie_Destroy( cmd_alias_trie );
 		cmd_alias_trie = NULL;
+		cmd_alias_map.clear();
 		Trie_Destroy( cmd_function_trie );
 		cmd_function_trie = NULL;
+		cmd_function_map.clear();
 
 		cmd_preinitialized = false;
 	}
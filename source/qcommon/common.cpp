@@ -23,6 +23,12 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 // TODO: Lift the header to the toplevel
 #include "wswstaticvector.h"
+#include "wswallocators.h"
+#include "wswinternedstrings.h"
+#include "../client/console.h"
+
+#include <atomic>
+#include <mutex>
 
 #if ( defined( _MSC_VER ) && ( defined( _M_IX86 ) || defined( _M_AMD64 ) || defined( _M_X64 ) ) )
 // For __cpuid() intrinsic
@@ -966,6 +972,197 @@ char *Q_strdup( const char *str ) {
 	return result;
 }
 
+/*
+==============================================================
+
+ACCOUNTED MEMORY
+
+==============================================================
+*/
+
+// precedes every accounted block
+typedef struct {
+	void *base;
+	size_t size;
+	uint32_t alignment;
+	uint32_t tag;
+} memheader_t;
+
+typedef struct {
+	std::atomic<size_t> liveBytes;
+	std::atomic<size_t> peakBytes;
+	std::atomic<size_t> liveBlocks;
+	std::atomic<size_t> totalAllocations;
+} memtagstats_t;
+
+static const char *mem_tagNames[MEMTAG_TOTAL] = { "frame", "commands", "console", "snapshots", "network", "renderer" };
+static memtagstats_t mem_tagStats[MEMTAG_TOTAL];
+
+static void *Com_FrameArenaAllocate( size_t size ) {
+	return Q_TagMalloc( size, MEMTAG_FRAME );
+}
+
+static wsw::LinearArena com_frameArena( 64 * 1024, { &Com_FrameArenaAllocate, &Q_TagFree } );
+
+static void Mem_AddLiveBytes( memtagstats_t *stats, size_t size ) {
+	const size_t liveBytes = stats->liveBytes.fetch_add( size, std::memory_order_relaxed ) + size;
+	size_t peakBytes = stats->peakBytes.load( std::memory_order_relaxed );
+	while( peakBytes < liveBytes && !stats->peakBytes.compare_exchange_weak( peakBytes, liveBytes ) ) {}
+}
+
+/*
+* Q_TagMallocAligned
+*/
+void *Q_TagMallocAligned( size_t size, size_t alignment, memtag_t tag ) {
+	assert( (unsigned)tag < MEMTAG_TOTAL );
+	alignment = std::max( alignment, (size_t)16 );
+
+	void *base = std::calloc( size + sizeof( memheader_t ) + alignment - 1, 1 );
+	if( !base ) {
+		throw std::bad_alloc();
+	}
+
+	auto *const buf = wsw::AlignUp( (uint8_t *)base + sizeof( memheader_t ), alignment );
+	auto *const header = (memheader_t *)buf - 1;
+	header->base = base;
+	header->size = size;
+	header->alignment = (uint32_t)alignment;
+	header->tag = tag;
+
+	memtagstats_t *const stats = &mem_tagStats[tag];
+	Mem_AddLiveBytes( stats, size );
+	stats->liveBlocks.fetch_add( 1, std::memory_order_relaxed );
+	stats->totalAllocations.fetch_add( 1, std::memory_order_relaxed );
+
+	return buf;
+}
+
+/*
+* Q_TagMalloc
+*/
+void *Q_TagMalloc( size_t size, memtag_t tag ) {
+	return Q_TagMallocAligned( size, 16, tag );
+}
+
+/*
+* Q_TagRealloc
+*
+* Unlike Q_realloc(), zeroes the grown part of the block
+* The block is resized in place by realloc() if the heap allows it
+*/
+void *Q_TagRealloc( void *buf, size_t newsize, memtag_t tag ) {
+	if( !buf ) {
+		return Q_TagMalloc( newsize, tag );
+	}
+
+	const memheader_t *const oldheader = (memheader_t *)buf - 1;
+	assert( oldheader->tag == (uint32_t)tag );
+	const size_t oldsize = oldheader->size;
+	const size_t alignment = oldheader->alignment;
+	const size_t oldoffset = (uint8_t *)buf - (uint8_t *)oldheader->base;
+
+	auto *const base = (uint8_t *)std::realloc( oldheader->base, newsize + sizeof( memheader_t ) + alignment - 1 );
+	if( !base ) {
+		throw std::bad_alloc();
+	}
+
+	// The block keeps its offset from the base, so it stays aligned unless the base has moved to an address
+	// of a different alignment. The data gets shifted within the block in the latter case.
+	auto *const newbuf = wsw::AlignUp( base + sizeof( memheader_t ), alignment );
+	if( newbuf != base + oldoffset ) {
+		std::memmove( newbuf - sizeof( memheader_t ), base + oldoffset - sizeof( memheader_t ),
+					  sizeof( memheader_t ) + std::min( oldsize, newsize ) );
+	}
+
+	auto *const header = (memheader_t *)newbuf - 1;
+	header->base = base;
+	header->size = newsize;
+
+	memtagstats_t *const stats = &mem_tagStats[tag];
+	if( newsize > oldsize ) {
+		std::memset( newbuf + oldsize, 0, newsize - oldsize );
+		Mem_AddLiveBytes( stats, newsize - oldsize );
+	} else {
+		stats->liveBytes.fetch_sub( oldsize - newsize, std::memory_order_relaxed );
+	}
+	stats->totalAllocations.fetch_add( 1, std::memory_order_relaxed );
+
+	return newbuf;
+}
+
+/*
+* Q_TagFree
+*/
+void Q_TagFree( void *buf ) {
+	if( !buf ) {
+		return;
+	}
+
+	const memheader_t *const header = (memheader_t *)buf - 1;
+	assert( header->tag < MEMTAG_TOTAL );
+	memtagstats_t *const stats = &mem_tagStats[header->tag];
+	stats->liveBytes.fetch_sub( header->size, std::memory_order_relaxed );
+	stats->liveBlocks.fetch_sub( 1, std::memory_order_relaxed );
+
+	std::free( header->base );
+}
+
+/*
+* Com_FrameAlloc
+*/
+void *Com_FrameAlloc( size_t size ) {
+	return std::memset( com_frameArena.allocate( size ), 0, size );
+}
+
+/*
+* Com_MemStats_f
+*/
+static void Com_MemStats_f( void ) {
+	size_t totalLiveBytes = 0;
+
+	Com_Printf( "%-10s %12s %12s %8s %10s\n", "tag", "live bytes", "peak bytes", "blocks", "allocs" );
+	for( int i = 0; i < MEMTAG_TOTAL; i++ ) {
+		const memtagstats_t *stats = &mem_tagStats[i];
+		const size_t liveBytes = stats->liveBytes.load( std::memory_order_relaxed );
+		Com_Printf( "%-10s %12" PRIu64 " %12" PRIu64 " %8" PRIu64 " %10" PRIu64 "\n", mem_tagNames[i],
+					(uint64_t)liveBytes, (uint64_t)stats->peakBytes.load( std::memory_order_relaxed ),
+					(uint64_t)stats->liveBlocks.load( std::memory_order_relaxed ),
+					(uint64_t)stats->totalAllocations.load( std::memory_order_relaxed ) );
+		totalLiveBytes += liveBytes;
+	}
+	Com_Printf( "Total: %" PRIu64 " bytes\n", (uint64_t)totalLiveBytes );
+	Com_Printf( "Frame arena: %" PRIu64 " bytes used, %" PRIu64 " peak, %" PRIu64 " reserved\n",
+				(uint64_t)com_frameArena.usedBytes(), (uint64_t)com_frameArena.peakBytes(),
+				(uint64_t)com_frameArena.reservedBytes() );
+}
+
+/*
+==============================================================
+
+INTERNED STRINGS
+
+==============================================================
+*/
+
+static std::mutex com_internedStringsMutex;
+static wsw::StringInterner com_internedStrings( !CON_CASE_SENSITIVE );
+
+/*
+* Com_InternString
+*/
+const wsw::InternedString *Com_InternString( const char *str ) {
+	std::lock_guard<std::mutex> lock( com_internedStringsMutex );
+	return com_internedStrings.intern( str );
+}
+
+/*
+* Com_FindInternedString
+*/
+const wsw::InternedString *Com_FindInternedString( const char *str ) {
+	std::lock_guard<std::mutex> lock( com_internedStringsMutex );
+	return com_internedStrings.find( str );
+}
+
 /*
 * Qcommon_InitCommands
 */
@@ -976,6 +1173,7 @@ void Qcommon_InitCommands( void ) {
 	Cmd_AddCommand( "error", Com_Error_f );
 	Cmd_AddCommand( "lag", Com_Lag_f );
 #endif
+	Cmd_AddCommand( "memstats", Com_MemStats_f );
 
 	if( dedicated->integer ) {
 		Cmd_AddCommand( "quit", Com_Quit );
@@ -996,6 +1194,7 @@ void Qcommon_ShutdownCommands( void ) {
 	Cmd_RemoveCommand( "error" );
 	Cmd_RemoveCommand( "lag" );
 #endif
+	Cmd_RemoveCommand( "memstats" );
 
 	if( dedicated->integer ) {
 		Cmd_RemoveCommand( "quit" );
@@ -1162,6 +1361,9 @@ void Qcommon_Frame( unsigned int realMsec ) {
 
 	}
 
+	// blocks of the previous frame (including an aborted one) are no longer referenced
+	com_frameArena.reset();
+
 	if( logconsole && logconsole->modified ) {
 		logconsole->modified = false;
 		Com_ReopenConsoleLog();
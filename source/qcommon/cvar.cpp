@@ -20,12 +20,16 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "qcommon.h"
 #include "q_trie.h"
+#include "wswinternedstrings.h"
 #include "../client/console.h"
 
 static bool cvar_initialized = false;
 static bool cvar_preinitialized = false;
 
+// a secondary index for listing and completion by prefixes
 static trie_t *cvar_trie = NULL;
+// exact lookups by names go through the global interned strings table
+static wsw::InternedStringMap<cvar_t> cvar_map;
 static qmutex_t *cvar_mutex = NULL;
 static const trie_casing_t CVAR_TRIE_CASING = CON_CASE_SENSITIVE ? TRIE_CASE_SENSITIVE : TRIE_CASE_INSENSITIVE;;
 
@@ -74,8 +78,12 @@ bool Cvar_Initialized( void ) {
 cvar_t *Cvar_Find( const char *var_name ) {
 	cvar_t *cvar;
 	assert( cvar_trie );
+	const wsw::InternedString *name = Com_FindInternedString( var_name );
+	if( !name ) {
+		return NULL;
+	}
 	QMutex_Lock( cvar_mutex );
-	Trie_Find( cvar_trie, var_name, TRIE_EXACT_MATCH, (void **)&cvar );
+	cvar = cvar_map.get( name );
 	QMutex_Unlock( cvar_mutex );
 	return cvar;
 }
@@ -134,10 +142,7 @@ cvar_t *Cvar_Get( const char *var_name, const char *var_value, cvar_flag_t flags
 		}
 	}
 
-	assert( cvar_trie );
-	QMutex_Lock( cvar_mutex );
-	Trie_Find( cvar_trie, var_name, TRIE_EXACT_MATCH, (void **)&var );
-	QMutex_Unlock( cvar_mutex );
+	var = Cvar_Find( var_name );
 
 	if( !var_value ) {
 		return NULL;
@@ -201,7 +206,9 @@ cvar_t *Cvar_Get( const char *var_name, const char *var_value, cvar_flag_t flags
 	var->flags = flags;
 	Cvar_SetModified( var );
 
+	const wsw::InternedString *name = Com_InternString( var_name );
 	QMutex_Lock( cvar_mutex );
+	cvar_map.set( name, var );
 	Trie_Insert( cvar_trie, var_name, var );
 	QMutex_Unlock( cvar_mutex );
 
@@ -914,6 +921,7 @@ void Cvar_Shutdown( void ) {
 		assert( cvar_trie );
 
 		QMutex_Lock( cvar_mutex );
+		cvar_map.clear();
 		Trie_Destroy( cvar_trie );
 		QMutex_Unlock( cvar_mutex );
 		cvar_trie = NULL;
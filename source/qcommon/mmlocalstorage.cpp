@@ -90,6 +90,12 @@ public:
 		return Exec( "begin exclusive" );
 	}
 
+	bool BeginForReading() {
+		// A deferred transaction reads a snapshot of the database
+		// and does not prevent other connections from writing in the WAL journal mode.
+		return Exec( "begin deferred" );
+	}
+
 	bool Commit() { return Exec( "commit" ); }
 	bool Rollback() { return Exec( "rollback" ); }
 };
@@ -202,38 +208,58 @@ template <> bool SQLiteBindArg( sqlite3_stmt *stmt, int index, const int &value
 	return false;
 }
 
+/**
+ * Returns a statement of the connection that has been prepared for the same SQL text before
+ * or prepares a new one if there is no such statement.
+ * Statements are kept until the connection gets deleted, so the connection acts as a statement cache
+ * and reusing a long-living connection saves parsing and planning of frequently executed statements.
+ * @note all statements of our connections are acquired this way and must be reset after use.
+ */
+static sqlite3_stmt *SQLiteGetCachedStmt( DBConnection connection, const char *sql ) {
+	for( sqlite3_stmt *stmt = ::sqlite3_next_stmt( connection, nullptr ); stmt; stmt = ::sqlite3_next_stmt( connection, stmt ) ) {
+		if( !::strcmp( ::sqlite3_sql( stmt ), sql ) ) {
+			assert( !::sqlite3_stmt_busy( stmt ) );
+			return stmt;
+		}
+	}
+
+	const char *tag = "SQLiteGetCachedStmt()";
+	Com_DPrintf( "%s: About to prepare `%s`\n", tag, sql );
+
+	sqlite3_stmt *stmt = nullptr;
+	const int code = ::sqlite3_prepare_v2( connection, sql, -1, &stmt, nullptr );
+	if( code == SQLITE_OK ) {
+		return stmt;
+	}
+
+	const char *format = S_COLOR_RED "%s: An error `%s` occurred while trying to prepare `%s`\n";
+	Com_Printf( format, tag, ::sqlite3_errstr( code ), sql );
+	return nullptr;
+}
+
+/**
+ * Resets a cached statement so it can be reused by the next {@code SQLiteGetCachedStmt()} call.
+ */
+static void SQLiteReleaseCachedStmt( sqlite3_stmt *stmt ) {
+	// An error code of the last step is returned again, it has been already reported
+	(void)::sqlite3_reset( stmt );
+	(void)::sqlite3_clear_bindings( stmt );
+}
+
 /**
  * Defines a helper for insertion of multiple rows sequentially
  * given a statement for instertion of a single row.
  */
 class SQLiteInsertAdapter : public SQLiteAdapter {
-	sqlite3_stmt *stmt { nullptr };
+	sqlite3_stmt *const stmt;
 public:
 	SQLiteInsertAdapter( DBConnection connection_, const char *sql_ )
-		: SQLiteAdapter( connection_ ) {
-		const int code = ::sqlite3_prepare_v2( connection_, sql_, -1, &stmt, nullptr );
-		if( code == SQLITE_OK ) {
-			return;
-		}
-
-		const char *tag = "SQLiteInsertAdapter::SQLiteInsertAdapter()";
-		const char *format = S_COLOR_RED "%s: An error `%s` occurred while trying to prepare `%s`\n";
-		Com_Printf( format, tag, ::sqlite3_errstr( code ), sql_ );
-	}
+		: SQLiteAdapter( connection_ ), stmt( SQLiteGetCachedStmt( connection_, sql_ ) ) {}
 
 	~SQLiteInsertAdapter() {
-		if( !stmt ) {
-			return;
-		}
-
-		const int code = ::sqlite3_finalize( stmt );
-		if( code == SQLITE_OK ) {
-			return;
+		if( stmt ) {
+			SQLiteReleaseCachedStmt( stmt );
 		}
-
-		const char *tag = "SQLiteInsertAdapter::~SQLiteInsertAdapter()";
-		const char *format = S_COLOR_RED "%s: An error `%s` occurred while trying to finalize a statement\n";
-		Com_Printf( format, tag, ::sqlite3_errstr( code ) );
 	}
 
 	// OK lets just add a specialization for the actually used call singature...
@@ -301,22 +327,28 @@ public:
  * A helper for retrieval of rows produced by a SELECT query.
  */
 class SQLiteSelectAdapter : public SQLiteAdapter {
-	sqlite3_stmt *stmt { nullptr };
+	sqlite3_stmt *stmt;
 public:
 	using RowConsumer = std::function<bool(const SQLiteRowReader &)>;
 
-#ifndef _MSC_VER
-	SQLiteSelectAdapter( DBConnection connection, const char *format, ... ) __attribute__( ( format( printf, 3, 4 ) ) );
-#else
-	SQLiteSelectAdapter( DBConnection connection, _Printf_format_string_ const char *format, ... );
-#endif
+	SQLiteSelectAdapter( DBConnection connection_, const char *sql_ )
+		: SQLiteAdapter( connection_ ), stmt( SQLiteGetCachedStmt( connection_, sql_ ) ) {}
 
 	~SQLiteSelectAdapter() {
 		if( stmt ) {
-			::sqlite3_finalize( stmt );
+			SQLiteReleaseCachedStmt( stmt );
 		}
 	}
 
+	/**
+	 * Binds a query parameter, should be called before the first {@code Next()} call.
+	 * @param index a 1-based index of the parameter.
+	 */
+	template <typename T>
+	bool BindArg( int index, const T &value ) {
+		return stmt && SQLiteBindArg( stmt, index, value );
+	}
+
 	/**
 	 * Executes a query step and applies the {@code rowConsumer} if needed.
 	 * @param rowConsumer a {@code RowConsumer} that may process a supplied row.
@@ -339,7 +371,7 @@ public:
 
 		const char *format = S_COLOR_RED "SQLiteSelectAdapter::Next(): An error `%s` occurred while performing a step\n";
 		Com_Printf( format, ::sqlite3_errstr( code ) );
-		(void)::sqlite3_finalize( stmt );
+		SQLiteReleaseCachedStmt( stmt );
 		stmt = nullptr;
 		return -1;
 	}
@@ -364,26 +396,6 @@ public:
 	}
 };
 
-SQLiteSelectAdapter::SQLiteSelectAdapter( DBConnection connection_, const char *format, ... )
-	: SQLiteAdapter( connection_ ) {
-	char sql[2048];
-	va_list va;
-	va_start( va, format );
-	Q_vsnprintfz( sql, sizeof( sql ), format, va );
-	va_end( va );
-
-	const char *tag = "SQLiteSelectAdapter::SQLiteSelectAdapter()";
-	Com_DPrintf( "%s: About to prepare `%s`\n", tag, sql );
-
-	const int code = sqlite3_prepare_v2( connection, sql, -1, &stmt, nullptr );
-	if( code == SQLITE_OK ) {
-		return;
-	}
-
-	const char *messageFormat = S_COLOR_RED "%s: An error `%s` occurred while trying to prepare `%s`\n";
-	Com_Printf( messageFormat, tag, sql, ::sqlite3_errstr( code ) );
-}
-
 LocalReliableStorage::LocalReliableStorage( const char *databasePath_ ) {
 	// Actually never fails... or a failure is discovered immediately
 	this->databasePath = ::strdup( databasePath_ );
@@ -403,6 +415,13 @@ LocalReliableStorage::LocalReliableStorage( const char *databasePath_ ) {
 		Com_Error( ERR_FATAL, "%s: Can't create or check existence of tables\n", tag );
 	}
 
+	// A commit appends pages to the write-ahead log instead of writing a rollback journal and the database file,
+	// and the sender may read pending queries in a deferred transaction while the writer commits new reports.
+	// The journal mode is persistent, so setting it once for the database is sufficient.
+	if( !SQLiteExecAdapter( connection ).Exec( "pragma journal_mode=wal" ) ) {
+		Com_Printf( S_COLOR_YELLOW "%s: Can't switch the database to the WAL journal mode\n", tag );
+	}
+
 	Com_Printf( "A local reliable storage has been successfully initialized at `%s`\n", databasePath_ );
 }
 
@@ -422,6 +441,12 @@ DBConnection LocalReliableStorage::NewConnection() {
 }
 
 void LocalReliableStorage::DeleteConnection( DBConnection connection ) {
+	// Finalize cached statements (they must have been released to the moment of this call)
+	while( sqlite3_stmt *stmt = ::sqlite3_next_stmt( connection, nullptr ) ) {
+		assert( !::sqlite3_stmt_busy( stmt ) );
+		(void)::sqlite3_finalize( stmt );
+	}
+
 	const int code = ::sqlite3_close( connection );
 	if( code == SQLITE_OK ) {
 		return;
@@ -467,8 +492,25 @@ bool LocalReliableStorage::WithinTransaction( std::function<bool( DBConnection )
 		return false;
 	}
 
+	return WithinTransaction( connection, std::move( block ) );
+}
+
+bool LocalReliableStorage::WithinTransaction( DBConnection connection, std::function<bool( DBConnection )> &&block ) {
+	return WithinTransaction( connection, std::move( block ), false );
+}
+
+bool LocalReliableStorage::WithinReadTransaction( DBConnection connection, std::function<bool( DBConnection )> &&block ) {
+	return WithinTransaction( connection, std::move( block ), true );
+}
+
+bool LocalReliableStorage::WithinTransaction( DBConnection connection,
+											  std::function<bool( DBConnection )> &&block, bool forReading ) {
+	if( !connection ) {
+		return false;
+	}
+
 	SQLiteExecAdapter execAdapter( connection );
-	if( !execAdapter.Begin() ) {
+	if( !( forReading ? execAdapter.BeginForReading() : execAdapter.Begin() ) ) {
 		return false;
 	}
 
@@ -503,7 +545,21 @@ bool LocalReliableStorage::Push( DBConnection connection, QueryObject *query, in
 	// We must set this to be able to recover query_id from query results
 	query->SetField( "query_id", queryIdAsString );
 
-	return InsertPendingQuery( connection, query, priority ) && InsertQueryFields( connection, query );
+	// Many queries may be pushed in a single transaction.
+	// Make sure a failed query does not leave partially inserted rows that are going to be committed.
+	SQLiteExecAdapter adapter( connection );
+	assert( adapter.IsInTransaction() );
+	if( !adapter.Exec( "savepoint push_query" ) ) {
+		return false;
+	}
+
+	if( InsertPendingQuery( connection, query, priority ) && InsertQueryFields( connection, query ) ) {
+		return adapter.Exec( "release push_query" );
+	}
+
+	adapter.Exec( "rollback to push_query" );
+	adapter.Exec( "release push_query" );
+	return false;
 }
 
 bool LocalReliableStorage::InsertPendingQuery( DBConnection connection, const QueryObject *query, int priority ) {
@@ -536,26 +592,22 @@ bool LocalReliableStorage::InsertQueryFields( DBConnection connection, const Que
 	return true;
 }
 
-QueryObject *LocalReliableStorage::FetchNext( DBConnection connection, const char *queryOutgoingIp ) {
-	// This CTE selects a best numeric query priority value in the table
-	const char *priorityCte =
-		"select distinct query_priority as priority from pending_queries order by query_priority desc limit 1";
-
-	// This CTE selects id and url of a random query that has the previously selected priority
-	const char *chosenCte =
-		"select query_id, query_url from pending_queries "
-		"where exists (select 1 from top_priority where top_priority.priority = pending_queries.query_priority) "
-		"order by random() limit 1";
-
-	// Select all fields that belong to the chosen query.
-	// Return the url in the first row.
-	const char *sqlFormat =
-		"with top_priority as (%s), chosen as (%s) "
-		"select chosen.query_url, query_fields.field_name, query_fields.field_value "
+unsigned LocalReliableStorage::FetchNext( DBConnection connection, QueryObject **queries,
+										  unsigned maxQueries, const char *queryOutgoingIp ) {
+	// Choose queries of the best numeric priority first, choose randomly among queries of the same priority.
+	// Select all fields that belong to the chosen queries grouped by query ids in the same priority order.
+	// Return the query id and the url in every row.
+	const char *sql =
+		"with chosen as (select query_id, query_url, query_priority from pending_queries "
+		"order by query_priority desc, random() limit ?) "
+		"select chosen.query_id, chosen.query_url, query_fields.field_name, query_fields.field_value "
 		"from query_fields join chosen "
-		"on query_fields.query_id = chosen.query_id";
+		"on query_fields.query_id = chosen.query_id "
+		"order by chosen.query_priority desc, chosen.query_id";
 
-	QueryObject *query = nullptr;
+	unsigned numQueries = 0;
+	// An id of the query that is being filled (row data gets invalidated on the next step)
+	char queryId[UUID_BUFFER_SIZE] = { '\0' };
 
 	auto printReadRow = [&]( const char *name, const wsw::StringView &value ) {
 		constexpr const char *tag = "LocalReliableStorage::FetchNext()";
@@ -571,39 +623,46 @@ QueryObject *LocalReliableStorage::FetchNext( DBConnection connection, const cha
 	};
 
 	const auto rowConsumer = [&]( const SQLiteRowReader &reader ) -> bool {
-		assert( reader.NumColumns() == 3 );
-		if( !query ) {
-			auto url( reader.GetString( 0 ) );
+		assert( reader.NumColumns() == 4 );
+		const auto id( reader.GetString( 0 ) );
+		if( !numQueries || !id.equals( wsw::StringView( queryId ) ) ) {
+			if( numQueries == maxQueries || id.size() >= sizeof( queryId ) ) {
+				return false;
+			}
+			memcpy( queryId, id.data(), id.size() );
+			queryId[id.size()] = '\0';
+
+			auto url( reader.GetString( 1 ) );
 			printReadRow( "url", url );
-			query = QueryObject::PostQueryForUrl( url.data(), queryOutgoingIp );
-			if( !query ) {
+			if( !( queries[numQueries] = QueryObject::PostQueryForUrl( url.data(), queryOutgoingIp ) ) ) {
 				return false;
 			}
+			// This won't harm ... even if there was no an actual attachment
+			queries[numQueries]->hasConveredJsonToFormParam = true;
+			numQueries++;
 		}
-		const auto name( reader.GetString( 1 ) );
+		const auto name( reader.GetString( 2 ) );
 		printReadRow( "field name", name );
-		const auto value( reader.GetString( 2 ) );
+		const auto value( reader.GetString( 3 ) );
 		printReadRow( "field value", value );
-		query->SetField( name.data(), name.size(), value.data(), value.size() );
+		queries[numQueries - 1]->SetField( name.data(), name.size(), value.data(), value.size() );
 		return true;
 	};
 
-	SQLiteSelectAdapter adapter( connection, sqlFormat, priorityCte, chosenCte );
+	SQLiteSelectAdapter adapter( connection, sql );
 	assert( adapter.IsInTransaction() );
-	if( adapter.TryReadingAll( rowConsumer ) > 0 ) {
-		// At least a single row has been read so the query must have been created
-		assert( query );
-		// This won't harm ... even if there was no an actual attachment
-		query->hasConveredJsonToFormParam = true;
-		return query;
+	if( adapter.BindArg( 1, (int)maxQueries ) && adapter.TryReadingAll( rowConsumer ) > 0 ) {
+		// At least a single row has been read so a query must have been created
+		assert( numQueries );
+		return numQueries;
 	}
 
-	// The query does not get created if no rows are retrieved
-	if( query ) {
-		QueryObject::DeleteQuery( query );
+	// Queries do not get returned if reading has failed
+	for( unsigned i = 0; i < numQueries; ++i ) {
+		QueryObject::DeleteQuery( queries[i] );
 	}
 
-	return nullptr;
+	return 0;
 }
 
 const char *LocalReliableStorage::GetQueryId( const QueryObject *query ) {
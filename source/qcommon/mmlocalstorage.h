@@ -41,6 +41,7 @@ class LocalReliableStorage {
 	 * Deletes a database connection.
 	 * All resources tied to it (like statements, bound parameters, etc.)
 	 * must have been released to the moment of this call.
+	 * Prepared statements that are cached by the connection get finalized.
 	 */
 	void DeleteConnection( DBConnection connection );
 
@@ -58,9 +59,15 @@ class LocalReliableStorage {
 	 * A {@code Push(DBConnection, QueryObject *, int)} implementation helper
 	 */
 	bool InsertQueryFields( DBConnection connection, const QueryObject *query );
+
+	/**
+	 * A {@code WithinTransaction()} and {@code WithinReadTransaction()} implementation helper
+	 */
+	bool WithinTransaction( DBConnection connection, std::function<bool( DBConnection )> &&block, bool forReading );
 public:
 	/**
 	 * Tries to store a query in a database.
+	 * Many queries may be stored in a single transaction, a failed query does not leave partially stored data.
 	 * @param connection a connection that acts as a transaction context.
 	 * @param query a {@code QueryObject} that could be sent later via network.
 	 * @param priority a numeric priority of a query, zero by default.
@@ -72,13 +79,18 @@ public:
 	bool Push( DBConnection connection, QueryObject *query, int priority = 0 );
 
 	/**
-	 * Tries to fetch a random not-sent query.
+	 * Tries to fetch multiple not-sent queries so they can be sent concurrently.
+	 * Queries that have larger priorities are fetched first, queries of the same priority are chosen randomly.
+	 * Fetched queries are put in the buffer in the descending priority order.
 	 * @param connection a connection that acts as a transaction context. Must be in transaction.
-	 * @param queryOutgoingIp an outgoing IP to use for the query.
-	 * @return a query to send, null if nothing is retrieved.
-	 * The query should be released by a caller by using {@code QueryObject::DeleteQuery()}.
+	 * @param queries a buffer for fetched queries.
+	 * @param maxQueries a capacity of the buffer.
+	 * @param queryOutgoingIp an outgoing IP to use for queries.
+	 * @return a number of fetched queries, zero if nothing is retrieved.
+	 * Queries should be released by a caller by using {@code QueryObject::DeleteQuery()}.
 	 */
-	QueryObject *FetchNext( DBConnection connection, const char *queryOutgoingIp = nullptr );
+	unsigned FetchNext( DBConnection connection, QueryObject **queries,
+						unsigned maxQueries, const char *queryOutgoingIp = nullptr );
 
 	/**
 	 * Marks a query as sent (actually deletes it from pending queries).
@@ -102,6 +114,24 @@ public:
 	 * @return true if a transaction lifecycle has been completed successfully (begin/commit/rollback calls succeeded).
 	 */
 	bool WithinTransaction( std::function<bool( DBConnection )> &&block );
+
+	/**
+	 * Executes a block of a code within transaction using an existing connection.
+	 * Long-living connections keep prepared statements cached between transactions.
+	 * @param connection a connection that acts as a transaction context, the call fails if it is null.
+	 * @param block a block of a code that should return true if a transaction should be committed.
+	 * @return true if a transaction lifecycle has been completed successfully (begin/commit/rollback calls succeeded).
+	 */
+	bool WithinTransaction( DBConnection connection, std::function<bool( DBConnection )> &&block );
+
+	/**
+	 * Executes a block of a code that only reads data within a deferred transaction using an existing connection.
+	 * Unlike {@code WithinTransaction()} it does not lock out writers (the database is in the WAL journal mode).
+	 * @param connection a connection that acts as a transaction context, the call fails if it is null.
+	 * @param block a block of a code that should return true if a transaction should be committed.
+	 * @return true if a transaction lifecycle has been completed successfully (begin/commit/rollback calls succeeded).
+	 */
+	bool WithinReadTransaction( DBConnection connection, std::function<bool( DBConnection )> &&block );
 };
 
 #endif
@@ -79,16 +79,17 @@ ReliablePipe::BackgroundWriter::Handler ReliablePipe::BackgroundWriter::pipeHand
 unsigned ReliablePipe::BackgroundWriter::AddReportHandler( const void *data ) {
 	AddReportCmd cmd;
 	memcpy( &cmd, data, sizeof( AddReportCmd ) );
-	// Can block for a substantial amount of time
-	// (for several seconds awaiting for completion of uploader thread transaction)
-	cmd.self->AddReport( cmd.report );
+	// Reports get written after all currently enqueued commands are read
+	cmd.self->pendingReports.push_back( cmd.report );
 	return (unsigned)sizeof( AddReportCmd );
 }
 
 void ReliablePipe::BackgroundWriter::RunStep() {
-	Sys_Sleep( 32 );
-
-	QBufPipe_ReadCmds( pipe, pipeHandlers );
+	// Wake up on a report immediately but check for termination periodically
+	if( QBufPipe_WaitForCmds( pipe, 32 ) ) {
+		QBufPipe_ReadCmds( pipe, pipeHandlers );
+		WritePendingReports();
+	}
 }
 
 void ReliablePipe::BackgroundWriter::RunMessageLoop() {
@@ -102,27 +103,42 @@ void ReliablePipe::BackgroundWriter::RunMessageLoop() {
 	// or won't do another read-and-upload attempt, hence the database is not going to be locked.
 	// This call blocks until all reports (if any) are written to the database.
 	QBufPipe_ReadCmds( pipe, pipeHandlers );
+	WritePendingReports();
 }
 
-void ReliablePipe::BackgroundWriter::AddReport( QueryObject *report ) {
-	bool hasInsertionSucceeded = false;
+void ReliablePipe::BackgroundWriter::WritePendingReports() {
+	if( pendingReports.empty() ) {
+		return;
+	}
+
+	unsigned numFailedInsertions = 0;
 	auto block = [&]( DBConnection connection ) {
-		hasInsertionSucceeded = reliableStorage->Push( connection, report );
+		numFailedInsertions = 0;
+		for( QueryObject *report: pendingReports ) {
+			if( !reliableStorage->Push( connection, report ) ) {
+				numFailedInsertions++;
+			}
+		}
 		// Returning true means the transaction should be committed
 		return true;
 	};
 
-	constexpr const char *tag = "ReliablePipe::BackgroundWriter::AddReport()";
+	constexpr const char *tag = "ReliablePipe::BackgroundWriter::WritePendingReports()";
 
+	// Can block for a substantial amount of time
+	// (for several seconds awaiting for completion of uploader thread transaction)
 	for(;; ) {
-		bool hasTransactionSucceeded = reliableStorage->WithinTransaction( block );
+		bool hasTransactionSucceeded = reliableStorage->WithinTransaction( Connection(), block );
 		// TODO: investigate SQLite behaviour... this code is based purely on MVCC RDBMS habits...
 		if( hasTransactionSucceeded ) {
 			// TODO: can insertion really fail?
-			if( !hasInsertionSucceeded ) {
-				Com_Printf( S_COLOR_RED "%s: Dropping a report\n", tag );
+			if( numFailedInsertions ) {
+				Com_Printf( S_COLOR_RED "%s: Dropping %u of %u reports\n", tag, numFailedInsertions, (unsigned)pendingReports.size() );
+			}
+			for( QueryObject *report: pendingReports ) {
+				QueryObject::DeleteQuery( report );
 			}
-			QueryObject::DeleteQuery( report );
+			pendingReports.clear();
 			return;
 		}
 
@@ -138,72 +154,107 @@ void ReliablePipe::BackgroundSender::RunStep() {
 
 	constexpr const char *tag = "ReliablePipe::BackgroundSender::RunStep()";
 
-	unsigned sleepInterval = 667;
-	reliableStorage->WithinTransaction( [&]( DBConnection connection ) {
-		if( !( activeQuery = reliableStorage->FetchNext( connection ) ) ) {
-			// No active report is present in the database yet.
-			// Writer threads have plenty of time for performing their transactions in this case
-			sleepInterval = 1500;
-			// Returning true means the transaction should be committed
-			return true;
-		}
+	// Fetch queries in a short read transaction that does not lock out the writer.
+	// Only this thread removes pending queries, so fetched queries remain pending until marked by this thread.
+	const bool hasFetchSucceeded = reliableStorage->WithinReadTransaction( Connection(), [&]( DBConnection connection ) {
+		numActiveQueries = reliableStorage->FetchNext( connection, activeQueries, kMaxActiveQueries );
+		return true;
+	});
 
-		Com_Printf( "%s: About to send query and start polling status\n", tag );
+	if( !hasFetchSucceeded || !numActiveQueries ) {
+		DeleteActiveQueries();
+		// No active report is present in the database yet.
+		// Writer threads have plenty of time for performing their transactions in this case
+		Sys_Sleep( 1500 );
+		return;
+	}
+
+	Com_Printf( "%s: About to send %u queries and start polling status\n", tag, numActiveQueries );
 
-		activeQuery->SendForStatusPolling();
-		while( !activeQuery->IsReady() ) {
+	// Queries are executed concurrently by the same polling calls outside of any transaction
+	for( unsigned i = 0; i < numActiveQueries; ++i ) {
+		activeQueries[i]->SendForStatusPolling();
+	}
+	for( unsigned i = 0; i < numActiveQueries; ++i ) {
+		while( !activeQueries[i]->IsReady() ) {
 			Sys_Sleep( 16 );
 			QueryObject::Poll();
 		}
+	}
 
-		if( activeQuery->HasSucceeded() ) {
-			bool transactionResult;
-			if( CheckQueryResponse() ) {
-				transactionResult = reliableStorage->MarkAsSent( connection, activeQuery );
+	unsigned numRetries = 0;
+	auto markQueries = [&]( DBConnection connection ) {
+		numRetries = 0;
+		for( unsigned i = 0; i < numActiveQueries; ++i ) {
+			QueryObject *const query = activeQueries[i];
+			bool result;
+			if( query->HasSucceeded() ) {
+				if( CheckQueryResponse( query ) ) {
+					result = reliableStorage->MarkAsSent( connection, query );
+				} else {
+					result = reliableStorage->MarkAsFailed( connection, query );
+				}
+			} else if( query->ShouldRetry() ) {
+				// This is more useful for non-persistent/reliable queries like client login.
+				// In this scenario let's retry implicitly on next RunStep() call.
+				// Fetching the same report (with the same id) is not guaranteed
+				// but we should not rely on reports ordering.
+				numRetries++;
+				continue;
 			} else {
-				transactionResult = reliableStorage->MarkAsFailed( connection, activeQuery );
+				assert( query->IsReady() && !query->HasSucceeded() && !query->ShouldRetry() );
+				Com_Printf( "%s: A query execution has failed\n", tag );
+				result = reliableStorage->MarkAsFailed( connection, query );
+			}
+			if( !result ) {
+				// Request rolling back
+				return false;
 			}
-			sleepInterval = transactionResult ? 1500 : 750;
-			// Request committing or rolling back depending of result of this call
-			DeleteActiveQuery();
-			return transactionResult;
 		}
+		// Returning true means the transaction should be committed
+		return true;
+	};
 
-		// This is more useful for non-persistent/reliable queries like client login.
-		// In this scenario let's retry implicitly on next RunStep() call.
-		// Fetching the same report (with the same id) is not guaranteed
-		// but we should not rely on reports ordering.
-		// This is to give a breathe for writer thread that is possibly tries
-		// to open a transaction while we're still holding a database exclusive lock.
-		if( activeQuery->ShouldRetry() ) {
-			Com_Printf( "%s: A query retry is scheduled\n", tag );
-			DeleteActiveQuery();
-			return true;
+	// Wait for the writer that may hold the database lock for a short time.
+	// Queries that are not marked in the database are going to be sent again.
+	bool hasMarkingSucceeded = false;
+	while( !( hasMarkingSucceeded = reliableStorage->WithinTransaction( Connection(), markQueries ) ) ) {
+		if( CanTerminate() ) {
+			break;
 		}
+		Com_Printf( "%s: Awaiting for a database write access\n", tag );
+		Sys_Sleep( 72 );
+	}
 
-		assert( activeQuery->IsReady() && !activeQuery->HasSucceeded() && !activeQuery->ShouldRetry() );
+	if( numRetries ) {
+		Com_Printf( "%s: A retry of %u queries is scheduled\n", tag, numRetries );
+	}
 
-		// Request committing or rolling back depending of result of this call
-		Com_Printf( "%s: A query execution has failed\n", tag );
-		bool result = reliableStorage->MarkAsFailed( connection, activeQuery );
-		DeleteActiveQuery();
-		return result;
-	});
+	unsigned sleepInterval = 667;
+	if( !hasMarkingSucceeded ) {
+		sleepInterval = 750;
+	} else if( !numRetries && numActiveQueries == kMaxActiveQueries ) {
+		// There could be more pending queries, e.g. reports of a match that had many players
+		sleepInterval = 0;
+	} else if( !numRetries ) {
+		sleepInterval = 1500;
+	}
 
+	DeleteActiveQueries();
 	Sys_Sleep( sleepInterval );
 }
 
-bool ReliablePipe::BackgroundSender::CheckQueryResponse() {
-	assert( activeQuery && activeQuery->HasSucceeded() );
+bool ReliablePipe::BackgroundSender::CheckQueryResponse( QueryObject *query ) {
+	assert( query && query->HasSucceeded() );
 
 	constexpr const char *tag = "ReliablePipe::BackgroundSender::CheckQueryResponse()";
 
-	if( !activeQuery->RawResponse() ) {
+	if( !query->RawResponse() ) {
 		Com_Printf( S_COLOR_RED "%s: The query response is empty\n", tag );
 		return false;
 	}
 
-	const double status = activeQuery->GetRootDouble( "status", std::numeric_limits<double>::infinity() );
+	const double status = query->GetRootDouble( "status", std::numeric_limits<double>::infinity() );
 	if( !std::isfinite( status ) ) {
 		Com_Printf( S_COLOR_RED "%s: The query field `status` is missing or has an invalid format\n", tag );
 		return false;
@@ -214,7 +265,7 @@ bool ReliablePipe::BackgroundSender::CheckQueryResponse() {
 		return true;
 	}
 
-	const char *errorString = activeQuery->GetRootString( "error", "" );
+	const char *errorString = query->GetRootString( "error", "" );
 	if( !*errorString ) {
 		Com_Printf( S_COLOR_RED "%s: A query remote execution has failed\n", tag );
 		return false;
@@ -3,6 +3,8 @@
 
 #include "mmlocalstorage.h"
 
+#include <vector>
+
 class ReliablePipe {
 	friend class SVStatsowFacade;
 
@@ -17,11 +19,30 @@ class ReliablePipe {
 		std::atomic<bool> signaledForTermination { false };
 		const char *const logTag;
 		LocalReliableStorage *const reliableStorage;
+		/**
+		 * A connection that is kept open for the runner lifetime so prepared statements remain cached
+		 */
+		DBConnection connection { nullptr };
 
 		BackgroundRunner( const char *logTag_, LocalReliableStorage *reliableStorage_ )
 			: logTag( logTag_ ), reliableStorage( reliableStorage_ ) {}
 
-		virtual ~BackgroundRunner() = default;
+		virtual ~BackgroundRunner() {
+			if( connection ) {
+				reliableStorage->DeleteConnection( connection );
+			}
+		}
+
+		/**
+		 * Returns the runner connection opening it if needed.
+		 * @return a null value if the connection can't be opened right now.
+		 */
+		DBConnection Connection() {
+			if( !connection ) {
+				connection = reliableStorage->NewConnection();
+			}
+			return connection;
+		}
 
 		virtual bool CanTerminate() const {
 			return signaledForTermination.load( std::memory_order_relaxed );
@@ -41,9 +62,11 @@ class ReliablePipe {
 	/**
 	 * A {@code BackgroundRunner} that listens for match reports
 	 * delivered via a buffered pipe and tries to store reports in a transaction.
+	 * All reports that have been read from the pipe at once are stored in a single transaction.
 	 */
 	class BackgroundWriter final : public BackgroundRunner {
 		struct qbufPipe_s *const pipe;
+		std::vector<QueryObject *> pendingReports;
 	public:
 		BackgroundWriter( LocalReliableStorage *reliableStorage_, struct qbufPipe_s *pipe_ )
 			: BackgroundRunner( "BackgroundWriter", reliableStorage_ ), pipe( pipe_ ) {}
@@ -57,7 +80,7 @@ class ReliablePipe {
 			AddReportCmd( BackgroundWriter *self_, QueryObject *report_ ): id( 0 ), self( self_ ), report( report_ ) {}
 		};
 
-		void AddReport( QueryObject *report );
+		void WritePendingReports();
 
 		void RunMessageLoop() override;
 
@@ -70,24 +93,24 @@ class ReliablePipe {
 	};
 
 	/**
-	 * A {@code BackgroundRunner} that wraps in a transaction
-	 * reading non-sent queries from a storage, sending queries
-	 * over network and marking report delivery status in the storage.
+	 * A {@code BackgroundRunner} that reads non-sent queries from a storage in a short read transaction,
+	 * sends queries over network outside of any transaction
+	 * and marks report delivery status in the storage in a separate short write transaction.
+	 * Multiple queries are sent concurrently.
 	 */
 	class BackgroundSender final : public BackgroundRunner {
+		static constexpr unsigned kMaxActiveQueries = 16;
 		/**
-		 * A query we try to fill using form name-value pairs stored in database.
-		 * @note do not confuse with {@code BackgroundWriter::activeReport}.
+		 * Queries we try to fill using form name-value pairs stored in database.
 		 */
-		QueryObject *activeQuery { nullptr };
+		QueryObject *activeQueries[kMaxActiveQueries];
+		unsigned numActiveQueries { 0 };
 	public:
 		explicit BackgroundSender( LocalReliableStorage *reliableStorage_ )
 			: BackgroundRunner( "BackgroundSender", reliableStorage_ ) {}
 
 		~BackgroundSender() override {
-			if( activeQuery ) {
-				QueryObject::DeleteQuery( activeQuery );
-			}
+			DeleteActiveQueries();
 		}
 
 		/**
@@ -95,14 +118,15 @@ class ReliablePipe {
 		 * @return true if the server has really accepted the query.
 		 * Otherwise the query should be considered failed.
 		 */
-		bool CheckQueryResponse();
+		bool CheckQueryResponse( QueryObject *query );
 
 		void RunStep() override;
 
-		void DeleteActiveQuery() {
-			assert( activeQuery );
-			QueryObject::DeleteQuery( activeQuery );
-			activeQuery = nullptr;
+		void DeleteActiveQueries() {
+			for( unsigned i = 0; i < numActiveQueries; ++i ) {
+				QueryObject::DeleteQuery( activeQueries[i] );
+			}
+			numActiveQueries = 0;
 		}
 	};
 
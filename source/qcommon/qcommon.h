@@ -764,6 +764,35 @@ void *Q_realloc( void *buf, size_t newsize );
 void Q_free( void *buf );
 char *Q_strdup( const char *str );
 
+// memory tags of accounted allocations, see the "memstats" command
+typedef enum {
+	MEMTAG_FRAME,
+	MEMTAG_COMMANDS,
+	MEMTAG_CONSOLE,
+	MEMTAG_SNAPSHOTS,
+	MEMTAG_NETWORK,
+	MEMTAG_RENDERER,
+
+	MEMTAG_TOTAL
+} memtag_t;
+
+// accounted allocations are zeroed and aligned at least by 16 bytes,
+// they must be released by Q_TagFree() and resized by Q_TagRealloc() only
+void *Q_TagMalloc( size_t size, memtag_t tag );
+void *Q_TagMallocAligned( size_t size, size_t alignment, memtag_t tag );
+void *Q_TagRealloc( void *buf, size_t newsize, memtag_t tag );
+void Q_TagFree( void *buf );
+
+// a scratch memory that remains valid until the end of the current frame, main thread only
+void *Com_FrameAlloc( size_t size );
+
+namespace wsw { struct InternedString; }
+
+// the global table of names of cvars, commands and aliases, casing follows CON_CASE_SENSITIVE
+const wsw::InternedString *Com_InternString( const char *str );
+// returns null if the string has never been interned, so the name is unknown to all registries
+const wsw::InternedString *Com_FindInternedString( const char *str );
+
 void Qcommon_Init( int argc, char **argv );
 void Qcommon_Frame( unsigned int realMsec );
 void Qcommon_Shutdown( void );
@@ -21,6 +21,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "qcommon.h"
 #include "snap_write.h"
 #include "snap_tables.h"
+#include "wswallocators.h"
 #include "../gameshared/gs_public.h"
 #include "../gameshared/q_comref.h"
 
@@ -462,15 +463,18 @@ static bool SNAP_ViewDirCullEntity( const edict_t *clent, const edict_t *ent ) {
 //=====================================================================
 
 class SnapEntNumsList {
-	int nums[MAX_EDICTS];
-	bool added[MAX_EDICTS];
+	int *const nums;
+	bool *const added;
+	const int capacity;
 	int numEnts { 0 };
 	int maxNumSoFar { 0 };
 	bool isSorted { false };
 public:
-	SnapEntNumsList() {
-		memset( added, 0, sizeof( added ) );
-	}
+	// A list is built for every client every frame, so the (zeroed) arrays come from the frame arena
+	explicit SnapEntNumsList( int capacity_ )
+		: nums( (int *)Com_FrameAlloc( sizeof( int ) * capacity_ ) )
+		, added( (bool *)Com_FrameAlloc( sizeof( bool ) * capacity_ ) )
+		, capacity( capacity_ ) {}
 
 	const int *begin() const { assert( isSorted ); return nums; }
 	const int *end() const { assert( isSorted ); return nums + numEnts; }
@@ -483,11 +487,11 @@ public:
 void SnapEntNumsList::AddEntNum( int entNum ) {
 	assert( !isSorted );
 
-	if( entNum >= MAX_EDICTS ) {
+	if( entNum >= capacity ) {
 		return;
 	}
 	// silent ignore of overflood
-	if( numEnts >= MAX_EDICTS ) {
+	if( numEnts >= capacity ) {
 		return;
 	}
 
@@ -828,6 +832,13 @@ static void SNAP_BuildSnapEntitiesList( cmodel_state_t *cms, ginfo_t *gi,
 	}
 }
 
+static void *SNAP_AllocateFramesChunk( size_t size ) {
+	return Q_TagMalloc( size, MEMTAG_SNAPSHOTS );
+}
+
+// areabits and player states of client frames are reallocated by few typical sizes, so keep them in size classes
+static wsw::SizeClassAllocator snap_framesAllocator( { &SNAP_AllocateFramesChunk, &Q_TagFree } );
+
 /*
 * SNAP_BuildClientFrameSnap
 *
@@ -872,11 +883,10 @@ void SNAP_BuildClientFrameSnap( cmodel_state_t *cms, ginfo_t *gi, int64_t frameN
 		frame->numareas = numareas;
 
 		numareas *= CM_AreaRowSize( cms );
-		if( frame->areabits ) {
-			Q_free( frame->areabits );
-			frame->areabits = nullptr;
-		}
-		frame->areabits = (uint8_t*)Q_malloc( numareas );
+		snap_framesAllocator.deallocate( frame->areabits, frame->areabits_size );
+		frame->areabits = (uint8_t*)snap_framesAllocator.allocate( numareas );
+		frame->areabits_size = numareas;
+		memset( frame->areabits, 0, numareas );
 	}
 
 	// grab the current player_state_t
@@ -893,12 +903,8 @@ void SNAP_BuildClientFrameSnap( cmodel_state_t *cms, ginfo_t *gi, int64_t frameN
 	}
 
 	if( frame->ps_size < frame->numplayers ) {
-		if( frame->ps ) {
-			Q_free( frame->ps );
-			frame->ps = nullptr;
-		}
-
-		frame->ps = ( player_state_t* )Q_malloc( sizeof( player_state_t ) * frame->numplayers );
+		snap_framesAllocator.deallocate( frame->ps, sizeof( player_state_t ) * frame->ps_size );
+		frame->ps = ( player_state_t* )snap_framesAllocator.allocate( sizeof( player_state_t ) * frame->numplayers );
 		frame->ps_size = frame->numplayers;
 	}
 
@@ -918,7 +924,7 @@ void SNAP_BuildClientFrameSnap( cmodel_state_t *cms, ginfo_t *gi, int64_t frameN
 	}
 
 	// build up the list of visible entities
-	SnapEntNumsList list;
+	SnapEntNumsList list( gi->num_edicts );
 	SNAP_BuildSnapEntitiesList( cms, gi, clent, org, fatvis->skyorg, fatvis->pvs, frame, list, snapHintFlags );
 	list.Sort();
 
@@ -963,12 +969,9 @@ void SNAP_BuildClientFrameSnap( cmodel_state_t *cms, ginfo_t *gi, int64_t frameN
 }
 
 template <typename T>
-static inline void FreeAndNullify( T **p, int *size ) {
-	if( *p ) {
-		Q_free( *p );
-		*p = nullptr;
-	}
-	*size = 0;
+static inline void FreeAndNullify( T **p, size_t byteSize ) {
+	snap_framesAllocator.deallocate( *p, byteSize );
+	*p = nullptr;
 }
 
 /*
@@ -977,8 +980,10 @@ static inline void FreeAndNullify( T **p, int *size ) {
 * Free structs and arrays we allocated in SNAP_BuildClientFrameSnap
 */
 static void SNAP_FreeClientFrame( client_snapshot_t *frame ) {
-	FreeAndNullify( &frame->areabits, &frame->numareas );
-	FreeAndNullify( &frame->ps, &frame->ps_size );
+	FreeAndNullify( &frame->areabits, frame->areabits_size );
+	FreeAndNullify( &frame->ps, sizeof( player_state_t ) * frame->ps_size );
+	frame->numareas = frame->areabits_size = 0;
+	frame->ps_size = 0;
 }
 
 /*
@@ -0,0 +1,141 @@
+#include "aabbtreetest.h"
+#include "../wswaabbtree.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr unsigned kMaxEntities = 1024;
+
+struct Box {
+	float mins[3];
+	float maxs[3];
+};
+
+bool overlaps( const Box &a, const Box &b ) {
+	return a.mins[0] <= b.maxs[0] && a.mins[1] <= b.maxs[1] && a.mins[2] <= b.maxs[2] &&
+		   a.maxs[0] >= b.mins[0] && a.maxs[1] >= b.mins[1] && a.maxs[2] >= b.mins[2];
+}
+
+Box makeBox( float x, float y, float z, float halfWidth, float halfHeight ) {
+	return Box { { x - halfWidth, y - halfWidth, z - halfHeight }, { x + halfWidth, y + halfWidth, z + halfHeight } };
+}
+
+/**
+ * Triggers of a 4096x4096 units map and player boxes that touch them (including sweeps of fast moving players).
+ */
+struct TriggersScene {
+	std::vector<Box> triggers;
+	std::vector<Box> queries;
+
+	TriggersScene( unsigned seed, unsigned numTriggers ) {
+		std::mt19937 rng( seed );
+		std::uniform_real_distribution<float> coord( -2048.0f, 2048.0f );
+		for( unsigned i = 0; i < numTriggers; ++i ) {
+			const float halfWidth = 16.0f + (float)( rng() % 240 );
+			triggers.push_back( makeBox( coord( rng ), coord( rng ), coord( rng ) * 0.1f, halfWidth, 32.0f + (float)( rng() % 96 ) ) );
+		}
+		for( unsigned i = 0; i < 512; ++i ) {
+			const float halfWidth = ( i % 4 ) ? 16.0f : 48.0f;
+			queries.push_back( makeBox( coord( rng ), coord( rng ), coord( rng ) * 0.1f, halfWidth, 32.0f ) );
+		}
+	}
+};
+
+template <unsigned N>
+std::vector<unsigned> queryTree( const wsw::AabbTree<N> &tree, const Box &box ) {
+	std::vector<unsigned> result;
+	tree.query( box.mins, box.maxs, [&]( unsigned item ) { result.push_back( item ); } );
+	std::sort( result.begin(), result.end() );
+	return result;
+}
+
+}
+
+void AabbTreeTest::test_smallTrees() {
+	wsw::AabbTree<16> tree;
+	const Box box = makeBox( 0, 0, 0, 8, 8 );
+	QVERIFY( queryTree( tree, box ).empty() );
+
+	tree.add( 3, box.mins, box.maxs );
+	tree.build();
+	QCOMPARE( tree.size(), 1u );
+	QCOMPARE( queryTree( tree, box ), std::vector<unsigned>( { 3 } ) );
+	// Boundaries are inclusive
+	const Box touching = makeBox( 16, 0, 0, 8, 8 );
+	QCOMPARE( queryTree( tree, touching ), std::vector<unsigned>( { 3 } ) );
+	const Box distant = makeBox( 17, 0, 0, 8, 8 );
+	QVERIFY( queryTree( tree, distant ).empty() );
+
+	tree.disable( 3 );
+	QVERIFY( !tree.isEnabled( 3 ) );
+	QVERIFY( queryTree( tree, box ).empty() );
+	tree.enable( 3 );
+	QCOMPARE( queryTree( tree, box ), std::vector<unsigned>( { 3 } ) );
+	tree.disable( 3 );
+
+	for( unsigned i = 0; i < 5; ++i ) {
+		const Box other = makeBox( 32.0f * (float)i, 0, 0, 8, 8 );
+		tree.add( 10 + i, other.mins, other.maxs );
+	}
+	tree.build();
+	QVERIFY( tree.isEnabled( 3 ) );
+	QVERIFY( !tree.contains( 4 ) );
+	QCOMPARE( queryTree( tree, makeBox( 32, 0, 0, 24, 8 ) ), std::vector<unsigned>( { 3, 10, 11, 12 } ) );
+}
+
+void AabbTreeTest::test_matchesBruteForce() {
+	for( unsigned numTriggers: { 2u, 5u, 17u, 64u, 333u, 1000u } ) {
+		TriggersScene scene( numTriggers, numTriggers );
+		wsw::AabbTree<kMaxEntities> tree;
+		for( unsigned i = 0; i < numTriggers; ++i ) {
+			tree.add( i, scene.triggers[i].mins, scene.triggers[i].maxs );
+		}
+		tree.build();
+		for( unsigned i = 0; i < numTriggers; i += 7 ) {
+			tree.disable( i );
+		}
+
+		for( const Box &query: scene.queries ) {
+			std::vector<unsigned> expected;
+			for( unsigned i = 0; i < numTriggers; ++i ) {
+				if( i % 7 && overlaps( query, scene.triggers[i] ) ) {
+					expected.push_back( i );
+				}
+			}
+			QCOMPARE( queryTree( tree, query ), expected );
+		}
+	}
+}
+
+void AabbTreeTest::benchmark_triggerTouches_linearScan() {
+	TriggersScene scene( 1, 300 );
+	unsigned numFound = 0;
+	QBENCHMARK {
+		for( const Box &query: scene.queries ) {
+			for( const Box &trigger: scene.triggers ) {
+				numFound += overlaps( query, trigger ) ? 1 : 0;
+			}
+		}
+	}
+	QVERIFY( numFound > 0 );
+}
+
+void AabbTreeTest::benchmark_triggerTouches_aabbTree() {
+	TriggersScene scene( 1, 300 );
+	static wsw::AabbTree<kMaxEntities> tree;
+	tree.clear();
+	for( unsigned i = 0; i < scene.triggers.size(); ++i ) {
+		tree.add( i, scene.triggers[i].mins, scene.triggers[i].maxs );
+	}
+	tree.build();
+	unsigned numFound = 0;
+	QBENCHMARK {
+		for( const Box &query: scene.queries ) {
+			tree.query( query.mins, query.maxs, [&]( unsigned ) { numFound++; } );
+		}
+	}
+	QVERIFY( numFound > 0 );
+}
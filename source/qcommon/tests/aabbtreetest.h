@@ -0,0 +1,16 @@
+#ifndef WSW_AABBTREETEST_H
+#define WSW_AABBTREETEST_H
+
+#include <QtTest/QtTest>
+
+class AabbTreeTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_smallTrees();
+	void test_matchesBruteForce();
+	void benchmark_triggerTouches_linearScan();
+	void benchmark_triggerTouches_aabbTree();
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "allocatorstest.h"
+#include "../wswallocators.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr unsigned kNumLines = 500;
+
+struct HeapLines {
+	char *append( char *line, size_t len, char ch ) {
+		auto *result = (char *)std::realloc( line, len + 2 );
+		result[len] = ch;
+		result[len + 1] = '\0';
+		return result;
+	}
+	void release( char *line ) {
+		std::free( line );
+	}
+};
+
+struct SizeClassLines {
+	wsw::SizeClassAllocator allocator;
+
+	char *append( char *line, size_t len, char ch ) {
+		auto *result = (char *)allocator.reallocate( line, line ? len + 1 : 0, len + 2 );
+		result[len] = ch;
+		result[len + 1] = '\0';
+		return result;
+	}
+	void release( char *line ) {
+		allocator.deallocate( line, std::strlen( line ) + 1 );
+	}
+};
+
+/**
+ * Follows the pattern of console printing that appends characters to a scrollback line one by one
+ * and drops the oldest line once the scrollback is full.
+ */
+template <typename Lines>
+size_t printToScrollback( Lines *lines, char **scrollback, unsigned numPrintedLines ) {
+	size_t totalLen = 0;
+	for( unsigned i = 0; i < numPrintedLines; ++i ) {
+		char **slot = &scrollback[i % kNumLines];
+		if( *slot ) {
+			lines->release( *slot );
+			*slot = nullptr;
+		}
+		const size_t lineLen = 20 + ( i * 37 ) % 60;
+		for( size_t len = 0; len < lineLen; ++len ) {
+			*slot = lines->append( *slot, len, (char)( 'a' + ( len + i ) % 26 ) );
+		}
+		totalLen += lineLen;
+	}
+	return totalLen;
+}
+
+template <typename Lines>
+void releaseScrollback( Lines *lines, char **scrollback ) {
+	for( unsigned i = 0; i < kNumLines; ++i ) {
+		if( scrollback[i] ) {
+			lines->release( scrollback[i] );
+			scrollback[i] = nullptr;
+		}
+	}
+}
+
+}
+
+void AllocatorsTest::test_linearArenaAlignmentAndReset() {
+	wsw::LinearArena arena( 256 );
+	std::vector<uint8_t *> blocks;
+	for( int i = 0; i < 16; ++i ) {
+		const size_t alignment = i % 2 ? 64 : 16;
+		auto *block = (uint8_t *)arena.allocate( 24 + i, alignment );
+		QVERIFY( ( (uintptr_t)block % alignment ) == 0 );
+		// Blocks must not overlap
+		std::memset( block, i, 24 + i );
+		blocks.push_back( block );
+	}
+	for( int i = 0; i < 16; ++i ) {
+		for( int j = 0; j < 24 + i; ++j ) {
+			QCOMPARE( (int)blocks[i][j], i );
+		}
+	}
+
+	// Blocks of the frame do not fit a single chunk of the minimal size
+	const size_t reservedBytes = arena.reservedBytes();
+	QVERIFY( reservedBytes > 256 );
+	const size_t peakBytes = arena.peakBytes();
+	QCOMPARE( peakBytes, arena.usedBytes() );
+
+	arena.reset();
+	QCOMPARE( arena.usedBytes(), (size_t)0 );
+	QCOMPARE( arena.reservedBytes(), reservedBytes );
+	// The same workload should fit the coalesced chunk
+	for( int i = 0; i < 16; ++i ) {
+		(void)arena.allocate( 24 + i, i % 2 ? 64 : 16 );
+	}
+	QCOMPARE( arena.reservedBytes(), reservedBytes );
+	QVERIFY( arena.peakBytes() >= peakBytes );
+
+	// Large blocks get dedicated chunks
+	auto *large = (uint8_t *)arena.allocate( 4096, 64 );
+	QVERIFY( ( (uintptr_t)large % 64 ) == 0 );
+	std::memset( large, 0, 4096 );
+
+	arena.clear();
+	QCOMPARE( arena.reservedBytes(), (size_t)0 );
+}
+
+void AllocatorsTest::test_sizeClassReuseAndReallocate() {
+	wsw::SizeClassAllocator allocator;
+	QCOMPARE( wsw::SizeClassAllocator::capacityOf( 1 ), (size_t)16 );
+	QCOMPARE( wsw::SizeClassAllocator::capacityOf( 17 ), (size_t)32 );
+	QCOMPARE( wsw::SizeClassAllocator::capacityOf( 1024 ), (size_t)1024 );
+	QCOMPARE( wsw::SizeClassAllocator::capacityOf( 1025 ), (size_t)1025 );
+
+	void *p1 = allocator.allocate( 20 );
+	void *p2 = allocator.allocate( 30 );
+	QVERIFY( p1 != p2 );
+	QVERIFY( ( (uintptr_t)p1 % wsw::SizeClassAllocator::kMinBlockSize ) == 0 );
+	QCOMPARE( allocator.usedBytes(), (size_t)64 );
+
+	allocator.deallocate( p1, 20 );
+	// The last released block of the class should be reused first
+	QVERIFY( allocator.allocate( 32 ) == p1 );
+
+	// Blocks stay in place while the size class remains the same
+	std::memcpy( p2, "0123456789", 11 );
+	QVERIFY( allocator.reallocate( p2, 30, 17 ) == p2 );
+	char *p3 = (char *)allocator.reallocate( p2, 17, 100 );
+	QVERIFY( p3 != p2 );
+	QCOMPARE( std::strcmp( p3, "0123456789" ), 0 );
+	QCOMPARE( allocator.usedBytes(), (size_t)( 32 + 128 ) );
+
+	char *p4 = (char *)allocator.reallocate( p3, 100, 2000 );
+	QCOMPARE( std::strcmp( p4, "0123456789" ), 0 );
+	QCOMPARE( allocator.usedBytes(), (size_t)( 32 + 2000 ) );
+
+	allocator.deallocate( p1, 32 );
+	allocator.deallocate( p4, 2000 );
+	QCOMPARE( allocator.usedBytes(), (size_t)0 );
+	const size_t reservedBytes = allocator.reservedBytes();
+	QVERIFY( reservedBytes > 0 );
+	// Released blocks are sufficient for the same allocations
+	allocator.deallocate( allocator.allocate( 20 ), 20 );
+	allocator.deallocate( allocator.allocate( 100 ), 100 );
+	QCOMPARE( allocator.reservedBytes(), reservedBytes );
+}
+
+void AllocatorsTest::benchmark_consoleLines_heap() {
+	HeapLines lines;
+	char *scrollback[kNumLines] {};
+	size_t totalLen = 0;
+	QBENCHMARK {
+		totalLen = printToScrollback( &lines, scrollback, 2 * kNumLines );
+	}
+	QVERIFY( totalLen > 0 && scrollback[0][0] == 'a' + ( kNumLines % 26 ) );
+	releaseScrollback( &lines, scrollback );
+}
+
+void AllocatorsTest::benchmark_consoleLines_sizeClasses() {
+	SizeClassLines lines;
+	char *scrollback[kNumLines] {};
+	size_t totalLen = 0;
+	QBENCHMARK {
+		totalLen = printToScrollback( &lines, scrollback, 2 * kNumLines );
+	}
+	QVERIFY( totalLen > 0 && scrollback[0][0] == 'a' + ( kNumLines % 26 ) );
+	releaseScrollback( &lines, scrollback );
+	QCOMPARE( lines.allocator.usedBytes(), (size_t)0 );
+}
@@ -0,0 +1,16 @@
+#ifndef WSW_ALLOCATORSTEST_H
+#define WSW_ALLOCATORSTEST_H
+
+#include <QtTest/QtTest>
+
+class AllocatorsTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_linearArenaAlignmentAndReset();
+	void test_sizeClassReuseAndReallocate();
+	void benchmark_consoleLines_heap();
+	void benchmark_consoleLines_sizeClasses();
+};
+
+#endif
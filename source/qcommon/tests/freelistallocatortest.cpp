@@ -0,0 +1,225 @@
+#include "freelistallocatortest.h"
+#include "../wswfreelistallocator.h"
+#include "../wswpooledstrings.h"
+
+#include <cstring>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+// Mirrors the layout of script strings
+struct TestString {
+	char *buffer;
+	unsigned len, size;
+	int refCount;
+};
+
+using TestStringsPool = wsw::PooledStrings<TestString>;
+
+struct HeapStrings {
+	TestString *alloc( unsigned size ) {
+		auto *s = new TestString;
+		s->buffer = new char[size];
+		s->size = size;
+		return s;
+	}
+	void release( TestString *s ) {
+		delete[] s->buffer;
+		delete s;
+	}
+};
+
+struct PooledStrings {
+	TestStringsPool pool;
+
+	TestString *alloc( unsigned size ) { return pool.allocate( size ); }
+	void release( TestString *s ) { pool.deallocate( s ); }
+};
+
+bool isInlineBufferOf( const TestString *s ) {
+	return s->buffer == (const char *)s + sizeof( TestString );
+}
+
+template <typename Strings>
+TestString *add( Strings *strings, const TestString *first, const char *second ) {
+	const unsigned secondLen = (unsigned)std::strlen( second );
+	TestString *result = strings->alloc( first->len + secondLen + 1 );
+	std::memcpy( result->buffer, first->buffer, first->len );
+	std::memcpy( result->buffer + first->len, second, secondLen + 1 );
+	result->len = first->len + secondLen;
+	return result;
+}
+
+/**
+ * Follows the sequence of string operations of the scoreboard message building code of stock gametype scripts:
+ * {@code entry = "&p " + playerID + " " + clanName + " " + score + " " + ping + " " + readyIcon + " "; }
+ * Every {@code +} produces a temporary string that is released right after the next one is built.
+ */
+template <typename Strings>
+unsigned buildScoreboard( Strings *strings, char *message, unsigned maxLen ) {
+	const char *clanNames[] = { "", "wsw", "clan^1red", "^7longer clan name" };
+	unsigned messageLen = 0;
+	char number[16];
+	for( int playerNum = 0; playerNum < 64; ++playerNum ) {
+		TestString *entry = strings->alloc( 4 );
+		std::memcpy( entry->buffer, "&p ", 4 );
+		entry->len = 3;
+		std::snprintf( number, sizeof( number ), "%d", playerNum );
+		const char *parts[] = { number, " ", clanNames[playerNum % 4], " ", "137", " ", "48", " ", "1", " " };
+		for( const char *part: parts ) {
+			TestString *next = add( strings, entry, part );
+			strings->release( entry );
+			entry = next;
+		}
+		if( messageLen + entry->len < maxLen ) {
+			std::memcpy( message + messageLen, entry->buffer, entry->len + 1 );
+			messageLen += entry->len;
+		}
+		strings->release( entry );
+	}
+	return messageLen;
+}
+
+}
+
+void FreelistAllocatorTest::test_reuseOfReleasedBlocks() {
+	wsw::FreelistAllocator<24, 4> allocator;
+	void *p1 = allocator.allocate();
+	void *p2 = allocator.allocate();
+	QVERIFY( p1 != p2 );
+	QCOMPARE( allocator.allocatedBlocks(), (size_t)2 );
+
+	allocator.deallocate( p1 );
+	QCOMPARE( allocator.allocatedBlocks(), (size_t)1 );
+	// The last released block should be reused first
+	QVERIFY( allocator.allocate() == p1 );
+	QCOMPARE( allocator.reservedBlocks(), (size_t)4 );
+
+	allocator.deallocate( p1 );
+	allocator.deallocate( p2 );
+	QCOMPARE( allocator.allocatedBlocks(), (size_t)0 );
+}
+
+void FreelistAllocatorTest::test_growthByChunks() {
+	wsw::FreelistAllocator<40, 8> allocator;
+	std::vector<char *> blocks;
+	for( int i = 0; i < 20; ++i ) {
+		char *block = (char *)allocator.allocate();
+		// Blocks must not overlap
+		std::memset( block, i, 40 );
+		QVERIFY( ( (uintptr_t)block % alignof( std::max_align_t ) ) == 0 );
+		blocks.push_back( block );
+	}
+
+	QCOMPARE( allocator.allocatedBlocks(), (size_t)20 );
+	QCOMPARE( allocator.reservedBlocks(), (size_t)24 );
+	for( int i = 0; i < 20; ++i ) {
+		for( int j = 0; j < 40; ++j ) {
+			QCOMPARE( (int)blocks[i][j], i );
+		}
+	}
+
+	for( char *block: blocks ) {
+		allocator.deallocate( block );
+	}
+	// Released blocks are sufficient for the same number of allocations
+	for( int i = 0; i < 20; ++i ) {
+		(void)allocator.allocate();
+	}
+	QCOMPARE( allocator.reservedBlocks(), (size_t)24 );
+}
+
+void FreelistAllocatorTest::test_pooledStringsInlineBufferLimit() {
+	TestStringsPool pool;
+	QCOMPARE( TestStringsPool::kInlineBufferSize, (unsigned)( 64 - sizeof( TestString ) ) );
+
+	TestString *small = pool.allocate( TestStringsPool::kInlineBufferSize );
+	QVERIFY( isInlineBufferOf( small ) );
+	QCOMPARE( small->size, TestStringsPool::kInlineBufferSize );
+
+	TestString *large = pool.allocate( TestStringsPool::kInlineBufferSize + 1 );
+	QVERIFY( !isInlineBufferOf( large ) );
+	QCOMPARE( large->size, TestStringsPool::kInlineBufferSize + 1 );
+	// Heap buffers must be writable in full
+	std::memset( large->buffer, 'x', large->size );
+
+	QCOMPARE( pool.allocatedStrings(), (size_t)2 );
+	pool.deallocate( small );
+	pool.deallocate( large );
+	QCOMPARE( pool.allocatedStrings(), (size_t)0 );
+}
+
+void FreelistAllocatorTest::test_pooledStringsAppendGrowth() {
+	TestStringsPool pool;
+	TestString *s = pool.allocate( 1 );
+	s->len = 0;
+	s->buffer[0] = '\0';
+
+	std::vector<char> expected;
+	unsigned numReallocations = 0;
+	for( int i = 0; i < 1000; ++i ) {
+		const char ch = (char)( 'a' + i % 26 );
+		const char *oldBuffer = s->buffer;
+		const unsigned oldSize = s->size;
+		pool.append( s, &ch, 1 );
+		expected.push_back( ch );
+		if( s->buffer != oldBuffer ) {
+			numReallocations++;
+			// The capacity must grow at least twice
+			QVERIFY( s->size >= 2 * oldSize );
+		}
+	}
+
+	QCOMPARE( s->len, 1000u );
+	QVERIFY( s->size > s->len );
+	QVERIFY( !std::memcmp( s->buffer, expected.data(), expected.size() ) );
+	QCOMPARE( s->buffer[s->len], '\0' );
+	// 40 -> 80 -> ... -> 1280 for 64-bit builds
+	QVERIFY( numReallocations <= 6 );
+
+	pool.deallocate( s );
+}
+
+void FreelistAllocatorTest::test_pooledStringsAppendOfOwnChars() {
+	TestStringsPool pool;
+	TestString *s = pool.allocate( TestStringsPool::kInlineBufferSize );
+	const unsigned len = TestStringsPool::kInlineBufferSize - 1;
+	for( unsigned i = 0; i < len; ++i ) {
+		s->buffer[i] = (char)( 'A' + i % 26 );
+	}
+	s->buffer[len] = '\0';
+	s->len = len;
+
+	// The inline buffer is full, so the appended chars are copied from the released buffer
+	pool.append( s, s->buffer, s->len );
+	QVERIFY( !isInlineBufferOf( s ) );
+	QCOMPARE( s->len, 2 * len );
+	for( unsigned i = 0; i < s->len; ++i ) {
+		QCOMPARE( s->buffer[i], (char)( 'A' + ( i % len ) % 26 ) );
+	}
+	QCOMPARE( s->buffer[s->len], '\0' );
+
+	pool.deallocate( s );
+}
+
+void FreelistAllocatorTest::benchmark_scoreboardStrings_heap() {
+	HeapStrings strings;
+	char message[4096];
+	unsigned len = 0;
+	QBENCHMARK {
+		len = buildScoreboard( &strings, message, sizeof( message ) );
+	}
+	QVERIFY( len > 0 && !std::strncmp( message, "&p 0  137 48 1 &p 1 wsw", 23 ) );
+}
+
+void FreelistAllocatorTest::benchmark_scoreboardStrings_freelist() {
+	PooledStrings strings;
+	char message[4096];
+	unsigned len = 0;
+	QBENCHMARK {
+		len = buildScoreboard( &strings, message, sizeof( message ) );
+	}
+	QVERIFY( len > 0 && !std::strncmp( message, "&p 0  137 48 1 &p 1 wsw", 23 ) );
+	QCOMPARE( strings.pool.allocatedStrings(), (size_t)0 );
+}
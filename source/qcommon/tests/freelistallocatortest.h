@@ -0,0 +1,19 @@
+#ifndef WSW_FREELISTALLOCATORTEST_H
+#define WSW_FREELISTALLOCATORTEST_H
+
+#include <QtTest/QtTest>
+
+class FreelistAllocatorTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_reuseOfReleasedBlocks();
+	void test_growthByChunks();
+	void test_pooledStringsInlineBufferLimit();
+	void test_pooledStringsAppendGrowth();
+	void test_pooledStringsAppendOfOwnChars();
+	void benchmark_scoreboardStrings_heap();
+	void benchmark_scoreboardStrings_freelist();
+};
+
+#endif
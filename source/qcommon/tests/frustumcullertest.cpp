@@ -0,0 +1,225 @@
+#include "frustumcullertest.h"
+#include "../wswfrustumculler.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Plane {
+	float normal[3];
+	float dist;
+};
+
+/**
+ * Mirrors a renderer leaf, bounds are accessed via an array of pointers to leaves
+ */
+struct Leaf {
+	int cluster, area;
+	float mins[3];
+	float maxs[3];
+	unsigned *visSurfaces;
+	unsigned *fragmentSurfaces;
+	unsigned numVisSurfaces;
+	unsigned numFragmentSurfaces;
+};
+
+/**
+ * Returns 1, 2 or 1 + 2 exactly like BoxOnPlaneSide() does
+ */
+int boxOnPlaneSide( const float *mins, const float *maxs, const Plane &p ) {
+	const float *const corner1[3] = { p.normal[0] < 0 ? mins : maxs, p.normal[1] < 0 ? mins : maxs, p.normal[2] < 0 ? mins : maxs };
+	const float *const corner2[3] = { p.normal[0] < 0 ? maxs : mins, p.normal[1] < 0 ? maxs : mins, p.normal[2] < 0 ? maxs : mins };
+	const float dist1 = p.normal[0] * corner1[0][0] + p.normal[1] * corner1[1][1] + p.normal[2] * corner1[2][2];
+	const float dist2 = p.normal[0] * corner2[0][0] + p.normal[1] * corner2[1][1] + p.normal[2] * corner2[2][2];
+	int sides = 0;
+	if( dist1 >= p.dist ) {
+		sides = 1;
+	}
+	if( dist2 < p.dist ) {
+		sides |= 2;
+	}
+	return sides;
+}
+
+/**
+ * Mirrors the scalar leaves culling loop of the renderer.
+ * @return 2 if the box is culled, 1 if it's partially visible, 0 if it's fully visible
+ */
+int classifyLeaf( const Leaf *leaf, const std::vector<Plane> &planes ) {
+	unsigned testFlags = ( 1u << planes.size() ) - 1;
+	for( unsigned i = 0; i < planes.size(); ++i ) {
+		const int clipped = boxOnPlaneSide( leaf->mins, leaf->maxs, planes[i] );
+		if( clipped == 2 ) {
+			return 2;
+		}
+		if( clipped == 1 ) {
+			testFlags &= ~( 1u << i );
+		}
+	}
+	return testFlags ? 1 : 0;
+}
+
+/**
+ * Builds side, top, bottom and far planes of a view frustum like the renderer does
+ */
+std::vector<Plane> makeFrustum( const float *origin, float yaw, float pitch, float fovX, float fovY, float farClip ) {
+	const float forward[3] = { std::cos( pitch ) * std::cos( yaw ), std::cos( pitch ) * std::sin( yaw ), -std::sin( pitch ) };
+	const float right[3] = { std::sin( yaw ), -std::cos( yaw ), 0.0f };
+	const float up[3] = {
+		right[1] * forward[2] - right[2] * forward[1],
+		right[2] * forward[0] - right[0] * forward[2],
+		right[0] * forward[1] - right[1] * forward[0]
+	};
+
+	std::vector<Plane> planes;
+	auto addPlane = [&]( const float *axis, float angle ) {
+		Plane p;
+		for( int i = 0; i < 3; ++i ) {
+			p.normal[i] = forward[i] * std::sin( angle ) + axis[i] * std::cos( angle );
+		}
+		p.dist = p.normal[0] * origin[0] + p.normal[1] * origin[1] + p.normal[2] * origin[2];
+		planes.push_back( p );
+	};
+	const float minusRight[3] = { -right[0], -right[1], -right[2] };
+	const float minusUp[3] = { -up[0], -up[1], -up[2] };
+	addPlane( minusRight, fovX * 0.5f );
+	addPlane( right, fovX * 0.5f );
+	addPlane( minusUp, fovY * 0.5f );
+	addPlane( up, fovY * 0.5f );
+
+	Plane farPlane;
+	for( int i = 0; i < 3; ++i ) {
+		farPlane.normal[i] = -forward[i];
+	}
+	farPlane.dist = farPlane.normal[0] * origin[0] + farPlane.normal[1] * origin[1] + farPlane.normal[2] * origin[2] - farClip;
+	planes.push_back( farPlane );
+	return planes;
+}
+
+/**
+ * Leaves of a 8192x8192 units map and frustums of a camera that walks along a circle and looks around
+ */
+struct Map {
+	std::vector<Leaf> leaves;
+	std::vector<Leaf *> visLeaves;
+	std::vector<float> bounds[6];
+	std::vector<std::vector<Plane>> cameraPath;
+
+	Map( unsigned seed, unsigned numLeaves, unsigned numFrames ) : leaves( numLeaves ) {
+		std::mt19937 rng( seed );
+		std::uniform_real_distribution<float> coord( -4096.0f, 4096.0f );
+		std::uniform_real_distribution<float> size( 16.0f, 512.0f );
+		for( Leaf &leaf: leaves ) {
+			for( int i = 0; i < 3; ++i ) {
+				leaf.mins[i] = coord( rng ) * ( i == 2 ? 0.25f : 1.0f );
+				leaf.maxs[i] = leaf.mins[i] + size( rng ) * ( i == 2 ? 0.5f : 1.0f );
+			}
+		}
+		// Leaves are allocated separately from other model data, so pointers do not follow the address order
+		for( unsigned i = 0; i < numLeaves; ++i ) {
+			visLeaves.push_back( &leaves[( i * 7919u ) % numLeaves] );
+		}
+		for( const Leaf *leaf: visLeaves ) {
+			for( int i = 0; i < 3; ++i ) {
+				bounds[i].push_back( leaf->mins[i] );
+				bounds[i + 3].push_back( leaf->maxs[i] );
+			}
+		}
+		// Padding for unmasked loads
+		for( std::vector<float> &array: bounds ) {
+			array.resize( numLeaves + 3, 0.0f );
+		}
+
+		for( unsigned frame = 0; frame < numFrames; ++frame ) {
+			const float t = 6.2831853f * (float)frame / (float)numFrames;
+			const float origin[3] = { 2048.0f * std::cos( t ), 2048.0f * std::sin( t ), 64.0f };
+			const float yaw = t * 3.0f, pitch = 0.3f * std::sin( t * 5.0f );
+			cameraPath.push_back( makeFrustum( origin, yaw, pitch, 1.5708f, 1.2f, 4096.0f + 2048.0f * ( frame % 2 ) ) );
+		}
+	}
+
+	const float *mins( int i ) const { return bounds[i].data(); }
+	const float *maxs( int i ) const { return bounds[i + 3].data(); }
+};
+
+void setupCuller( wsw::FrustumCuller *culler, const std::vector<Plane> &planes ) {
+	culler->clear();
+	for( const Plane &p: planes ) {
+		culler->addPlane( p.normal, p.dist );
+	}
+}
+
+unsigned countVisibleSoa( const Map &map, const wsw::FrustumCuller &culler ) {
+	const float *const mins[3] = { map.mins( 0 ), map.mins( 1 ), map.mins( 2 ) };
+	const float *const maxs[3] = { map.maxs( 0 ), map.maxs( 1 ), map.maxs( 2 ) };
+	static const unsigned kNumBits[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+	const unsigned numLeaves = (unsigned)map.visLeaves.size();
+	unsigned numVisible = 0;
+	for( unsigned first = 0; first < numLeaves; first += 4 ) {
+		unsigned culled, partial;
+		culler.classify4( mins, maxs, first, &culled, &partial );
+		const unsigned validMask = numLeaves - first >= 4 ? 0xF : ( 1u << ( numLeaves - first ) ) - 1;
+		// Fully visible leaves count twice like in the scalar version
+		numVisible += kNumBits[~culled & validMask] + kNumBits[~( culled | partial ) & validMask];
+	}
+	return numVisible;
+}
+
+}
+
+void FrustumCullerTest::test_matchesBoxOnPlaneSide() {
+	Map map( 1, 4093, 64 );
+	const float *const mins[3] = { map.mins( 0 ), map.mins( 1 ), map.mins( 2 ) };
+	const float *const maxs[3] = { map.maxs( 0 ), map.maxs( 1 ), map.maxs( 2 ) };
+	wsw::FrustumCuller culler;
+	unsigned numCulled = 0, numPartial = 0, numFull = 0;
+	for( const std::vector<Plane> &planes: map.cameraPath ) {
+		setupCuller( &culler, planes );
+		for( unsigned first = 0; first < map.visLeaves.size(); first += 4 ) {
+			unsigned culled, partial;
+			culler.classify4( mins, maxs, first, &culled, &partial );
+			for( unsigned lane = 0; lane < 4 && first + lane < map.visLeaves.size(); ++lane ) {
+				const int expected = classifyLeaf( map.visLeaves[first + lane], planes );
+				if( expected == 2 ) {
+					QVERIFY( culled & ( 1u << lane ) );
+					numCulled++;
+				} else {
+					QVERIFY( !( culled & ( 1u << lane ) ) );
+					QCOMPARE( ( partial >> lane ) & 1u, (unsigned)expected );
+					expected ? numPartial++ : numFull++;
+				}
+			}
+		}
+	}
+	// Make sure all cases have been tested
+	QVERIFY( numCulled && numPartial && numFull );
+}
+
+void FrustumCullerTest::benchmark_cameraPath_leafPointers() {
+	Map map( 2, 8192, 32 );
+	unsigned numVisible = 0;
+	QBENCHMARK {
+		for( const std::vector<Plane> &planes: map.cameraPath ) {
+			for( const Leaf *leaf: map.visLeaves ) {
+				const int clipped = classifyLeaf( leaf, planes );
+				numVisible += clipped == 2 ? 0 : ( clipped == 1 ? 1 : 2 );
+			}
+		}
+	}
+	QVERIFY( numVisible > 0 );
+}
+
+void FrustumCullerTest::benchmark_cameraPath_soaBounds() {
+	Map map( 2, 8192, 32 );
+	wsw::FrustumCuller culler;
+	unsigned numVisible = 0;
+	QBENCHMARK {
+		for( const std::vector<Plane> &planes: map.cameraPath ) {
+			setupCuller( &culler, planes );
+			numVisible += countVisibleSoa( map, culler );
+		}
+	}
+	QVERIFY( numVisible > 0 );
+}
@@ -0,0 +1,15 @@
+#ifndef WSW_FRUSTUMCULLERTEST_H
+#define WSW_FRUSTUMCULLERTEST_H
+
+#include <QtTest/QtTest>
+
+class FrustumCullerTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_matchesBoxOnPlaneSide();
+	void benchmark_cameraPath_leafPointers();
+	void benchmark_cameraPath_soaBounds();
+};
+
+#endif
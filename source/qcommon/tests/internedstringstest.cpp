@@ -0,0 +1,130 @@
+#include "internedstringstest.h"
+#include "../wswinternedstrings.h"
+#include "../q_trie.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * Makes names that resemble cvar names, they share few long common prefixes like real ones do
+ */
+std::vector<std::string> makeNames() {
+	const char *prefixes[] = { "cg_", "r_", "sv_", "g_", "ui_", "snd_", "cl_", "con_", "net_", "fs_" };
+	const char *words[] = { "draw", "fov", "weapon", "crosshair", "hud", "team", "model", "skin", "color", "scale" };
+	std::vector<std::string> names;
+	char buffer[64];
+	for( const char *prefix: prefixes ) {
+		for( const char *first: words ) {
+			for( int i = 0; i < 8; ++i ) {
+				std::snprintf( buffer, sizeof( buffer ), "%s%s%s%d", prefix, first, words[i], i );
+				names.push_back( buffer );
+			}
+		}
+	}
+	return names;
+}
+
+}
+
+void InternedStringsTest::test_internReturnsSameHandles() {
+	wsw::StringInterner interner( false );
+	const wsw::InternedString *first = interner.intern( "cg_fov" );
+	const wsw::InternedString *second = interner.intern( "r_drawworld" );
+	QVERIFY( first != second );
+	QVERIFY( interner.intern( "cg_fov" ) == first );
+	QCOMPARE( interner.size(), (size_t)2 );
+	QCOMPARE( first->length, (uint32_t)6 );
+	QCOMPARE( first->index, (uint32_t)0 );
+	QCOMPARE( second->index, (uint32_t)1 );
+	QVERIFY( interner.find( "cg_fov" ) == first );
+	QVERIFY( interner.find( "CG_FOV" ) == nullptr );
+	QVERIFY( interner.find( "cg_fo" ) == nullptr );
+
+	// Handles must stay valid while the table grows
+	const std::vector<std::string> names = makeNames();
+	for( const std::string &name: names ) {
+		(void)interner.intern( name.c_str() );
+	}
+	QVERIFY( interner.find( "cg_fov" ) == first );
+	QVERIFY( !std::strcmp( first->chars, "cg_fov" ) );
+	for( const std::string &name: names ) {
+		const wsw::InternedString *string = interner.find( name.c_str() );
+		QVERIFY( string && !std::strcmp( string->chars, name.c_str() ) );
+	}
+}
+
+void InternedStringsTest::test_findIgnoresCase() {
+	wsw::StringInterner interner( true );
+	const wsw::InternedString *string = interner.intern( "Cg_Fov" );
+	QVERIFY( interner.find( "cg_fov" ) == string );
+	QVERIFY( interner.find( "CG_FOV" ) == string );
+	QVERIFY( interner.intern( "cG_fOV" ) == string );
+	// The first spelling is kept
+	QVERIFY( !std::strcmp( string->chars, "Cg_Fov" ) );
+	QVERIFY( interner.find( "cg_fov_" ) == nullptr );
+}
+
+void InternedStringsTest::test_mapByHandles() {
+	wsw::StringInterner interner( true );
+	wsw::InternedStringMap<int> map;
+	int values[] = { 1, 2 };
+	const wsw::InternedString *first = interner.intern( "first" );
+	const wsw::InternedString *second = interner.intern( "second" );
+	QVERIFY( map.get( first ) == nullptr );
+	QVERIFY( map.get( nullptr ) == nullptr );
+
+	map.set( second, &values[1] );
+	QVERIFY( map.get( first ) == nullptr );
+	QVERIFY( map.get( interner.find( "SECOND" ) ) == &values[1] );
+
+	map.set( first, &values[0] );
+	QVERIFY( map.get( first ) == &values[0] );
+	QVERIFY( map.remove( first ) == &values[0] );
+	QVERIFY( map.remove( first ) == nullptr );
+	QVERIFY( map.get( second ) == &values[1] );
+
+	map.clear();
+	QVERIFY( map.get( second ) == nullptr );
+}
+
+void InternedStringsTest::benchmark_lookup_trie() {
+	const std::vector<std::string> names = makeNames();
+	trie_t *trie;
+	Trie_Create( TRIE_CASE_INSENSITIVE, &trie );
+	for( const std::string &name: names ) {
+		Trie_Insert( trie, name.c_str(), (void *)&name );
+	}
+
+	size_t numFound = 0;
+	QBENCHMARK {
+		numFound = 0;
+		for( const std::string &name: names ) {
+			void *value = nullptr;
+			numFound += Trie_Find( trie, name.c_str(), TRIE_EXACT_MATCH, &value ) == TRIE_OK && value == &name;
+		}
+	}
+	QCOMPARE( numFound, names.size() );
+
+	Trie_Destroy( trie );
+}
+
+void InternedStringsTest::benchmark_lookup_interned() {
+	const std::vector<std::string> names = makeNames();
+	wsw::StringInterner interner( true );
+	wsw::InternedStringMap<const std::string> map;
+	for( const std::string &name: names ) {
+		map.set( interner.intern( name.c_str() ), &name );
+	}
+
+	size_t numFound = 0;
+	QBENCHMARK {
+		numFound = 0;
+		for( const std::string &name: names ) {
+			numFound += map.get( interner.find( name.c_str() ) ) == &name;
+		}
+	}
+	QCOMPARE( numFound, names.size() );
+}
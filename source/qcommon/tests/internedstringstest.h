@@ -0,0 +1,17 @@
+#ifndef WSW_INTERNEDSTRINGSTEST_H
+#define WSW_INTERNEDSTRINGSTEST_H
+
+#include <QtTest/QtTest>
+
+class InternedStringsTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_internReturnsSameHandles();
+	void test_findIgnoresCase();
+	void test_mapByHandles();
+	void benchmark_lookup_trie();
+	void benchmark_lookup_interned();
+};
+
+#endif
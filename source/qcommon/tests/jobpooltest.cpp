@@ -0,0 +1,83 @@
+#include "jobpooltest.h"
+#include "../wswjobpool.h"
+
+#include <atomic>
+#include <memory>
+
+namespace {
+
+/**
+ * Counts calls for every item and checks that ranges are valid
+ */
+struct CoverageJob {
+	std::unique_ptr<std::atomic<int>[]> counts;
+	const unsigned numItems, rangeSize, numThreads;
+	std::atomic<int> numErrors { 0 };
+
+	CoverageJob( unsigned numItems_, unsigned rangeSize_, unsigned numThreads_ )
+		: counts( new std::atomic<int>[numItems_] ), numItems( numItems_ ), rangeSize( rangeSize_ ), numThreads( numThreads_ ) {
+		for( unsigned i = 0; i < numItems; ++i ) {
+			counts[i] = 0;
+		}
+	}
+
+	void operator()( unsigned first, unsigned count, unsigned threadNum ) {
+		if( !count || count > rangeSize || first + count > numItems || threadNum >= numThreads ) {
+			numErrors++;
+			return;
+		}
+		for( unsigned i = first; i < first + count; ++i ) {
+			counts[i]++;
+		}
+	}
+
+	bool coversAllItemsOnce() const {
+		for( unsigned i = 0; i < numItems; ++i ) {
+			if( counts[i] != 1 ) {
+				return false;
+			}
+		}
+		return !numErrors;
+	}
+};
+
+}
+
+void JobPoolTest::test_coversAllItemsOnce() {
+	wsw::JobPool pool( 3 );
+	for( unsigned numItems: { 1u, 63u, 64u, 65u, 1000u, 10007u } ) {
+		for( unsigned rangeSize: { 1u, 7u, 64u, 4096u } ) {
+			CoverageJob job( numItems, rangeSize, pool.numThreads() );
+			pool.run( numItems, rangeSize, job );
+			QVERIFY( job.coversAllItemsOnce() );
+		}
+	}
+}
+
+void JobPoolTest::test_runsSingleRangeOnCaller() {
+	wsw::JobPool pool( 3 );
+	unsigned numCalls = 0, numItems = 0;
+	const std::thread::id callerId = std::this_thread::get_id();
+	bool runsOnCaller = true;
+	pool.run( 100, 100, [&]( unsigned first, unsigned count, unsigned threadNum ) {
+		numCalls++;
+		numItems += count;
+		runsOnCaller &= threadNum == 0 && first == 0 && std::this_thread::get_id() == callerId;
+	});
+	QCOMPARE( numCalls, 1u );
+	QCOMPARE( numItems, 100u );
+	QVERIFY( runsOnCaller );
+	// Nothing should be called for an empty job
+	pool.run( 0, 100, [&]( unsigned, unsigned, unsigned ) { numCalls++; });
+	QCOMPARE( numCalls, 1u );
+}
+
+void JobPoolTest::test_restartsWorkersAfterStop() {
+	wsw::JobPool pool( 2 );
+	for( int i = 0; i < 3; ++i ) {
+		CoverageJob job( 5000, 16, pool.numThreads() );
+		pool.run( 5000, 16, job );
+		QVERIFY( job.coversAllItemsOnce() );
+		pool.stop();
+	}
+}
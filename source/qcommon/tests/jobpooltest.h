@@ -0,0 +1,15 @@
+#ifndef WSW_JOBPOOLTEST_H
+#define WSW_JOBPOOLTEST_H
+
+#include <QtTest/QtTest>
+
+class JobPoolTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_coversAllItemsOnce();
+	void test_runsSingleRangeOnCaller();
+	void test_restartsWorkersAfterStop();
+};
+
+#endif
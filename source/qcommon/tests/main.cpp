@@ -1,10 +1,22 @@
+#include "aabbtreetest.h"
+#include "allocatorstest.h"
 #include "boundsbuildertest.h"
 #include "bufferedreadertest.h"
 #include "configstringstoragetest.h"
 #include "enumtokenmatchertest.h"
+#include "freelistallocatortest.h"
+#include "frustumcullertest.h"
+#include "internedstringstest.h"
+#include "jobpooltest.h"
+#include "mipmaptest.h"
+#include "mpscqueuetest.h"
+#include "radixsorttest.h"
+#include "skeletalposestest.h"
 #include "staticstringtest.h"
 #include "stringsplittertest.h"
 #include "stringviewtest.h"
+#include "sweepandprunetest.h"
+#include "timerwheeltest.h"
 #include "tonumtest.h"
 #include <QCoreApplication>
 
@@ -54,5 +66,65 @@ int main( int argc, char **argv ) {
 		result |= QTest::qExec( &toNumTest, argc, argv );
 	}
 
+	{
+		FreelistAllocatorTest freelistAllocatorTest;
+		result |= QTest::qExec( &freelistAllocatorTest, argc, argv );
+	}
+
+	{
+		TimerWheelTest timerWheelTest;
+		result |= QTest::qExec( &timerWheelTest, argc, argv );
+	}
+
+	{
+		SweepAndPruneTest sweepAndPruneTest;
+		result |= QTest::qExec( &sweepAndPruneTest, argc, argv );
+	}
+
+	{
+		AabbTreeTest aabbTreeTest;
+		result |= QTest::qExec( &aabbTreeTest, argc, argv );
+	}
+
+	{
+		RadixSortTest radixSortTest;
+		result |= QTest::qExec( &radixSortTest, argc, argv );
+	}
+
+	{
+		FrustumCullerTest frustumCullerTest;
+		result |= QTest::qExec( &frustumCullerTest, argc, argv );
+	}
+
+	{
+		JobPoolTest jobPoolTest;
+		result |= QTest::qExec( &jobPoolTest, argc, argv );
+	}
+
+	{
+		SkeletalPosesTest skeletalPosesTest;
+		result |= QTest::qExec( &skeletalPosesTest, argc, argv );
+	}
+
+	{
+		MipMapTest mipMapTest;
+		result |= QTest::qExec( &mipMapTest, argc, argv );
+	}
+
+	{
+		AllocatorsTest allocatorsTest;
+		result |= QTest::qExec( &allocatorsTest, argc, argv );
+	}
+
+	{
+		InternedStringsTest internedStringsTest;
+		result |= QTest::qExec( &internedStringsTest, argc, argv );
+	}
+
+	{
+		MpscQueueTest mpscQueueTest;
+		result |= QTest::qExec( &mpscQueueTest, argc, argv );
+	}
+
 	return result;
 }
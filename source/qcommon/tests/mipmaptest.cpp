@@ -0,0 +1,160 @@
+#include "mipmaptest.h"
+#include "../wswmipmap.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+/**
+ * Mirrors the original in-place mip generation code of the renderer
+ */
+void referenceMipMap8( uint8_t *in, int width, int height, int samples, int alignment ) {
+	const int instride = wsw::MipMapRowStride( width, samples, alignment );
+	const int outwidth = width > 1 ? width >> 1 : 1;
+	const int outheight = height > 1 ? height >> 1 : 1;
+	const int outpadding = wsw::MipMapRowStride( outwidth, samples, alignment ) - outwidth * samples;
+	uint8_t *out = in;
+	for( int i = 0; i < outheight; i++, in += instride * 2, out += outpadding ) {
+		const uint8_t *next = ( ( ( i << 1 ) + 1 ) < height ) ? ( in + instride ) : in;
+		for( int j = 0, inofs = 0; j < outwidth; j++, inofs += samples ) {
+			if( ( ( j << 1 ) + 1 ) < width ) {
+				for( int k = 0; k < samples; ++k, ++inofs )
+					*( out++ ) = ( in[inofs] + in[inofs + samples] + next[inofs] + next[inofs + samples] ) >> 2;
+			} else {
+				for( int k = 0; k < samples; ++k, ++inofs )
+					*( out++ ) = ( in[inofs] + next[inofs] ) >> 1;
+			}
+		}
+	}
+}
+
+void referenceMipMap16( uint16_t *in, int width, int height, int rMask, int gMask, int bMask, int aMask ) {
+	const int instride = ( width + 1 ) & ~1;
+	const int outwidth = width > 1 ? width >> 1 : 1;
+	const int outheight = height > 1 ? height >> 1 : 1;
+	const int outpadding = outwidth & 1;
+	uint16_t *out = in;
+	for( int i = 0; i < outheight; i++, in += instride * 2, out += outpadding ) {
+		const uint16_t *next = ( ( ( i << 1 ) + 1 ) < height ) ? ( in + instride ) : in;
+		for( int j = 0; j < outwidth; j++ ) {
+			const int col = j << 1;
+			int p[4] = { in[col], next[col], 0, 0 };
+			if( ( col + 1 ) < width ) {
+				p[2] = in[col + 1];
+				p[3] = next[col + 1];
+				*( out++ ) = ( ( ( ( p[0] & rMask ) + ( p[1] & rMask ) + ( p[2] & rMask ) + ( p[3] & rMask ) ) >> 2 ) & rMask ) |
+							 ( ( ( ( p[0] & gMask ) + ( p[1] & gMask ) + ( p[2] & gMask ) + ( p[3] & gMask ) ) >> 2 ) & gMask ) |
+							 ( ( ( ( p[0] & bMask ) + ( p[1] & bMask ) + ( p[2] & bMask ) + ( p[3] & bMask ) ) >> 2 ) & bMask ) |
+							 ( ( ( ( p[0] & aMask ) + ( p[1] & aMask ) + ( p[2] & aMask ) + ( p[3] & aMask ) ) >> 2 ) & aMask );
+			} else {
+				*( out++ ) = ( ( ( ( p[0] & rMask ) + ( p[1] & rMask ) ) >> 1 ) & rMask ) |
+							 ( ( ( ( p[0] & gMask ) + ( p[1] & gMask ) ) >> 1 ) & gMask ) |
+							 ( ( ( ( p[0] & bMask ) + ( p[1] & bMask ) ) >> 1 ) & bMask ) |
+							 ( ( ( ( p[0] & aMask ) + ( p[1] & aMask ) ) >> 1 ) & aMask );
+			}
+		}
+	}
+}
+
+template <typename T>
+std::vector<T> makeImage( unsigned seed, size_t size ) {
+	std::mt19937 rng( seed );
+	std::vector<T> image( size );
+	for( T &value: image ) {
+		value = (T)rng();
+	}
+	return image;
+}
+
+/**
+ * Compares images ignoring bytes of a row padding, they are not defined
+ */
+template <typename T>
+bool equalRows( const T *lhs, const T *rhs, int height, int rowSize, int stride ) {
+	for( int i = 0; i < height; ++i ) {
+		if( std::memcmp( lhs + i * stride, rhs + i * stride, rowSize * sizeof( T ) ) != 0 ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+void MipMapTest::test_matchesReferenceFilter8() {
+	const int sizes[] = { 1, 2, 3, 5, 8, 17, 32, 33, 64, 127 };
+	for( int samples = 1; samples <= 4; ++samples ) {
+		for( int alignment: { 1, 4 } ) {
+			for( int width: sizes ) {
+				for( int height: sizes ) {
+					const size_t size = (size_t)wsw::MipMapRowStride( width, samples, alignment ) * height;
+					std::vector<uint8_t> expected = makeImage<uint8_t>( width * 131 + height, size );
+					std::vector<uint8_t> inPlace = expected;
+					std::vector<uint8_t> separate( size );
+					wsw::MipMap8( expected.data(), width, height, samples, alignment, separate.data() );
+					referenceMipMap8( expected.data(), width, height, samples, alignment );
+					wsw::MipMap8( inPlace.data(), width, height, samples, alignment, inPlace.data() );
+
+					const int outWidth = width > 1 ? width >> 1 : 1;
+					const int outHeight = height > 1 ? height >> 1 : 1;
+					const int outStride = wsw::MipMapRowStride( outWidth, samples, alignment );
+					QVERIFY( equalRows( separate.data(), expected.data(), outHeight, outWidth * samples, outStride ) );
+					QVERIFY( equalRows( inPlace.data(), expected.data(), outHeight, outWidth * samples, outStride ) );
+				}
+			}
+		}
+	}
+}
+
+void MipMapTest::test_matchesReferenceFilter16() {
+	// 4444, 5551 and 565 formats
+	const unsigned masks[3][4] = {
+		{ 15u << 12, 15u << 8, 15u << 4, 15u },
+		{ 31u << 11, 31u << 6, 31u << 1, 1u },
+		{ 31u << 11, 63u << 5, 31u, 0u }
+	};
+	const int sizes[] = { 1, 2, 3, 7, 8, 9, 16, 31, 64 };
+	for( const auto &m: masks ) {
+		for( int width: sizes ) {
+			for( int height: sizes ) {
+				const size_t size = (size_t)( ( width + 1 ) & ~1 ) * height;
+				std::vector<uint16_t> expected = makeImage<uint16_t>( width * 67 + height, size );
+				std::vector<uint16_t> inPlace = expected;
+				referenceMipMap16( expected.data(), width, height, (int)m[0], (int)m[1], (int)m[2], (int)m[3] );
+				wsw::MipMap16( inPlace.data(), width, height, m[0], m[1], m[2], m[3], inPlace.data() );
+
+				const int outWidth = width > 1 ? width >> 1 : 1;
+				const int outHeight = height > 1 ? height >> 1 : 1;
+				QVERIFY( equalRows( inPlace.data(), expected.data(), outHeight, outWidth, ( outWidth + 1 ) & ~1 ) );
+			}
+		}
+	}
+}
+
+void MipMapTest::benchmark_mipChain_reference() {
+	const std::vector<uint8_t> image = makeImage<uint8_t>( 1, 512 * 512 * 4 );
+	std::vector<uint8_t> chain;
+	QBENCHMARK {
+		chain = image;
+		for( int size = 512; size > 1; size >>= 1 ) {
+			referenceMipMap8( chain.data(), size, size, 4, 4 );
+		}
+	}
+}
+
+void MipMapTest::benchmark_mipChain_mipMap8() {
+	const std::vector<uint8_t> image = makeImage<uint8_t>( 1, 512 * 512 * 4 );
+	std::vector<uint8_t> chain, expected = image;
+	for( int size = 512; size > 1; size >>= 1 ) {
+		referenceMipMap8( expected.data(), size, size, 4, 4 );
+	}
+	QBENCHMARK {
+		chain = image;
+		for( int size = 512; size > 1; size >>= 1 ) {
+			wsw::MipMap8( chain.data(), size, size, 4, 4, chain.data() );
+		}
+	}
+	QVERIFY( chain[0] == expected[0] && chain[1] == expected[1] && chain[2] == expected[2] && chain[3] == expected[3] );
+}
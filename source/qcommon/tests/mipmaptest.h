@@ -0,0 +1,16 @@
+#ifndef WSW_MIPMAPTEST_H
+#define WSW_MIPMAPTEST_H
+
+#include <QtTest/QtTest>
+
+class MipMapTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_matchesReferenceFilter8();
+	void test_matchesReferenceFilter16();
+	void benchmark_mipChain_reference();
+	void benchmark_mipChain_mipMap8();
+};
+
+#endif
@@ -0,0 +1,215 @@
+#include "mpscqueuetest.h"
+#include "../wswmpscqueue.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr unsigned kNumProducers = 4;
+constexpr unsigned kCommandsPerProducer = 50000;
+
+/**
+ * Mirrors a typical sound command: an id, a source number and few vectors
+ */
+struct TestCommand {
+	int id;
+	unsigned producer;
+	unsigned sequence;
+	float values[9];
+};
+
+/**
+ * A queue that locks a mutex and signals a condition variable on every write like the old pipe did
+ */
+class MutexQueue {
+	std::mutex mutex;
+	std::condition_variable nonEmpty;
+	std::deque<TestCommand> commands;
+public:
+	void write( const TestCommand &command ) {
+		std::lock_guard<std::mutex> lock( mutex );
+		commands.push_back( command );
+		nonEmpty.notify_one();
+	}
+
+	template <typename Handler>
+	unsigned waitAndRead( Handler &&handler ) {
+		std::unique_lock<std::mutex> lock( mutex );
+		nonEmpty.wait_for( lock, std::chrono::milliseconds( 10 ), [&]() { return !commands.empty(); } );
+		unsigned numRead = 0;
+		while( !commands.empty() ) {
+			handler( commands.front() );
+			commands.pop_front();
+			numRead++;
+		}
+		return numRead;
+	}
+};
+
+class MpscQueue {
+	// The size of the sound commands pipe
+	wsw::MpscCommandQueue queue { 1024 * 1024 };
+public:
+	void write( const TestCommand &command ) {
+		queue.write( &command, sizeof( command ) );
+	}
+
+	template <typename Handler>
+	unsigned waitAndRead( Handler &&handler ) {
+		queue.waitForCommands( 10 );
+		return queue.read( [&]( const void *data, unsigned ) {
+			handler( *(const TestCommand *)data );
+			return true;
+		});
+	}
+};
+
+/**
+ * Runs producers that write sequences of commands and checks that the consumer gets every sequence in order
+ */
+template <typename Queue>
+bool runProducers( Queue *queue ) {
+	std::vector<std::thread> producers;
+	for( unsigned i = 0; i < kNumProducers; ++i ) {
+		producers.emplace_back( [=]() {
+			TestCommand command {};
+			command.producer = i;
+			for( unsigned j = 0; j < kCommandsPerProducer; ++j ) {
+				command.sequence = j;
+				command.values[0] = (float)j;
+				queue->write( command );
+			}
+		});
+	}
+
+	unsigned nextSequences[kNumProducers] {};
+	unsigned numRead = 0;
+	bool isOrdered = true;
+	while( numRead < kNumProducers * kCommandsPerProducer ) {
+		numRead += queue->waitAndRead( [&]( const TestCommand &command ) {
+			isOrdered &= command.sequence == nextSequences[command.producer]++;
+			isOrdered &= command.values[0] == (float)command.sequence;
+		});
+	}
+
+	for( std::thread &producer: producers ) {
+		producer.join();
+	}
+	return isOrdered;
+}
+
+}
+
+void MpscQueueTest::test_keepsOrderAcrossWraps() {
+	wsw::MpscCommandQueue queue( 256 );
+	QCOMPARE( queue.maxCommandSize(), (size_t)120 );
+
+	uint8_t data[120];
+	unsigned nextToWrite = 0, nextToRead = 0;
+	for( int round = 0; round < 100; ++round ) {
+		// Odd sizes make records pad the rest of the ring at different offsets
+		for( ;; ) {
+			const unsigned size = 1 + ( nextToWrite * 37 ) % sizeof( data );
+			std::memset( data, (int)( nextToWrite & 0xFF ), size );
+			if( !queue.tryWrite( data, size ) ) {
+				break;
+			}
+			nextToWrite++;
+		}
+		QVERIFY( queue.stats().numFullWrites > 0 );
+		QVERIFY( queue.hasPublishedCommand() );
+
+		bool isValid = true;
+		const unsigned numRead = queue.read( [&]( const void *command, unsigned size ) {
+			const auto *bytes = (const uint8_t *)command;
+			isValid &= ( (uintptr_t)command % 8 ) == 0;
+			isValid &= size == 1 + ( nextToRead * 37 ) % sizeof( data );
+			for( unsigned i = 0; i < size; ++i ) {
+				isValid &= bytes[i] == ( nextToRead & 0xFF );
+			}
+			nextToRead++;
+			return true;
+		});
+		QVERIFY( isValid );
+		QVERIFY( numRead > 0 );
+		QVERIFY( queue.isEmpty() );
+		QCOMPARE( nextToRead, nextToWrite );
+	}
+}
+
+void MpscQueueTest::test_deliversCommandsOfAllProducers() {
+	MpscQueue queue;
+	QVERIFY( runProducers( &queue ) );
+}
+
+void MpscQueueTest::test_terminationStopsWritesAndReads() {
+	wsw::MpscCommandQueue queue( 1024 );
+	const int values[] = { 1, 2, 3 };
+	for( int value: values ) {
+		QVERIFY( queue.tryWrite( &value, sizeof( value ) ) );
+	}
+
+	std::vector<int> readValues;
+	const unsigned numRead = queue.read( [&]( const void *command, unsigned ) {
+		readValues.push_back( *(const int *)command );
+		// Request termination on the second command
+		return readValues.size() < 2;
+	});
+	QCOMPARE( numRead, 2u );
+	QCOMPARE( readValues.size(), (size_t)2 );
+	QVERIFY( queue.terminated() );
+	QVERIFY( !queue.tryWrite( &values[0], sizeof( int ) ) );
+	QVERIFY( !queue.write( &values[0], sizeof( int ) ) );
+	QCOMPARE( queue.read( []( const void *, unsigned ) { return true; } ), 0u );
+}
+
+void MpscQueueTest::test_waitWakesUpOnWrite() {
+	wsw::MpscCommandQueue queue( 1024 );
+	QVERIFY( !queue.waitForCommands( 1 ) );
+
+	std::thread producer( [&]() {
+		std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+		const int value = 42;
+		queue.write( &value, sizeof( value ) );
+	});
+
+	// Should not wait for the entire timeout
+	const auto startTime = std::chrono::steady_clock::now();
+	bool hasCommands = false;
+	while( !hasCommands && std::chrono::steady_clock::now() - startTime < std::chrono::seconds( 10 ) ) {
+		hasCommands = queue.waitForCommands( 10 * 1000 );
+	}
+	producer.join();
+	QVERIFY( hasCommands );
+	QVERIFY( std::chrono::steady_clock::now() - startTime < std::chrono::seconds( 5 ) );
+
+	int value = 0;
+	queue.read( [&]( const void *command, unsigned ) {
+		value = *(const int *)command;
+		return true;
+	});
+	QCOMPARE( value, 42 );
+}
+
+void MpscQueueTest::benchmark_producers_mutexQueue() {
+	bool isOrdered = false;
+	QBENCHMARK {
+		MutexQueue queue;
+		isOrdered = runProducers( &queue );
+	}
+	QVERIFY( isOrdered );
+}
+
+void MpscQueueTest::benchmark_producers_mpscQueue() {
+	bool isOrdered = false;
+	QBENCHMARK {
+		MpscQueue queue;
+		isOrdered = runProducers( &queue );
+	}
+	QVERIFY( isOrdered );
+}
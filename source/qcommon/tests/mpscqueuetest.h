@@ -0,0 +1,18 @@
+#ifndef WSW_MPSCQUEUETEST_H
+#define WSW_MPSCQUEUETEST_H
+
+#include <QtTest/QtTest>
+
+class MpscQueueTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_keepsOrderAcrossWraps();
+	void test_deliversCommandsOfAllProducers();
+	void test_terminationStopsWritesAndReads();
+	void test_waitWakesUpOnWrite();
+	void benchmark_producers_mutexQueue();
+	void benchmark_producers_mpscQueue();
+};
+
+#endif
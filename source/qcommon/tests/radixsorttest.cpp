@@ -0,0 +1,130 @@
+#include "radixsorttest.h"
+#include "../wswradixsort.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+/**
+ * Mirrors a sorted draw surface of the renderer
+ */
+struct DrawSurf {
+	unsigned distKey;
+	unsigned sortKey;
+	const void *drawSurf;
+};
+
+uint64_t keyOf( const DrawSurf &surf ) {
+	return ( (uint64_t)surf.distKey << 32 ) | surf.sortKey;
+}
+
+int compareDrawSurfs( const DrawSurf *lhs, const DrawSurf *rhs ) {
+	if( lhs->distKey != rhs->distKey ) {
+		return lhs->distKey > rhs->distKey ? 1 : -1;
+	}
+	if( lhs->sortKey != rhs->sortKey ) {
+		return lhs->sortKey > rhs->sortKey ? 1 : -1;
+	}
+	return 0;
+}
+
+/**
+ * Produces a draw list that resembles one of a busy scene: mostly opaque world surfaces
+ * that have the same distance key, and sky, models and transparent surfaces sorted by distance.
+ * Keys are packed the same way the renderer packs them.
+ */
+std::vector<DrawSurf> makeDrawList( unsigned seed, unsigned numSurfs ) {
+	std::mt19937 rng( seed );
+	std::vector<DrawSurf> surfs( numSurfs );
+	for( unsigned i = 0; i < numSurfs; ++i ) {
+		const unsigned kind = rng() % 16;
+		unsigned shaderSort, dist, order;
+		if( kind < 10 ) {
+			// opaque world surfaces
+			shaderSort = 3, dist = 0x400, order = rng() % 0x7FFF;
+		} else if( kind < 13 ) {
+			// models
+			shaderSort = 3 + rng() % 2, dist = rng() % 0x400, order = 0;
+		} else {
+			// transparent surfaces, there are many ties for surfaces of the same entity
+			shaderSort = 8 + rng() % 6, dist = rng() % 64, order = 0;
+		}
+		const unsigned shaderNum = rng() % 300, entNum = rng() % 64, portalNum = rng() % 3, fogNum = rng() % 2;
+		surfs[i].distKey = ( shaderSort << 26 ) | ( ( 0x400 - dist ) << 15 ) | order;
+		surfs[i].sortKey = ( shaderNum << 21 ) | ( entNum << 10 ) | ( portalNum << 5 ) | fogNum;
+		surfs[i].drawSurf = (const void *)(uintptr_t)( i + 1 );
+	}
+	return surfs;
+}
+
+bool equal( const std::vector<DrawSurf> &lhs, const std::vector<DrawSurf> &rhs ) {
+	for( size_t i = 0; i < lhs.size(); ++i ) {
+		if( compareDrawSurfs( &lhs[i], &rhs[i] ) || lhs[i].drawSurf != rhs[i].drawSurf ) {
+			return false;
+		}
+	}
+	return lhs.size() == rhs.size();
+}
+
+std::vector<DrawSurf> stableSorted( std::vector<DrawSurf> surfs ) {
+	std::stable_sort( surfs.begin(), surfs.end(), []( const DrawSurf &lhs, const DrawSurf &rhs ) {
+		return keyOf( lhs ) < keyOf( rhs );
+	});
+	return surfs;
+}
+
+}
+
+void RadixSortTest::test_shortRanges() {
+	for( unsigned numSurfs = 0; numSurfs < 70; ++numSurfs ) {
+		std::vector<DrawSurf> surfs = makeDrawList( numSurfs, numSurfs );
+		const std::vector<DrawSurf> expected = stableSorted( surfs );
+		std::vector<DrawSurf> scratch( numSurfs );
+		wsw::RadixSort64( surfs.data(), scratch.data(), surfs.size(), keyOf );
+		QVERIFY( equal( surfs, expected ) );
+	}
+}
+
+void RadixSortTest::test_matchesStableSort() {
+	for( unsigned numSurfs: { 64u, 100u, 1000u, 12345u } ) {
+		std::vector<DrawSurf> surfs = makeDrawList( numSurfs, numSurfs );
+		std::vector<DrawSurf> scratch( numSurfs );
+		const std::vector<DrawSurf> expected = stableSorted( surfs );
+		wsw::RadixSort64( surfs.data(), scratch.data(), surfs.size(), keyOf );
+		QVERIFY( equal( surfs, expected ) );
+
+		// All keys are equal, the order must be kept
+		std::vector<DrawSurf> sameKeys( numSurfs, DrawSurf { 1u << 26, 7, nullptr } );
+		for( unsigned i = 0; i < numSurfs; ++i ) {
+			sameKeys[i].drawSurf = (const void *)(uintptr_t)( i + 1 );
+		}
+		const std::vector<DrawSurf> unchanged = sameKeys;
+		wsw::RadixSort64( sameKeys.data(), scratch.data(), sameKeys.size(), keyOf );
+		QVERIFY( equal( sameKeys, unchanged ) );
+	}
+}
+
+void RadixSortTest::benchmark_drawList_qsort() {
+	const std::vector<DrawSurf> drawList = makeDrawList( 1, 8192 );
+	std::vector<DrawSurf> surfs;
+	QBENCHMARK {
+		surfs = drawList;
+		qsort( surfs.data(), surfs.size(), sizeof( DrawSurf ), ( int ( * )( const void *, const void * ) )compareDrawSurfs );
+	}
+	QVERIFY( std::is_sorted( surfs.begin(), surfs.end(), []( const DrawSurf &lhs, const DrawSurf &rhs ) {
+		return keyOf( lhs ) < keyOf( rhs );
+	}));
+}
+
+void RadixSortTest::benchmark_drawList_radixSort() {
+	const std::vector<DrawSurf> drawList = makeDrawList( 1, 8192 );
+	std::vector<DrawSurf> surfs, scratch( drawList.size() );
+	QBENCHMARK {
+		surfs = drawList;
+		wsw::RadixSort64( surfs.data(), scratch.data(), surfs.size(), keyOf );
+	}
+	QVERIFY( equal( surfs, stableSorted( drawList ) ) );
+}
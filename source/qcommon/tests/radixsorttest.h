@@ -0,0 +1,16 @@
+#ifndef WSW_RADIXSORTTEST_H
+#define WSW_RADIXSORTTEST_H
+
+#include <QtTest/QtTest>
+
+class RadixSortTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_shortRanges();
+	void test_matchesStableSort();
+	void benchmark_drawList_qsort();
+	void benchmark_drawList_radixSort();
+};
+
+#endif
@@ -0,0 +1,220 @@
+#include "skeletalposestest.h"
+#include "../wswskeletalposes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+using DualQuat = float[8];
+
+void quatMultiply( const float *q1, const float *q2, float *out ) {
+	out[0] = q1[3] * q2[0] + q1[0] * q2[3] + q1[1] * q2[2] - q1[2] * q2[1];
+	out[1] = q1[3] * q2[1] + q1[1] * q2[3] + q1[2] * q2[0] - q1[0] * q2[2];
+	out[2] = q1[3] * q2[2] + q1[2] * q2[3] + q1[0] * q2[1] - q1[1] * q2[0];
+	out[3] = q1[3] * q2[3] - q1[0] * q2[0] - q1[1] * q2[1] - q1[2] * q2[2];
+}
+
+void dualQuatMultiply( const float *dq1, const float *dq2, float *out ) {
+	float tq1[4], tq2[4];
+	quatMultiply( dq1, dq2 + 4, tq1 );
+	quatMultiply( dq1 + 4, dq2, tq2 );
+	quatMultiply( dq1, dq2, out );
+	for( int i = 0; i < 4; ++i ) {
+		out[i + 4] = tq1[i] + tq2[i];
+	}
+}
+
+void normalize( float *dq, int numComponents ) {
+	const float length = dq[0] * dq[0] + dq[1] * dq[1] + dq[2] * dq[2] + dq[3] * dq[3];
+	if( length != 0 ) {
+		const float ilength = 1.0 / std::sqrt( length );
+		for( int i = 0; i < numComponents; ++i ) {
+			dq[i] *= ilength;
+		}
+	}
+}
+
+void lerp( const float *dq1, const float *dq2, float t, float *out ) {
+	float k = dq1[0] * dq2[0] + dq1[1] * dq2[1] + dq1[2] * dq2[2] + dq1[3] * dq2[3];
+	k = k < 0 ? -t : t;
+	t = 1.0 - t;
+	for( int i = 0; i < 8; ++i ) {
+		out[i] = dq1[i] * t + dq2[i] * k;
+	}
+	normalize( out, 4 );
+}
+
+void copy( const float *from, float *to ) {
+	for( int i = 0; i < 8; ++i ) {
+		to[i] = from[i];
+	}
+}
+
+struct Skeleton {
+	std::vector<int> parents;
+	std::vector<float> invBasePoses;
+	std::vector<std::vector<float>> frames;
+
+	/**
+	 * Makes a random unit dual quaternion, the real part has a random sign as in exported models
+	 */
+	static void makePose( std::mt19937 &rng, float *dq ) {
+		std::normal_distribution<float> normal;
+		std::uniform_real_distribution<float> coord( -32.0f, 32.0f );
+		for( int i = 0; i < 4; ++i ) {
+			dq[i] = normal( rng );
+		}
+		normalize( dq, 4 );
+		const float t[4] = { coord( rng ), coord( rng ), coord( rng ), 0.0f };
+		float dual[4];
+		quatMultiply( t, dq, dual );
+		for( int i = 0; i < 4; ++i ) {
+			dq[i + 4] = 0.5f * dual[i];
+		}
+	}
+
+	Skeleton( unsigned seed, unsigned numBones, unsigned numFrames ) {
+		std::mt19937 rng( seed );
+		for( unsigned i = 0; i < numBones; ++i ) {
+			// Bones of a chain tend to follow each other, there are few roots
+			parents.push_back( i && rng() % 8 ? (int)( i - 1 - rng() % std::min( i, 4u ) ) : -1 );
+		}
+		invBasePoses.resize( numBones * 8 );
+		for( unsigned i = 0; i < numBones; ++i ) {
+			makePose( rng, &invBasePoses[i * 8] );
+		}
+		for( unsigned i = 0; i < numFrames; ++i ) {
+			frames.emplace_back( numBones * 8 );
+			for( unsigned j = 0; j < numBones; ++j ) {
+				makePose( rng, &frames.back()[j * 8] );
+			}
+		}
+	}
+
+	unsigned numBones() const { return (unsigned)parents.size(); }
+};
+
+/**
+ * Mirrors the former per-entity bone transforms of the renderer
+ */
+void computePerEntity( const Skeleton &skeleton, const wsw::SkeletalPoseBatch::Lane &lane, float *temp ) {
+	const unsigned numBones = skeleton.numBones();
+	const float *lerped = temp;
+	if( !lane.lerp ) {
+		if( lane.parentsApplied ) {
+			lerped = lane.frame;
+		} else {
+			for( unsigned i = 0; i < numBones; ++i ) {
+				if( skeleton.parents[i] >= 0 ) {
+					dualQuatMultiply( temp + skeleton.parents[i] * 8, lane.frame + i * 8, temp + i * 8 );
+				} else {
+					copy( lane.frame + i * 8, temp + i * 8 );
+				}
+			}
+		}
+	} else {
+		for( unsigned i = 0; i < numBones; ++i ) {
+			lerp( lane.oldFrame + i * 8, lane.frame + i * 8, lane.frontLerp, temp + i * 8 );
+			if( !lane.parentsApplied && skeleton.parents[i] >= 0 ) {
+				DualQuat tp;
+				copy( temp + i * 8, tp );
+				dualQuatMultiply( temp + skeleton.parents[i] * 8, tp, temp + i * 8 );
+			}
+		}
+	}
+
+	for( unsigned i = 0; i < numBones; ++i ) {
+		dualQuatMultiply( lerped + i * 8, &skeleton.invBasePoses[i * 8], lane.out + i * 8 );
+		normalize( lane.out + i * 8, 8 );
+	}
+}
+
+/**
+ * Players of a crowded fight that share a model, most of them are interpolated between frames
+ */
+struct Crowd {
+	Skeleton skeleton;
+	std::vector<wsw::SkeletalPoseBatch::Lane> lanes;
+	std::vector<std::vector<float>> outputs;
+
+	Crowd( unsigned seed, unsigned numEntities, unsigned numBones, bool mixedFlags ) : skeleton( seed, numBones, 16 ) {
+		std::mt19937 rng( seed );
+		outputs.resize( numEntities, std::vector<float>( numBones * 8 ) );
+		for( unsigned i = 0; i < numEntities; ++i ) {
+			wsw::SkeletalPoseBatch::Lane lane;
+			lane.frame = skeleton.frames[rng() % 16].data();
+			lane.oldFrame = skeleton.frames[rng() % 16].data();
+			lane.frontLerp = ( rng() % 1000 ) / 1000.0f;
+			lane.lerp = mixedFlags ? rng() % 4 != 0 : true;
+			lane.parentsApplied = mixedFlags && rng() % 3 == 0;
+			lane.out = outputs[i].data();
+			lanes.push_back( lane );
+		}
+	}
+
+	void computePerEntity( float *temp ) {
+		for( const auto &lane: lanes ) {
+			::computePerEntity( skeleton, lane, temp );
+		}
+	}
+
+	void computeBatched( float *scratch, unsigned maxLanes = wsw::SkeletalPoseBatch::kMaxLanes ) {
+		const std::vector<int> &parents = skeleton.parents;
+		wsw::SkeletalPoseBatch batch;
+		for( size_t first = 0; first < lanes.size(); first += maxLanes ) {
+			batch.clear();
+			for( size_t i = first; i < first + maxLanes && i < lanes.size(); ++i ) {
+				batch.add( lanes[i] );
+			}
+			batch.compute( [&]( unsigned bone ) { return parents[bone]; }, skeleton.invBasePoses.data(), skeleton.numBones(), scratch );
+		}
+	}
+};
+
+struct alignas( 16 ) Scratch {
+	float data[256 * wsw::SkeletalPoseBatch::kScratchFloatsPerBone];
+};
+
+}
+
+void SkeletalPosesTest::test_matchesPerEntityPoses() {
+	auto scratch = std::make_unique<Scratch>();
+	// Check batches of all sizes
+	for( unsigned maxLanes = 1; maxLanes <= wsw::SkeletalPoseBatch::kMaxLanes; ++maxLanes ) {
+		Crowd crowd( maxLanes, 37, 90, true );
+		crowd.computePerEntity( scratch->data );
+		const std::vector<std::vector<float>> expected( crowd.outputs );
+		for( auto &output: crowd.outputs ) {
+			std::fill( output.begin(), output.end(), 0.0f );
+		}
+
+		crowd.computeBatched( scratch->data, maxLanes );
+		for( size_t i = 0; i < expected.size(); ++i ) {
+			for( size_t j = 0; j < expected[i].size(); ++j ) {
+				// Parent chains accumulate rounding errors of different operation orders, translations are in units
+				const float tolerance = 1e-5f * std::max( 1.0f, std::fabs( expected[i][j] ) );
+				QVERIFY( std::fabs( crowd.outputs[i][j] - expected[i][j] ) <= tolerance );
+			}
+		}
+	}
+}
+
+void SkeletalPosesTest::benchmark_crowd_perEntity() {
+	Crowd crowd( 7, 64, 72, false );
+	auto scratch = std::make_unique<Scratch>();
+	QBENCHMARK {
+		crowd.computePerEntity( scratch->data );
+	}
+}
+
+void SkeletalPosesTest::benchmark_crowd_batched() {
+	Crowd crowd( 7, 64, 72, false );
+	auto scratch = std::make_unique<Scratch>();
+	QBENCHMARK {
+		crowd.computeBatched( scratch->data );
+	}
+}
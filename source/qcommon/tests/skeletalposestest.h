@@ -0,0 +1,15 @@
+#ifndef WSW_SKELETALPOSESTEST_H
+#define WSW_SKELETALPOSESTEST_H
+
+#include <QtTest/QtTest>
+
+class SkeletalPosesTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_matchesPerEntityPoses();
+	void benchmark_crowd_perEntity();
+	void benchmark_crowd_batched();
+};
+
+#endif
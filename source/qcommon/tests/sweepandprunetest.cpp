@@ -0,0 +1,343 @@
+#include "sweepandprunetest.h"
+#include "../wswsweepandprune.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr unsigned kMaxEntities = 1024;
+
+struct Box {
+	float mins[3];
+	float maxs[3];
+};
+
+bool overlaps( const Box &a, const Box &b ) {
+	return a.mins[0] <= b.maxs[0] && a.mins[1] <= b.maxs[1] && a.mins[2] <= b.maxs[2] &&
+		   a.maxs[0] >= b.mins[0] && a.maxs[1] >= b.mins[1] && a.maxs[2] >= b.mins[2];
+}
+
+Box makeBox( float x, float y, float z, float halfWidth, float halfHeight ) {
+	return Box { { x - halfWidth, y - halfWidth, z - halfHeight }, { x + halfWidth, y + halfWidth, z + halfHeight } };
+}
+
+/**
+ * A crowded scene of a 4096x4096 units map: players, items, projectiles,
+ * triggers and few large brush entities. Players and projectiles move every frame.
+ */
+struct CrowdedScene {
+	Box boxes[kMaxEntities];
+	float velocities[kMaxEntities][2];
+	unsigned numEntities { 0 };
+	unsigned numMoving { 0 };
+	std::vector<Box> queries;
+
+	explicit CrowdedScene( unsigned seed ) {
+		std::mt19937 rng( seed );
+		std::uniform_real_distribution<float> coord( -2048.0f, 2048.0f );
+		std::uniform_real_distribution<float> speed( -20.0f, 20.0f );
+		// Moving entities go first: players and projectiles
+		for( unsigned i = 0; i < 64 + 256; ++i ) {
+			const float halfWidth = i < 64 ? 16.0f : 4.0f;
+			boxes[numEntities] = makeBox( coord( rng ), coord( rng ), coord( rng ) * 0.1f, halfWidth, halfWidth * 1.5f );
+			velocities[numEntities][0] = speed( rng );
+			velocities[numEntities][1] = speed( rng );
+			numEntities++;
+		}
+		numMoving = numEntities;
+		// Items
+		for( unsigned i = 0; i < 300; ++i ) {
+			boxes[numEntities++] = makeBox( coord( rng ), coord( rng ), coord( rng ) * 0.1f, 16.0f, 16.0f );
+		}
+		// Triggers
+		for( unsigned i = 0; i < 200; ++i ) {
+			const float halfWidth = 32.0f + (float)( rng() % 96 );
+			boxes[numEntities++] = makeBox( coord( rng ), coord( rng ), coord( rng ) * 0.1f, halfWidth, 64.0f );
+		}
+		// Large movers and map-wide triggers
+		for( unsigned i = 0; i < 24; ++i ) {
+			boxes[numEntities++] = makeBox( coord( rng ), coord( rng ), coord( rng ) * 0.1f, 300.0f + (float)( rng() % 700 ), 128.0f );
+		}
+
+		// Splash damage radii, trigger touches of players and projectiles, AI surroundings checks
+		for( unsigned i = 0; i < 256; ++i ) {
+			const float x = coord( rng ), y = coord( rng ), z = coord( rng ) * 0.1f;
+			if( i % 4 == 0 ) {
+				queries.push_back( makeBox( x, y, z, 500.0f, 200.0f ) );
+			} else if( i % 2 ) {
+				queries.push_back( makeBox( x, y, z, 16.0f, 24.0f ) );
+			} else {
+				queries.push_back( makeBox( x, y, z, 150.0f, 150.0f ) );
+			}
+		}
+	}
+
+	void move( unsigned entNum ) {
+		for( int i = 0; i < 2; ++i ) {
+			float delta = velocities[entNum][i];
+			if( boxes[entNum].maxs[i] + delta > 2048.0f || boxes[entNum].mins[i] + delta < -2048.0f ) {
+				velocities[entNum][i] = -velocities[entNum][i];
+				delta = -delta;
+			}
+			boxes[entNum].mins[i] += delta;
+			boxes[entNum].maxs[i] += delta;
+		}
+	}
+};
+
+struct Link {
+	Link *prev, *next;
+	int entNum;
+};
+
+/**
+ * Mirrors the area grid of the game module clipping code including copying of clip entities of candidates.
+ */
+struct AreaGrid {
+	static constexpr int kGridSize = 128;
+	static constexpr int kMaxEntAreas = 16;
+
+	struct ClipEntity {
+		Box box;
+		uint8_t otherFields[400];
+	};
+
+	Link grid[kGridSize * kGridSize];
+	Link outside;
+	Link links[kMaxEntities][kMaxEntAreas];
+	int markNumbers[kMaxEntities];
+	int markNumber { 1 };
+	float bias, scale;
+	ClipEntity entities[kMaxEntities];
+
+	AreaGrid() {
+		bias = 2048.0f;
+		scale = kGridSize / 4096.0f;
+		for( Link &l: grid ) {
+			l.prev = l.next = &l;
+		}
+		outside.prev = outside.next = &outside;
+		std::memset( links, 0, sizeof( links ) );
+		std::memset( markNumbers, 0, sizeof( markNumbers ) );
+	}
+
+	static void insertBefore( Link *l, Link *before, int entNum ) {
+		l->entNum = entNum;
+		l->prev = before->prev;
+		l->next = before;
+		l->prev->next = l;
+		l->next->prev = l;
+	}
+
+	void unlink( int entNum ) {
+		for( Link &l: links[entNum] ) {
+			if( !l.prev ) {
+				break;
+			}
+			l.prev->next = l.next;
+			l.next->prev = l.prev;
+			l.prev = l.next = nullptr;
+		}
+	}
+
+	void link( int entNum, const Box &box ) {
+		unlink( entNum );
+		entities[entNum].box = box;
+		int mins[2], maxs[2];
+		for( int i = 0; i < 2; ++i ) {
+			mins[i] = (int)std::floor( ( box.mins[i] + bias ) * scale );
+			maxs[i] = (int)std::floor( ( box.maxs[i] + bias ) * scale ) + 1;
+		}
+		if( mins[0] < 0 || maxs[0] > kGridSize || mins[1] < 0 || maxs[1] > kGridSize ||
+			( maxs[0] - mins[0] ) * ( maxs[1] - mins[1] ) > kMaxEntAreas ) {
+			insertBefore( &links[entNum][0], &outside, entNum );
+			return;
+		}
+		int linkNum = 0;
+		for( int y = mins[1]; y < maxs[1]; ++y ) {
+			for( int x = mins[0]; x < maxs[0]; ++x ) {
+				insertBefore( &links[entNum][linkNum++], &grid[y * kGridSize + x], entNum );
+			}
+		}
+	}
+
+	void addCell( Link *cell, const Box &box, int *list, int &numList ) {
+		for( Link *l = cell->next; l != cell; l = l->next ) {
+			// The game module code copies a clip entity for every candidate to support antilag
+			static ClipEntity clipEntity;
+			clipEntity = entities[l->entNum];
+			if( markNumbers[l->entNum] == markNumber ) {
+				continue;
+			}
+			markNumbers[l->entNum] = markNumber;
+			if( overlaps( box, clipEntity.box ) ) {
+				list[numList++] = l->entNum;
+			}
+		}
+	}
+
+	int query( const Box &box, int *list ) {
+		markNumber++;
+		int mins[2], maxs[2];
+		for( int i = 0; i < 2; ++i ) {
+			mins[i] = std::max( 0, (int)std::floor( ( box.mins[i] + bias ) * scale ) );
+			maxs[i] = std::min( kGridSize, (int)std::floor( ( box.maxs[i] + bias ) * scale ) + 1 );
+		}
+		int numList = 0;
+		addCell( &outside, box, list, numList );
+		for( int y = mins[1]; y < maxs[1]; ++y ) {
+			for( int x = mins[0]; x < maxs[0]; ++x ) {
+				Link *cell = &grid[y * kGridSize + x];
+				if( cell->next != cell ) {
+					addCell( cell, box, list, numList );
+				}
+			}
+		}
+		return numList;
+	}
+};
+
+struct SweepAndPruneIndex {
+	wsw::SweepAndPrune<kMaxEntities> index;
+	Box boxes[kMaxEntities];
+
+	void link( int entNum, const Box &box ) {
+		boxes[entNum] = box;
+		index.link( (unsigned)entNum, box.mins, box.maxs );
+	}
+
+	int query( const Box &box, int *list ) {
+		int numList = 0;
+		index.query( box.mins, box.maxs, [&]( unsigned entNum ) {
+			// The game module code checks an exact entity box once more
+			if( overlaps( box, boxes[entNum] ) ) {
+				list[numList++] = (int)entNum;
+			}
+		});
+		return numList;
+	}
+};
+
+template <typename Index>
+unsigned runFrames( CrowdedScene *scene, Index *index, int numFrames ) {
+	int list[kMaxEntities];
+	unsigned numFound = 0;
+	for( int frame = 0; frame < numFrames; ++frame ) {
+		for( unsigned i = 0; i < scene->numMoving; ++i ) {
+			scene->move( i );
+			index->link( (int)i, scene->boxes[i] );
+		}
+		for( const Box &query: scene->queries ) {
+			numFound += (unsigned)index->query( query, list );
+		}
+	}
+	return numFound;
+}
+
+}
+
+void SweepAndPruneTest::test_linkUpdateUnlink() {
+	wsw::SweepAndPrune<16> index( 100.0f );
+	const Box small = makeBox( 0, 0, 0, 8, 8 );
+	const Box large = makeBox( 0, 0, 0, 200, 8 );
+	index.link( 1, small.mins, small.maxs );
+	index.link( 2, large.mins, large.maxs );
+	index.link( 3, small.mins, small.maxs );
+	QCOMPARE( index.size(), 3u );
+
+	std::vector<unsigned> found;
+	const Box query = makeBox( 150, 0, 0, 4, 4 );
+	index.query( query.mins, query.maxs, [&]( unsigned item ) { found.push_back( item ); } );
+	QCOMPARE( found, std::vector<unsigned>( { 2 } ) );
+
+	// Make the large box small and move it away, the small one becomes large
+	const Box moved = makeBox( 1000, 0, 0, 8, 8 );
+	index.link( 2, moved.mins, moved.maxs );
+	index.link( 1, large.mins, large.maxs );
+	found.clear();
+	index.query( query.mins, query.maxs, [&]( unsigned item ) { found.push_back( item ); } );
+	QCOMPARE( found, std::vector<unsigned>( { 1 } ) );
+
+	index.unlink( 1 );
+	index.unlink( 1 );
+	QVERIFY( !index.isLinked( 1 ) );
+	QCOMPARE( index.size(), 2u );
+	found.clear();
+	index.query( query.mins, query.maxs, [&]( unsigned item ) { found.push_back( item ); } );
+	QVERIFY( found.empty() );
+}
+
+void SweepAndPruneTest::test_matchesBruteForce() {
+	CrowdedScene scene( 1 );
+	wsw::SweepAndPrune<kMaxEntities> index;
+	std::mt19937 rng( 2 );
+	bool linked[kMaxEntities] {};
+	for( unsigned i = 0; i < scene.numEntities; ++i ) {
+		index.link( i, scene.boxes[i].mins, scene.boxes[i].maxs );
+		linked[i] = true;
+	}
+
+	std::vector<unsigned> expected, found;
+	for( int frame = 0; frame < 100; ++frame ) {
+		for( unsigned i = 0; i < scene.numMoving; ++i ) {
+			scene.move( i );
+			if( linked[i] ) {
+				index.link( i, scene.boxes[i].mins, scene.boxes[i].maxs );
+			}
+		}
+		// Simulate freeing and respawning of entities
+		for( int i = 0; i < 8; ++i ) {
+			const unsigned entNum = rng() % scene.numEntities;
+			if( linked[entNum] ) {
+				index.unlink( entNum );
+			} else {
+				index.link( entNum, scene.boxes[entNum].mins, scene.boxes[entNum].maxs );
+			}
+			linked[entNum] = !linked[entNum];
+		}
+
+		for( const Box &query: scene.queries ) {
+			expected.clear();
+			found.clear();
+			for( unsigned i = 0; i < scene.numEntities; ++i ) {
+				if( linked[i] && overlaps( query, scene.boxes[i] ) ) {
+					expected.push_back( i );
+				}
+			}
+			index.query( query.mins, query.maxs, [&]( unsigned item ) { found.push_back( item ); } );
+			std::sort( found.begin(), found.end() );
+			QCOMPARE( found, expected );
+		}
+	}
+}
+
+void SweepAndPruneTest::benchmark_crowdedScene_areaGrid() {
+	CrowdedScene scene( 3 );
+	auto *grid = new AreaGrid;
+	for( unsigned i = 0; i < scene.numEntities; ++i ) {
+		grid->link( (int)i, scene.boxes[i] );
+	}
+	unsigned numFound = 0;
+	QBENCHMARK {
+		numFound += runFrames( &scene, grid, 2 );
+	}
+	QVERIFY( numFound > 0 );
+	delete grid;
+}
+
+void SweepAndPruneTest::benchmark_crowdedScene_sweepAndPrune() {
+	CrowdedScene scene( 3 );
+	auto *index = new SweepAndPruneIndex;
+	for( unsigned i = 0; i < scene.numEntities; ++i ) {
+		index->link( (int)i, scene.boxes[i] );
+	}
+	unsigned numFound = 0;
+	QBENCHMARK {
+		numFound += runFrames( &scene, index, 2 );
+	}
+	QVERIFY( numFound > 0 );
+	delete index;
+}
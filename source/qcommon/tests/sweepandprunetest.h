@@ -0,0 +1,16 @@
+#ifndef WSW_SWEEPANDPRUNETEST_H
+#define WSW_SWEEPANDPRUNETEST_H
+
+#include <QtTest/QtTest>
+
+class SweepAndPruneTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_linkUpdateUnlink();
+	void test_matchesBruteForce();
+	void benchmark_crowdedScene_areaGrid();
+	void benchmark_crowdedScene_sweepAndPrune();
+};
+
+#endif
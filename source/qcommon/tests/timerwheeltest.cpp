@@ -0,0 +1,172 @@
+#include "timerwheeltest.h"
+#include "../wswtimerwheel.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr unsigned kNumEntities = 1024;
+constexpr int64_t kFrameTime = 16;
+
+/**
+ * Mimics an entity-heavy map: most entities are idle items, triggers and decorations,
+ * some of them have rare delayed thinks (respawns, target delays), a few ones think every 100 ms.
+ */
+struct EntityThinks {
+	int64_t nextThink[kNumEntities];
+
+	explicit EntityThinks( unsigned seed ) {
+		std::mt19937 rng( seed );
+		for( unsigned i = 0; i < kNumEntities; ++i ) {
+			const unsigned kind = rng() % 100;
+			if( kind < 4 ) {
+				nextThink[i] = 1 + rng() % 100;
+			} else if( kind < 20 ) {
+				nextThink[i] = 1 + rng() % 30000;
+			} else {
+				nextThink[i] = 0;
+			}
+		}
+	}
+
+	int64_t think( unsigned entNum, int64_t levelTime ) {
+		// Frequently thinking entities keep thinking, others go idle
+		nextThink[entNum] = ( entNum % 25 ) ? 0 : levelTime + 100;
+		return nextThink[entNum];
+	}
+};
+
+}
+
+void TimerWheelTest::test_expirationAtScheduledTime() {
+	wsw::TimerWheel<16> wheel;
+	QVERIFY( wheel.schedule( 1, 7 ) );
+	QVERIFY( wheel.schedule( 2, 300 ) );
+	QVERIFY( wheel.schedule( 3, 20000 ) );
+	QVERIFY( wheel.schedule( 4, 5000000 ) );
+	QVERIFY( wheel.schedule( 5, 100000000 ) );
+	QVERIFY( !wheel.schedule( 6, 0 ) );
+	QCOMPARE( wheel.size(), 5u );
+
+	const int64_t expected[] = { 7, 300, 20000, 5000000, 100000000 };
+	for( unsigned item = 1; item <= 5; ++item ) {
+		int64_t expiredAt = -1;
+		for( int64_t time = wheel.time() + 1; expiredAt < 0; ++time ) {
+			wheel.advance( time, [&]( unsigned expired ) {
+				QCOMPARE( expired, item );
+				expiredAt = time;
+			});
+			// Use large steps far from the expiration time, small ones near it
+			if( expected[item - 1] - time > 1000 ) {
+				time += ( expected[item - 1] - time ) / 2;
+			}
+		}
+		QCOMPARE( expiredAt, expected[item - 1] );
+	}
+	QCOMPARE( wheel.size(), 0u );
+}
+
+void TimerWheelTest::test_rescheduleAndCancel() {
+	wsw::TimerWheel<16> wheel( 1000 );
+	QVERIFY( wheel.schedule( 3, 1100 ) );
+	QVERIFY( wheel.schedule( 3, 1300 ) );
+	QVERIFY( wheel.schedule( 4, 1200 ) );
+	wheel.cancel( 4 );
+	QVERIFY( !wheel.isScheduled( 4 ) );
+	QCOMPARE( wheel.size(), 1u );
+
+	std::vector<unsigned> expired;
+	wheel.advance( 1299, [&]( unsigned item ) { expired.push_back( item ); } );
+	QVERIFY( expired.empty() );
+	wheel.advance( 1300, [&]( unsigned item ) { expired.push_back( item ); } );
+	QCOMPARE( expired.size(), (size_t)1 );
+	QCOMPARE( expired.front(), 3u );
+	QVERIFY( !wheel.isScheduled( 3 ) );
+}
+
+void TimerWheelTest::test_matchesLinearScan() {
+	EntityThinks thinks( 1 );
+	wsw::TimerWheel<kNumEntities> wheel;
+	for( unsigned i = 0; i < kNumEntities; ++i ) {
+		if( thinks.nextThink[i] ) {
+			wheel.schedule( i, thinks.nextThink[i] );
+		}
+	}
+
+	std::mt19937 rng( 2 );
+	std::vector<unsigned> fromWheel, fromScan;
+	for( int64_t levelTime = 0; levelTime < 120000; ) {
+		// Simulate hitches and long pauses too
+		const unsigned dice = rng() % 1000;
+		levelTime += dice ? kFrameTime : 20000;
+		fromWheel.clear();
+		fromScan.clear();
+		wheel.advance( levelTime, [&]( unsigned item ) { fromWheel.push_back( item ); } );
+		for( unsigned i = 0; i < kNumEntities; ++i ) {
+			if( thinks.nextThink[i] > 0 && thinks.nextThink[i] <= levelTime ) {
+				fromScan.push_back( i );
+			}
+		}
+		std::sort( fromWheel.begin(), fromWheel.end() );
+		QCOMPARE( fromWheel, fromScan );
+		for( unsigned entNum: fromScan ) {
+			if( const int64_t nextThink = thinks.think( entNum, levelTime ) ) {
+				wheel.schedule( entNum, nextThink );
+			}
+		}
+		// Some entities get triggered by others
+		if( !( rng() % 10 ) ) {
+			const unsigned entNum = rng() % kNumEntities;
+			thinks.nextThink[entNum] = levelTime + 1 + rng() % 5000;
+			wheel.schedule( entNum, thinks.nextThink[entNum] );
+		}
+	}
+}
+
+void TimerWheelTest::benchmark_idleEntities_linearScan() {
+	EntityThinks thinks( 3 );
+	int64_t levelTime = 0;
+	unsigned numThinks = 0;
+	QBENCHMARK {
+		for( int frame = 0; frame < 64; ++frame ) {
+			levelTime += kFrameTime;
+			for( unsigned i = 0; i < kNumEntities; ++i ) {
+				if( thinks.nextThink[i] > 0 && thinks.nextThink[i] <= levelTime ) {
+					thinks.think( i, levelTime );
+					numThinks++;
+				}
+			}
+		}
+	}
+	QVERIFY( numThinks > 0 );
+}
+
+void TimerWheelTest::benchmark_idleEntities_timerWheel() {
+	EntityThinks thinks( 3 );
+	wsw::TimerWheel<kNumEntities> wheel;
+	for( unsigned i = 0; i < kNumEntities; ++i ) {
+		if( thinks.nextThink[i] ) {
+			wheel.schedule( i, thinks.nextThink[i] );
+		}
+	}
+	int64_t levelTime = 0;
+	unsigned numThinks = 0;
+	std::vector<unsigned> due;
+	due.reserve( kNumEntities );
+	QBENCHMARK {
+		for( int frame = 0; frame < 64; ++frame ) {
+			levelTime += kFrameTime;
+			due.clear();
+			wheel.advance( levelTime, [&]( unsigned item ) { due.push_back( item ); } );
+			for( unsigned entNum: due ) {
+				if( const int64_t nextThink = thinks.think( entNum, levelTime ) ) {
+					wheel.schedule( entNum, nextThink );
+				}
+				numThinks++;
+			}
+		}
+	}
+	QVERIFY( numThinks > 0 );
+}
@@ -0,0 +1,17 @@
+#ifndef WSW_TIMERWHEELTEST_H
+#define WSW_TIMERWHEELTEST_H
+
+#include <QtTest/QtTest>
+
+class TimerWheelTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void test_expirationAtScheduledTime();
+	void test_rescheduleAndCancel();
+	void test_matchesLinearScan();
+	void benchmark_idleEntities_linearScan();
+	void benchmark_idleEntities_timerWheel();
+};
+
+#endif
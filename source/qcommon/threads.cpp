@@ -20,6 +20,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "qcommon.h"
 #include "sys_threads.h"
+#include "wswmpscqueue.h"
 
 /*
 * QMutex_Create
@@ -144,31 +145,17 @@ void QThreads_Shutdown( void ) {
 // ============================================================================
 
 struct qbufPipe_s {
-	int blockWrite;
-	volatile int terminated;
-	unsigned write_pos;
-	unsigned read_pos;
-	volatile int cmdbuf_len;
-	qmutex_t *cmdbuf_mutex;
-	size_t bufSize;
-	qcondvar_t *nonempty_condvar;
-	qmutex_t *nonempty_mutex;
-	char *buf;
+	qbufPipe_s( size_t bufSize, int flags ) : queue( bufSize ), blockWrite( ( flags & 1 ) != 0 ) {}
+
+	wsw::MpscCommandQueue queue;
+	const bool blockWrite;
 };
 
 /*
 * QBufPipe_Create
 */
 qbufPipe_t *QBufPipe_Create( size_t bufSize, int flags ) {
-	qbufPipe_t *pipe = (qbufPipe_t *)malloc( sizeof( *pipe ) + bufSize );
-	memset( pipe, 0, sizeof( *pipe ) );
-	pipe->blockWrite = flags & 1;
-	pipe->buf = (char *)( pipe + 1 );
-	pipe->bufSize = bufSize;
-	pipe->cmdbuf_mutex = QMutex_Create();
-	pipe->nonempty_condvar = QCondVar_Create();
-	pipe->nonempty_mutex = QMutex_Create();
-	return pipe;
+	return new qbufPipe_t( bufSize, flags );
 }
 
 /*
@@ -185,19 +172,12 @@ void QBufPipe_Destroy( qbufPipe_t **ppipe ) {
 	pipe = *ppipe;
 	*ppipe = NULL;
 
-	QMutex_Destroy( &pipe->cmdbuf_mutex );
-	QMutex_Destroy( &pipe->nonempty_mutex );
-	QCondVar_Destroy( &pipe->nonempty_condvar );
-	free( pipe );
-}
+	const wsw::MpscCommandQueue::Stats stats = pipe->queue.stats();
+	Com_DPrintf( "QBufPipe_Destroy: %" PRIu64 " writes, %" PRIu64 " reserve retries, %" PRIu64 " full writes, "
+				 "%" PRIu64 " batches, %" PRIu64 " wakeups\n", stats.numWrites, stats.numReserveRetries,
+				 stats.numFullWrites, stats.numBatches, stats.numWakeups );
 
-/*
-* QBufPipe_Wake
-*
-* Signals the waiting thread to wake up.
-*/
-static void QBufPipe_Wake( qbufPipe_t *pipe ) {
-	QCondVar_Wake( pipe->nonempty_condvar );
+	delete pipe;
 }
 
 /*
@@ -207,161 +187,59 @@ static void QBufPipe_Wake( qbufPipe_t *pipe ) {
 * or terminates with an error.
 */
 void QBufPipe_Finish( qbufPipe_t *pipe ) {
-	while( Sys_Atomic_CAS( &pipe->cmdbuf_len, 0, 0, pipe->cmdbuf_mutex ) == false && !pipe->terminated ) {
-		QMutex_Lock( pipe->nonempty_mutex );
-		QBufPipe_Wake( pipe );
-		QMutex_Unlock( pipe->nonempty_mutex );
+	while( !pipe->queue.isEmpty() && !pipe->queue.terminated() ) {
+		pipe->queue.wake();
 		QThread_Yield();
 	}
 }
 
-/*
-* QBufPipe_AllocCmd
-*/
-static void *QBufPipe_AllocCmd( qbufPipe_t *pipe, unsigned cmd_size ) {
-	void *buf = &pipe->buf[pipe->write_pos];
-	pipe->write_pos += cmd_size;
-	return buf;
-}
-
-/*
-* QBufPipe_BufLenAdd
-*/
-static void QBufPipe_BufLenAdd( qbufPipe_t *pipe, int val ) {
-	Sys_Atomic_Add( &pipe->cmdbuf_len, val, pipe->cmdbuf_mutex );
-}
-
 /*
 * QBufPipe_WriteCmd
 *
-* Add new command to buffer. Never allow the distance between the reader
-* and the writer to grow beyond the size of the buffer.
-*
-* Note that there are race conditions here but in the worst case we're going
-* to erroneously drop cmd's instead of stepping on the reader's toes.
+* Add new command to buffer. May be called by multiple threads.
+* If the buffer is full, either waits for the reader or drops the command
+* depending on flags the pipe has been created with.
 */
 void QBufPipe_WriteCmd( qbufPipe_t *pipe, const void *pcmd, unsigned cmd_size ) {
-	void *buf;
-	unsigned write_remains;
-
 	if( !pipe ) {
 		return;
 	}
-	if( pipe->terminated ) {
-		return;
-	}
 
-	assert( pipe->bufSize >= pipe->write_pos );
-	if( pipe->bufSize < pipe->write_pos ) {
-		pipe->write_pos = 0;
+	assert( cmd_size <= pipe->queue.maxCommandSize() );
+	if( cmd_size > pipe->queue.maxCommandSize() ) {
+		return;
 	}
 
-	write_remains = pipe->bufSize - pipe->write_pos;
-
-	if( sizeof( int ) > write_remains ) {
-		while( pipe->cmdbuf_len + cmd_size + write_remains > pipe->bufSize ) {
-			if( pipe->blockWrite ) {
-				QThread_Yield();
-				continue;
-			}
-			return;
-		}
-
-		// not enough space to enpipe even the reset cmd, rewind
-		QBufPipe_BufLenAdd( pipe, write_remains ); // atomic
-		pipe->write_pos = 0;
-	} else if( cmd_size > write_remains ) {
-		int *cmd;
-
-		while( pipe->cmdbuf_len + sizeof( int ) + cmd_size + write_remains > pipe->bufSize ) {
-			if( pipe->blockWrite ) {
-				QThread_Yield();
-				continue;
-			}
-			return;
-		}
-
-		// explicit pointer reset cmd
-		cmd = (int *)QBufPipe_AllocCmd( pipe, sizeof( int ) );
-		*cmd = -1;
-
-		QBufPipe_BufLenAdd( pipe, sizeof( *cmd ) + write_remains ); // atomic
-		pipe->write_pos = 0;
+	if( pipe->blockWrite ) {
+		pipe->queue.write( pcmd, cmd_size );
 	} else {
-		while( pipe->cmdbuf_len + cmd_size > pipe->bufSize ) {
-			if( pipe->blockWrite ) {
-				QThread_Yield();
-				continue;
-			}
-			return;
-		}
+		pipe->queue.tryWrite( pcmd, cmd_size );
 	}
-
-	buf = QBufPipe_AllocCmd( pipe, cmd_size );
-	memcpy( buf, pcmd, cmd_size );
-	QBufPipe_BufLenAdd( pipe, cmd_size ); // atomic
-
-	// wake the other thread waiting for signal
-	QMutex_Lock( pipe->nonempty_mutex );
-	QBufPipe_Wake( pipe );
-	QMutex_Unlock( pipe->nonempty_mutex );
 }
 
 /*
 * QBufPipe_ReadCmds
 */
 int QBufPipe_ReadCmds( qbufPipe_t *pipe, unsigned( **cmdHandlers )( const void * ) ) {
-	int read = 0;
-
 	if( !pipe ) {
 		return -1;
 	}
 
-	while( Sys_Atomic_CAS( &pipe->cmdbuf_len, 0, 0, pipe->cmdbuf_mutex ) == false && !pipe->terminated ) {
-		int cmd;
-		int cmd_size;
-		int read_remains;
-
-		assert( pipe->bufSize >= pipe->read_pos );
-		if( pipe->bufSize < pipe->read_pos ) {
-			pipe->read_pos = 0;
-		}
-
-		read_remains = pipe->bufSize - pipe->read_pos;
-
-		if( (int )sizeof( int ) > read_remains ) {
-			// implicit reset
-			pipe->read_pos = 0;
-			QBufPipe_BufLenAdd( pipe, -read_remains );
-		}
-
-		cmd = *( (int *)( pipe->buf + pipe->read_pos ) );
-		if( cmd == -1 ) {
-			// this cmd is special
-			pipe->read_pos = 0;
-			QBufPipe_BufLenAdd( pipe, -( (int)( sizeof( int ) + read_remains ) ) ); // atomic
-			continue;
-		}
-
-		cmd_size = cmdHandlers[cmd]( pipe->buf + pipe->read_pos );
-		read++;
+	const unsigned read = pipe->queue.read( [=]( const void *cmd, unsigned cmd_size ) {
+		const unsigned handled_size = cmdHandlers[*( (const int *)cmd )]( cmd );
+		// a zero size requests termination, a size that exceeds the written one means a broken command
+		assert( handled_size <= cmd_size );
+		return handled_size && handled_size <= cmd_size;
+	});
 
-		if( !cmd_size ) {
-			pipe->terminated = 1;
-			return -1;
-		}
-
-		if( cmd_size > pipe->cmdbuf_len ) {
-			assert( 0 );
-			pipe->terminated = 1;
-			return -1;
-		}
-
-		pipe->read_pos += cmd_size;
-		QBufPipe_BufLenAdd( pipe, -cmd_size ); // atomic
-	}
+	return pipe->queue.terminated() ? -1 : (int)read;
+}
 
-	return read;
+/*
+* QBufPipe_WaitForCmds
+*/
+bool QBufPipe_WaitForCmds( qbufPipe_t *pipe, unsigned timeout_msec ) {
+	return pipe->queue.waitForCommands( timeout_msec == Q_THREADS_WAIT_INFINITE ? -1 : (int)timeout_msec );
 }
 
 /*
@@ -369,24 +247,10 @@ int QBufPipe_ReadCmds( qbufPipe_t *pipe, unsigned( **cmdHandlers )( const void *
 */
 void QBufPipe_Wait( qbufPipe_t *pipe, int ( *read )( qbufPipe_t *, unsigned( ** )( const void * ), bool ),
 					unsigned( **cmdHandlers )( const void * ), unsigned timeout_msec ) {
-	while( !pipe->terminated ) {
-		int res;
-		bool timeout = false;
-
-		while( Sys_Atomic_CAS( &pipe->cmdbuf_len, 0, 0, pipe->cmdbuf_mutex ) == true ) {
-			QMutex_Lock( pipe->nonempty_mutex );
-
-			timeout = QCondVar_Wait( pipe->nonempty_condvar, pipe->nonempty_mutex, timeout_msec ) == false;
-
-			// don't hold the mutex, changes to cmdbuf_len are atomic anyway
-			QMutex_Unlock( pipe->nonempty_mutex );
-			break;
-		}
-
-		// we're guaranteed at this point that either cmdbuf_len is > 0
-		// or that waiting on the condition variable has timed out
-		res = read( pipe, cmdHandlers, timeout );
-		if( res < 0 ) {
+	while( !pipe->queue.terminated() ) {
+		// either there are commands to read or waiting has timed out
+		const bool timeout = !QBufPipe_WaitForCmds( pipe, timeout_msec );
+		if( read( pipe, cmdHandlers, timeout ) < 0 ) {
 			// done
 			return;
 		}
@@ -0,0 +1,249 @@
+#ifndef WSW_AABBTREE_H
+#define WSW_AABBTREE_H
+
+#include "../gameshared/q_arch.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <limits>
+
+namespace wsw {
+
+/**
+ * A bounding volume hierarchy of axis-aligned boxes identified by small integers (e.g. entity numbers)
+ * for sets of boxes that are built once and are rarely changed (e.g. static triggers of a map).
+ * Every node has 4 children which bounds are stored in a structure of arrays,
+ * so a node test checks all children at once (using SSE if it's available).
+ * Items can be disabled and enabled again after the tree has been built (e.g. if a static box gets unlinked),
+ * a tree has to be rebuilt to add items or to change their bounds.
+ * @note This class is not thread-safe.
+ */
+template <unsigned MaxItems>
+class AabbTree {
+	static_assert( MaxItems > 0 && MaxItems < 0x7FFF, "Illegal number of items" );
+
+	// A leaf lane refers to an item as ~item, an empty lane has inverted bounds
+	struct alignas( 16 ) Node {
+		float minX[4], minY[4], minZ[4];
+		float maxX[4], maxY[4], maxZ[4];
+		int16_t children[4];
+	};
+
+	struct Box {
+		float mins[3], maxs[3];
+		float center[3];
+		uint16_t item;
+	};
+
+	// Every node has at least 2 non-empty lanes, so there are less nodes than items
+	static constexpr unsigned kMaxNodes = MaxItems;
+	static constexpr unsigned kMaxDepth = 32;
+
+	enum : uint8_t { kAbsent, kEnabled, kDisabled };
+
+	Node nodes[kMaxNodes];
+	Box boxes[MaxItems];
+	uint8_t states[MaxItems];
+	unsigned numNodes { 0 };
+	unsigned numBoxes { 0 };
+
+	static void setLane( Node *node, unsigned lane, const float *mins, const float *maxs, int child ) {
+		node->minX[lane] = mins[0], node->minY[lane] = mins[1], node->minZ[lane] = mins[2];
+		node->maxX[lane] = maxs[0], node->maxY[lane] = maxs[1], node->maxZ[lane] = maxs[2];
+		node->children[lane] = (int16_t)child;
+	}
+
+	static void clearLane( Node *node, unsigned lane ) {
+		const float inf = std::numeric_limits<float>::infinity();
+		const float mins[3] = { +inf, +inf, +inf };
+		const float maxs[3] = { -inf, -inf, -inf };
+		setLane( node, lane, mins, maxs, ~0 );
+	}
+
+	static void addBoundsOf( const Box *begin, const Box *end, float *mins, float *maxs ) {
+		for( const Box *box = begin; box != end; ++box ) {
+			for( int i = 0; i < 3; ++i ) {
+				mins[i] = std::min( mins[i], box->mins[i] );
+				maxs[i] = std::max( maxs[i], box->maxs[i] );
+			}
+		}
+	}
+
+	/**
+	 * Splits a range of boxes into 4 groups of (almost) equal size by centers along the longest axis
+	 * and makes a node that refers to groups (directly if a group consists of a single box).
+	 */
+	unsigned buildNode( Box *begin, Box *end ) {
+		const unsigned nodeIndex = numNodes++;
+		assert( nodeIndex < kMaxNodes );
+		const unsigned count = (unsigned)( end - begin );
+
+		Box *groups[5];
+		if( count <= 4 ) {
+			for( unsigned i = 0; i <= 4; ++i ) {
+				groups[i] = begin + std::min( i, count );
+			}
+		} else {
+			float centerMins[3] = { +std::numeric_limits<float>::max(), +std::numeric_limits<float>::max(), +std::numeric_limits<float>::max() };
+			float centerMaxs[3] = { -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+			for( const Box *box = begin; box != end; ++box ) {
+				for( int i = 0; i < 3; ++i ) {
+					centerMins[i] = std::min( centerMins[i], box->center[i] );
+					centerMaxs[i] = std::max( centerMaxs[i], box->center[i] );
+				}
+			}
+			int axis = 0;
+			for( int i = 1; i < 3; ++i ) {
+				if( centerMaxs[i] - centerMins[i] > centerMaxs[axis] - centerMins[axis] ) {
+					axis = i;
+				}
+			}
+			std::sort( begin, end, [=]( const Box &lhs, const Box &rhs ) {
+				return lhs.center[axis] < rhs.center[axis] || ( lhs.center[axis] == rhs.center[axis] && lhs.item < rhs.item );
+			});
+			for( unsigned i = 0; i <= 4; ++i ) {
+				groups[i] = begin + ( count * i ) / 4;
+			}
+		}
+
+		for( unsigned lane = 0; lane < 4; ++lane ) {
+			Box *const groupBegin = groups[lane], *const groupEnd = groups[lane + 1];
+			if( groupBegin == groupEnd ) {
+				clearLane( &nodes[nodeIndex], lane );
+			} else if( groupEnd - groupBegin == 1 ) {
+				setLane( &nodes[nodeIndex], lane, groupBegin->mins, groupBegin->maxs, ~(int)groupBegin->item );
+			} else {
+				float mins[3] = { +std::numeric_limits<float>::max(), +std::numeric_limits<float>::max(), +std::numeric_limits<float>::max() };
+				float maxs[3] = { -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+				addBoundsOf( groupBegin, groupEnd, mins, maxs );
+				const unsigned childIndex = buildNode( groupBegin, groupEnd );
+				setLane( &nodes[nodeIndex], lane, mins, maxs, (int)childIndex );
+			}
+		}
+
+		return nodeIndex;
+	}
+
+	/**
+	 * Returns a mask of node lanes that overlap the given box (boundaries are inclusive).
+	 */
+	static unsigned overlapMask( const Node *node, const float *mins, const float *maxs ) {
+#ifdef WSW_USE_SSE2
+		__m128 overlaps = _mm_cmple_ps( _mm_load_ps( node->minX ), _mm_set1_ps( maxs[0] ) );
+		overlaps = _mm_and_ps( overlaps, _mm_cmpge_ps( _mm_load_ps( node->maxX ), _mm_set1_ps( mins[0] ) ) );
+		overlaps = _mm_and_ps( overlaps, _mm_cmple_ps( _mm_load_ps( node->minY ), _mm_set1_ps( maxs[1] ) ) );
+		overlaps = _mm_and_ps( overlaps, _mm_cmpge_ps( _mm_load_ps( node->maxY ), _mm_set1_ps( mins[1] ) ) );
+		overlaps = _mm_and_ps( overlaps, _mm_cmple_ps( _mm_load_ps( node->minZ ), _mm_set1_ps( maxs[2] ) ) );
+		overlaps = _mm_and_ps( overlaps, _mm_cmpge_ps( _mm_load_ps( node->maxZ ), _mm_set1_ps( mins[2] ) ) );
+		return (unsigned)_mm_movemask_ps( overlaps );
+#else
+		unsigned mask = 0;
+		for( unsigned lane = 0; lane < 4; ++lane ) {
+			bool overlaps = node->minX[lane] <= maxs[0] && node->maxX[lane] >= mins[0];
+			overlaps &= node->minY[lane] <= maxs[1] && node->maxY[lane] >= mins[1];
+			overlaps &= node->minZ[lane] <= maxs[2] && node->maxZ[lane] >= mins[2];
+			mask |= (unsigned)overlaps << lane;
+		}
+		return mask;
+#endif
+	}
+public:
+	AabbTree() { clear(); }
+
+	void clear() {
+		numNodes = numBoxes = 0;
+		std::memset( states, kAbsent, sizeof( states ) );
+	}
+
+	[[nodiscard]]
+	unsigned size() const { return numBoxes; }
+	[[nodiscard]]
+	bool contains( unsigned item ) const { return states[item] != kAbsent; }
+	[[nodiscard]]
+	bool isEnabled( unsigned item ) const { return states[item] == kEnabled; }
+
+	/**
+	 * Adds a box to a set of boxes the tree is going to be built of.
+	 * @note {@code build()} must be called to make added boxes visible to queries.
+	 */
+	void add( unsigned item, const float *mins, const float *maxs ) {
+		assert( item < MaxItems && numBoxes < MaxItems );
+		Box *box = &boxes[numBoxes++];
+		for( int i = 0; i < 3; ++i ) {
+			box->mins[i] = mins[i];
+			box->maxs[i] = maxs[i];
+			box->center[i] = 0.5f * ( mins[i] + maxs[i] );
+		}
+		box->item = (uint16_t)item;
+	}
+
+	/**
+	 * Builds the tree of all added boxes. Boxes that have been disabled become enabled again.
+	 */
+	void build() {
+		numNodes = 0;
+		std::memset( states, kAbsent, sizeof( states ) );
+		for( unsigned i = 0; i < numBoxes; ++i ) {
+			states[boxes[i].item] = kEnabled;
+		}
+		if( numBoxes ) {
+			buildNode( boxes, boxes + numBoxes );
+		}
+	}
+
+	/**
+	 * Excludes an item from results of queries until it's enabled again or the tree is rebuilt.
+	 */
+	void disable( unsigned item ) {
+		assert( item < MaxItems );
+		if( states[item] == kEnabled ) {
+			states[item] = kDisabled;
+		}
+	}
+
+	/**
+	 * Makes an item that has been disabled visible to queries again.
+	 * @note the item must have been added to the tree on the last build.
+	 */
+	void enable( unsigned item ) {
+		assert( item < MaxItems && states[item] != kAbsent );
+		states[item] = kEnabled;
+	}
+
+	/**
+	 * Calls {@code onOverlap( item )} for every enabled box that overlaps the given one (boundaries are inclusive).
+	 * An order of items is unspecified.
+	 */
+	template <typename OnOverlap>
+	void query( const float *mins, const float *maxs, OnOverlap &&onOverlap ) const {
+		if( !numNodes ) {
+			return;
+		}
+
+		// A node replaces itself by at most 4 children on the stack, the tree is balanced and shallow
+		unsigned stack[kMaxDepth * 3 + 1];
+		unsigned stackSize = 0;
+		stack[stackSize++] = 0;
+		do {
+			const Node *node = &nodes[stack[--stackSize]];
+			unsigned mask = overlapMask( node, mins, maxs );
+			for( unsigned lane = 0; mask; ++lane, mask >>= 1 ) {
+				if( !( mask & 1 ) ) {
+					continue;
+				}
+				const int child = node->children[lane];
+				if( child >= 0 ) {
+					stack[stackSize++] = (unsigned)child;
+				} else if( states[~child] == kEnabled ) {
+					onOverlap( (unsigned)~child );
+				}
+			}
+		} while( stackSize );
+	}
+};
+
+}
+
+#endif
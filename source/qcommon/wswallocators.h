@@ -0,0 +1,310 @@
+#ifndef WSW_ALLOCATORS_H
+#define WSW_ALLOCATORS_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace wsw {
+
+/**
+ * A pair of functions that allocators of this file use for getting memory chunks from the heap.
+ * Supplying custom functions allows the owner to account reserved memory.
+ */
+struct UpstreamAllocator {
+	void *( *allocate )( size_t size );
+	void ( *deallocate )( void *p );
+
+	static void *defaultAllocate( size_t size ) {
+		if( void *p = std::malloc( size ) ) {
+			return p;
+		}
+		throw std::bad_alloc();
+	}
+
+	static void defaultDeallocate( void *p ) { std::free( p ); }
+};
+
+constexpr UpstreamAllocator kDefaultUpstreamAllocator {
+	&UpstreamAllocator::defaultAllocate, &UpstreamAllocator::defaultDeallocate
+};
+
+inline uint8_t *AlignUp( uint8_t *p, size_t alignment ) {
+	assert( alignment && !( alignment & ( alignment - 1 ) ) );
+	return (uint8_t *)( ( (uintptr_t)p + alignment - 1 ) & ~(uintptr_t)( alignment - 1 ) );
+}
+
+/**
+ * An allocator that bumps a pointer within chunks of memory and releases everything at once on {@code reset()}.
+ * Individual blocks are never freed, so it suits transient data of a known lifetime (e.g. a frame).
+ * If a reset arena has used multiple chunks, they get replaced by a single chunk of the total size,
+ * so a steady workload ends up served by a single chunk.
+ * @note This allocator is not thread-safe.
+ */
+class LinearArena {
+	struct Chunk {
+		Chunk *next;
+		uint8_t *data;
+		size_t capacity;
+		size_t used;
+	};
+
+	const UpstreamAllocator upstream;
+	const size_t minChunkSize;
+	Chunk *head { nullptr };
+	size_t numChunks { 0 };
+	size_t numUsedBytes { 0 };
+	size_t numReservedBytes { 0 };
+	size_t peakUsedBytes { 0 };
+
+	void addChunk( size_t capacity ) {
+		auto *const chunk = (Chunk *)upstream.allocate( sizeof( Chunk ) + capacity );
+		chunk->next = head;
+		chunk->data = (uint8_t *)( chunk + 1 );
+		chunk->capacity = capacity;
+		chunk->used = 0;
+		head = chunk;
+		numChunks++;
+		numReservedBytes += capacity;
+	}
+
+	void releaseChunks() {
+		for( Chunk *chunk = head, *next; chunk; chunk = next ) {
+			next = chunk->next;
+			upstream.deallocate( chunk );
+		}
+		head = nullptr;
+		numChunks = 0;
+		numReservedBytes = 0;
+	}
+
+	[[nodiscard]]
+	void *tryAllocateInHead( size_t size, size_t alignment ) {
+		if( !head ) {
+			return nullptr;
+		}
+		uint8_t *const top = head->data + head->used;
+		uint8_t *const result = AlignUp( top, alignment );
+		if( result + size > head->data + head->capacity ) {
+			return nullptr;
+		}
+		head->used = ( result + size ) - head->data;
+		numUsedBytes += ( result + size ) - top;
+		if( peakUsedBytes < numUsedBytes ) {
+			peakUsedBytes = numUsedBytes;
+		}
+		return result;
+	}
+public:
+	/**
+	 * @param minChunkSize_ a minimal capacity of a chunk, larger chunks are allocated for larger blocks
+	 * @param upstream_ functions for getting chunks from the heap
+	 */
+	explicit LinearArena( size_t minChunkSize_ = 64 * 1024,
+						  const UpstreamAllocator &upstream_ = kDefaultUpstreamAllocator )
+		: upstream( upstream_ ), minChunkSize( minChunkSize_ ) {}
+
+	~LinearArena() { releaseChunks(); }
+
+	LinearArena( const LinearArena & ) = delete;
+	LinearArena &operator=( const LinearArena & ) = delete;
+
+	/**
+	 * Allocates an uninitialized block that remains valid until the next {@code reset()} call.
+	 * @param alignment a power of two
+	 */
+	[[nodiscard]]
+	void *allocate( size_t size, size_t alignment = 16 ) {
+		if( void *result = tryAllocateInHead( size, alignment ) ) {
+			return result;
+		}
+		const size_t requiredCapacity = size + alignment - 1;
+		addChunk( requiredCapacity > minChunkSize ? requiredCapacity : minChunkSize );
+		void *result = tryAllocateInHead( size, alignment );
+		assert( result );
+		return result;
+	}
+
+	/**
+	 * Invalidates all allocated blocks.
+	 */
+	void reset() {
+		if( numChunks > 1 ) {
+			const size_t totalCapacity = numReservedBytes;
+			releaseChunks();
+			addChunk( totalCapacity );
+		} else if( head ) {
+			head->used = 0;
+		}
+		numUsedBytes = 0;
+	}
+
+	/**
+	 * Invalidates all allocated blocks and returns all chunks to the heap.
+	 */
+	void clear() {
+		releaseChunks();
+		numUsedBytes = 0;
+	}
+
+	[[nodiscard]]
+	size_t usedBytes() const { return numUsedBytes; }
+	[[nodiscard]]
+	size_t reservedBytes() const { return numReservedBytes; }
+	[[nodiscard]]
+	size_t peakBytes() const { return peakUsedBytes; }
+};
+
+/**
+ * An allocator of variable-sized blocks that rounds sizes up to power-of-two classes
+ * and reuses freed blocks of every class via an intrusive freelist.
+ * Blocks of a class are carved from dedicated chunks that are not returned to the heap until the allocator is destroyed.
+ * Blocks larger than {@code kMaxBlockSize} are allocated directly in the heap.
+ * A size of a block must be supplied on deallocation, so blocks do not have headers.
+ * All blocks are aligned at least by {@code kMinBlockSize}.
+ * @note This allocator is not thread-safe.
+ */
+class SizeClassAllocator {
+public:
+	static constexpr size_t kMinBlockSize = 16;
+	static constexpr size_t kMaxBlockSize = 1024;
+	static constexpr unsigned kNumClasses = 7;
+private:
+	static constexpr size_t kChunkSize = 16 * 1024;
+
+	struct FreeBlock {
+		FreeBlock *next;
+	};
+
+	struct Chunk {
+		Chunk *next;
+	};
+
+	const UpstreamAllocator upstream;
+	FreeBlock *freeHeads[kNumClasses] {};
+	Chunk *chunksHead { nullptr };
+	size_t numChunks { 0 };
+	size_t numUsedBytes { 0 };
+	size_t numLargeBytes { 0 };
+
+	static unsigned classOf( size_t size ) {
+		unsigned sizeClass = 0;
+		for( size_t classSize = kMinBlockSize; classSize < size; classSize <<= 1 ) {
+			sizeClass++;
+		}
+		return sizeClass;
+	}
+
+	void addChunk( unsigned sizeClass ) {
+		auto *const chunk = (Chunk *)upstream.allocate( kChunkSize );
+		chunk->next = chunksHead;
+		chunksHead = chunk;
+		numChunks++;
+
+		const size_t blockSize = kMinBlockSize << sizeClass;
+		uint8_t *const end = (uint8_t *)chunk + kChunkSize;
+		// Link blocks so they are going to be allocated in the address order
+		FreeBlock **tail = &freeHeads[sizeClass];
+		for( uint8_t *p = AlignUp( (uint8_t *)( chunk + 1 ), kMinBlockSize ); p + blockSize <= end; p += blockSize ) {
+			*tail = (FreeBlock *)p;
+			tail = &( (FreeBlock *)p )->next;
+		}
+		*tail = nullptr;
+	}
+public:
+	explicit SizeClassAllocator( const UpstreamAllocator &upstream_ = kDefaultUpstreamAllocator )
+		: upstream( upstream_ ) {}
+
+	~SizeClassAllocator() {
+		for( Chunk *chunk = chunksHead, *next; chunk; chunk = next ) {
+			next = chunk->next;
+			upstream.deallocate( chunk );
+		}
+	}
+
+	SizeClassAllocator( const SizeClassAllocator & ) = delete;
+	SizeClassAllocator &operator=( const SizeClassAllocator & ) = delete;
+
+	/**
+	 * Returns an actual capacity of a block of the given size.
+	 */
+	[[nodiscard]]
+	static size_t capacityOf( size_t size ) {
+		return size <= kMaxBlockSize ? kMinBlockSize << classOf( size ) : size;
+	}
+
+	/**
+	 * Allocates an uninitialized block.
+	 */
+	[[nodiscard]]
+	void *allocate( size_t size ) {
+		if( size > kMaxBlockSize ) {
+			numLargeBytes += size;
+			return upstream.allocate( size );
+		}
+		const unsigned sizeClass = classOf( size );
+		if( !freeHeads[sizeClass] ) {
+			addChunk( sizeClass );
+		}
+		FreeBlock *const block = freeHeads[sizeClass];
+		freeHeads[sizeClass] = block->next;
+		numUsedBytes += kMinBlockSize << sizeClass;
+		return block;
+	}
+
+	/**
+	 * @param size a size the block has been allocated or reallocated with
+	 */
+	void deallocate( void *p, size_t size ) {
+		if( !p ) {
+			return;
+		}
+		if( size > kMaxBlockSize ) {
+			assert( numLargeBytes >= size );
+			numLargeBytes -= size;
+			upstream.deallocate( p );
+			return;
+		}
+		const unsigned sizeClass = classOf( size );
+		assert( numUsedBytes >= ( kMinBlockSize << sizeClass ) );
+		numUsedBytes -= kMinBlockSize << sizeClass;
+		auto *const block = (FreeBlock *)p;
+		block->next = freeHeads[sizeClass];
+		freeHeads[sizeClass] = block;
+	}
+
+	/**
+	 * Resizes a block preserving its contents up to the minimal size.
+	 * The block is kept in place if the new size fits its capacity.
+	 */
+	[[nodiscard]]
+	void *reallocate( void *p, size_t oldSize, size_t newSize ) {
+		if( p && oldSize <= kMaxBlockSize && newSize <= kMaxBlockSize && classOf( oldSize ) == classOf( newSize ) ) {
+			return p;
+		}
+		void *const result = allocate( newSize );
+		if( p ) {
+			std::memcpy( result, p, oldSize < newSize ? oldSize : newSize );
+			deallocate( p, oldSize );
+		}
+		return result;
+	}
+
+	/**
+	 * Returns a total capacity of live blocks.
+	 */
+	[[nodiscard]]
+	size_t usedBytes() const { return numUsedBytes + numLargeBytes; }
+	/**
+	 * Returns a total size of memory obtained from the heap, including free blocks.
+	 */
+	[[nodiscard]]
+	size_t reservedBytes() const { return numChunks * kChunkSize + numLargeBytes; }
+};
+
+}
+
+#endif
@@ -23,9 +23,9 @@
 #include "qcommon.h"
 
 ///////////////////////
-#define WMALLOC( x )      Q_malloc( x )
-#define WREALLOC( x, y )  ( ( x ) ? Mem_Realloc( ( x ), ( y ) ) : WMALLOC( y ) )
-#define WFREE( x )        Q_free( x )
+#define WMALLOC( x )      Q_TagMalloc( x, MEMTAG_NETWORK )
+#define WREALLOC( x, y )  Q_TagRealloc( x, y, MEMTAG_NETWORK )
+#define WFREE( x )        Q_TagFree( x )
 
 // Curl setopt wrapper
 #define CURLSETOPT( c,r,o,v ) { if( c ) { r = qcurl_easy_setopt( c,o,v ); if( r ) { printf( "\nCURL ERROR: %d: %s\n", r, qcurl_easy_strerror( r ) ); qcurl_easy_cleanup( c ) ; c = NULL; } } }
@@ -686,12 +686,12 @@ static int wswcurl_debug_callback( CURL *curl, curl_infotype infotype, char *buf
 		return 0;
 	}
 
-	temp = (char *)Q_malloc( buf_size + 1 );
+	temp = (char *)WMALLOC( buf_size + 1 );
 	memcpy( temp, buf, buf_size );
 
 	Com_Printf( "%s\n", temp );
 
-	Q_free( temp );
+	WFREE( temp );
 
 	return 0;
 }
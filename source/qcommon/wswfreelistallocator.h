@@ -0,0 +1,88 @@
+#ifndef WSW_FREELISTALLOCATOR_H
+#define WSW_FREELISTALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
+namespace wsw {
+
+/**
+ * An allocator of fixed-size blocks for objects that are created and destroyed at high rates.
+ * Blocks are carved from chunks that are allocated on demand and are reused via an intrusive freelist.
+ * Chunks are not returned to the system until the allocator is destroyed.
+ * @note This allocator is not thread-safe.
+ */
+template <size_t BlockSize, unsigned BlocksPerChunk = 256>
+class FreelistAllocator {
+	static_assert( BlockSize > 0 && BlocksPerChunk > 0, "Illegal parameters" );
+
+	union Block {
+		Block *next;
+		alignas( alignof( std::max_align_t ) ) uint8_t data[BlockSize];
+	};
+
+	struct Chunk {
+		Chunk *next;
+		Block blocks[BlocksPerChunk];
+	};
+
+	Chunk *chunksHead { nullptr };
+	Block *freeHead { nullptr };
+	size_t numChunks { 0 };
+	size_t numAllocatedBlocks { 0 };
+
+	void addChunk() {
+		auto *const chunk = new Chunk;
+		chunk->next = chunksHead;
+		chunksHead = chunk;
+		numChunks++;
+		// Link blocks so they are going to be allocated in the address order
+		for( unsigned i = 0; i + 1 < BlocksPerChunk; ++i ) {
+			chunk->blocks[i].next = &chunk->blocks[i + 1];
+		}
+		chunk->blocks[BlocksPerChunk - 1].next = freeHead;
+		freeHead = &chunk->blocks[0];
+	}
+public:
+	static constexpr size_t kBlockSize = sizeof( Block );
+
+	FreelistAllocator() = default;
+	FreelistAllocator( const FreelistAllocator & ) = delete;
+	FreelistAllocator &operator=( const FreelistAllocator & ) = delete;
+
+	~FreelistAllocator() {
+		for( Chunk *chunk = chunksHead, *next; chunk; chunk = next ) {
+			next = chunk->next;
+			delete chunk;
+		}
+	}
+
+	[[nodiscard]]
+	void *allocate() {
+		if( !freeHead ) {
+			addChunk();
+		}
+		Block *const block = freeHead;
+		freeHead = block->next;
+		numAllocatedBlocks++;
+		return block->data;
+	}
+
+	void deallocate( void *p ) {
+		assert( p && numAllocatedBlocks );
+		auto *const block = (Block *)p;
+		block->next = freeHead;
+		freeHead = block;
+		numAllocatedBlocks--;
+	}
+
+	[[nodiscard]]
+	size_t allocatedBlocks() const { return numAllocatedBlocks; }
+	[[nodiscard]]
+	size_t reservedBlocks() const { return numChunks * BlocksPerChunk; }
+};
+
+}
+
+#endif
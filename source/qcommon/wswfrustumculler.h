@@ -0,0 +1,94 @@
+#ifndef WSW_FRUSTUMCULLER_H
+#define WSW_FRUSTUMCULLER_H
+
+#include "../gameshared/q_arch.h"
+
+#include <cassert>
+
+namespace wsw {
+
+/**
+ * Tests axis-aligned boxes that are stored in a structure of arrays against a set of planes, 4 boxes at once.
+ * Boxes are classified exactly like BoxOnPlaneSide() does it for every plane:
+ * a box is culled if it is entirely behind any plane
+ * and is partially visible if it is not entirely in front of some plane.
+ * @note Arrays of bounds must be readable for 3 elements past the last box as loads are not masked.
+ */
+class FrustumCuller {
+public:
+	static constexpr unsigned kMaxPlanes = 8;
+private:
+	float normals[kMaxPlanes][3];
+	float dists[kMaxPlanes];
+	unsigned numPlanes { 0 };
+public:
+	void clear() { numPlanes = 0; }
+
+	[[nodiscard]]
+	unsigned size() const { return numPlanes; }
+
+	void addPlane( const float *normal, float dist ) {
+		assert( numPlanes < kMaxPlanes );
+		normals[numPlanes][0] = normal[0];
+		normals[numPlanes][1] = normal[1];
+		normals[numPlanes][2] = normal[2];
+		dists[numPlanes] = dist;
+		numPlanes++;
+	}
+
+	/**
+	 * Classifies boxes [first, first + 4).
+	 * @param mins arrays of X, Y and Z min coordinates of boxes
+	 * @param maxs arrays of X, Y and Z max coordinates of boxes
+	 * @param culledMask receives a bit per box that is culled
+	 * @param partialMask receives a bit per box that is not entirely in front of all planes
+	 */
+	void classify4( const float *const *mins, const float *const *maxs, unsigned first,
+					unsigned *culledMask, unsigned *partialMask ) const {
+#ifdef WSW_USE_SSE2
+		__m128 outside = _mm_setzero_ps();
+		__m128 notInside = _mm_setzero_ps();
+		const __m128 minsX = _mm_loadu_ps( mins[0] + first ), maxsX = _mm_loadu_ps( maxs[0] + first );
+		const __m128 minsY = _mm_loadu_ps( mins[1] + first ), maxsY = _mm_loadu_ps( maxs[1] + first );
+		const __m128 minsZ = _mm_loadu_ps( mins[2] + first ), maxsZ = _mm_loadu_ps( maxs[2] + first );
+		for( unsigned i = 0; i < numPlanes; ++i ) {
+			const float *const n = normals[i];
+			const __m128 nx = _mm_set1_ps( n[0] ), ny = _mm_set1_ps( n[1] ), nz = _mm_set1_ps( n[2] );
+			// The farthest corner along the normal, the same one BoxOnPlaneSide() selects using signbits
+			__m128 dist1 = _mm_mul_ps( nx, n[0] < 0 ? minsX : maxsX );
+			dist1 = _mm_add_ps( dist1, _mm_mul_ps( ny, n[1] < 0 ? minsY : maxsY ) );
+			dist1 = _mm_add_ps( dist1, _mm_mul_ps( nz, n[2] < 0 ? minsZ : maxsZ ) );
+			__m128 dist2 = _mm_mul_ps( nx, n[0] < 0 ? maxsX : minsX );
+			dist2 = _mm_add_ps( dist2, _mm_mul_ps( ny, n[1] < 0 ? maxsY : minsY ) );
+			dist2 = _mm_add_ps( dist2, _mm_mul_ps( nz, n[2] < 0 ? maxsZ : minsZ ) );
+			const __m128 dist = _mm_set1_ps( dists[i] );
+			outside = _mm_or_ps( outside, _mm_cmplt_ps( dist1, dist ) );
+			notInside = _mm_or_ps( notInside, _mm_cmplt_ps( dist2, dist ) );
+		}
+		*culledMask = (unsigned)_mm_movemask_ps( outside );
+		*partialMask = (unsigned)_mm_movemask_ps( notInside );
+#else
+		unsigned culled = 0, partial = 0;
+		for( unsigned lane = 0; lane < 4; ++lane ) {
+			const unsigned index = first + lane;
+			for( unsigned i = 0; i < numPlanes; ++i ) {
+				const float *const n = normals[i];
+				float dist1 = n[0] * ( n[0] < 0 ? mins[0][index] : maxs[0][index] );
+				dist1 += n[1] * ( n[1] < 0 ? mins[1][index] : maxs[1][index] );
+				dist1 += n[2] * ( n[2] < 0 ? mins[2][index] : maxs[2][index] );
+				float dist2 = n[0] * ( n[0] < 0 ? maxs[0][index] : mins[0][index] );
+				dist2 += n[1] * ( n[1] < 0 ? maxs[1][index] : mins[1][index] );
+				dist2 += n[2] * ( n[2] < 0 ? maxs[2][index] : mins[2][index] );
+				culled |= (unsigned)( dist1 < dists[i] ) << lane;
+				partial |= (unsigned)( dist2 < dists[i] ) << lane;
+			}
+		}
+		*culledMask = culled;
+		*partialMask = partial;
+#endif
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef WSW_INTERNEDSTRINGS_H
+#define WSW_INTERNEDSTRINGS_H
+
+#include "wswallocators.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace wsw {
+
+/**
+ * A handle of a string that has been added to a {@code StringInterner}.
+ * Equal strings (in terms of the interner casing) share the same handle, so handles may be compared by address.
+ * Handles stay valid for the entire lifetime of the interner.
+ */
+struct InternedString {
+	const char *chars;
+	uint32_t hash;
+	uint32_t length;
+	/** A dense index of the string in the interner, it may be used for keying arrays */
+	uint32_t index;
+};
+
+/**
+ * A hash table of unique strings with precomputed hashes.
+ * A lookup hashes a string once and compares characters of a single candidate in the usual case,
+ * so it does not depend on a number of strings and on lengths of common prefixes.
+ * Strings are never removed.
+ * @note This class is not thread-safe.
+ */
+class StringInterner {
+	LinearArena storage { 16 * 1024 };
+	std::vector<const InternedString *> strings;
+	// An open addressing table of a power-of-two size that is kept at most half-full
+	std::vector<const InternedString *> buckets;
+	const bool ignoreCase;
+
+	static char toLower( char ch ) {
+		return ( ch >= 'A' && ch <= 'Z' ) ? (char)( ch + ( 'a' - 'A' ) ) : ch;
+	}
+
+	uint32_t hashOf( const char *s, uint32_t *length ) const {
+		// FNV-1a
+		uint32_t hash = 2166136261u;
+		const char *p = s;
+		if( ignoreCase ) {
+			for(; *p; ++p ) {
+				hash = ( hash ^ (uint8_t)toLower( *p ) ) * 16777619u;
+			}
+		} else {
+			for(; *p; ++p ) {
+				hash = ( hash ^ (uint8_t)*p ) * 16777619u;
+			}
+		}
+		*length = (uint32_t)( p - s );
+		return hash;
+	}
+
+	bool equals( const InternedString *string, const char *s, uint32_t hash, uint32_t length ) const {
+		if( string->hash != hash || string->length != length ) {
+			return false;
+		}
+		if( !ignoreCase ) {
+			return !std::memcmp( string->chars, s, length );
+		}
+		for( uint32_t i = 0; i < length; ++i ) {
+			if( toLower( string->chars[i] ) != toLower( s[i] ) ) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	[[nodiscard]]
+	size_t findBucket( const char *s, uint32_t hash, uint32_t length ) const {
+		const size_t mask = buckets.size() - 1;
+		for( size_t i = hash & mask;; i = ( i + 1 ) & mask ) {
+			const InternedString *string = buckets[i];
+			if( !string || equals( string, s, hash, length ) ) {
+				return i;
+			}
+		}
+	}
+
+	void grow() {
+		std::vector<const InternedString *> oldBuckets( buckets.size() ? 2 * buckets.size() : 256 );
+		oldBuckets.swap( buckets );
+		const size_t mask = buckets.size() - 1;
+		for( const InternedString *string: oldBuckets ) {
+			if( string ) {
+				size_t i = string->hash & mask;
+				while( buckets[i] ) {
+					i = ( i + 1 ) & mask;
+				}
+				buckets[i] = string;
+			}
+		}
+	}
+public:
+	/**
+	 * @param ignoreCase_ whether strings that differ only by the case of ASCII letters should be considered equal
+	 */
+	explicit StringInterner( bool ignoreCase_ ) : ignoreCase( ignoreCase_ ) {
+		grow();
+	}
+
+	StringInterner( const StringInterner & ) = delete;
+	StringInterner &operator=( const StringInterner & ) = delete;
+
+	/**
+	 * Returns a handle of a previously interned string or null if the string has never been interned.
+	 */
+	[[nodiscard]]
+	const InternedString *find( const char *s ) const {
+		uint32_t length;
+		const uint32_t hash = hashOf( s, &length );
+		return buckets[findBucket( s, hash, length )];
+	}
+
+	/**
+	 * Returns a handle of the string adding a copy of it to the table if needed.
+	 * The first interned spelling of a string is kept.
+	 */
+	[[nodiscard]]
+	const InternedString *intern( const char *s ) {
+		uint32_t length;
+		const uint32_t hash = hashOf( s, &length );
+		size_t bucket = findBucket( s, hash, length );
+		if( buckets[bucket] ) {
+			return buckets[bucket];
+		}
+
+		if( 2 * ( strings.size() + 1 ) > buckets.size() ) {
+			grow();
+			bucket = findBucket( s, hash, length );
+		}
+
+		auto *const string = (InternedString *)storage.allocate( sizeof( InternedString ), alignof( InternedString ) );
+		auto *const chars = (char *)storage.allocate( length + 1, 1 );
+		std::memcpy( chars, s, length + 1 );
+		string->chars = chars;
+		string->hash = hash;
+		string->length = length;
+		string->index = (uint32_t)strings.size();
+		strings.push_back( string );
+		buckets[bucket] = string;
+		return string;
+	}
+
+	[[nodiscard]]
+	size_t size() const { return strings.size(); }
+};
+
+/**
+ * A map of values keyed by interned strings.
+ * Values are stored in an array indexed by interned string indices, so a lookup by a handle costs a single load.
+ */
+template <typename T>
+class InternedStringMap {
+	std::vector<T *> values;
+public:
+	[[nodiscard]]
+	T *get( const InternedString *key ) const {
+		return ( key && key->index < values.size() ) ? values[key->index] : nullptr;
+	}
+
+	void set( const InternedString *key, T *value ) {
+		assert( key );
+		if( key->index >= values.size() ) {
+			values.resize( key->index + 1 );
+		}
+		values[key->index] = value;
+	}
+
+	/**
+	 * Returns a removed value or null if there were no value for the key.
+	 */
+	T *remove( const InternedString *key ) {
+		T *const value = get( key );
+		if( value ) {
+			values[key->index] = nullptr;
+		}
+		return value;
+	}
+
+	void clear() { values.clear(); }
+};
+
+}
+
+#endif
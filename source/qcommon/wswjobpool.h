@@ -0,0 +1,166 @@
+#ifndef WSW_JOBPOOL_H
+#define WSW_JOBPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace wsw {
+
+/**
+ * A pool of persistent worker threads that process a job split to ranges of items in parallel.
+ * The calling thread takes ranges as well and returns only when all ranges have been processed,
+ * so a job may safely refer to data on the caller stack.
+ * Workers are started lazily on the first job that has more than a single range.
+ * @note Jobs must be submitted from a single thread and must not submit other jobs.
+ */
+class JobPool {
+	using Invoker = void (*)( void *job, unsigned first, unsigned count, unsigned threadNum );
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	std::condition_variable allDone;
+	unsigned generation { 0 };
+	unsigned numBusyWorkers { 0 };
+	bool quit { false };
+
+	const unsigned numWorkers;
+
+	Invoker invoker { nullptr };
+	void *job { nullptr };
+	unsigned numItems { 0 };
+	unsigned rangeSize { 0 };
+	std::atomic<unsigned> nextItem { 0 };
+
+	template <typename Job>
+	static void invoke( void *job, unsigned first, unsigned count, unsigned threadNum ) {
+		( *(Job *)job )( first, count, threadNum );
+	}
+
+	static unsigned suggestNumWorkers( unsigned maxWorkers ) {
+		// Leave a core for the calling thread
+		unsigned result = std::thread::hardware_concurrency();
+		result = result > 1 ? result - 1 : 0;
+		return std::min( result, maxWorkers );
+	}
+
+	void takeRanges( unsigned threadNum ) {
+		for(;; ) {
+			const unsigned first = nextItem.fetch_add( rangeSize, std::memory_order_relaxed );
+			if( first >= numItems ) {
+				return;
+			}
+			invoker( job, first, std::min( rangeSize, numItems - first ), threadNum );
+		}
+	}
+
+	void workerLoop( unsigned threadNum, unsigned seenGeneration ) {
+		for(;; ) {
+			{
+				std::unique_lock<std::mutex> lock( mutex );
+				wakeUp.wait( lock, [&]() { return quit || generation != seenGeneration; } );
+				if( quit ) {
+					return;
+				}
+				seenGeneration = generation;
+			}
+
+			takeRanges( threadNum );
+
+			std::lock_guard<std::mutex> lock( mutex );
+			if( !--numBusyWorkers ) {
+				allDone.notify_one();
+			}
+		}
+	}
+
+	void startWorkers() {
+		quit = false;
+		// Workers must wait for the next job and must not take ranges of jobs that have been run before
+		const unsigned startGeneration = generation;
+		workers.reserve( numWorkers );
+		for( unsigned i = 0; i < numWorkers; ++i ) {
+			workers.emplace_back( [this, i, startGeneration]() { workerLoop( i + 1, startGeneration ); } );
+		}
+	}
+public:
+	/**
+	 * @param maxWorkers a limit of a number of worker threads, the actual number depends on available cores too
+	 */
+	explicit JobPool( unsigned maxWorkers ) : numWorkers( suggestNumWorkers( maxWorkers ) ) {}
+
+	~JobPool() { stop(); }
+
+	JobPool( const JobPool & ) = delete;
+	JobPool &operator=( const JobPool & ) = delete;
+
+	/**
+	 * Returns a number of threads that may run ranges of a job (including the calling one).
+	 * Thread numbers that are passed to jobs are less than this value, so they may index per-thread data.
+	 */
+	[[nodiscard]]
+	unsigned numThreads() const { return numWorkers + 1; }
+
+	/**
+	 * Calls {@code job( first, count, threadNum )} for ranges of at most {@code rangeSize_} items
+	 * that cover {@code [0, numItems_)} and waits for completion of all ranges.
+	 * An order of ranges is unspecified. The calling thread has the number 0.
+	 */
+	template <typename Job>
+	void run( unsigned numItems_, unsigned rangeSize_, Job &&job_ ) {
+		assert( rangeSize_ > 0 );
+		if( numItems_ <= rangeSize_ || !numWorkers ) {
+			for( unsigned first = 0; first < numItems_; first += rangeSize_ ) {
+				job_( first, std::min( rangeSize_, numItems_ - first ), 0u );
+			}
+			return;
+		}
+
+		if( workers.empty() ) {
+			startWorkers();
+		}
+
+		using JobType = typename std::remove_reference<Job>::type;
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			invoker = &invoke<JobType>;
+			job = (void *)&job_;
+			numItems = numItems_;
+			rangeSize = rangeSize_;
+			nextItem.store( 0, std::memory_order_relaxed );
+			numBusyWorkers = (unsigned)workers.size();
+			generation++;
+		}
+		wakeUp.notify_all();
+
+		takeRanges( 0 );
+
+		std::unique_lock<std::mutex> lock( mutex );
+		allDone.wait( lock, [&]() { return !numBusyWorkers; } );
+	}
+
+	/**
+	 * Stops and joins worker threads. Workers are started again on demand.
+	 */
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			quit = true;
+		}
+		wakeUp.notify_all();
+		for( auto &worker: workers ) {
+			worker.join();
+		}
+		workers.clear();
+	}
+};
+
+}
+
+#endif
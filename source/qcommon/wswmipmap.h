@@ -0,0 +1,149 @@
+#ifndef WSW_MIPMAP_H
+#define WSW_MIPMAP_H
+
+#include "../gameshared/q_arch.h"
+
+#include <cstdint>
+
+namespace wsw {
+
+/**
+ * Returns a size of a row of pixels in bytes including the padding required by the alignment.
+ */
+inline int MipMapRowStride( int width, int samples, int alignment ) {
+	return ( ( width * samples + alignment - 1 ) / alignment ) * alignment;
+}
+
+/**
+ * Makes the next level of a mip chain of an image with 8-bit channels using a 2x2 box filter.
+ * The last row or column of an odd-sized image is dropped, a dimension of 1 is averaged along the other one only.
+ * Results are bit-exact for SIMD and scalar code paths.
+ * @param in an input image which rows are aligned by the given alignment
+ * @param width a width of the input image
+ * @param height a height of the input image
+ * @param samples a number of channels
+ * @param alignment an alignment of rows of both input and output images in bytes
+ * @param out an output image, it may be the same as the input one (the input gets overwritten in this case)
+ * @note Bytes of a row padding of the output image are not written.
+ */
+inline void MipMap8( const uint8_t *in, int width, int height, int samples, int alignment, uint8_t *out ) {
+	const int inStride = MipMapRowStride( width, samples, alignment );
+	const int outWidth = width > 1 ? width >> 1 : 1;
+	const int outHeight = height > 1 ? height >> 1 : 1;
+	const int outStride = MipMapRowStride( outWidth, samples, alignment );
+
+	for( int i = 0; i < outHeight; ++i, in += inStride * 2, out += outStride ) {
+		const uint8_t *next = ( ( i << 1 ) + 1 ) < height ? in + inStride : in;
+		if( width < 2 ) {
+			for( int k = 0; k < samples; ++k ) {
+				out[k] = ( in[k] + next[k] ) >> 1;
+			}
+			continue;
+		}
+
+		const int numBytes = outWidth * samples;
+		int j = 0;
+#ifdef WSW_USE_SSE2
+		// Pixels of a single row are processed from left to right and loads precede stores, so it works in-place.
+		// Input chunks of 16 bytes hold 16, 8 or 4 whole pixels for 1, 2 or 4 samples.
+		if( samples == 1 || samples == 2 || samples == 4 ) {
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i lowBytes = _mm_set1_epi16( 0xFF );
+			for(; j + 8 <= numBytes; j += 8 ) {
+				const __m128i a = _mm_loadu_si128( (const __m128i *)( in + j * 2 ) );
+				const __m128i b = _mm_loadu_si128( (const __m128i *)( next + j * 2 ) );
+				__m128i even, odd;
+				if( samples == 1 ) {
+					even = _mm_add_epi16( _mm_and_si128( a, lowBytes ), _mm_and_si128( b, lowBytes ) );
+					odd = _mm_add_epi16( _mm_srli_epi16( a, 8 ), _mm_srli_epi16( b, 8 ) );
+				} else {
+					// Vertical sums of channels of every pixel
+					const __m128i lo = _mm_add_epi16( _mm_unpacklo_epi8( a, zero ), _mm_unpacklo_epi8( b, zero ) );
+					const __m128i hi = _mm_add_epi16( _mm_unpackhi_epi8( a, zero ), _mm_unpackhi_epi8( b, zero ) );
+					if( samples == 2 ) {
+						const __m128 loPs = _mm_castsi128_ps( lo ), hiPs = _mm_castsi128_ps( hi );
+						even = _mm_castps_si128( _mm_shuffle_ps( loPs, hiPs, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+						odd = _mm_castps_si128( _mm_shuffle_ps( loPs, hiPs, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+					} else {
+						even = _mm_unpacklo_epi64( lo, hi );
+						odd = _mm_unpackhi_epi64( lo, hi );
+					}
+				}
+				const __m128i sum = _mm_srli_epi16( _mm_add_epi16( even, odd ), 2 );
+				_mm_storel_epi64( (__m128i *)( out + j ), _mm_packus_epi16( sum, sum ) );
+			}
+		}
+#endif
+		for(; j < numBytes; j += samples ) {
+			const int inOffset = j * 2;
+			for( int k = 0; k < samples; ++k ) {
+				const int index = inOffset + k;
+				out[j + k] = ( in[index] + in[index + samples] + next[index] + next[index + samples] ) >> 2;
+			}
+		}
+	}
+}
+
+/**
+ * Makes the next level of a mip chain of an image with 16-bit packed pixels (e.g. 4444, 5551 or 565) using a 2x2 box filter.
+ * Channels are filtered separately using the given masks. Rows are assumed to be aligned by 4 bytes.
+ * Sizes are treated exactly like {@code MipMap8()} does it.
+ * @param out an output image, it may be the same as the input one
+ */
+inline void MipMap16( const uint16_t *in, int width, int height,
+					  unsigned rMask, unsigned gMask, unsigned bMask, unsigned aMask, uint16_t *out ) {
+	const int inStride = ( width + 1 ) & ~1;
+	const int outWidth = width > 1 ? width >> 1 : 1;
+	const int outHeight = height > 1 ? height >> 1 : 1;
+	const int outStride = ( outWidth + 1 ) & ~1;
+	const unsigned masks[4] = { rMask, gMask, bMask, aMask };
+
+	for( int i = 0; i < outHeight; ++i, in += inStride * 2, out += outStride ) {
+		const uint16_t *next = ( ( i << 1 ) + 1 ) < height ? in + inStride : in;
+		if( width < 2 ) {
+			unsigned result = 0;
+			for( unsigned mask: masks ) {
+				result |= ( ( ( in[0] & mask ) + ( next[0] & mask ) ) >> 1 ) & mask;
+			}
+			out[0] = (uint16_t)result;
+			continue;
+		}
+
+		int j = 0;
+#ifdef WSW_USE_SSE2
+		const __m128i lowHalves = _mm_set1_epi32( 0xFFFF );
+		const __m128i bias32 = _mm_set1_epi32( 0x8000 );
+		const __m128i bias16 = _mm_set1_epi16( (short)0x8000 );
+		for(; j + 4 <= outWidth; j += 4 ) {
+			const __m128i a = _mm_loadu_si128( (const __m128i *)( in + j * 2 ) );
+			const __m128i b = _mm_loadu_si128( (const __m128i *)( next + j * 2 ) );
+			// Every 32-bit lane holds a pair of horizontally adjacent pixels
+			const __m128i aEven = _mm_and_si128( a, lowHalves ), aOdd = _mm_srli_epi32( a, 16 );
+			const __m128i bEven = _mm_and_si128( b, lowHalves ), bOdd = _mm_srli_epi32( b, 16 );
+			__m128i result = _mm_setzero_si128();
+			for( unsigned mask: masks ) {
+				const __m128i m = _mm_set1_epi32( (int)mask );
+				__m128i sum = _mm_add_epi32( _mm_and_si128( aEven, m ), _mm_and_si128( aOdd, m ) );
+				sum = _mm_add_epi32( sum, _mm_add_epi32( _mm_and_si128( bEven, m ), _mm_and_si128( bOdd, m ) ) );
+				result = _mm_or_si128( result, _mm_and_si128( _mm_srli_epi32( sum, 2 ), m ) );
+			}
+			// There is no unsigned saturating 32-bit pack in SSE2, so shift the range to the signed one
+			result = _mm_packs_epi32( _mm_sub_epi32( result, bias32 ), _mm_sub_epi32( result, bias32 ) );
+			_mm_storel_epi64( (__m128i *)( out + j ), _mm_add_epi16( result, bias16 ) );
+		}
+#endif
+		for(; j < outWidth; ++j ) {
+			const int col = j << 1;
+			unsigned result = 0;
+			for( unsigned mask: masks ) {
+				const unsigned sum = ( in[col] & mask ) + ( in[col + 1] & mask ) + ( next[col] & mask ) + ( next[col + 1] & mask );
+				result |= ( sum >> 2 ) & mask;
+			}
+			out[j] = (uint16_t)result;
+		}
+	}
+}
+
+}
+
+#endif
@@ -0,0 +1,331 @@
+#ifndef WSW_MPSCQUEUE_H
+#define WSW_MPSCQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace wsw {
+
+/**
+ * A ring buffer of variable-sized commands that may be written by multiple threads without locks
+ * and is read by a single consumer thread.
+ * Producers reserve space by a CAS on the write position, copy a command and publish it by a release store of its size.
+ * The consumer handles all published commands in a batch and publishes the freed space once per batch.
+ * Producers signal the consumer only if it is actually sleeping (a futex on Linux, a condition variable elsewhere),
+ * so writes to a busy consumer do not make system calls.
+ */
+class MpscCommandQueue {
+public:
+	/**
+	 * Counters that help to detect contention, they are updated with relaxed atomics.
+	 */
+	struct Stats {
+		uint64_t numWrites;
+		/** A number of failed attempts to reserve space due to concurrent producers */
+		uint64_t numReserveRetries;
+		/** A number of writes that have found the queue full */
+		uint64_t numFullWrites;
+		uint64_t numBatches;
+		uint64_t numWakeups;
+	};
+private:
+	static constexpr uint32_t kPaddingBit = 0x80000000u;
+	static constexpr size_t kHeaderSize = 8;
+
+	struct alignas( 8 ) Header {
+		// A size of the payload or a size of the entire padding record, zero if the record is not published yet
+		std::atomic<uint32_t> size;
+		uint32_t reserved;
+	};
+
+	static_assert( sizeof( Header ) == kHeaderSize, "" );
+
+	std::unique_ptr<uint64_t[]> storage;
+	uint8_t *const buffer;
+	const size_t capacity;
+	const size_t mask;
+
+	// Keep positions that are written by different sides on different cache lines
+	alignas( 64 ) std::atomic<uint64_t> writePos { 0 };
+	alignas( 64 ) std::atomic<uint64_t> readPos { 0 };
+	alignas( 64 ) std::atomic<uint32_t> wakeSeq { 0 };
+	std::atomic<bool> isConsumerSleeping { false };
+	std::atomic<bool> isTerminated { false };
+
+	std::atomic<uint64_t> numWrites { 0 };
+	std::atomic<uint64_t> numReserveRetries { 0 };
+	std::atomic<uint64_t> numFullWrites { 0 };
+	std::atomic<uint64_t> numBatches { 0 };
+	std::atomic<uint64_t> numWakeups { 0 };
+
+#ifndef __linux__
+	std::mutex wakeMutex;
+	std::condition_variable wakeCondVar;
+#endif
+
+	static size_t suggestCapacity( size_t size ) {
+		size_t result = 64;
+		while( result < size ) {
+			result <<= 1;
+		}
+		return result;
+	}
+
+	static size_t recordSizeOf( size_t payloadSize ) {
+		return ( kHeaderSize + payloadSize + 7 ) & ~(size_t)7;
+	}
+
+	Header *headerAt( uint64_t pos ) {
+		return (Header *)( buffer + ( pos & mask ) );
+	}
+
+	void wakeConsumer() {
+		// Pairs with the fence of the consumer, either we see it sleeping or it sees the published command
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		if( !isConsumerSleeping.load( std::memory_order_relaxed ) ) {
+			return;
+		}
+		// Only a single producer makes the system call until the consumer gets to sleep again
+		if( !isConsumerSleeping.exchange( false, std::memory_order_relaxed ) ) {
+			return;
+		}
+		numWakeups.fetch_add( 1, std::memory_order_relaxed );
+#ifdef __linux__
+		wakeSeq.fetch_add( 1, std::memory_order_release );
+		syscall( SYS_futex, (uint32_t *)&wakeSeq, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0 );
+#else
+		{
+			std::lock_guard<std::mutex> lock( wakeMutex );
+			wakeSeq.fetch_add( 1, std::memory_order_release );
+		}
+		wakeCondVar.notify_one();
+#endif
+	}
+
+	void clearConsumedSpace( uint64_t from, uint64_t to ) {
+		// Records must be published over zeroed headers, so a stale payload is never taken as a header
+		const size_t offset = from & mask;
+		const size_t length = to - from;
+		const size_t firstPart = std::min( length, capacity - offset );
+		std::memset( buffer + offset, 0, firstPart );
+		std::memset( buffer, 0, length - firstPart );
+	}
+public:
+	/**
+	 * @param size a requested size of the ring in bytes, it gets rounded up to a power of two
+	 */
+	explicit MpscCommandQueue( size_t size )
+		: storage( new uint64_t[suggestCapacity( size ) / sizeof( uint64_t )]() )
+		, buffer( (uint8_t *)storage.get() )
+		, capacity( suggestCapacity( size ) )
+		, mask( suggestCapacity( size ) - 1 ) {}
+
+	MpscCommandQueue( const MpscCommandQueue & ) = delete;
+	MpscCommandQueue &operator=( const MpscCommandQueue & ) = delete;
+
+	/**
+	 * Returns a maximal size of a single command.
+	 */
+	[[nodiscard]]
+	size_t maxCommandSize() const { return capacity / 2 - kHeaderSize; }
+
+	/**
+	 * Tries to add a command, may be called by multiple threads concurrently.
+	 * @return false if there is no space for the command or the queue has been terminated
+	 * @note Commands are stored at addresses aligned by 8 bytes.
+	 */
+	bool tryWrite( const void *data, unsigned size ) {
+		assert( size > 0 && size <= maxCommandSize() );
+		const size_t recordSize = recordSizeOf( size );
+
+		uint64_t pos = writePos.load( std::memory_order_relaxed );
+		size_t paddingSize;
+		for(;; ) {
+			if( isTerminated.load( std::memory_order_relaxed ) ) {
+				return false;
+			}
+			// A record never wraps, the rest of the ring gets padded if needed
+			const size_t tail = capacity - ( pos & mask );
+			paddingSize = recordSize <= tail ? 0 : tail;
+			const uint64_t consumedPos = readPos.load( std::memory_order_acquire );
+			if( pos < consumedPos ) {
+				// The position is stale, the consumer has already passed it
+				pos = writePos.load( std::memory_order_relaxed );
+				continue;
+			}
+			if( pos + paddingSize + recordSize - consumedPos > capacity ) {
+				numFullWrites.fetch_add( 1, std::memory_order_relaxed );
+				return false;
+			}
+			if( writePos.compare_exchange_weak( pos, pos + paddingSize + recordSize, std::memory_order_relaxed ) ) {
+				break;
+			}
+			numReserveRetries.fetch_add( 1, std::memory_order_relaxed );
+		}
+
+		if( paddingSize ) {
+			headerAt( pos )->size.store( (uint32_t)paddingSize | kPaddingBit, std::memory_order_release );
+			pos += paddingSize;
+		}
+		Header *const header = headerAt( pos );
+		std::memcpy( (uint8_t *)header + kHeaderSize, data, size );
+		header->size.store( size, std::memory_order_release );
+
+		numWrites.fetch_add( 1, std::memory_order_relaxed );
+		wakeConsumer();
+		return true;
+	}
+
+	/**
+	 * Adds a command waiting for free space if needed.
+	 * @return false if the queue has been terminated
+	 */
+	bool write( const void *data, unsigned size ) {
+		while( !tryWrite( data, size ) ) {
+			if( isTerminated.load( std::memory_order_relaxed ) ) {
+				return false;
+			}
+			wakeConsumer();
+			std::this_thread::yield();
+		}
+		return true;
+	}
+
+	/**
+	 * Calls {@code handler( data, size )} for every published command in the order of publishing.
+	 * A handler returns false to terminate the queue, the rest of commands are not handled in this case.
+	 * Must be called by the consumer thread only.
+	 * @return a number of handled commands
+	 */
+	template <typename Handler>
+	unsigned read( Handler &&handler ) {
+		const uint64_t startPos = readPos.load( std::memory_order_relaxed );
+		uint64_t pos = startPos;
+		unsigned numHandled = 0;
+		// Headers of consumed records are cleared after the batch, so a full ring must not be read past its end
+		while( pos - startPos < capacity && !isTerminated.load( std::memory_order_relaxed ) ) {
+			Header *const header = headerAt( pos );
+			const uint32_t size = header->size.load( std::memory_order_acquire );
+			if( !size ) {
+				break;
+			}
+			if( size & kPaddingBit ) {
+				pos += size & ~kPaddingBit;
+				continue;
+			}
+			numHandled++;
+			if( !handler( (const void *)( (uint8_t *)header + kHeaderSize ), (unsigned)size ) ) {
+				terminate();
+			}
+			pos += recordSizeOf( size );
+		}
+
+		if( pos != startPos ) {
+			clearConsumedSpace( startPos, pos );
+			readPos.store( pos, std::memory_order_release );
+			numBatches.fetch_add( 1, std::memory_order_relaxed );
+		}
+		return numHandled;
+	}
+
+	/**
+	 * Checks whether there are commands that are not handled yet (including commands that are being written).
+	 */
+	[[nodiscard]]
+	bool isEmpty() const {
+		return readPos.load( std::memory_order_acquire ) == writePos.load( std::memory_order_acquire );
+	}
+
+	/**
+	 * Blocks the consumer thread until a command gets published or the timeout expires.
+	 * @param timeoutMillis a timeout, a negative value means waiting without a timeout
+	 * @return true if there is a command to read
+	 */
+	bool waitForCommands( int timeoutMillis ) {
+		if( hasPublishedCommand() ) {
+			return true;
+		}
+
+		const uint32_t seq = wakeSeq.load( std::memory_order_acquire );
+		isConsumerSleeping.store( true, std::memory_order_relaxed );
+		// Pairs with the fence of producers
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		if( !hasPublishedCommand() && !isTerminated.load( std::memory_order_relaxed ) ) {
+#ifdef __linux__
+			if( timeoutMillis < 0 ) {
+				syscall( SYS_futex, (uint32_t *)&wakeSeq, FUTEX_WAIT_PRIVATE, seq, nullptr, nullptr, 0 );
+			} else {
+				struct timespec ts;
+				ts.tv_sec = timeoutMillis / 1000;
+				ts.tv_nsec = ( timeoutMillis % 1000 ) * 1000000;
+				syscall( SYS_futex, (uint32_t *)&wakeSeq, FUTEX_WAIT_PRIVATE, seq, &ts, nullptr, 0 );
+			}
+#else
+			std::unique_lock<std::mutex> lock( wakeMutex );
+			auto isWoken = [&]() { return wakeSeq.load( std::memory_order_relaxed ) != seq; };
+			if( timeoutMillis < 0 ) {
+				wakeCondVar.wait( lock, isWoken );
+			} else {
+				wakeCondVar.wait_for( lock, std::chrono::milliseconds( timeoutMillis ), isWoken );
+			}
+#endif
+		}
+		isConsumerSleeping.store( false, std::memory_order_relaxed );
+		return hasPublishedCommand();
+	}
+
+	/**
+	 * Checks whether the next command is published. Must be called by the consumer thread only.
+	 */
+	[[nodiscard]]
+	bool hasPublishedCommand() {
+		return headerAt( readPos.load( std::memory_order_relaxed ) )->size.load( std::memory_order_acquire ) != 0;
+	}
+
+	/**
+	 * Makes all further writes and reads fail and wakes the consumer.
+	 */
+	void terminate() {
+		isTerminated.store( true, std::memory_order_relaxed );
+		wakeConsumer();
+	}
+
+	[[nodiscard]]
+	bool terminated() const { return isTerminated.load( std::memory_order_relaxed ); }
+
+	/**
+	 * Wakes the consumer if it is sleeping, so it can handle commands or check the termination status.
+	 */
+	void wake() { wakeConsumer(); }
+
+	[[nodiscard]]
+	Stats stats() const {
+		return Stats {
+			numWrites.load( std::memory_order_relaxed ),
+			numReserveRetries.load( std::memory_order_relaxed ),
+			numFullWrites.load( std::memory_order_relaxed ),
+			numBatches.load( std::memory_order_relaxed ),
+			numWakeups.load( std::memory_order_relaxed )
+		};
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef WSW_POOLEDSTRINGS_H
+#define WSW_POOLEDSTRINGS_H
+
+#include "wswallocators.h"
+#include "wswfreelistallocator.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace wsw {
+
+/**
+ * Allocates objects of mutable strings (like script strings) from a freelist
+ * along with a small inline buffer that is sufficient for most of short-living temporaries.
+ * Larger buffers are allocated by size classes, so buffers of released strings get reused.
+ * @tparam String a plain structure that has {@code char *buffer; unsigned len, size;} fields,
+ * a size is a capacity of the buffer including the terminating zero.
+ * @note This class is not thread-safe.
+ */
+template <typename String, size_t BlockSize = 64, unsigned BlocksPerChunk = 512>
+class PooledStrings {
+	static_assert( BlockSize > sizeof( String ), "There is no space for an inline buffer" );
+public:
+	static constexpr unsigned kInlineBufferSize = (unsigned)( BlockSize - sizeof( String ) );
+	/** The highest bit of a size is reserved by users (e.g. for marking constant strings) */
+	static constexpr unsigned kSizeMask = ~( 1u << 31 );
+private:
+	struct PooledString {
+		String string;
+		char inlineBuffer[kInlineBufferSize];
+	};
+
+	FreelistAllocator<sizeof( PooledString ), BlocksPerChunk> allocator;
+	SizeClassAllocator buffers;
+
+	static char *inlineBufferOf( String *object ) {
+		return ( (PooledString *)object )->inlineBuffer;
+	}
+public:
+	/**
+	 * Allocates a string object that has a buffer of at least the given size.
+	 * Fields other than the buffer and the size are left uninitialized.
+	 */
+	[[nodiscard]]
+	String *allocate( unsigned size ) {
+		auto *const object = (String *)allocator.allocate();
+		if( size <= kInlineBufferSize ) {
+			object->buffer = inlineBufferOf( object );
+			object->size = kInlineBufferSize;
+		} else {
+			allocateBuffer( object, size );
+		}
+		return object;
+	}
+
+	/**
+	 * Sets a new buffer of the given size for the string, a former buffer must have been released.
+	 */
+	void allocateBuffer( String *object, unsigned size ) {
+		object->buffer = (char *)buffers.allocate( size );
+		object->size = size;
+	}
+
+	/**
+	 * Releases a heap buffer of the string (if any), the buffer field must be reassigned after this call.
+	 */
+	void freeBuffer( String *object ) {
+		if( object->buffer != inlineBufferOf( object ) ) {
+			buffers.deallocate( object->buffer, object->size & kSizeMask );
+		}
+	}
+
+	void deallocate( String *object ) {
+		freeBuffer( object );
+		allocator.deallocate( object );
+	}
+
+	/**
+	 * Appends characters (that may be a part of the string itself) to the string.
+	 * The buffer grows geometrically, so chains of appends take a linear time in total.
+	 */
+	void append( String *self, const char *chars, size_t numChars ) {
+		if( !numChars ) {
+			return;
+		}
+
+		unsigned length = (unsigned)numChars + self->len;
+		unsigned size = ( length + 1 ) & kSizeMask;
+
+		length = size - 1;
+		numChars = length - self->len;
+		if( size <= self->size ) {
+			std::memmove( self->buffer + self->len, chars, numChars );
+		} else {
+			size = std::max( size, ( 2 * self->size ) & kSizeMask );
+			char *buffer = (char *)buffers.allocate( size );
+			std::memcpy( buffer, self->buffer, self->len );
+			// The appended chars may be a part of the old buffer, so release it only after copying
+			std::memcpy( buffer + self->len, chars, numChars );
+			freeBuffer( self );
+			self->buffer = buffer;
+			self->size = size;
+		}
+
+		self->len = length;
+		self->buffer[length] = '\0';
+	}
+
+	[[nodiscard]]
+	size_t allocatedStrings() const { return allocator.allocatedBlocks(); }
+};
+
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef WSW_RADIXSORT_H
+#define WSW_RADIXSORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace wsw {
+
+/**
+ * Sorts items by 64-bit unsigned keys in the ascending order using a least significant digit radix sort.
+ * The sort is stable, so items with equal keys keep their original relative order.
+ * Histograms of all digits are built in a single pass, passes for digits that are equal for all keys are skipped.
+ * Short ranges are sorted by insertion as a histogram setup costs more than sorting them.
+ * @param items items to sort
+ * @param scratch a caller-supplied buffer of the same size, so the sort does not allocate memory
+ * @param count a number of items
+ * @param keyOf a function that returns a key of an item, it gets called few times per item so it should be cheap
+ */
+template <typename T, typename KeyOf>
+void RadixSort64( T *items, T *scratch, size_t count, KeyOf &&keyOf ) {
+	constexpr unsigned kNumDigits = 8;
+	constexpr size_t kMinRadixSortCount = 64;
+
+	if( count < kMinRadixSortCount ) {
+		for( size_t i = 1; i < count; ++i ) {
+			const uint64_t key = keyOf( items[i] );
+			if( keyOf( items[i - 1] ) <= key ) {
+				continue;
+			}
+			T item( std::move( items[i] ) );
+			size_t j = i;
+			do {
+				items[j] = std::move( items[j - 1] );
+				--j;
+			} while( j > 0 && keyOf( items[j - 1] ) > key );
+			items[j] = std::move( item );
+		}
+		return;
+	}
+
+	uint32_t histograms[kNumDigits][256];
+	std::memset( histograms, 0, sizeof( histograms ) );
+	for( size_t i = 0; i < count; ++i ) {
+		uint64_t key = keyOf( items[i] );
+		for( unsigned digit = 0; digit < kNumDigits; ++digit ) {
+			histograms[digit][key & 0xFF]++;
+			key >>= 8;
+		}
+	}
+
+	T *from = items, *to = scratch;
+	for( unsigned digit = 0; digit < kNumDigits; ++digit ) {
+		uint32_t *const histogram = histograms[digit];
+		const unsigned shift = digit * 8;
+		// Skip the pass if all keys have the same digit
+		if( histogram[( keyOf( from[0] ) >> shift ) & 0xFF] == count ) {
+			continue;
+		}
+
+		// Convert counts to offsets
+		uint32_t offset = 0;
+		for( unsigned value = 0; value < 256; ++value ) {
+			const uint32_t valueCount = histogram[value];
+			histogram[value] = offset;
+			offset += valueCount;
+		}
+
+		for( size_t i = 0; i < count; ++i ) {
+			const unsigned value = (unsigned)( keyOf( from[i] ) >> shift ) & 0xFF;
+			to[histogram[value]++] = std::move( from[i] );
+		}
+		std::swap( from, to );
+	}
+
+	if( from != items ) {
+		for( size_t i = 0; i < count; ++i ) {
+			items[i] = std::move( from[i] );
+		}
+	}
+}
+
+}
+
+#endif
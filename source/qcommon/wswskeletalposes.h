@@ -0,0 +1,273 @@
+#ifndef WSW_SKELETALPOSES_H
+#define WSW_SKELETALPOSES_H
+
+#include "../gameshared/q_arch.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+namespace wsw {
+
+/**
+ * Computes skinning dual quaternions of up to 4 entities that share a skeleton at once.
+ * Every entity is processed exactly like scalar code processes it bone by bone:
+ * frames are interpolated, transformed by parents (unless parents have been applied already),
+ * multiplied by inverse base poses and normalized.
+ * Entities are kept in lanes of a structure of arrays, so every operation processes all entities using SSE.
+ * A dual quaternion is 8 floats: a real part (x, y, z, w) followed by a dual part (x, y, z, w).
+ * @note Batches are independent, so different batches may be computed on different threads.
+ */
+class SkeletalPoseBatch {
+public:
+	static constexpr unsigned kMaxLanes = 4;
+	static constexpr unsigned kScratchFloatsPerBone = 8 * kMaxLanes;
+
+	struct Lane {
+		const float *frame;         // dual quaternions of bones in the current frame
+		const float *oldFrame;      // dual quaternions of bones in the previous frame, used only for interpolation
+		float frontLerp;            // a weight of the current frame
+		bool lerp;                  // whether frames are interpolated, the current frame is used as is otherwise
+		bool parentsApplied;        // whether frames have been transformed by parents already
+		float *out;                 // receives dual quaternions of bones relative to the base pose
+	};
+private:
+	Lane lanes[kMaxLanes];
+	unsigned numLanes { 0 };
+
+	static void quatMultiply( const float *q1, const float *q2, float *out ) {
+		out[0] = q1[3] * q2[0] + q1[0] * q2[3] + q1[1] * q2[2] - q1[2] * q2[1];
+		out[1] = q1[3] * q2[1] + q1[1] * q2[3] + q1[2] * q2[0] - q1[0] * q2[2];
+		out[2] = q1[3] * q2[2] + q1[2] * q2[3] + q1[0] * q2[1] - q1[1] * q2[0];
+		out[3] = q1[3] * q2[3] - q1[0] * q2[0] - q1[1] * q2[1] - q1[2] * q2[2];
+	}
+
+	static void dualQuatMultiply( const float *dq1, const float *dq2, float *out ) {
+		float tq1[4], tq2[4];
+		quatMultiply( dq1, dq2 + 4, tq1 );
+		quatMultiply( dq1 + 4, dq2, tq2 );
+		quatMultiply( dq1, dq2, out );
+		for( int i = 0; i < 4; ++i ) {
+			out[i + 4] = tq1[i] + tq2[i];
+		}
+	}
+
+	/**
+	 * Scales both parts of a dual quaternion (or only the given number of components) by the real part length
+	 */
+	static void normalize( float *dq, int numComponents ) {
+		const float length = dq[0] * dq[0] + dq[1] * dq[1] + dq[2] * dq[2] + dq[3] * dq[3];
+		if( length != 0 ) {
+			const float ilength = 1.0f / std::sqrt( length );
+			for( int i = 0; i < numComponents; ++i ) {
+				dq[i] *= ilength;
+			}
+		}
+	}
+
+	static void lerp( const float *dq1, const float *dq2, float t, float *out ) {
+		float k = dq1[0] * dq2[0] + dq1[1] * dq2[1] + dq1[2] * dq2[2] + dq1[3] * dq2[3];
+		k = k < 0 ? -t : t;
+		t = 1.0f - t;
+		for( int i = 0; i < 8; ++i ) {
+			out[i] = dq1[i] * t + dq2[i] * k;
+		}
+		normalize( out, 4 );
+	}
+
+#ifdef WSW_USE_SSE2
+	struct DualQuat4 {
+		__m128 v[8];
+	};
+
+	static __m128 select( __m128 mask, __m128 ifTrue, __m128 ifFalse ) {
+		return _mm_or_ps( _mm_and_ps( mask, ifTrue ), _mm_andnot_ps( mask, ifFalse ) );
+	}
+
+	static __m128 laneMask( const bool *flags ) {
+		return _mm_castsi128_ps( _mm_set_epi32( -(int)flags[3], -(int)flags[2], -(int)flags[1], -(int)flags[0] ) );
+	}
+
+	static void load4( const float *const *dqs, unsigned bone, DualQuat4 *out ) {
+		for( unsigned part = 0; part < 8; part += 4 ) {
+			__m128 r0 = _mm_loadu_ps( dqs[0] + bone * 8 + part ), r1 = _mm_loadu_ps( dqs[1] + bone * 8 + part );
+			__m128 r2 = _mm_loadu_ps( dqs[2] + bone * 8 + part ), r3 = _mm_loadu_ps( dqs[3] + bone * 8 + part );
+			_MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+			out->v[part + 0] = r0, out->v[part + 1] = r1, out->v[part + 2] = r2, out->v[part + 3] = r3;
+		}
+	}
+
+	static void quatMultiply4( const __m128 *q1, const __m128 *q2, __m128 *out ) {
+		out[0] = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( q1[3], q2[0] ), _mm_mul_ps( q1[0], q2[3] ) ), _mm_mul_ps( q1[1], q2[2] ) ), _mm_mul_ps( q1[2], q2[1] ) );
+		out[1] = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( q1[3], q2[1] ), _mm_mul_ps( q1[1], q2[3] ) ), _mm_mul_ps( q1[2], q2[0] ) ), _mm_mul_ps( q1[0], q2[2] ) );
+		out[2] = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( q1[3], q2[2] ), _mm_mul_ps( q1[2], q2[3] ) ), _mm_mul_ps( q1[0], q2[1] ) ), _mm_mul_ps( q1[1], q2[0] ) );
+		out[3] = _mm_sub_ps( _mm_sub_ps( _mm_sub_ps( _mm_mul_ps( q1[3], q2[3] ), _mm_mul_ps( q1[0], q2[0] ) ), _mm_mul_ps( q1[1], q2[1] ) ), _mm_mul_ps( q1[2], q2[2] ) );
+	}
+
+	static void dualQuatMultiply4( const DualQuat4 &dq1, const DualQuat4 &dq2, DualQuat4 *out ) {
+		__m128 tq1[4], tq2[4];
+		quatMultiply4( dq1.v, dq2.v + 4, tq1 );
+		quatMultiply4( dq1.v + 4, dq2.v, tq2 );
+		quatMultiply4( dq1.v, dq2.v, out->v );
+		for( int i = 0; i < 4; ++i ) {
+			out->v[i + 4] = _mm_add_ps( tq1[i], tq2[i] );
+		}
+	}
+
+	static void normalize4( DualQuat4 *dq, int numComponents ) {
+		const __m128 *v = dq->v;
+		__m128 length = _mm_mul_ps( v[0], v[0] );
+		length = _mm_add_ps( length, _mm_mul_ps( v[1], v[1] ) );
+		length = _mm_add_ps( length, _mm_mul_ps( v[2], v[2] ) );
+		length = _mm_add_ps( length, _mm_mul_ps( v[3], v[3] ) );
+		// Zero-length lanes are left as is
+		const __m128 one = _mm_set1_ps( 1.0f );
+		const __m128 zeroMask = _mm_cmpeq_ps( length, _mm_setzero_ps() );
+		const __m128 ilength = select( zeroMask, one, _mm_div_ps( one, _mm_sqrt_ps( select( zeroMask, one, length ) ) ) );
+		for( int i = 0; i < numComponents; ++i ) {
+			dq->v[i] = _mm_mul_ps( dq->v[i], ilength );
+		}
+	}
+
+	template <typename ParentOf>
+	void computeSimd( ParentOf &&parentOf, const float *invBasePoses, unsigned numBones, float *scratch ) const {
+		assert( !( (uintptr_t)scratch % 16 ) );
+		// Missing lanes duplicate the first one, results of these lanes are not stored
+		const float *frames[kMaxLanes], *oldFrames[kMaxLanes];
+		float frontLerps[kMaxLanes];
+		bool lerpFlags[kMaxLanes], applyFlags[kMaxLanes];
+		for( unsigned i = 0; i < kMaxLanes; ++i ) {
+			const Lane &lane = lanes[i < numLanes ? i : 0];
+			frames[i] = lane.frame;
+			oldFrames[i] = lane.lerp ? lane.oldFrame : lane.frame;
+			frontLerps[i] = lane.frontLerp;
+			lerpFlags[i] = lane.lerp;
+			applyFlags[i] = !lane.parentsApplied;
+		}
+
+		const __m128 lerpMask = laneMask( lerpFlags );
+		const __m128 applyMask = laneMask( applyFlags );
+		const bool anyLerp = _mm_movemask_ps( lerpMask ) != 0;
+		const __m128 t = _mm_loadu_ps( frontLerps );
+		const __m128 t1 = _mm_sub_ps( _mm_set1_ps( 1.0f ), t );
+		const __m128 minusT = _mm_sub_ps( _mm_setzero_ps(), t );
+
+		auto *const poses = (DualQuat4 *)scratch;
+		for( unsigned bone = 0; bone < numBones; ++bone ) {
+			DualQuat4 pose;
+			load4( frames, bone, &pose );
+
+			if( anyLerp ) {
+				DualQuat4 oldPose, lerped;
+				load4( oldFrames, bone, &oldPose );
+				__m128 k = _mm_mul_ps( oldPose.v[0], pose.v[0] );
+				k = _mm_add_ps( k, _mm_mul_ps( oldPose.v[1], pose.v[1] ) );
+				k = _mm_add_ps( k, _mm_mul_ps( oldPose.v[2], pose.v[2] ) );
+				k = _mm_add_ps( k, _mm_mul_ps( oldPose.v[3], pose.v[3] ) );
+				k = select( _mm_cmplt_ps( k, _mm_setzero_ps() ), minusT, t );
+				for( int i = 0; i < 8; ++i ) {
+					lerped.v[i] = _mm_add_ps( _mm_mul_ps( oldPose.v[i], t1 ), _mm_mul_ps( pose.v[i], k ) );
+				}
+				normalize4( &lerped, 4 );
+				for( int i = 0; i < 8; ++i ) {
+					pose.v[i] = select( lerpMask, lerped.v[i], pose.v[i] );
+				}
+			}
+
+			const int parent = parentOf( bone );
+			if( parent >= 0 ) {
+				assert( (unsigned)parent < bone );
+				DualQuat4 transformed;
+				dualQuatMultiply4( poses[parent], pose, &transformed );
+				for( int i = 0; i < 8; ++i ) {
+					pose.v[i] = select( applyMask, transformed.v[i], pose.v[i] );
+				}
+			}
+
+			poses[bone] = pose;
+
+			DualQuat4 invBasePose, relative;
+			for( int i = 0; i < 8; ++i ) {
+				invBasePose.v[i] = _mm_set1_ps( invBasePoses[bone * 8 + i] );
+			}
+			dualQuatMultiply4( pose, invBasePose, &relative );
+			normalize4( &relative, 8 );
+
+			for( unsigned part = 0; part < 8; part += 4 ) {
+				__m128 r0 = relative.v[part + 0], r1 = relative.v[part + 1];
+				__m128 r2 = relative.v[part + 2], r3 = relative.v[part + 3];
+				_MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+				const __m128 rows[4] = { r0, r1, r2, r3 };
+				for( unsigned i = 0; i < numLanes; ++i ) {
+					_mm_storeu_ps( lanes[i].out + bone * 8 + part, rows[i] );
+				}
+			}
+		}
+	}
+#endif
+
+	template <typename ParentOf>
+	void computeScalar( ParentOf &&parentOf, const float *invBasePoses, unsigned numBones, float *scratch ) const {
+		for( unsigned laneNum = 0; laneNum < numLanes; ++laneNum ) {
+			const Lane &lane = lanes[laneNum];
+			for( unsigned bone = 0; bone < numBones; ++bone ) {
+				float *const pose = scratch + bone * 8;
+				const float *const frame = lane.frame + bone * 8;
+				if( lane.lerp ) {
+					lerp( lane.oldFrame + bone * 8, frame, lane.frontLerp, pose );
+				} else {
+					for( int i = 0; i < 8; ++i ) {
+						pose[i] = frame[i];
+					}
+				}
+				const int parent = parentOf( bone );
+				if( parent >= 0 && !lane.parentsApplied ) {
+					assert( (unsigned)parent < bone );
+					float local[8];
+					for( int i = 0; i < 8; ++i ) {
+						local[i] = pose[i];
+					}
+					dualQuatMultiply( scratch + parent * 8, local, pose );
+				}
+				float *const out = lane.out + bone * 8;
+				dualQuatMultiply( pose, invBasePoses + bone * 8, out );
+				normalize( out, 8 );
+			}
+		}
+	}
+public:
+	void clear() { numLanes = 0; }
+
+	[[nodiscard]]
+	unsigned size() const { return numLanes; }
+	[[nodiscard]]
+	bool full() const { return numLanes == kMaxLanes; }
+
+	void add( const Lane &lane ) {
+		assert( numLanes < kMaxLanes );
+		assert( lane.frame && lane.out && ( !lane.lerp || lane.oldFrame ) );
+		lanes[numLanes++] = lane;
+	}
+
+	/**
+	 * Computes poses of all added entities.
+	 * @param parentOf a function that returns a parent of a bone (negative for roots), a parent must precede its children
+	 * @param invBasePoses dual quaternions of inverse base poses of bones
+	 * @param scratch a buffer of at least {@code kScratchFloatsPerBone * numBones} floats aligned on 16 bytes
+	 */
+	template <typename ParentOf>
+	void compute( ParentOf &&parentOf, const float *invBasePoses, unsigned numBones, float *scratch ) const {
+		if( !numLanes ) {
+			return;
+		}
+#ifdef WSW_USE_SSE2
+		computeSimd( parentOf, invBasePoses, numBones, scratch );
+#else
+		computeScalar( parentOf, invBasePoses, numBones, scratch );
+#endif
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,185 @@
+#ifndef WSW_SWEEPANDPRUNE_H
+#define WSW_SWEEPANDPRUNE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+
+namespace wsw {
+
+/**
+ * A broadphase index of axis-aligned boxes identified by small integers (e.g. entity numbers).
+ * Boxes are kept in a structure of arrays sorted by their min X coordinate.
+ * A query does a binary search for the first box that may overlap a query box along X
+ * and then tests compact bounds arrays sequentially until min X of boxes exceeds the query box.
+ * Boxes that are wider than the given extent along X are kept in a separate short unsorted list,
+ * so the range of tested boxes stays narrow.
+ * Updates of moving boxes are cheap as their position in the sorted order rarely changes much between updates.
+ * @note This class is not thread-safe.
+ */
+template <unsigned MaxItems>
+class SweepAndPrune {
+	static_assert( MaxItems > 0 && MaxItems < 0xFFFF, "Illegal number of items" );
+
+	enum : uint8_t { kNotLinked, kSorted, kLarge };
+
+	struct Boxes {
+		float minX[MaxItems], maxX[MaxItems];
+		float minY[MaxItems], maxY[MaxItems];
+		float minZ[MaxItems], maxZ[MaxItems];
+		uint16_t items[MaxItems];
+		unsigned count { 0 };
+
+		void set( unsigned index, unsigned item, const float *mins, const float *maxs ) {
+			minX[index] = mins[0], maxX[index] = maxs[0];
+			minY[index] = mins[1], maxY[index] = maxs[1];
+			minZ[index] = mins[2], maxZ[index] = maxs[2];
+			items[index] = (uint16_t)item;
+		}
+
+		void copy( unsigned from, unsigned to ) {
+			minX[to] = minX[from], maxX[to] = maxX[from];
+			minY[to] = minY[from], maxY[to] = maxY[from];
+			minZ[to] = minZ[from], maxZ[to] = maxZ[from];
+			items[to] = items[from];
+		}
+
+		[[nodiscard]]
+		bool overlapsYZ( unsigned index, const float *mins, const float *maxs ) const {
+			return minY[index] <= maxs[1] && maxY[index] >= mins[1] && minZ[index] <= maxs[2] && maxZ[index] >= mins[2];
+		}
+	};
+
+	Boxes sorted;
+	Boxes large;
+	uint16_t indexOf[MaxItems];
+	uint8_t listOf[MaxItems];
+	const float maxSortedExtent;
+
+	void setIndex( const Boxes &boxes, unsigned index ) { indexOf[boxes.items[index]] = (uint16_t)index; }
+
+	/**
+	 * Moves a sorted box to a position that corresponds to its min X coordinate.
+	 * Boxes between old and new positions get shifted by one.
+	 */
+	void restoreOrder( unsigned index ) {
+		const float x = sorted.minX[index];
+		unsigned target = index;
+		if( target > 0 && sorted.minX[target - 1] > x ) {
+			target = (unsigned)( std::upper_bound( sorted.minX, sorted.minX + index, x ) - sorted.minX );
+		} else if( target + 1 < sorted.count && sorted.minX[target + 1] < x ) {
+			target = (unsigned)( std::lower_bound( sorted.minX + index + 1, sorted.minX + sorted.count, x ) - sorted.minX ) - 1;
+		} else {
+			return;
+		}
+
+		const float mins[3] = { sorted.minX[index], sorted.minY[index], sorted.minZ[index] };
+		const float maxs[3] = { sorted.maxX[index], sorted.maxY[index], sorted.maxZ[index] };
+		const unsigned item = sorted.items[index];
+		if( target < index ) {
+			for( unsigned i = index; i > target; --i ) {
+				sorted.copy( i - 1, i );
+				setIndex( sorted, i );
+			}
+		} else {
+			for( unsigned i = index; i < target; ++i ) {
+				sorted.copy( i + 1, i );
+				setIndex( sorted, i );
+			}
+		}
+		sorted.set( target, item, mins, maxs );
+		setIndex( sorted, target );
+	}
+
+	void removeSorted( unsigned index ) {
+		for( unsigned i = index; i + 1 < sorted.count; ++i ) {
+			sorted.copy( i + 1, i );
+			setIndex( sorted, i );
+		}
+		sorted.count--;
+	}
+
+	void removeLarge( unsigned index ) {
+		large.count--;
+		if( index != large.count ) {
+			large.copy( large.count, index );
+			setIndex( large, index );
+		}
+	}
+public:
+	/**
+	 * @param maxSortedExtent_ boxes that have a greater size along X are kept in an unsorted list
+	 */
+	explicit SweepAndPrune( float maxSortedExtent_ = 512.0f ) : maxSortedExtent( maxSortedExtent_ ) {
+		clear();
+	}
+
+	void clear() {
+		sorted.count = large.count = 0;
+		std::memset( listOf, kNotLinked, sizeof( listOf ) );
+	}
+
+	[[nodiscard]]
+	unsigned size() const { return sorted.count + large.count; }
+	[[nodiscard]]
+	bool isLinked( unsigned item ) const { return listOf[item] != kNotLinked; }
+
+	/**
+	 * Adds a box or updates bounds of a box that has been added already.
+	 */
+	void link( unsigned item, const float *mins, const float *maxs ) {
+		assert( item < MaxItems );
+		const uint8_t list = ( maxs[0] - mins[0] > maxSortedExtent ) ? kLarge : kSorted;
+		if( listOf[item] != list ) {
+			unlink( item );
+			Boxes &boxes = ( list == kSorted ) ? sorted : large;
+			indexOf[item] = (uint16_t)boxes.count++;
+			listOf[item] = list;
+		}
+
+		const unsigned index = indexOf[item];
+		if( list == kLarge ) {
+			large.set( index, item, mins, maxs );
+		} else {
+			sorted.set( index, item, mins, maxs );
+			restoreOrder( index );
+		}
+	}
+
+	void unlink( unsigned item ) {
+		assert( item < MaxItems );
+		if( listOf[item] == kSorted ) {
+			removeSorted( indexOf[item] );
+		} else if( listOf[item] == kLarge ) {
+			removeLarge( indexOf[item] );
+		}
+		listOf[item] = kNotLinked;
+	}
+
+	/**
+	 * Calls {@code onOverlap( item )} for every box that overlaps the given one (boundaries are inclusive).
+	 * @note callbacks must not link or unlink items.
+	 */
+	template <typename OnOverlap>
+	void query( const float *mins, const float *maxs, OnOverlap &&onOverlap ) const {
+		for( unsigned i = 0; i < large.count; ++i ) {
+			if( large.minX[i] <= maxs[0] && large.maxX[i] >= mins[0] && large.overlapsYZ( i, mins, maxs ) ) {
+				onOverlap( (unsigned)large.items[i] );
+			}
+		}
+
+		// Boxes that start before this coordinate can't reach the query box (there is a margin for rounding errors)
+		const float minStartX = mins[0] - maxSortedExtent - 1.0f;
+		const float *first = std::lower_bound( sorted.minX, sorted.minX + sorted.count, minStartX );
+		for( unsigned i = (unsigned)( first - sorted.minX ); i < sorted.count && sorted.minX[i] <= maxs[0]; ++i ) {
+			if( sorted.maxX[i] >= mins[0] && sorted.overlapsYZ( i, mins, maxs ) ) {
+				onOverlap( (unsigned)sorted.items[i] );
+			}
+		}
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef WSW_TIMERWHEEL_H
+#define WSW_TIMERWHEEL_H
+
+#include <cstdint>
+#include <cassert>
+
+namespace wsw {
+
+/**
+ * A hierarchical timer wheel for items identified by small integers (e.g. entity numbers).
+ * Every item has at most a single pending expiration time with a millisecond resolution.
+ * Scheduling and cancellation are O(1), advancing the time costs O(1) per elapsed millisecond
+ * and O(1) amortized per item (items get moved to lower levels at most once per level).
+ * Levels cover 256 ms, 16 s, 17 min and 18 h, later times are kept in an overflow list.
+ * @note This class is not thread-safe.
+ */
+template <unsigned MaxItems>
+class TimerWheel {
+	static_assert( MaxItems > 0 && MaxItems < 0xFFFF, "Illegal number of items" );
+
+	using Index = uint16_t;
+	static constexpr Index kNone = 0xFFFF;
+
+	static constexpr unsigned kNumLevels = 4;
+	static constexpr unsigned kLevelShift[kNumLevels] = { 0, 8, 14, 20 };
+	static constexpr unsigned kLevelBits[kNumLevels] = { 8, 6, 6, 6 };
+	static constexpr unsigned kLevelBase[kNumLevels] = { 0, 256, 256 + 64, 256 + 2 * 64 };
+	static constexpr unsigned kOverflowSlot = 256 + 3 * 64;
+	// Jumps longer than that are handled by rebuilding the wheel instead of stepping every millisecond
+	static constexpr int64_t kMaxSteppedJump = 1 << 14;
+
+	Index heads[kOverflowSlot + 1];
+	Index next[MaxItems];
+	Index prev[MaxItems];
+	Index slotOf[MaxItems];
+	int64_t timeOf[MaxItems];
+
+	int64_t currTime { 0 };
+	unsigned numScheduled { 0 };
+
+	void link( unsigned item, unsigned slot ) {
+		slotOf[item] = (Index)slot;
+		prev[item] = kNone;
+		next[item] = heads[slot];
+		if( heads[slot] != kNone ) {
+			prev[heads[slot]] = (Index)item;
+		}
+		heads[slot] = (Index)item;
+	}
+
+	void unlink( unsigned item ) {
+		if( prev[item] != kNone ) {
+			next[prev[item]] = next[item];
+		} else {
+			heads[slotOf[item]] = next[item];
+		}
+		if( next[item] != kNone ) {
+			prev[next[item]] = prev[item];
+		}
+		slotOf[item] = kNone;
+	}
+
+	/**
+	 * Links an item to a slot of the lowest level that contains its time.
+	 * @note the time must not be less than the current time.
+	 */
+	void place( unsigned item ) {
+		const int64_t time = timeOf[item];
+		assert( time >= currTime );
+		for( unsigned level = 0; level < kNumLevels; ++level ) {
+			const unsigned windowShift = kLevelShift[level] + kLevelBits[level];
+			if( ( time >> windowShift ) == ( currTime >> windowShift ) ) {
+				const unsigned index = (unsigned)( time >> kLevelShift[level] ) & ( ( 1u << kLevelBits[level] ) - 1 );
+				link( item, kLevelBase[level] + index );
+				return;
+			}
+		}
+		link( item, kOverflowSlot );
+	}
+
+	void replaceSlot( unsigned slot ) {
+		Index item = heads[slot];
+		heads[slot] = kNone;
+		while( item != kNone ) {
+			const Index nextItem = next[item];
+			place( item );
+			item = nextItem;
+		}
+	}
+
+	/**
+	 * Moves items of the slot that starts at the current time to lower levels.
+	 * Higher levels are cascaded first as their slots may start at the current time too.
+	 */
+	void cascade( unsigned level ) {
+		const unsigned index = (unsigned)( currTime >> kLevelShift[level] ) & ( ( 1u << kLevelBits[level] ) - 1 );
+		if( !index ) {
+			if( level + 1 < kNumLevels ) {
+				cascade( level + 1 );
+			} else {
+				replaceSlot( kOverflowSlot );
+			}
+		}
+		replaceSlot( kLevelBase[level] + index );
+	}
+
+	template <typename OnExpired>
+	void expireSlot( unsigned slot, OnExpired &&onExpired ) {
+		while( heads[slot] != kNone ) {
+			const unsigned item = heads[slot];
+			unlink( item );
+			numScheduled--;
+			onExpired( item );
+		}
+	}
+
+	template <typename OnExpired>
+	void rebuild( int64_t newTime, OnExpired &&onExpired ) {
+		Index pending = kNone;
+		for( unsigned slot = 0; slot <= kOverflowSlot; ++slot ) {
+			for( Index item = heads[slot], nextItem; item != kNone; item = nextItem ) {
+				nextItem = next[item];
+				next[item] = pending;
+				pending = item;
+				slotOf[item] = kNone;
+			}
+			heads[slot] = kNone;
+		}
+		currTime = newTime;
+		for( Index item = pending, nextItem; item != kNone; item = nextItem ) {
+			nextItem = next[item];
+			if( timeOf[item] <= newTime ) {
+				numScheduled--;
+				onExpired( item );
+			} else {
+				place( item );
+			}
+		}
+	}
+public:
+	explicit TimerWheel( int64_t time = 0 ) { clear( time ); }
+
+	void clear( int64_t time ) {
+		for( Index &head: heads ) {
+			head = kNone;
+		}
+		for( Index &slot: slotOf ) {
+			slot = kNone;
+		}
+		currTime = time;
+		numScheduled = 0;
+	}
+
+	[[nodiscard]]
+	int64_t time() const { return currTime; }
+	[[nodiscard]]
+	unsigned size() const { return numScheduled; }
+	[[nodiscard]]
+	bool isScheduled( unsigned item ) const { return slotOf[item] != kNone; }
+
+	/**
+	 * Schedules an item replacing its previous expiration time (if any).
+	 * @return false if the time has already come, the item is not kept in the wheel in this case.
+	 */
+	bool schedule( unsigned item, int64_t time ) {
+		assert( item < MaxItems );
+		cancel( item );
+		if( time <= currTime ) {
+			return false;
+		}
+		timeOf[item] = time;
+		place( item );
+		numScheduled++;
+		return true;
+	}
+
+	void cancel( unsigned item ) {
+		assert( item < MaxItems );
+		if( slotOf[item] != kNone ) {
+			unlink( item );
+			numScheduled--;
+		}
+	}
+
+	/**
+	 * Advances the current time calling {@code onExpired( item )} for every item that has expired.
+	 * An order of expiration is unspecified, callers that need a deterministic order should sort expired items.
+	 * @note callbacks must not schedule or cancel items.
+	 */
+	template <typename OnExpired>
+	void advance( int64_t newTime, OnExpired &&onExpired ) {
+		if( newTime <= currTime ) {
+			return;
+		}
+		if( !numScheduled ) {
+			currTime = newTime;
+			return;
+		}
+		if( newTime - currTime > kMaxSteppedJump ) {
+			rebuild( newTime, onExpired );
+			return;
+		}
+		while( currTime < newTime ) {
+			currTime++;
+			if( !( currTime & ( ( 1 << kLevelBits[0] ) - 1 ) ) ) {
+				cascade( 1 );
+			}
+			expireSlot( (unsigned)currTime & ( ( 1u << kLevelBits[0] ) - 1 ), onExpired );
+		}
+	}
+};
+
+}
+
+#endif
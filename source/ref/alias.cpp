@@ -690,33 +690,48 @@ void R_AliasModelFrameBounds( const model_t *mod, int frame, vec3_t mins, vec3_t
 	VectorCopy( pframe->maxs, maxs );
 }
 
+/*
+* R_CullAliasModel
+*
+* Selects a LOD of the model and culls it. Does not modify shared data, so entities can be culled in parallel.
+*/
+void R_CullAliasModel( const entity_t *e, modelCullInfo_t *info ) {
+	const model_t *mod;
+	const maliasmodel_t *aliasmodel;
+
+	info->mod = NULL;
+
+	mod = R_AliasModelLOD( e );
+	if( !( aliasmodel = ( ( const maliasmodel_t * )mod->extradata ) ) || !aliasmodel->nummeshes ) {
+		return;
+	}
+
+	info->mod = mod;
+	info->radius = R_AliasModelLerpBBox( e, mod, info->mins, info->maxs );
+	info->clipped = R_CullModelEntity( e, info->mins, info->maxs, info->radius, true, aliasmodel->numtris > 100 );
+}
+
 /*
 * R_AddAliasModelToDrawList
 *
 * Returns true if the entity is added to draw list
 */
-bool R_AddAliasModelToDrawList( const entity_t *e ) {
+bool R_AddAliasModelToDrawList( const entity_t *e, const modelCullInfo_t *info ) {
 	int i, j;
 	const model_t *mod;
 	const maliasmodel_t *aliasmodel;
 	const mfog_t *fog;
 	const shader_t *shader;
 	const maliasmesh_t *mesh;
-	vec3_t mins, maxs;
 	float radius;
 	float distance;
-	int clipped;
 
-	mod = R_AliasModelLOD( e );
-	if( !( aliasmodel = ( ( const maliasmodel_t * )mod->extradata ) ) || !aliasmodel->nummeshes ) {
+	if( !( mod = info->mod ) || info->clipped ) {
 		return false;
 	}
 
-	radius = R_AliasModelLerpBBox( e, mod, mins, maxs );
-	clipped = R_CullModelEntity( e, mins, maxs, radius, true, aliasmodel->numtris > 100 );
-	if( clipped ) {
-		return false;
-	}
+	aliasmodel = ( const maliasmodel_t * )mod->extradata;
+	radius = info->radius;
 
 	// never render weapon models or non-occluders into shadowmaps
 	if( rn.renderFlags & RF_SHADOWMAPVIEW ) {
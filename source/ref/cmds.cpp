@@ -130,6 +130,22 @@ void R_TakeScreenShot( const char *path, const char *name, const char *fmtString
 	R_ScreenShot( checkname, x, y, w, h, quality, silent );
 }
 
+/*
+* R_BenchmarkFrontend_f
+*
+* Culling is benchmarked by the thread that renders the next main view
+*/
+void R_BenchmarkFrontend_f( void ) {
+	int numRuns = Cmd_Argc() >= 2 ? atoi( Cmd_Argv( 1 ) ) : 100;
+
+	if( numRuns <= 0 ) {
+		Com_Printf( "Usage: %s [numRuns]\n", Cmd_Argv( 0 ) );
+		return;
+	}
+
+	rf.numFrontendBenchmarkRuns = numRuns;
+}
+
 /*
 * R_ScreenShot_f
 */
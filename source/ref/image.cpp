@@ -21,6 +21,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "../qcommon/hash.h"
 #include "../qcommon/qcommon.h"
 #include "../qcommon/wswfs.h"
+#include "../qcommon/wswjobpool.h"
+#include "../qcommon/wswmipmap.h"
 
 #include <algorithm>
 #include <tuple>
@@ -494,9 +496,11 @@ static void R_CutImage( const uint8_t *in, int inwidth, int height, uint8_t *out
 
 /*
 * R_ResampleTexture
+*
+* Uses the shared line buffer unless a caller-supplied one of 2 * outwidth elements is given
 */
 static void R_ResampleTexture( const uint8_t *in, int inwidth, int inheight, uint8_t *out,
-							   int outwidth, int outheight, int samples, int alignment ) {
+							   int outwidth, int outheight, int samples, int alignment, unsigned *lineBuffer = nullptr ) {
 	int i, j, k;
 	int inwidthS, outwidthS;
 	unsigned int frac, fracstep;
@@ -509,7 +513,7 @@ static void R_ResampleTexture( const uint8_t *in, int inwidth, int inheight, uin
 		return;
 	}
 
-	p1 = ( unsigned * )R_PrepareImageBuffer( TEXTURE_LINE_BUF, outwidth * sizeof( *p1 ) * 2 );
+	p1 = lineBuffer ? lineBuffer : ( unsigned * )R_PrepareImageBuffer( TEXTURE_LINE_BUF, outwidth * sizeof( *p1 ) * 2 );
 	p2 = p1 + outwidth;
 
 	fracstep = inwidth * 0x10000 / outwidth;
@@ -606,35 +610,7 @@ static void R_ResampleTexture16( const unsigned short *in, int inwidth, int inhe
 * Operates in place, quartering the size of the texture
 */
 static void R_MipMap( uint8_t *in, int width, int height, int samples, int alignment ) {
-	int i, j, k;
-	int instride = ALIGN( width * samples, alignment );
-	int outwidth, outheight, outpadding;
-	uint8_t *out = in;
-	uint8_t *next;
-	int inofs;
-
-	outwidth = width >> 1;
-	outheight = height >> 1;
-	if( !outwidth ) {
-		outwidth = 1;
-	}
-	if( !outheight ) {
-		outheight = 1;
-	}
-	outpadding = ALIGN( outwidth * samples, alignment ) - outwidth * samples;
-
-	for( i = 0; i < outheight; i++, in += instride * 2, out += outpadding ) {
-		next = ( ( ( i << 1 ) + 1 ) < height ) ? ( in + instride ) : in;
-		for( j = 0, inofs = 0; j < outwidth; j++, inofs += samples ) {
-			if( ( ( j << 1 ) + 1 ) < width ) {
-				for( k = 0; k < samples; ++k, ++inofs )
-					*( out++ ) = ( in[inofs] + in[inofs + samples] + next[inofs] + next[inofs + samples] ) >> 2;
-			} else {
-				for( k = 0; k < samples; ++k, ++inofs )
-					*( out++ ) = ( in[inofs] + next[inofs] ) >> 1;
-			}
-		}
-	}
+	wsw::MipMap8( in, width, height, samples, alignment, in );
 }
 
 /*
@@ -643,44 +619,7 @@ static void R_MipMap( uint8_t *in, int width, int height, int samples, int align
 * Operates in place, quartering the size of the 16-bit texture, assumes unpack alignment of 4
 */
 static void R_MipMap16( unsigned short *in, int width, int height, int rMask, int gMask, int bMask, int aMask ) {
-	int i, j;
-	int instride = ALIGN( width, 2 );
-	int outwidth, outheight, outpadding;
-	unsigned short *out = in;
-	unsigned short *next;
-	int col, p[4];
-
-	outwidth = width >> 1;
-	outheight = height >> 1;
-	if( !outwidth ) {
-		outwidth = 1;
-	}
-	if( !outheight ) {
-		outheight = 1;
-	}
-	outpadding = outwidth & 1;
-
-	for( i = 0; i < outheight; i++, in += instride * 2, out += outpadding ) {
-		next = ( ( ( i << 1 ) + 1 ) < height ) ? ( in + instride ) : in;
-		for( j = 0; j < outwidth; j++ ) {
-			col = j << 1;
-			p[0] = in[col];
-			p[1] = next[col];
-			if( ( col + 1 ) < width ) {
-				p[2] = in[col + 1];
-				p[3] = next[col + 1];
-				*( out++ ) =    ( ( ( ( p[0] & rMask ) + ( p[1] & rMask ) + ( p[2] & rMask ) + ( p[3] & rMask ) ) >> 2 ) & rMask ) |
-							 ( ( ( ( p[0] & gMask ) + ( p[1] & gMask ) + ( p[2] & gMask ) + ( p[3] & gMask ) ) >> 2 ) & gMask ) |
-							 ( ( ( ( p[0] & bMask ) + ( p[1] & bMask ) + ( p[2] & bMask ) + ( p[3] & bMask ) ) >> 2 ) & bMask ) |
-							 ( ( ( ( p[0] & aMask ) + ( p[1] & aMask ) + ( p[2] & aMask ) + ( p[3] & aMask ) ) >> 2 ) & aMask );
-			} else {
-				*( out++ ) =    ( ( ( ( p[0] & rMask ) + ( p[1] & rMask ) ) >> 1 ) & rMask ) |
-							 ( ( ( ( p[0] & gMask ) + ( p[1] & gMask ) ) >> 1 ) & gMask ) |
-							 ( ( ( ( p[0] & bMask ) + ( p[1] & bMask ) ) >> 1 ) & bMask ) |
-							 ( ( ( ( p[0] & aMask ) + ( p[1] & aMask ) ) >> 1 ) & aMask );
-			}
-		}
-	}
+	wsw::MipMap16( in, width, height, rMask, gMask, bMask, aMask, in );
 }
 
 static const GLint kSwizzleMaskIdentity[] = { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA };
@@ -1319,6 +1258,395 @@ static bool R_LoadImageFromDisk( image_t *image ) {
 	return loaded;
 }
 
+/*
+=================================================================
+
+DEFERRED LOADING
+
+=================================================================
+*/
+
+#define MIP_CHAIN_CACHE_MAGIC   "WMIP"
+#define MIP_CHAIN_CACHE_VERSION 1
+
+typedef struct {
+	char magic[4];
+	int version;
+	unsigned sourceHash;
+	unsigned sourceSize;
+	int flags;
+	int minmipsize;
+	int width, height;
+	int upload_width, upload_height;
+	int samples;
+	int numLevels;
+} mipChainCacheHeader_t;
+
+typedef struct {
+	image_t *image;
+	wsw::String pathname;                       // including the actual extension
+	wsw::String cachePath;
+	int flags;
+	int minmipsize;
+	unsigned sourceHash;
+	unsigned sourceSize;
+	int width, height, samples;
+	int upload_width, upload_height;
+	int numLevels;
+	wsw::Vector<uint8_t> levels;                // ready to upload with the unpack alignment of 1
+	bool fromCache;
+} pendingImage_t;
+
+static bool r_deferImageLoading;
+static wsw::Vector<pendingImage_t> r_pendingImages;
+
+/*
+* R_MipChainSize
+*
+* Returns a size of levels R_Upload32 makes of an image with the unpack alignment of 1
+*/
+static size_t R_MipChainSize( int width, int height, int samples, int flags, int minmipsize,
+							  int *upload_width, int *upload_height, int *numLevels ) {
+	int w, h;
+
+	R_ScaledImageSize( width, height, &w, &h, flags, 1, minmipsize, false );
+	*upload_width = w;
+	*upload_height = h;
+
+	size_t size = (size_t)w * h * samples;
+	int levels = 1;
+	if( !( flags & IT_NOMIPMAP ) ) {
+		while( w > minmipsize || h > minmipsize ) {
+			w = std::max( w >> 1, 1 );
+			h = std::max( h >> 1, 1 );
+			size += (size_t)w * h * samples;
+			levels++;
+		}
+	}
+
+	*numLevels = levels;
+	return size;
+}
+
+/*
+* R_ReadMipChainFromCache
+*/
+static bool R_ReadMipChainFromCache( pendingImage_t *pending ) {
+	auto maybeHandle = wsw::fs::openAsReadHandle( wsw::StringView( pending->cachePath.c_str() ), wsw::fs::UseCacheFS );
+	if( !maybeHandle ) {
+		return false;
+	}
+
+	mipChainCacheHeader_t header;
+	if( maybeHandle->getInitialFileSize() < sizeof( header ) || !maybeHandle->readExact( (uint8_t *)&header, sizeof( header ) ) ) {
+		return false;
+	}
+
+	if( memcmp( header.magic, MIP_CHAIN_CACHE_MAGIC, sizeof( header.magic ) ) || header.version != MIP_CHAIN_CACHE_VERSION ) {
+		return false;
+	}
+	if( header.sourceHash != pending->sourceHash || header.sourceSize != pending->sourceSize ) {
+		return false;
+	}
+	if( header.flags != pending->flags || header.minmipsize != pending->minmipsize ) {
+		return false;
+	}
+	if( header.width <= 0 || header.width > ( 1 << 16 ) || header.height <= 0 || header.height > ( 1 << 16 ) ) {
+		return false;
+	}
+	if( header.samples < 1 || header.samples > 4 ) {
+		return false;
+	}
+
+	// Sizes depend on picmip and hardware limits, so they have to be checked as well
+	int upload_width, upload_height, numLevels;
+	const size_t size = R_MipChainSize( header.width, header.height, header.samples, header.flags, header.minmipsize,
+										&upload_width, &upload_height, &numLevels );
+	if( upload_width != header.upload_width || upload_height != header.upload_height || numLevels != header.numLevels ) {
+		return false;
+	}
+	if( maybeHandle->getInitialFileSize() != sizeof( header ) + size ) {
+		return false;
+	}
+
+	pending->levels.resize( size );
+	if( !maybeHandle->readExact( pending->levels.data(), size ) ) {
+		return false;
+	}
+
+	pending->width = header.width;
+	pending->height = header.height;
+	pending->samples = header.samples;
+	pending->upload_width = upload_width;
+	pending->upload_height = upload_height;
+	pending->numLevels = numLevels;
+	pending->fromCache = true;
+	return true;
+}
+
+/*
+* R_WriteMipChainToCache
+*/
+static void R_WriteMipChainToCache( const pendingImage_t *pending ) {
+	auto maybeHandle = wsw::fs::openAsWriteHandle( wsw::StringView( pending->cachePath.c_str() ), wsw::fs::UseCacheFS );
+	if( !maybeHandle ) {
+		return;
+	}
+
+	mipChainCacheHeader_t header;
+	memcpy( header.magic, MIP_CHAIN_CACHE_MAGIC, sizeof( header.magic ) );
+	header.version = MIP_CHAIN_CACHE_VERSION;
+	header.sourceHash = pending->sourceHash;
+	header.sourceSize = pending->sourceSize;
+	header.flags = pending->flags;
+	header.minmipsize = pending->minmipsize;
+	header.width = pending->width;
+	header.height = pending->height;
+	header.upload_width = pending->upload_width;
+	header.upload_height = pending->upload_height;
+	header.samples = pending->samples;
+	header.numLevels = pending->numLevels;
+
+	// A truncated file gets rejected by the size check on reading
+	if( !maybeHandle->write( (const uint8_t *)&header, sizeof( header ) ) ||
+		!maybeHandle->write( pending->levels.data(), pending->levels.size() ) ) {
+		Com_DPrintf( S_COLOR_YELLOW "Failed to write %s\n", pending->cachePath.c_str() );
+	}
+}
+
+/*
+* R_PrepareMipChain
+*
+* Reads an image and makes levels of its mip chain exactly like R_Upload32 does it.
+* Gets called by worker threads, so it must not touch GL and shared image buffers.
+*/
+static void R_PrepareMipChain( pendingImage_t *pending ) {
+	auto maybeHandle = wsw::fs::openAsReadHandle( wsw::StringView( pending->pathname.c_str() ) );
+	if( !maybeHandle ) {
+		return;
+	}
+
+	const size_t fileSize = maybeHandle->getInitialFileSize();
+	wsw::Vector<uint8_t> buffer;
+	buffer.resize( fileSize );
+	if( !maybeHandle->readExact( buffer.data(), fileSize ) ) {
+		return;
+	}
+
+	pending->sourceHash = COM_SuperFastHash( buffer.data(), fileSize, fileSize );
+	pending->sourceSize = (unsigned)fileSize;
+	if( r_imagecache->integer && R_ReadMipChainFromCache( pending ) ) {
+		return;
+	}
+
+	int width = 0, height = 0, samples = 0;
+	stbi_uc *pic = stbi_load_from_memory( (const stbi_uc *)buffer.data(), (int)fileSize, &width, &height, &samples, 0 );
+	if( !pic ) {
+		return;
+	}
+
+	const int flags = pending->flags;
+	const uint8_t *source = pic;
+	wsw::Vector<uint8_t> flipped;
+	if( flags & ( IT_FLIPX | IT_FLIPY | IT_FLIPDIAGONAL ) ) {
+		flipped.resize( (size_t)width * height * samples );
+		R_FlipTexture( pic, flipped.data(), width, height, samples,
+					   ( flags & IT_FLIPX ) ? true : false,
+					   ( flags & IT_FLIPY ) ? true : false,
+					   ( flags & IT_FLIPDIAGONAL ) ? true : false );
+		source = flipped.data();
+	}
+
+	int w, h, numLevels;
+	pending->levels.resize( R_MipChainSize( width, height, samples, flags, pending->minmipsize, &w, &h, &numLevels ) );
+	pending->width = width;
+	pending->height = height;
+	pending->samples = samples;
+	pending->upload_width = w;
+	pending->upload_height = h;
+	pending->numLevels = numLevels;
+
+	wsw::Vector<unsigned> lineBuffer( 2 * w );
+	uint8_t *level = pending->levels.data();
+	R_ResampleTexture( source, width, height, level, w, h, samples, 1, lineBuffer.data() );
+	stbi_image_free( pic );
+
+	for( int i = 1; i < numLevels; i++ ) {
+		uint8_t *const nextLevel = level + (size_t)w * h * samples;
+		wsw::MipMap8( level, w, h, samples, 1, nextLevel );
+		level = nextLevel;
+		w = std::max( w >> 1, 1 );
+		h = std::max( h >> 1, 1 );
+	}
+}
+
+/*
+* R_UploadMipChain
+*/
+static void R_UploadMipChain( pendingImage_t *pending ) {
+	image_t *image = pending->image;
+	const int flags = pending->flags;
+
+	if( pending->levels.empty() ) {
+		// Materials that refer to the image have been made already, so it can't be released
+		Com_DPrintf( S_COLOR_YELLOW "Missing image: %s\n", image->name );
+		image->missing = true;
+		return;
+	}
+
+	image->width = pending->width;
+	image->height = pending->height;
+	image->samples = pending->samples;
+	image->upload_width = pending->upload_width;
+	image->upload_height = pending->upload_height;
+
+	int comp, format, type, target;
+	const GLint *swizzleMask = nullptr;
+	R_TextureFormat( flags, pending->samples, &comp, &format, &type, &swizzleMask );
+	R_TextureTarget( flags, &target );
+
+	R_BindImage( image );
+	R_SetupTexParameters( flags, pending->upload_width, pending->upload_height, pending->minmipsize );
+	qglTexParameteriv( R_TextureTarget( flags, nullptr ), GL_TEXTURE_SWIZZLE_RGBA, swizzleMask );
+	R_UnpackAlignment( 1 );
+
+	const uint8_t *level = pending->levels.data();
+	int w = pending->upload_width, h = pending->upload_height;
+	for( int i = 0; i < pending->numLevels; i++ ) {
+		qglTexImage2D( target, i, comp, w, h, 0, format, type, level );
+		level += (size_t)w * h * pending->samples;
+		w = std::max( w >> 1, 1 );
+		h = std::max( h >> 1, 1 );
+	}
+
+	R_UnbindImage( image );
+
+	Q_strncpyz( image->extension, pending->pathname.c_str() + strlen( image->name ), sizeof( image->extension ) );
+	image->loaded = true;
+	R_DeferDataSync();
+}
+
+/*
+* R_DeferImageLoading
+*
+* Checks whether an image exists and makes a placeholder that gets loaded by R_EndDeferredImageLoading
+*/
+static image_t *R_DeferImageLoading( const char *name, int flags, int minmipsize, int tags ) {
+	uint8_t *empty_data[6] = { NULL, NULL, NULL, NULL, NULL, NULL };
+	char pathname[1024];
+	const size_t len = strlen( name );
+
+	if( len >= sizeof( pathname ) - 7 ) {
+		return NULL;
+	}
+
+	memcpy( pathname, name, len + 1 );
+	Q_strncatz( pathname, ".tga", sizeof( pathname ) );
+
+	const char *extension = FS_FirstExtension( pathname, IMAGE_EXTENSIONS, NUM_IMAGE_EXTENSIONS - 1 );
+	if( !extension ) {
+		Com_DPrintf( S_COLOR_YELLOW "Missing image: %s\n", name );
+		return NULL;
+	}
+
+	COM_ReplaceExtension( pathname, extension, sizeof( pathname ) );
+
+	image_t *image = R_LoadImage( name, empty_data, 1, 1, flags, minmipsize, tags, 1 );
+	R_UnbindImage( image );
+
+	// The backend binds a white texture instead until the image is loaded
+	image->loaded = false;
+
+	char cachePath[1024 + 32];
+	Q_snprintfz( cachePath, sizeof( cachePath ), "cache/images/%s.%x.%d.mip", pathname, flags, minmipsize );
+
+	r_pendingImages.emplace_back();
+	pendingImage_t *pending = &r_pendingImages.back();
+	pending->image = image;
+	pending->pathname = pathname;
+	pending->cachePath = cachePath;
+	pending->flags = flags;
+	pending->minmipsize = minmipsize;
+	pending->fromCache = false;
+
+	return image;
+}
+
+/*
+* R_BeginDeferredImageLoading
+*
+* Images that are found from now on are loaded at once by R_EndDeferredImageLoading.
+* Images that must be loaded synchronously and cubemaps are still loaded immediately.
+*/
+void R_BeginDeferredImageLoading( void ) {
+	// Finish images of a map loading that has been interrupted by an error
+	R_CancelDeferredImageLoading();
+	r_deferImageLoading = true;
+}
+
+/*
+* R_CancelDeferredImageLoading
+*
+* Stops deferring images and loads images of a deferred loading that has been interrupted by an error synchronously.
+* Placeholders may be referenced by materials, so they can't be just freed.
+*/
+void R_CancelDeferredImageLoading( void ) {
+	r_deferImageLoading = false;
+
+	for( pendingImage_t &pending: r_pendingImages ) {
+		image_t *const image = pending.image;
+		// The image could have been freed and its slot could have been reused
+		if( !image->name || image->loaded ) {
+			continue;
+		}
+		if( R_LoadImageFromDisk( image ) ) {
+			image->loaded = true;
+		}
+		R_UnbindImage( image );
+	}
+
+	wsw::Vector<pendingImage_t>().swap( r_pendingImages );
+}
+
+/*
+* R_EndDeferredImageLoading
+*
+* Reads and decodes pending images and makes their mip chains in parallel, then uploads them.
+* This is done in groups as mip chains of all images of a map may take gigabytes.
+*/
+void R_EndDeferredImageLoading( void ) {
+	r_deferImageLoading = false;
+
+	const unsigned numThreads = r_frontend_jobs->integer ? rf.jobPool->numThreads() : 1;
+	const unsigned groupSize = 2 * numThreads;
+	for( unsigned first = 0; first < r_pendingImages.size(); first += groupSize ) {
+		pendingImage_t *const group = r_pendingImages.data() + first;
+		const unsigned count = std::min( groupSize, (unsigned)r_pendingImages.size() - first );
+
+		auto prepareMipChains = [=]( unsigned firstImage, unsigned numImages, unsigned ) {
+			for( unsigned i = 0; i < numImages; ++i ) {
+				R_PrepareMipChain( group + firstImage + i );
+			}
+		};
+
+		if( r_frontend_jobs->integer ) {
+			rf.jobPool->run( count, 1, prepareMipChains );
+		} else {
+			prepareMipChains( 0, count, 0 );
+		}
+
+		for( unsigned i = 0; i < count; ++i ) {
+			R_UploadMipChain( group + i );
+			if( r_imagecache->integer && !group[i].fromCache && !group[i].levels.empty() ) {
+				R_WriteMipChainToCache( group + i );
+			}
+			wsw::Vector<uint8_t>().swap( group[i].levels );
+		}
+	}
+
+	r_pendingImages.clear();
+}
+
 /*
 * R_LinkPic
 */
@@ -1630,6 +1958,10 @@ image_t *R_FindImage( const wsw::StringView &name, const wsw::StringView &suffix
 		}
 	}
 
+	if( r_deferImageLoading && !( flags & ( IT_SYNC | IT_CUBEMAP | IT_LEFTHALF | IT_RIGHTHALF ) ) ) {
+		return R_DeferImageLoading( buffer.data(), flags, minmipsize, tags );
+	}
+
 	//
 	// load the pic from disk
 	//
@@ -2366,6 +2698,9 @@ void R_ShutdownImages( void ) {
 
 	R_FreeImageBuffers();
 
+	wsw::Vector<pendingImage_t>().swap( r_pendingImages );
+	r_deferImageLoading = false;
+
 	if( r_imagePathBuf ) {
 		Q_free( r_imagePathBuf );
 	}
@@ -129,6 +129,10 @@ inline image_t *R_FindImage( const char *name, const char *suffix, int flags, in
 	return R_FindImage( nameView, suffixView, flags, minmipsize, tags );
 }
 
+void R_BeginDeferredImageLoading( void );
+void R_EndDeferredImageLoading( void );
+void R_CancelDeferredImageLoading( void );
+
 image_t *R_Create3DImage( const char *name, int width, int height, int layers, int flags, int tags, int samples, bool array );
 void R_ReplaceImage( image_t *image, uint8_t **pic, int width, int height, int flags, int minmipsize, int samples );
 void R_ReplaceSubImage( image_t *image, int layer, int x, int y, uint8_t **pic, int width, int height );
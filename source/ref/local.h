@@ -30,6 +30,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "../qcommon/patch.h"
 #include "../qcommon/qcommon.h"
 
+#include <atomic>
+
 #ifdef ALIGN
 #undef ALIGN
 #endif
@@ -42,6 +44,8 @@ typedef struct qthread_s qthread_t;
 typedef struct qmutex_s qmutex_t;
 typedef struct qbufPipe_s qbufPipe_t;
 
+namespace wsw { class JobPool; }
+
 typedef unsigned short elem_t;
 
 typedef vec_t instancePoint_t[8]; // quaternion for rotation + xyz pos + uniform scale
@@ -389,6 +393,11 @@ public:
 	}
 };
 
+typedef struct {
+	sortedDrawSurf_t sds;       // sds.drawSurf is NULL if the draw surface is not added
+	bool deferred;              // the draw surface has to be added by the calling thread
+} preparedWorldDrawSurf_t;
+
 // global frontend variables are stored here
 // the backend should never attempt reading or modifying them
 typedef struct {
@@ -425,24 +434,33 @@ typedef struct {
 
 	volatile bool dataSync;   // call R_Finish
 
+	volatile int numFrontendBenchmarkRuns;    // run R_BenchmarkFrontend for the next main view
+
 	char speedsMsg[2048];
 	qmutex_t        *speedsMsgLock;
 
 	msurface_t      *debugSurface;
 	qmutex_t        *debugSurfaceLock;
 
+	// surfaces are shared by leaves, so these flags are set by concurrently culled ranges of leaves
 	unsigned int numWorldSurfVis;
-	volatile unsigned char *worldSurfVis;
-	volatile unsigned char *worldSurfFullVis;
+	std::atomic<uint8_t> *worldSurfVis;
+	std::atomic<uint8_t> *worldSurfFullVis;
 
 	unsigned int numWorldLeafVis;
 	volatile unsigned char *worldLeafVis;
 
+	// several surfaces share a draw surface, so these flags are set by concurrently culled ranges of surfaces
 	unsigned int numWorldDrawSurfVis;
-	volatile unsigned char *worldDrawSurfVis;
+	std::atomic<uint8_t> *worldDrawSurfVis;
+	// world draw surfaces that are prepared for the draw list by ranges of draw surfaces
+	preparedWorldDrawSurf_t *worldDrawSurfsPrepared;
 
 	char drawBuffer[32];
 	bool newDrawBuffer;
+
+	// runs culling and other frontend work that does not touch GL on worker threads
+	wsw::JobPool    *jobPool;
 } r_globals_t;
 
 extern r_shared_t rsh;
@@ -526,6 +544,7 @@ extern cvar_t *r_gamma;
 extern cvar_t *r_texturemode;
 extern cvar_t *r_texturefilter;
 extern cvar_t *r_texturecompression;
+extern cvar_t *r_imagecache;
 extern cvar_t *r_mode;
 extern cvar_t *r_nobind;
 extern cvar_t *r_picmip;
@@ -549,6 +568,7 @@ extern cvar_t *r_usenotexture;
 extern cvar_t *r_maxglslbones;
 
 extern cvar_t *r_multithreading;
+extern cvar_t *r_frontend_jobs;
 
 extern cvar_t *r_showShaderCache;
 
@@ -570,10 +590,18 @@ void R_LatLongToNorm4( const uint8_t latlong[2], vec4_t out );
 
 //====================================================================
 
+typedef struct {
+	const model_t *mod;         // a LOD of the model, NULL if there,s nothing to draw
+	vec3_t mins, maxs;
+	float radius;
+	int clipped;                // a result of R_CullModelEntity
+} modelCullInfo_t;
+
 //
 // r_alias.c
 //
-bool    R_AddAliasModelToDrawList( const entity_t *e );
+void    R_CullAliasModel( const entity_t *e, modelCullInfo_t *info );
+bool    R_AddAliasModelToDrawList( const entity_t *e, const modelCullInfo_t *info );
 void    R_DrawAliasSurf( const entity_t *e, const shader_t *shader, const mfog_t *fog, const portalSurface_t *portalSurface, unsigned int shadowBits, drawSurfaceAlias_t *drawSurf );
 bool    R_AliasModelLerpTag( orientation_t *orient, const maliasmodel_t *aliasmodel, int framenum, int oldframenum,
 							 float lerpfrac, const char *name );
@@ -584,6 +612,7 @@ void        R_AliasModelFrameBounds( const model_t *mod, int frame, vec3_t mins,
 //
 void        R_TakeScreenShot( const char *path, const char *name, const char *fmtString, int x, int y, int w, int h, bool silent );
 void        R_ScreenShot_f( void );
+void        R_BenchmarkFrontend_f( void );
 
 //
 // r_cull.c
@@ -730,11 +759,15 @@ void R_ClearDrawList( drawList_t *list );
 unsigned R_PackOpaqueOrder( const mfog_t *fog, const shader_t *shader, int numLightmaps, bool dlight );
 void *R_AddSurfToDrawList( drawList_t *list, const entity_t *e, const mfog_t *fog, const shader_t *shader,
 						   float dist, unsigned int order, const portalSurface_t *portalSurf, void *drawSurf );
+bool R_PrepareSurfForDrawList( sortedDrawSurf_t *sds, const entity_t *e, const mfog_t *fog, const shader_t *shader,
+							   float dist, unsigned int order, const portalSurface_t *portalSurf, void *drawSurf );
+void *R_AddPreparedSurfToDrawList( drawList_t *list, const sortedDrawSurf_t *prepared );
 void R_UpdateDrawSurfDistKey( void *psds, int renderFx, const shader_t *shader, float dist, unsigned order );
 portalSurface_t *R_GetDrawListSurfPortal( void *psds );
 void R_AddDrawListVBOSlice( drawList_t *list, unsigned int index, unsigned int numVerts, unsigned int numElems,
 					unsigned int firstVert, unsigned int firstElem );
 vboSlice_t *R_GetDrawListVBOSlice( drawList_t *list, unsigned int index );
+void R_ReserveDrawListVBOSlices( drawList_t *list, unsigned int numSlices );
 void R_GetVBOSliceCounts( drawList_t *list, unsigned *numSliceVerts, unsigned *numSliceElems );
 
 void R_InitDrawLists( void );
@@ -798,6 +831,8 @@ void R_BlurScreen( void );
 #define MAX_SURF_QUERIES        0x1E0
 
 void        R_DrawWorld( void );
+void        R_CullWorldLeaves( unsigned clipFlags, bool useJobs );
+void        R_CullWorldSurfaces( unsigned clipFlags, bool useJobs );
 bool    R_SurfPotentiallyVisible( const msurface_t *surf );
 bool    R_SurfPotentiallyShadowed( const msurface_t *surf );
 bool    R_SurfPotentiallyLit( const msurface_t *surf );
@@ -818,7 +853,8 @@ shader_t    *R_FindShaderForSkinFile( const struct skinfile_s *skinfile, const c
 //
 // r_skm.c
 //
-bool    R_AddSkeletalModelToDrawList( const entity_t *e );
+void    R_CullSkeletalModel( const entity_t *e, modelCullInfo_t *info );
+bool    R_AddSkeletalModelToDrawList( const entity_t *e, const modelCullInfo_t *info );
 void    R_DrawSkeletalSurf( const entity_t *e, const shader_t *shader, const mfog_t *fog, const portalSurface_t *portalSurface, unsigned int shadowBits, drawSurfaceSkeletal_t *drawSurf );
 float       R_SkeletalModelBBox( const entity_t *e, vec3_t mins, vec3_t maxs );
 void        R_SkeletalModelFrameBounds( const model_t *mod, int frame, vec3_t mins, vec3_t maxs );
@@ -829,6 +865,7 @@ bool        R_SkeletalModelLerpTag( orientation_t *orient, const mskmodel_t *skm
 
 void        R_InitSkeletalCache( void );
 void        R_ClearSkeletalCache( void );
+void        R_UpdateSkeletalCache( void );
 void        R_ShutdownSkeletalCache( void );
 
 //
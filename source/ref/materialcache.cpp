@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "../qcommon/links.h"
 #include "../qcommon/singletonholder.h"
 #include "../qcommon/wswfs.h"
+#include "../qcommon/wswjobpool.h"
 #include "materiallocal.h"
 
 #include <algorithm>
@@ -47,24 +48,51 @@ auto MaterialCache::instance() -> MaterialCache * {
 }
 
 MaterialCache::MaterialCache() {
+	wsw::Vector<wsw::String> fileNames;
 	for( const wsw::StringView &dir : { "<scripts"_asView, ">scripts"_asView, "scripts"_asView } ) {
 		// TODO: Must be checked if exists
-		loadDirContents( dir );
+		wsw::fs::SearchResultHolder searchResultHolder;
+		if( auto callResult = searchResultHolder.findDirFiles( dir, ".shader"_asView ) ) {
+			for( const wsw::StringView &fileName: *callResult ) {
+				fileNames.emplace_back( wsw::String( fileName.data(), fileName.size() ) );
+			}
+		}
 	}
 
+	loadFilesContents( fileNames );
+
 	freeMaterialIds.reserve( MAX_SHADERS );
 	for( unsigned i = 0; i < MAX_SHADERS; ++i ) {
 		freeMaterialIds.push_back( i );
 	}
 }
 
-void MaterialCache::loadDirContents( const wsw::StringView &dir ) {
-	wsw::fs::SearchResultHolder searchResultHolder;
-	if( auto callResult = searchResultHolder.findDirFiles( dir, ".shader"_asView ) ) {
-		for( const wsw::StringView &fileName: *callResult ) {
-			this->addFileContents( fileName );
+void MaterialCache::loadFilesContents( const wsw::Vector<wsw::String> &fileNames ) {
+	wsw::Vector<MaterialFileContents *> loadedContents( fileNames.size(), nullptr );
+	const bool showFiles = r_showShaderCache && r_showShaderCache->integer;
+	const int64_t startTime = Sys_Milliseconds();
+
+	if( showFiles ) {
+		for( const wsw::String &fileName: fileNames ) {
+			Com_Printf( "...loading 'scripts/%s'\n", fileName.data() );
+		}
+	}
+
+	// Reading and tokenizing files does not touch the cache state, so files may be loaded in parallel
+	wsw::JobPool *const jobPool = r_frontend_jobs->integer ? rf.jobPool : nullptr;
+	MaterialFileContents::loadFiles( fileNames, &MaterialCache::readRawContents, jobPool, loadedContents.data() );
+
+	// Sources must be added in the order of files as sources of later files take precedence
+	for( MaterialFileContents *contents: loadedContents ) {
+		if( contents ) {
+			addFileContents( contents );
 		}
 	}
+
+	if( showFiles ) {
+		const int64_t loadingTime = Sys_Milliseconds() - startTime;
+		Com_Printf( "Loaded %u material files in %" PRIi64 " millis\n", (unsigned)fileNames.size(), loadingTime );
+	}
 }
 
 MaterialCache::~MaterialCache() {
@@ -733,106 +761,39 @@ auto MaterialCache::newDefaultMaterial( int type, const wsw::HashedStringView &c
 	return nullptr;
 }
 
-auto MaterialCache::readRawContents( const wsw::StringView &fileName ) -> const wsw::String * {
-	wsw::String &pathName = pathNameBuffer;
+auto MaterialCache::readRawContents( const wsw::StringView &fileName, MaterialFileContents::LoadingBuffers *buffers )
+	-> const wsw::String * {
+	wsw::String &pathName = buffers->pathName;
 	pathName.clear();
 	pathName.append( "scripts/" );
 	pathName.append( fileName.data(), fileName.size() );
 
-	if ( r_showShaderCache && r_showShaderCache->integer ) {
-		Com_Printf( "...loading '%s'\n", pathName.data() );
-	}
-
 	auto maybeHandle = wsw::fs::openAsReadHandle( wsw::StringView( pathName.data(), pathName.size() ) );
 	if( !maybeHandle ) {
 		return nullptr;
 	}
 
+	wsw::String &rawContents = buffers->rawContents;
 	const auto size = maybeHandle->getInitialFileSize();
-	fileContentsBuffer.resize( size + 1 );
-	if( !maybeHandle->readExact( fileContentsBuffer.data(), size ) ) {
+	rawContents.resize( size + 1 );
+	if( !maybeHandle->readExact( rawContents.data(), size ) ) {
 		return nullptr;
 	}
 
 	// Put the terminating zero, this is not mandatory as tokens aren't supposed
 	// to be zero terminated but allows printing contents using C-style facilities
-	fileContentsBuffer[size] = '\0';
-	return &fileContentsBuffer;
+	rawContents[size] = '\0';
+	return &rawContents;
 }
 
-auto MaterialCache::loadFileContents( const wsw::StringView &fileName ) -> MaterialFileContents * {
-	const wsw::String *rawContents = readRawContents( fileName );
-	if( !rawContents ) {
-		return nullptr;
-	}
-
-	int offsetShift = 0;
-	// Strip an UTF8 BOM (if any)
-	if( rawContents->size() > 2 ) {
-		// The data must be cast to an unsigned type first, otherwise a comparison gets elided by a compiler
-		const auto *p = (const uint8_t *)rawContents->data();
-		if( ( p[0] == 0xEFu ) && ( p[1] == 0xBBu ) && ( p[2] == 0xBFu ) ) {
-			offsetShift = 3;
-		}
-	}
-
-	TokenSplitter splitter( rawContents->data() + offsetShift, rawContents->size() - offsetShift );
-
-	fileTokenSpans.clear();
-
-	uint32_t lineNum = 0;
-	size_t numKeptChars = 0;
-	while( !splitter.isAtEof() ) {
-		while( auto maybeToken = splitter.fetchNextTokenInLine() ) {
-			const auto &[off, len] = *maybeToken;
-			fileTokenSpans.emplace_back( TokenSpan { (int)( off + offsetShift ), len, lineNum } );
-			numKeptChars += len;
-		}
-		lineNum++;
-	}
-
-	MemSpecBuilder memSpec;
-	auto headerSpec = memSpec.add<MaterialFileContents>();
-	auto spansSpec = memSpec.add<TokenSpan>( fileTokenSpans.size() );
-	auto contentsSpec = memSpec.add<char>( numKeptChars );
-
-	auto *mem = (uint8_t *)::malloc( memSpec.sizeSoFar() );
-	if( !mem ) {
-		return nullptr;
-	}
-
-	auto *result = new( headerSpec.get( mem ) )MaterialFileContents();
-	result->spans = spansSpec.get( mem );
-	result->data = contentsSpec.get( mem );
-	assert( !result->dataSize && !result->numSpans );
-
-	// Copy spans and compactified data
-	char *data = contentsSpec.get( mem );
-	for( const auto &parsedSpan: fileTokenSpans ) {
-		auto *copiedSpan = &result->spans[result->numSpans++];
-		*copiedSpan = parsedSpan;
-		copiedSpan->offset = result->dataSize;
-		std::memcpy( data + copiedSpan->offset, rawContents->data() + parsedSpan.offset, parsedSpan.len );
-		result->dataSize += parsedSpan.len;
-		assert( parsedSpan.len == copiedSpan->len && parsedSpan.line == copiedSpan->line );
-	}
-
-	assert( result->numSpans == fileTokenSpans.size() );
-	assert( result->dataSize == numKeptChars );
-
-	return result;
-}
-
-void MaterialCache::addFileContents( const wsw::StringView &fileName ) {
-	if( MaterialFileContents *contents = loadFileContents( fileName ) ) {
-		if( tryAddingFileContents( contents ) ) {
-			assert( !contents->next );
-			contents->next = fileContentsHead;
-			fileContentsHead = contents;
-		} else {
-			contents->~MaterialFileContents();
-			free( contents );
-		}
+void MaterialCache::addFileContents( MaterialFileContents *contents ) {
+	if( tryAddingFileContents( contents ) ) {
+		assert( !contents->next );
+		contents->next = fileContentsHead;
+		fileContentsHead = contents;
+	} else {
+		contents->~MaterialFileContents();
+		free( contents );
 	}
 }
 
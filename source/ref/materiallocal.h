@@ -13,6 +13,8 @@
 
 #include <optional>
 
+namespace wsw { class JobPool; }
+
 enum class PassKey {
 	RgbGen,
 	BlendFunc,
@@ -492,6 +494,35 @@ struct MaterialFileContents {
 	size_t dataSize { 0 };
 	TokenSpan *spans { nullptr };
 	unsigned numSpans { 0 };
+
+	/**
+	 * Splits raw data of a file to tokens and makes a compact copy of their characters.
+	 * @param spansBuffer a buffer for intermediate spans that may be reused for many files
+	 * @return a single {@code malloc()}-allocated memory chunk or null if the allocation has failed
+	 */
+	[[nodiscard]]
+	static auto tokenize( const char *rawData, size_t rawDataSize, wsw::Vector<TokenSpan> *spansBuffer )
+		-> MaterialFileContents *;
+
+	// Files are loaded by multiple threads, so every thread has its own buffers
+	struct LoadingBuffers {
+		wsw::String pathName;
+		wsw::String rawContents;
+		wsw::Vector<TokenSpan> tokenSpans;
+	};
+
+	/**
+	 * Reads raw contents of a file to {@code buffers->rawContents} using {@code buffers->pathName} for building a path.
+	 * @return the raw contents buffer or null on failure
+	 */
+	using RawContentsReader = const wsw::String *(*)( const wsw::StringView &fileName, LoadingBuffers *buffers );
+
+	/**
+	 * Reads and tokenizes files. Files are processed in parallel if a job pool is supplied.
+	 * @param results an array of {@code fileNames.size()} contents that are null for files that have failed to load
+	 */
+	static void loadFiles( const wsw::Vector<wsw::String> &fileNames, RawContentsReader readRawContents,
+						   wsw::JobPool *jobPool, MaterialFileContents **results );
 };
 
 class MaterialSource {
@@ -574,12 +605,9 @@ class MaterialCache {
 
 	shader_t *materialById[MAX_SHADERS] { nullptr };
 
-	wsw::String pathNameBuffer;
 	wsw::String cleanNameBuffer;
 	wsw::String expansionBuffer;
-	wsw::String fileContentsBuffer;
 
-	wsw::Vector<TokenSpan> fileTokenSpans;
 	wsw::Vector<TokenSpan> templateTokenSpans;
 
 	wsw::Vector<wsw::StringView> fileMaterialNames;
@@ -591,8 +619,8 @@ class MaterialCache {
 	wsw::StaticVector<MaterialLexer, 1> templateLexerHolder;
 	wsw::StaticVector<TokenStream, 1> primaryTokenStreamHolder;
 
-	auto loadFileContents( const wsw::StringView &fileName ) -> MaterialFileContents *;
-	auto readRawContents( const wsw::StringView &fileName ) -> const wsw::String *;
+	static auto readRawContents( const wsw::StringView &fileName, MaterialFileContents::LoadingBuffers *buffers )
+		-> const wsw::String *;
 
 	auto findSourceByName( const wsw::StringView &name ) -> MaterialSource * {
 		return findSourceByName( wsw::HashedStringView( name ) );
@@ -603,9 +631,9 @@ class MaterialCache {
 	auto findImage( const wsw::StringView &name, int flags, int imageTags, int minMipSize = 1 ) -> image_s *;
 	void loadMaterial( image_s **images, const wsw::StringView &fullName, int flags, int imageTags, int minMipSize = 1 );
 
-	void loadDirContents( const wsw::StringView &dir );
+	void loadFilesContents( const wsw::Vector<wsw::String> &fileNames );
 
-	void addFileContents( const wsw::StringView &fileName );
+	void addFileContents( MaterialFileContents *contents );
 	bool tryAddingFileContents( const MaterialFileContents *contents );
 
 	void unlinkAndFree( shader_t *s );
@@ -1,4 +1,5 @@
 #include "materiallocal.h"
+#include "../qcommon/wswjobpool.h"
 
 auto MaterialSource::preparePlaceholders() -> std::optional<Placeholders> {
 	wsw::Vector<PlaceholderSpan> buffer;
@@ -155,4 +156,85 @@ bool MaterialSource::expandTemplate( const ExpansionParams &params, ExpansionSta
 
 	addTheRest( state, lastTokenNum, numSpans );
 	return true;
-}
\ No newline at end of file
+}
+
+auto MaterialFileContents::tokenize( const char *rawData, size_t rawDataSize, wsw::Vector<TokenSpan> *spansBuffer )
+	-> MaterialFileContents * {
+	int offsetShift = 0;
+	// Strip an UTF8 BOM (if any)
+	if( rawDataSize > 2 ) {
+		// The data must be cast to an unsigned type first, otherwise a comparison gets elided by a compiler
+		const auto *p = (const uint8_t *)rawData;
+		if( ( p[0] == 0xEFu ) && ( p[1] == 0xBBu ) && ( p[2] == 0xBFu ) ) {
+			offsetShift = 3;
+		}
+	}
+
+	TokenSplitter splitter( rawData + offsetShift, rawDataSize - offsetShift );
+
+	spansBuffer->clear();
+
+	uint32_t lineNum = 0;
+	size_t numKeptChars = 0;
+	while( !splitter.isAtEof() ) {
+		while( auto maybeToken = splitter.fetchNextTokenInLine() ) {
+			const auto &[off, len] = *maybeToken;
+			spansBuffer->emplace_back( TokenSpan { (int)( off + offsetShift ), len, lineNum } );
+			numKeptChars += len;
+		}
+		lineNum++;
+	}
+
+	MemSpecBuilder memSpec;
+	auto headerSpec = memSpec.add<MaterialFileContents>();
+	auto spansSpec = memSpec.add<TokenSpan>( spansBuffer->size() );
+	auto contentsSpec = memSpec.add<char>( numKeptChars );
+
+	auto *mem = (uint8_t *)::malloc( memSpec.sizeSoFar() );
+	if( !mem ) {
+		return nullptr;
+	}
+
+	auto *result = new( headerSpec.get( mem ) )MaterialFileContents();
+	result->spans = spansSpec.get( mem );
+	result->data = contentsSpec.get( mem );
+	assert( !result->dataSize && !result->numSpans );
+
+	// Copy spans and compactified data
+	char *data = contentsSpec.get( mem );
+	for( const auto &parsedSpan: *spansBuffer ) {
+		auto *copiedSpan = &result->spans[result->numSpans++];
+		*copiedSpan = parsedSpan;
+		copiedSpan->offset = result->dataSize;
+		std::memcpy( data + copiedSpan->offset, rawData + parsedSpan.offset, parsedSpan.len );
+		result->dataSize += parsedSpan.len;
+		assert( parsedSpan.len == copiedSpan->len && parsedSpan.line == copiedSpan->line );
+	}
+
+	assert( result->numSpans == spansBuffer->size() );
+	assert( result->dataSize == numKeptChars );
+
+	return result;
+}
+
+void MaterialFileContents::loadFiles( const wsw::Vector<wsw::String> &fileNames, RawContentsReader readRawContents,
+									  wsw::JobPool *jobPool, MaterialFileContents **results ) {
+	wsw::Vector<LoadingBuffers> buffers( jobPool ? jobPool->numThreads() : 1 );
+	auto loadRange = [&]( unsigned first, unsigned count, unsigned threadNum ) {
+		LoadingBuffers *const threadBuffers = &buffers[threadNum];
+		for( unsigned i = first; i < first + count; ++i ) {
+			results[i] = nullptr;
+			const wsw::StringView fileName( fileNames[i].data(), fileNames[i].size() );
+			if( const wsw::String *rawContents = readRawContents( fileName, threadBuffers ) ) {
+				// The terminating zero is passed as well, the splitter treats it as the end of data
+				results[i] = tokenize( rawContents->data(), rawContents->size(), &threadBuffers->tokenSpans );
+			}
+		}
+	};
+
+	if( jobPool ) {
+		jobPool->run( (unsigned)fileNames.size(), 4, loadRange );
+	} else {
+		loadRange( 0, (unsigned)fileNames.size(), 0 );
+	}
+}
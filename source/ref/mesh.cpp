@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "local.h"
 #include "materiallocal.h"
+#include "../qcommon/wswradixsort.h"
 
 #include <algorithm>
 
@@ -85,6 +86,12 @@ static void R_ReserveDrawSurfaces( drawList_t *list, int minMeshes ) {
 
 	list->drawSurfs = newDs;
 	list->maxDrawSurfs = newSize;
+
+	// the contents does not have to be preserved
+	if( list->sortScratch ) {
+		Q_free( list->sortScratch );
+	}
+	list->sortScratch = (sortedDrawSurf_t *)Q_malloc( newSize * sizeof( sortedDrawSurf_t ) );
 }
 
 /*
@@ -169,21 +176,20 @@ unsigned R_PackOpaqueOrder( const mfog_t *fog, const shader_t *shader, int numLi
 }
 
 /*
-* R_AddSurfToDrawList
+* R_PrepareSurfForDrawList
 *
-* Calculate sortkey and store info used for batching and sorting.
-* All 3D-geometry passes this function.
+* Calculates keys of a surface without touching a draw list, so it may be called by worker threads.
+* Returns false if the surface should not be drawn.
 */
-void *R_AddSurfToDrawList( drawList_t *list, const entity_t *e, const mfog_t *fog, const shader_t *shader,
-						   float dist, unsigned int order, const portalSurface_t *portalSurf, void *drawSurf ) {
+bool R_PrepareSurfForDrawList( sortedDrawSurf_t *sds, const entity_t *e, const mfog_t *fog, const shader_t *shader,
+							   float dist, unsigned int order, const portalSurface_t *portalSurf, void *drawSurf ) {
 	int distKey;
-	sortedDrawSurf_t *sds;
 
-	if( !list || !shader ) {
-		return NULL;
+	if( !shader ) {
+		return false;
 	}
 	if( ( rn.renderFlags & RF_SHADOWMAPVIEW ) && Shader_ReadDepth( shader ) ) {
-		return NULL;
+		return false;
 	}
 	if( !rsh.worldBrushModel ) {
 		fog = NULL;
@@ -191,9 +197,23 @@ void *R_AddSurfToDrawList( drawList_t *list, const entity_t *e, const mfog_t *fo
 
 	distKey = R_PackDistKey( e->renderfx, shader, dist, order );
 	if( !distKey ) {
-		return NULL;
+		return false;
 	}
 
+	sds->drawSurf = ( drawSurfaceType_t * )drawSurf;
+	sds->sortKey = R_PackSortKey( shader->id, fog ? fog - rsh.worldBrushModel->fogs : -1,
+		portalSurf ? portalSurf - rn.portalSurfaces : -1, R_ENT2NUM( e ) );
+	sds->distKey = distKey;
+
+	return true;
+}
+
+/*
+* R_AddPreparedSurfToDrawList
+*/
+void *R_AddPreparedSurfToDrawList( drawList_t *list, const sortedDrawSurf_t *prepared ) {
+	sortedDrawSurf_t *sds;
+
 	// reallocate if numDrawSurfs
 	if( list->numDrawSurfs >= list->maxDrawSurfs ) {
 		int minMeshes = MIN_RENDER_MESHES;
@@ -204,14 +224,31 @@ void *R_AddSurfToDrawList( drawList_t *list, const entity_t *e, const mfog_t *fo
 	}
 
 	sds = &list->drawSurfs[list->numDrawSurfs++];
-	sds->drawSurf = ( drawSurfaceType_t * )drawSurf;
-	sds->sortKey = R_PackSortKey( shader->id, fog ? fog - rsh.worldBrushModel->fogs : -1,
-		portalSurf ? portalSurf - rn.portalSurfaces : -1, R_ENT2NUM( e ) );
-	sds->distKey = distKey;
+	*sds = *prepared;
 
 	return sds;
 }
 
+/*
+* R_AddSurfToDrawList
+*
+* Calculate sortkey and store info used for batching and sorting.
+* All 3D-geometry passes this function.
+*/
+void *R_AddSurfToDrawList( drawList_t *list, const entity_t *e, const mfog_t *fog, const shader_t *shader,
+						   float dist, unsigned int order, const portalSurface_t *portalSurf, void *drawSurf ) {
+	sortedDrawSurf_t sds;
+
+	if( !list ) {
+		return NULL;
+	}
+	if( !R_PrepareSurfForDrawList( &sds, e, fog, shader, dist, order, portalSurf, drawSurf ) ) {
+		return NULL;
+	}
+
+	return R_AddPreparedSurfToDrawList( list, &sds );
+}
+
 /*
 * R_UpdateDrawSurfDistKey
 */
@@ -236,41 +273,25 @@ portalSurface_t *R_GetDrawListSurfPortal( void *psds ) {
 }
 
 /*
-* R_DrawSurfCompare
+* R_DrawSurfSortKey
 *
-* Comparison callback function for R_SortDrawList
+* Combines keys of a draw surface so the distance key is the most significant one
 */
-static int R_DrawSurfCompare( const sortedDrawSurf_t *sbs1, const sortedDrawSurf_t *sbs2 ) {
-	if( sbs1->distKey > sbs2->distKey ) {
-		return 1;
-	}
-	if( sbs2->distKey > sbs1->distKey ) {
-		return -1;
-	}
-
-	if( sbs1->sortKey > sbs2->sortKey ) {
-		return 1;
-	}
-	if( sbs2->sortKey > sbs1->sortKey ) {
-		return -1;
-	}
-
-	return 0;
+static inline uint64_t R_DrawSurfSortKey( const sortedDrawSurf_t &sds ) {
+	return ( (uint64_t)sds.distKey << 32 ) | sds.sortKey;
 }
 
 /*
 * R_SortDrawList
 *
-* Regular quicksort. Note that for all kinds of transparent meshes
-* you probably want to set distance or draw order to prevent flickering
-* due to quicksort's unstable nature.
+* Stable radix sort, so transparent meshes that have equal keys
+* keep the order they have been added in and do not flicker.
 */
 void R_SortDrawList( drawList_t *list ) {
 	if( r_draworder->integer ) {
 		return;
 	}
-	qsort( list->drawSurfs, list->numDrawSurfs, sizeof( sortedDrawSurf_t ),
-		   ( int ( * )( const void *, const void * ) )R_DrawSurfCompare );
+	wsw::RadixSort64( list->drawSurfs, list->sortScratch, list->numDrawSurfs, R_DrawSurfSortKey );
 }
 
 /*
@@ -297,6 +318,17 @@ static void R_ReserveVBOSlices( drawList_t *list, unsigned int minSlices ) {
 	list->maxVboSlices = newSize;
 }
 
+/*
+* R_ReserveDrawListVBOSlices
+*
+* Makes sure slices of the given indices can be added without reallocation, e.g. by worker threads
+*/
+void R_ReserveDrawListVBOSlices( drawList_t *list, unsigned int numSlices ) {
+	if( numSlices > list->maxVboSlices ) {
+		R_ReserveVBOSlices( list, numSlices );
+	}
+}
+
 /*
 * R_AddDrawListVBOSlice
 */
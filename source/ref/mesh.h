@@ -58,6 +58,7 @@ typedef struct {
 typedef struct {
 	unsigned int numDrawSurfs, maxDrawSurfs;
 	sortedDrawSurf_t    *drawSurfs;
+	sortedDrawSurf_t    *sortScratch;   // a buffer of the same size for R_SortDrawList
 
 	unsigned int maxVboSlices;
 	vboSlice_t          *vboSlices;
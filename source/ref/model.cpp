@@ -295,6 +295,8 @@ static void Mod_SetupSubmodels( model_t *mod ) {
 		} else {
 			bmodel->visleafs = NULL;
 			bmodel->numvisleafs = 0;
+			bmodel->visLeafClusters = NULL;
+			bmodel->visLeafAreas = NULL;
 		}
 
 		VectorCopy( bm->maxs, starmod->maxs );
@@ -865,6 +867,52 @@ void Mod_CreateVertexBufferObjects( model_t *mod ) {
 	}
 }
 
+/*
+* Mod_CreateCullingData
+*
+* Copies bounds of visleafs and surfaces to arrays that are tested 4 at once by R_DrawWorld
+*/
+static void Mod_CreateCullingData( model_t *mod ) {
+	unsigned i, j;
+	mbrushmodel_t *loadbmodel = ( ( mbrushmodel_t * )mod->extradata );
+	const unsigned numLeafs = loadbmodel->numvisleafs + 3;
+	const unsigned numSurfaces = loadbmodel->numsurfaces + 3;
+	float *bounds;
+	int *leafData;
+
+	bounds = (float *)Q_malloc( 6 * ( numLeafs + numSurfaces ) * sizeof( float ) );
+	memset( bounds, 0, 6 * ( numLeafs + numSurfaces ) * sizeof( float ) );
+	leafData = (int *)Q_malloc( 2 * numLeafs * sizeof( int ) );
+	memset( leafData, 0, 2 * numLeafs * sizeof( int ) );
+
+	for( j = 0; j < 3; j++ ) {
+		loadbmodel->visLeafMins[j] = bounds + ( 2 * j + 0 ) * numLeafs;
+		loadbmodel->visLeafMaxs[j] = bounds + ( 2 * j + 1 ) * numLeafs;
+		loadbmodel->surfaceMins[j] = bounds + 6 * numLeafs + ( 2 * j + 0 ) * numSurfaces;
+		loadbmodel->surfaceMaxs[j] = bounds + 6 * numLeafs + ( 2 * j + 1 ) * numSurfaces;
+	}
+	loadbmodel->visLeafClusters = leafData;
+	loadbmodel->visLeafAreas = leafData + numLeafs;
+
+	for( i = 0; i < loadbmodel->numvisleafs; i++ ) {
+		const mleaf_t *leaf = loadbmodel->visleafs[i];
+		for( j = 0; j < 3; j++ ) {
+			loadbmodel->visLeafMins[j][i] = leaf->mins[j];
+			loadbmodel->visLeafMaxs[j][i] = leaf->maxs[j];
+		}
+		loadbmodel->visLeafClusters[i] = leaf->cluster;
+		loadbmodel->visLeafAreas[i] = leaf->area;
+	}
+
+	for( i = 0; i < loadbmodel->numsurfaces; i++ ) {
+		const msurface_t *surf = loadbmodel->surfaces + i;
+		for( j = 0; j < 3; j++ ) {
+			loadbmodel->surfaceMins[j][i] = surf->mins[j];
+			loadbmodel->surfaceMaxs[j][i] = surf->maxs[j];
+		}
+	}
+}
+
 /*
 * Mod_CreateSkydome
 */
@@ -896,6 +944,8 @@ static void Mod_FinalizeBrushModel( model_t *model ) {
 
 	Mod_CreateVertexBufferObjects( model );
 
+	Mod_CreateCullingData( model );
+
 	Mod_SetupSubmodels( model );
 
 	Mod_CreateSkydome( model );
@@ -193,6 +193,13 @@ typedef struct mbrushmodel_s {
 
 	unsigned numMiptex;
 	void            *mipTex;
+
+	// bounds, clusters and areas of visleafs and bounds of surfaces in a structure of arrays
+	// for SIMD culling of the world, arrays are padded by 3 elements for unmasked loads
+	float           *visLeafMins[3], *visLeafMaxs[3];
+	int             *visLeafClusters;
+	int             *visLeafAreas;
+	float           *surfaceMins[3], *surfaceMaxs[3];
 } mbrushmodel_t;
 
 /*
@@ -255,7 +255,8 @@ static void Mod_PreloadFaces( const lump_t *l ) {
 		}
 	}
 
-	// preload shaders (images will start loading in background threads while we're still busy with the map)
+	// preload shaders (images are decoded in parallel when all shaders have been registered)
+	R_BeginDeferredImageLoading();
 	in = loadmodel_dsurfaces;
 	for( i = 0; i < loadmodel_numsurfaces; i++, in++ ) {
 		// load shader
@@ -282,6 +283,7 @@ static void Mod_PreloadFaces( const lump_t *l ) {
 			shaderRef->shaders[shaderType - SHADER_TYPE_BSP_MIN] = R_RegisterShader( shaderRef->name, shaderType );
 		}
 	}
+	R_EndDeferredImageLoading();
 }
 
 /*
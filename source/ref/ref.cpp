@@ -23,6 +23,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "local.h"
 #include "../qcommon/qcommon.h"
+#include "../qcommon/wswjobpool.h"
 #include <algorithm>
 
 r_globals_t rf;
@@ -857,11 +858,11 @@ static void R_SetupFrame( void ) {
 			rf.worldModelSequence = rsh.worldModelSequence;
 
 			if( !rf.numWorldSurfVis ) {
-				rf.worldSurfVis = (unsigned char *)Q_malloc( rsh.worldBrushModel->numsurfaces * sizeof( *rf.worldSurfVis ) );
-				rf.worldSurfFullVis = (unsigned char *)Q_malloc( rsh.worldBrushModel->numsurfaces * sizeof( *rf.worldSurfVis ) );
+				rf.worldSurfVis = (std::atomic<uint8_t> *)Q_malloc( rsh.worldBrushModel->numsurfaces * sizeof( *rf.worldSurfVis ) );
+				rf.worldSurfFullVis = (std::atomic<uint8_t> *)Q_malloc( rsh.worldBrushModel->numsurfaces * sizeof( *rf.worldSurfVis ) );
 			} else if( rf.numWorldSurfVis < rsh.worldBrushModel->numsurfaces ) {
-				rf.worldSurfVis = (unsigned char *)Q_realloc( (void *)rf.worldSurfVis, rsh.worldBrushModel->numsurfaces * sizeof( *rf.worldSurfVis ) );
-				rf.worldSurfFullVis = (unsigned char *)Q_realloc( (void *)rf.worldSurfFullVis, rsh.worldBrushModel->numsurfaces * sizeof( *rf.worldSurfVis ) );
+				rf.worldSurfVis = (std::atomic<uint8_t> *)Q_realloc( (void *)rf.worldSurfVis, rsh.worldBrushModel->numsurfaces * sizeof( *rf.worldSurfVis ) );
+				rf.worldSurfFullVis = (std::atomic<uint8_t> *)Q_realloc( (void *)rf.worldSurfFullVis, rsh.worldBrushModel->numsurfaces * sizeof( *rf.worldSurfVis ) );
 			}
 			rf.numWorldSurfVis = rsh.worldBrushModel->numsurfaces;
 
@@ -873,9 +874,11 @@ static void R_SetupFrame( void ) {
 			rf.numWorldLeafVis = rsh.worldBrushModel->numvisleafs;
 
 			if( !rf.numWorldDrawSurfVis ) {
-				rf.worldDrawSurfVis = (unsigned char *)Q_malloc( rsh.worldBrushModel->numDrawSurfaces * sizeof( *rf.worldDrawSurfVis ) );
+				rf.worldDrawSurfVis = (std::atomic<uint8_t> *)Q_malloc( rsh.worldBrushModel->numDrawSurfaces * sizeof( *rf.worldDrawSurfVis ) );
+				rf.worldDrawSurfsPrepared = (preparedWorldDrawSurf_t *)Q_malloc( rsh.worldBrushModel->numDrawSurfaces * sizeof( *rf.worldDrawSurfsPrepared ) );
 			} else if( rf.numWorldDrawSurfVis < rsh.worldBrushModel->numDrawSurfaces ) {
-				rf.worldDrawSurfVis = (unsigned char *)Q_realloc( (void *)rf.worldDrawSurfVis, rsh.worldBrushModel->numDrawSurfaces * sizeof( *rf.worldDrawSurfVis ) );
+				rf.worldDrawSurfVis = (std::atomic<uint8_t> *)Q_realloc( (void *)rf.worldDrawSurfVis, rsh.worldBrushModel->numDrawSurfaces * sizeof( *rf.worldDrawSurfVis ) );
+				rf.worldDrawSurfsPrepared = (preparedWorldDrawSurf_t *)Q_realloc( rf.worldDrawSurfsPrepared, rsh.worldBrushModel->numDrawSurfaces * sizeof( *rf.worldDrawSurfsPrepared ) );
 			}
 			rf.numWorldDrawSurfVis = rsh.worldBrushModel->numDrawSurfaces;
 
@@ -1007,6 +1010,128 @@ static void R_EndGL( void ) {
 	}
 }
 
+static modelCullInfo_t r_entityCullInfo[MAX_REF_ENTITIES];
+
+/*
+* R_CullModelEntities
+*
+* Selects LODs and culls alias and skeletal models of entities in the given range
+*/
+static void R_CullModelEntities( unsigned first, unsigned count ) {
+	unsigned int i;
+	const entity_t *e;
+	modelCullInfo_t *info;
+
+	for( i = first; i < first + count; i++ ) {
+		e = R_NUM2ENT( i );
+		info = &r_entityCullInfo[i];
+		info->mod = NULL;
+
+		if( e->rtype != RT_MODEL || !e->model ) {
+			continue;
+		}
+
+		switch( e->model->type ) {
+			case mod_alias:
+				R_CullAliasModel( e, info );
+				break;
+			case mod_skeletal:
+				R_CullSkeletalModel( e, info );
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+/*
+* R_CullEntities
+*/
+static void R_CullEntities( bool useJobs ) {
+	const unsigned numEntities = rsc.numEntities - rsc.numLocalEntities;
+
+	// culling does not modify shared data, entities are added to the draw list in their order later
+	if( useJobs ) {
+		rf.jobPool->run( numEntities, 32, []( unsigned first, unsigned count, unsigned ) {
+			R_CullModelEntities( rsc.numLocalEntities + first, count );
+		});
+	} else {
+		R_CullModelEntities( rsc.numLocalEntities, numEntities );
+	}
+}
+
+/*
+* R_BenchmarkFrontend
+*
+* Runs world and entity culling of the current view serially and on the job pool.
+* It does not touch GL, so timings do not include waiting for the driver.
+*/
+static void R_BenchmarkFrontend( int numRuns ) {
+	const unsigned clipFlags = r_nocull->integer ? 0 : rn.clipFlags;
+	const unsigned numSurfaces = rsh.worldBrushModel->numsurfaces;
+	const unsigned numDrawSurfaces = rsh.worldBrushModel->numDrawSurfaces;
+	const unsigned numEntities = rsc.numEntities - rsc.numLocalEntities;
+	uint64_t worldTime[2], entitiesTime[2];
+	uint8_t *serialVis;
+	modelCullInfo_t *serialCullInfo;
+	bool match = true;
+	unsigned i;
+	int mode, run;
+
+	serialVis = (uint8_t *)Q_malloc( numSurfaces + numDrawSurfaces );
+	serialCullInfo = (modelCullInfo_t *)Q_malloc( numEntities * sizeof( *serialCullInfo ) + 1 );
+
+	for( mode = 0; mode < 2; mode++ ) {
+		const bool useJobs = mode != 0;
+
+		uint64_t startTime = Sys_Microseconds();
+		for( run = 0; run < numRuns; run++ ) {
+			R_CullWorldLeaves( clipFlags, useJobs );
+			R_CullWorldSurfaces( clipFlags, useJobs );
+		}
+		worldTime[mode] = Sys_Microseconds() - startTime;
+
+		startTime = Sys_Microseconds();
+		for( run = 0; run < numRuns; run++ ) {
+			R_CullEntities( useJobs );
+		}
+		entitiesTime[mode] = Sys_Microseconds() - startTime;
+
+		for( i = 0; i < numSurfaces; i++ ) {
+			const uint8_t vis = rf.worldSurfVis[i].load( std::memory_order_relaxed );
+			match &= !useJobs || serialVis[i] == vis;
+			serialVis[i] = vis;
+		}
+		for( i = 0; i < numDrawSurfaces; i++ ) {
+			const uint8_t vis = rf.worldDrawSurfVis[i].load( std::memory_order_relaxed );
+			match &= !useJobs || serialVis[numSurfaces + i] == vis;
+			serialVis[numSurfaces + i] = vis;
+		}
+		for( i = 0; i < numEntities; i++ ) {
+			const modelCullInfo_t *info = &r_entityCullInfo[rsc.numLocalEntities + i];
+			if( useJobs ) {
+				const modelCullInfo_t *serialInfo = &serialCullInfo[i];
+				match &= info->mod == serialInfo->mod && info->clipped == serialInfo->clipped;
+				match &= VectorCompare( info->mins, serialInfo->mins ) && VectorCompare( info->maxs, serialInfo->maxs );
+			}
+			serialCullInfo[i] = *info;
+		}
+	}
+
+	Com_Printf( "Frontend culling of %u surfaces and %u entities, %d runs, %u threads\n",
+				numSurfaces, numEntities, numRuns, rf.jobPool->numThreads() );
+	Com_Printf( "World: %.3f ms serial, %.3f ms on jobs\n",
+				worldTime[0] * 1e-3 / numRuns, worldTime[1] * 1e-3 / numRuns );
+	Com_Printf( "Entities: %.3f ms serial, %.3f ms on jobs\n",
+				entitiesTime[0] * 1e-3 / numRuns, entitiesTime[1] * 1e-3 / numRuns );
+	if( !match ) {
+		Com_Printf( S_COLOR_YELLOW "Serial and parallel culling results differ\n" );
+	}
+
+	Q_free( serialCullInfo );
+	Q_free( serialVis );
+}
+
 /*
 * R_DrawEntities
 */
@@ -1027,13 +1152,17 @@ static void R_DrawEntities( void ) {
 		return;
 	}
 
+	if( !r_lerpmodels->integer ) {
+		for( i = rsc.numLocalEntities; i < rsc.numEntities; i++ ) {
+			R_NUM2ENT( i )->backlerp = 0;
+		}
+	}
+
+	R_CullEntities( r_frontend_jobs->integer != 0 );
+
 	for( i = rsc.numLocalEntities; i < rsc.numEntities; i++ ) {
 		e = R_NUM2ENT( i );
 
-		if( !r_lerpmodels->integer ) {
-			e->backlerp = 0;
-		}
-
 		switch( e->rtype ) {
 			case RT_MODEL:
 				if( !e->model ) {
@@ -1043,10 +1172,10 @@ static void R_DrawEntities( void ) {
 
 				switch( e->model->type ) {
 					case mod_alias:
-						R_AddAliasModelToDrawList( e );
+						R_AddAliasModelToDrawList( e, &r_entityCullInfo[i] );
 						break;
 					case mod_skeletal:
-						R_AddSkeletalModelToDrawList( e );
+						R_AddSkeletalModelToDrawList( e, &r_entityCullInfo[i] );
 						break;
 					case mod_brush:
 						e->outlineHeight = rsc.worldent->outlineHeight;
@@ -1063,6 +1192,8 @@ static void R_DrawEntities( void ) {
 				break;
 		}
 	}
+
+	R_UpdateSkeletalCache();
 }
 
 //=======================================================================
@@ -1124,6 +1255,12 @@ void R_RenderView( const refdef_t *fd ) {
 
 	R_SetupFrustum( &rn.refdef, rn.farClip, rn.frustum );
 
+	if( rf.numFrontendBenchmarkRuns && !( rn.renderFlags & RF_NONVIEWERREF ) && rsh.worldModel &&
+		!( rn.refdef.rdflags & RDF_NOWORLDMODEL ) ) {
+		R_BenchmarkFrontend( rf.numFrontendBenchmarkRuns );
+		rf.numFrontendBenchmarkRuns = 0;
+	}
+
 	// we know the initial farclip at this point after determining visible world leafs
 	// R_DrawEntities can make adjustments as well
 
@@ -23,6 +23,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "../qcommon/hash.h"
 #include "../qcommon/qcommon.h"
 #include "materiallocal.h"
+#include "../qcommon/wswjobpool.h"
 
 #include <algorithm>
 
@@ -105,6 +106,7 @@ cvar_t *r_gamma;
 cvar_t *r_texturemode;
 cvar_t *r_texturefilter;
 cvar_t *r_texturecompression;
+cvar_t *r_imagecache;
 cvar_t *r_picmip;
 cvar_t *r_skymip;
 cvar_t *r_nobind;
@@ -129,6 +131,7 @@ cvar_t *r_maxglslbones;
 cvar_t *gl_driver;
 cvar_t *gl_cull;
 cvar_t *r_multithreading;
+cvar_t *r_frontend_jobs;
 
 cvar_t *r_showShaderCache;
 
@@ -578,6 +581,7 @@ static void R_Register( const char *screenshotsPrefix ) {
 	r_texturemode = Cvar_Get( "r_texturemode", "GL_LINEAR_MIPMAP_LINEAR", CVAR_ARCHIVE );
 	r_texturefilter = Cvar_Get( "r_texturefilter", "4", CVAR_ARCHIVE );
 	r_texturecompression = Cvar_Get( "r_texturecompression", "0", CVAR_ARCHIVE | CVAR_LATCH_VIDEO );
+	r_imagecache = Cvar_Get( "r_imagecache", "1", CVAR_ARCHIVE );
 	r_stencilbits = Cvar_Get( "r_stencilbits", "0", CVAR_ARCHIVE | CVAR_LATCH_VIDEO );
 
 	r_screenshot_jpeg = Cvar_Get( "r_screenshot_jpeg", "1", CVAR_ARCHIVE );
@@ -606,6 +610,7 @@ static void R_Register( const char *screenshotsPrefix ) {
 	r_maxglslbones = Cvar_Get( "r_maxglslbones", STR_TOSTR( MAX_GLSL_UNIFORM_BONES ), CVAR_LATCH_VIDEO );
 
 	r_multithreading = Cvar_Get( "r_multithreading", "0", CVAR_ARCHIVE | CVAR_LATCH_VIDEO );
+	r_frontend_jobs = Cvar_Get( "r_frontend_jobs", "1", CVAR_ARCHIVE );
 
 	r_showShaderCache = Cvar_Get( "r_showShaderCache", "1", CVAR_ARCHIVE );
 
@@ -619,6 +624,7 @@ static void R_Register( const char *screenshotsPrefix ) {
 	}
 
 	Cmd_AddCommand( "screenshot", R_ScreenShot_f );
+	Cmd_AddCommand( "r_benchfrontend", R_BenchmarkFrontend_f );
 }
 
 static void R_PrintInfo() {
@@ -820,6 +826,8 @@ static rserr_t R_PostInit( void ) {
 	rf.swapInterval = -1;
 	rf.speedsMsgLock = QMutex_Create();
 	rf.debugSurfaceLock = QMutex_Create();
+	// leave cores for the backend, the sound and the server
+	rf.jobPool = new wsw::JobPool( 4 );
 
 	R_InitDrawLists();
 
@@ -939,6 +947,9 @@ void R_BeginRegistration( void ) {
 	}
 	rsh.registrationOpen = true;
 
+	// A map loading could have been interrupted by an error
+	R_CancelDeferredImageLoading();
+
 	R_InitVolatileAssets();
 
 	R_DeferDataSync();
@@ -956,6 +967,10 @@ void R_EndRegistration( void ) {
 
 	rsh.registrationOpen = false;
 
+	// Stop deferring images that are found after the registration, and load placeholders
+	// that are still pending before unused images get freed
+	R_CancelDeferredImageLoading();
+
 	R_FreeUnusedModels();
 	R_FreeUnusedVBOs();
 	R_FreeUnusedSkinFiles();
@@ -974,6 +989,7 @@ void R_EndRegistration( void ) {
 */
 void R_Shutdown( bool verbose ) {
 	Cmd_RemoveCommand( "screenshot" );
+	Cmd_RemoveCommand( "r_benchfrontend" );
 
 	// free shaders, models, etc.
 
@@ -1002,6 +1018,9 @@ void R_Shutdown( bool verbose ) {
 	QMutex_Destroy( &rf.speedsMsgLock );
 	QMutex_Destroy( &rf.debugSurfaceLock );
 
+	delete rf.jobPool;
+	rf.jobPool = NULL;
+
 	// shut down OS specific OpenGL stuff like contexts, etc.
 	GLimp_Shutdown();
 
@@ -23,6 +23,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "local.h"
 #include "iqm.h"
 #include "../qcommon/qcommon.h"
+#include "../qcommon/wswjobpool.h"
+#include "../qcommon/wswskeletalposes.h"
 
 #include <algorithm>
 
@@ -944,6 +946,12 @@ typedef struct skmcacheentry_s {
 static skmcacheentry_t *r_skmcache_head;    // actual entries are linked to this
 static skmcacheentry_t *r_skmcache_free;    // actual entries are linked to this
 static skmcacheentry_t *r_skmcachekeys[MAX_REF_ENTITIES * ( MOD_MAX_LODS + 1 )];      // entities linked to cache entries
+static skmcacheentry_t *r_skmcachepending[MAX_REF_ENTITIES * ( MOD_MAX_LODS + 1 )];   // entries that wait for bone transforms
+static unsigned r_skmcachenumpending;
+static wsw::SkeletalPoseBatch r_skmcachebatches[MAX_REF_ENTITIES * ( MOD_MAX_LODS + 1 )];
+static const mskmodel_t *r_skmcachebatchmodels[MAX_REF_ENTITIES * ( MOD_MAX_LODS + 1 )];
+static float *r_skmcachescratch;     // intermediate poses of bones, a separate chunk for every thread
+static size_t r_skmcachescratchsize;
 
 #define R_SKMCacheAlloc( size ) Q_malloc( r_skmcachepool, ( size ), 16, 1 )
 
@@ -953,6 +961,7 @@ static skmcacheentry_t *r_skmcachekeys[MAX_REF_ENTITIES * ( MOD_MAX_LODS + 1 )];
 void R_InitSkeletalCache( void ) {
 	r_skmcache_head = NULL;
 	r_skmcache_free = NULL;
+	r_skmcachenumpending = 0;
 }
 
 /*
@@ -1062,6 +1071,7 @@ void R_ClearSkeletalCache( void ) {
 		cache = next;
 	}
 	r_skmcache_head = NULL;
+	r_skmcachenumpending = 0;
 
 	memset( r_skmcachekeys, 0, sizeof( r_skmcachekeys ) );
 }
@@ -1072,78 +1082,31 @@ void R_ClearSkeletalCache( void ) {
 void R_ShutdownSkeletalCache( void ) {
 	r_skmcache_head = NULL;
 	r_skmcache_free = NULL;
-}
-
-static void R_CacheBoneTransforms( skmcacheentry_t *cache ) {
-	unsigned i, j;
-	const entity_t *e;
-	float frontlerp;
-	bonepose_t tempbonepose[256];
-	const bonepose_t *bp, *oldbp, *bonepose, *oldbonepose, *lerpedbonepose;
-	bonepose_t *out, tp;
-	mskbone_t *bone;
-	const mskmodel_t *skmodel;
-	dualquat_t *bonePoseRelativeDQ;
 
-	e = R_NUM2ENT( cache->entNum );
-	skmodel = cache->skmodel;
-	bp = cache->boneposes;
-	oldbp = cache->oldboneposes;
-	frontlerp = 1.0 - e->backlerp;
-
-	// lerp boneposes and store results in cache
-
-	lerpedbonepose = tempbonepose;
-	if( bp == oldbp || frontlerp == 1 ) {
-		if( e->boneposes ) {
-			// assume that parent transforms have already been applied
-			lerpedbonepose = bp;
-		} else {
-			for( i = 0; i < skmodel->numbones; i++ ) {
-				j = i;
-				out = tempbonepose + j;
-				bonepose = bp + j;
-				bone = skmodel->bones + j;
-
-				if( bone->parent >= 0 ) {
-					DualQuat_Multiply( tempbonepose[bone->parent].dualquat, bonepose->dualquat, out->dualquat );
-				} else {
-					DualQuat_Copy( bonepose->dualquat, out->dualquat );
-				}
-			}
-		}
-	} else {
-		if( e->boneposes ) {
-			// lerp, assume that parent transforms have already been applied
-			for( i = 0, out = tempbonepose, bonepose = bp, oldbonepose = oldbp, bone = skmodel->bones; i < skmodel->numbones; i++, out++, bonepose++, oldbonepose++, bone++ ) {
-				DualQuat_Lerp( oldbonepose->dualquat, bonepose->dualquat, frontlerp, out->dualquat );
-			}
-		} else {
-			// lerp and transform
-			for( i = 0; i < skmodel->numbones; i++ ) {
-				j = i;
-				out = tempbonepose + j;
-				bonepose = bp + j;
-				oldbonepose = oldbp + j;
-				bone = skmodel->bones + j;
-
-				DualQuat_Lerp( oldbonepose->dualquat, bonepose->dualquat, frontlerp, out->dualquat );
-
-				if( bone->parent >= 0 ) {
-					DualQuat_Copy( out->dualquat, tp.dualquat );
-					DualQuat_Multiply( tempbonepose[bone->parent].dualquat, tp.dualquat, out->dualquat );
-				}
-			}
-		}
-	}
-
-	bonePoseRelativeDQ = ( dualquat_t * )cache->data;
+	Q_TagFree( r_skmcachescratch );
+	r_skmcachescratch = NULL;
+	r_skmcachescratchsize = 0;
+}
 
-	// generate dual quaternions for all bones
-	for( i = 0; i < skmodel->numbones; i++ ) {
-		DualQuat_Multiply( lerpedbonepose[i].dualquat, skmodel->invbaseposes[i].dualquat, bonePoseRelativeDQ[i] );
-		DualQuat_Normalize( bonePoseRelativeDQ[i] );
-	}
+/*
+* R_AddSkeletalCacheToBatch
+*
+* Lerps boneposes of the frames the cache entry has been set up for,
+* applies parent transforms unless the entity has its own boneposes with transforms applied already,
+* and stores dual quaternions relative to the base pose in the cache
+*/
+static void R_AddSkeletalCacheToBatch( const skmcacheentry_t *cache, wsw::SkeletalPoseBatch *batch ) {
+	wsw::SkeletalPoseBatch::Lane lane;
+	const entity_t *e = R_NUM2ENT( cache->entNum );
+
+	lane.frontLerp = 1.0 - e->backlerp;
+	lane.frame = cache->boneposes->dualquat;
+	lane.oldFrame = cache->oldboneposes->dualquat;
+	lane.lerp = !( cache->boneposes == cache->oldboneposes || lane.frontLerp == 1 );
+	lane.parentsApplied = e->boneposes != NULL;
+	lane.out = ( float * )cache->data;
+
+	batch->add( lane );
 }
 
 //=======================================================================
@@ -1342,34 +1305,109 @@ static void R_AddSkeletalModelCache( const entity_t *e, const model_t *mod ) {
 		return;
 	}
 
-	R_CacheBoneTransforms( cache );
+	r_skmcachepending[r_skmcachenumpending++] = cache;
+}
+
+/*
+* R_UpdateSkeletalCache
+*
+* Computes bone transforms of cache entries that have been added since the last call.
+* Entries of the same model are grouped in batches that are computed 4 entries at once,
+* batches are independent, so they are computed in parallel.
+*/
+void R_UpdateSkeletalCache( void ) {
+	unsigned i, numBatches, maxBones, numThreads;
+	size_t scratchSize;
+
+	if( !r_skmcachenumpending ) {
+		return;
+	}
+
+	std::sort( r_skmcachepending, r_skmcachepending + r_skmcachenumpending, []( const skmcacheentry_t *lhs, const skmcacheentry_t *rhs ) {
+		return std::less<const mskmodel_t *>()( lhs->skmodel, rhs->skmodel );
+	});
+
+	numBatches = 0;
+	maxBones = 0;
+	for( i = 0; i < r_skmcachenumpending; i++ ) {
+		const skmcacheentry_t *cache = r_skmcachepending[i];
+		if( !numBatches || r_skmcachebatchmodels[numBatches - 1] != cache->skmodel || r_skmcachebatches[numBatches - 1].full() ) {
+			r_skmcachebatches[numBatches].clear();
+			r_skmcachebatchmodels[numBatches] = cache->skmodel;
+			numBatches++;
+		}
+		R_AddSkeletalCacheToBatch( cache, &r_skmcachebatches[numBatches - 1] );
+		maxBones = std::max( maxBones, cache->skmodel->numbones );
+	}
+
+	numThreads = r_frontend_jobs->integer ? rf.jobPool->numThreads() : 1;
+	// SIMD code stores 4-wide vectors to the scratch, keep chunks of all threads aligned on 16 bytes
+	scratchSize = (size_t)maxBones * wsw::SkeletalPoseBatch::kScratchFloatsPerBone;
+	scratchSize = ( scratchSize + 3 ) & ~(size_t)3;
+	if( r_skmcachescratchsize < numThreads * scratchSize ) {
+		Q_TagFree( r_skmcachescratch );
+		r_skmcachescratchsize = numThreads * scratchSize;
+		r_skmcachescratch = ( float * )Q_TagMallocAligned( r_skmcachescratchsize * sizeof( float ), 16, MEMTAG_RENDERER );
+	}
+
+	auto computeBatches = [=]( unsigned first, unsigned count, unsigned threadNum ) {
+		float *scratch = r_skmcachescratch + threadNum * scratchSize;
+		for( unsigned j = first; j < first + count; j++ ) {
+			const mskmodel_t *skmodel = r_skmcachebatchmodels[j];
+			r_skmcachebatches[j].compute( [=]( unsigned bone ) { return skmodel->bones[bone].parent; },
+										  skmodel->invbaseposes->dualquat, skmodel->numbones, scratch );
+		}
+	};
+
+	if( r_frontend_jobs->integer ) {
+		rf.jobPool->run( numBatches, 2, computeBatches );
+	} else {
+		computeBatches( 0, numBatches, 0 );
+	}
+
+	r_skmcachenumpending = 0;
+}
+
+/*
+* R_CullSkeletalModel
+*
+* Selects a LOD of the model and culls it. Does not modify shared data, so entities can be culled in parallel.
+*/
+void R_CullSkeletalModel( const entity_t *e, modelCullInfo_t *info ) {
+	const model_t *mod;
+	const mskmodel_t *skmodel;
+
+	info->mod = NULL;
+
+	mod = R_SkeletalModelLOD( e );
+	if( !( skmodel = ( ( mskmodel_t * )mod->extradata ) ) || !skmodel->nummeshes ) {
+		return;
+	}
+
+	info->mod = mod;
+	info->radius = R_SkeletalModelLerpBBox( e, mod, info->mins, info->maxs );
+	info->clipped = R_CullModelEntity( e, info->mins, info->maxs, info->radius, true, true );
 }
 
 /*
 * R_AddSkeletalModelToDrawList
 */
-bool R_AddSkeletalModelToDrawList( const entity_t *e ) {
+bool R_AddSkeletalModelToDrawList( const entity_t *e, const modelCullInfo_t *info ) {
 	int i;
 	const mfog_t *fog;
 	const model_t *mod;
 	const shader_t *shader;
 	const mskmesh_t *mesh;
 	const mskmodel_t *skmodel;
-	vec3_t mins, maxs;
 	float radius;
 	float distance;
-	int clipped;
 
-	mod = R_SkeletalModelLOD( e );
-	if( !( skmodel = ( ( mskmodel_t * )mod->extradata ) ) || !skmodel->nummeshes ) {
+	if( !( mod = info->mod ) || info->clipped ) {
 		return false;
 	}
 
-	radius = R_SkeletalModelLerpBBox( e, mod, mins, maxs );
-	clipped = R_CullModelEntity( e, mins, maxs, radius, true, true );
-	if( clipped ) {
-		return false;
-	}
+	skmodel = ( const mskmodel_t * )mod->extradata;
+	radius = info->radius;
 
 	// never render weapon models or non-occluders into shadowmaps
 	if( rn.renderFlags & RF_SHADOWMAPVIEW ) {
@@ -1395,7 +1433,7 @@ bool R_AddSkeletalModelToDrawList( const entity_t *e ) {
 	}
 #endif
 
-	// run quaternions lerping job in the background
+	// bones get transformed in parallel by R_UpdateSkeletalCache
 	R_AddSkeletalModelCache( e, mod );
 
 	for( i = 0, mesh = skmodel->meshes; i < (int)skmodel->nummeshes; i++, mesh++ ) {
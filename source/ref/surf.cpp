@@ -22,6 +22,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 #include "local.h"
 #include "../qcommon/qcommon.h"
+#include "../qcommon/wswfrustumculler.h"
+#include "../qcommon/wswjobpool.h"
 #include <algorithm>
 
 #define WORLDSURF_DIST 1024.0f                  // hack the draw order for world surfaces
@@ -306,8 +308,9 @@ static bool R_ClipSpecialWorldSurf( drawSurfaceBSP_t *drawSurf, const msurface_t
 *
 * Walk the list of visible world surfaces and prepare the final VBO slice and draw order bits.
 * For sky surfaces, skybox clipping is also performed.
+* The listSurf is either the drawSurf->listSurf or a prepared entry that is not in the list yet.
 */
-static void R_UpdateSurfaceInDrawList( drawSurfaceBSP_t *drawSurf, unsigned int dlightBits, const vec3_t origin ) {
+static void R_UpdateSurfaceInDrawList( drawSurfaceBSP_t *drawSurf, void *listSurf, unsigned int dlightBits, const vec3_t origin ) {
 	unsigned i, end;
 	float dist = 0;
 	bool special;
@@ -316,7 +319,7 @@ static void R_UpdateSurfaceInDrawList( drawSurfaceBSP_t *drawSurf, unsigned int
 	unsigned curDlightBits;
 	msurface_t *firstVisSurf, *lastVisSurf;
 
-	if( !drawSurf->listSurf ) {
+	if( !listSurf ) {
 		return;
 	}
 
@@ -330,7 +333,7 @@ static void R_UpdateSurfaceInDrawList( drawSurfaceBSP_t *drawSurf, unsigned int
 	special = ( drawSurf->shader->flags & (SHADER_SKY|SHADER_PORTAL) ) != 0;
 
 	for( i = drawSurf->firstWorldSurface; i < end; i++ ) {
-		if( rf.worldSurfVis[i] ) {
+		if( rf.worldSurfVis[i].load( std::memory_order_relaxed ) ) {
 			float sdist = 0;
 			unsigned int checkDlightBits = dlightBits & ~curDlightBits;
 
@@ -384,7 +387,7 @@ static void R_UpdateSurfaceInDrawList( drawSurfaceBSP_t *drawSurf, unsigned int
 			int drawOrder = R_PackOpaqueOrder( drawSurf->fog, drawSurf->shader, drawSurf->numLightmaps, dlight );
 			if( dist == 0 )
 				dist = WORLDSURF_DIST;
-			R_UpdateDrawSurfDistKey( drawSurf->listSurf, 0, drawSurf->shader, dist, drawOrder );
+			R_UpdateDrawSurfDistKey( listSurf, 0, drawSurf->shader, dist, drawOrder );
 		}
 	}
 }
@@ -493,18 +496,18 @@ bool R_AddBrushModelToDrawList( const entity_t *e ) {
 			continue;
 		}
 
-		rf.worldSurfVis[s] = 1;
-		rf.worldDrawSurfVis[surf->drawSurf - 1] = 1;
+		rf.worldSurfVis[s].store( 1, std::memory_order_relaxed );
+		rf.worldDrawSurfVis[surf->drawSurf - 1].store( 1, std::memory_order_relaxed );
 	}
 
 	for( i = 0; i < bmodel->numModelDrawSurfaces; i++ ) {
 		unsigned s = bmodel->firstModelDrawSurface + i;
 		drawSurfaceBSP_t *drawSurf = rsh.worldBrushModel->drawSurfaces + s;
 
-		if( rf.worldDrawSurfVis[s] ) {
+		if( rf.worldDrawSurfVis[s].load( std::memory_order_relaxed ) ) {
 			R_AddSurfaceToDrawList( e, drawSurf );
 
-			R_UpdateSurfaceInDrawList( drawSurf, dlightBits, origin );
+			R_UpdateSurfaceInDrawList( drawSurf, drawSurf->listSurf, dlightBits, origin );
 		}
 	}
 
@@ -543,26 +546,45 @@ static void R_PostCullVisLeaves( void ) {
 	}
 }
 
+/*
+* R_SetupFrustumCuller
+*/
+static void R_SetupFrustumCuller( wsw::FrustumCuller *culler, unsigned clipFlags ) {
+	unsigned i;
+
+	culler->clear();
+	for( i = 0; i < sizeof( rn.frustum ) / sizeof( rn.frustum[0] ); i++ ) {
+		if( clipFlags & ( 1 << i ) ) {
+			culler->addPlane( rn.frustum[i].normal, rn.frustum[i].dist );
+		}
+	}
+}
+
 /*
 * R_CullVisLeaves
+*
+* Leaves are tested in groups of 4 using bounds, clusters and areas stored in arrays at load time
 */
 static void R_CullVisLeaves( unsigned firstLeaf, unsigned numLeaves, unsigned clipFlags ) {
-	unsigned i, j;
+	unsigned i, j, lane;
+	unsigned end;
 	mleaf_t *leaf;
 	uint8_t *pvs;
 	uint8_t *areabits;
 	int arearowbytes, areabytes;
 	bool novis;
+	wsw::FrustumCuller culler;
+	const mbrushmodel_t *bmodel = rsh.worldBrushModel;
 
 	if( rn.renderFlags & RF_SHADOWMAPVIEW ) {
 		return;
 	}
 
-	novis = rn.renderFlags & RF_NOVIS || rf.viewcluster == -1 || !rsh.worldBrushModel->pvs;
-	arearowbytes = ( ( rsh.worldBrushModel->numareas + 7 ) / 8 );
+	novis = rn.renderFlags & RF_NOVIS || rf.viewcluster == -1 || !bmodel->pvs;
+	arearowbytes = ( ( bmodel->numareas + 7 ) / 8 );
 	areabytes = arearowbytes;
 #ifdef AREAPORTALS_MATRIX
-	areabytes *= rsh.worldBrushModel->numareas;
+	areabytes *= bmodel->numareas;
 #endif
 
 	pvs = Mod_ClusterPVS( rf.viewcluster, rsh.worldModel );
@@ -576,96 +598,124 @@ static void R_CullVisLeaves( unsigned firstLeaf, unsigned numLeaves, unsigned cl
 		areabits = NULL;
 	}
 
-	for( i = 0; i < numLeaves; i++ ) {
-		int clipped;
-		unsigned bit, testFlags;
-		cplane_t *clipplane;
-		unsigned l = firstLeaf + i;
+	R_SetupFrustumCuller( &culler, clipFlags );
+
+	end = firstLeaf + numLeaves;
+	for( i = firstLeaf; i < end; i += 4 ) {
+		unsigned visMask = ( 1u << std::min( 4u, end - i ) ) - 1;
+		unsigned culledMask = 0, partialMask = 0;
 
-		leaf = rsh.worldBrushModel->visleafs[l];
 		if( !novis ) {
-			// check for door connected areas
-			if( areabits ) {
-				if( leaf->area < 0 || !( areabits[leaf->area >> 3] & ( 1 << ( leaf->area & 7 ) ) ) ) {
-					continue; // not visible
+			for( lane = 0; lane < 4; lane++ ) {
+				const int area = bmodel->visLeafAreas[i + lane];
+				const int cluster = bmodel->visLeafClusters[i + lane];
+
+				// check for door connected areas
+				if( areabits ) {
+					if( area < 0 || !( areabits[area >> 3] & ( 1 << ( area & 7 ) ) ) ) {
+						visMask &= ~( 1u << lane );
+						continue;
+					}
 				}
-			}
 
-			if( !( pvs[leaf->cluster >> 3] & ( 1 << ( leaf->cluster & 7 ) ) ) ) {
-				continue; // not visible
+				if( !( pvs[cluster >> 3] & ( 1 << ( cluster & 7 ) ) ) ) {
+					visMask &= ~( 1u << lane );
+				}
 			}
 		}
 
-		// track leaves, which are entirely inside the frustum
-		clipped = 0;
-		testFlags = clipFlags;
-		for( j = sizeof( rn.frustum ) / sizeof( rn.frustum[0] ), bit = 1, clipplane = rn.frustum; j > 0; j--, bit <<= 1, clipplane++ ) {
-			if( testFlags & bit ) {
-				clipped = BoxOnPlaneSide( leaf->mins, leaf->maxs, clipplane );
-				if( clipped == 2 ) {
-					break;
-				} else if( clipped == 1 ) {
-					testFlags &= ~bit; // node is entirely on screen
-				}
-			}
+		if( !visMask ) {
+			continue;
 		}
 
-		if( clipped == 2 ) {
-			continue; // fully clipped
+		// track leaves, which are entirely inside the frustum
+		if( culler.size() ) {
+			culler.classify4( bmodel->visLeafMins, bmodel->visLeafMaxs, i, &culledMask, &partialMask );
+			visMask &= ~culledMask;
 		}
 
-		if( testFlags == 0 ) {
-			// fully visible
-			for( j = 0; j < leaf->numVisSurfaces; j++ ) {
-				assert( leaf->visSurfaces[j] < rf.numWorldSurfVis );
-				rf.worldSurfFullVis[leaf->visSurfaces[j]] = 1;
+		for( lane = 0; visMask; lane++, visMask >>= 1 ) {
+			unsigned l = i + lane;
+
+			if( !( visMask & 1 ) ) {
+				continue;
 			}
-		} else {
-			// partly visible
-			for( j = 0; j < leaf->numVisSurfaces; j++ ) {
-				assert( leaf->visSurfaces[j] < rf.numWorldSurfVis );
-				rf.worldSurfVis[leaf->visSurfaces[j]] = 1;
+
+			leaf = bmodel->visleafs[l];
+			if( !( partialMask & ( 1u << lane ) ) ) {
+				// fully visible
+				for( j = 0; j < leaf->numVisSurfaces; j++ ) {
+					assert( leaf->visSurfaces[j] < rf.numWorldSurfVis );
+					rf.worldSurfFullVis[leaf->visSurfaces[j]].store( 1, std::memory_order_relaxed );
+				}
+			} else {
+				// partly visible
+				for( j = 0; j < leaf->numVisSurfaces; j++ ) {
+					assert( leaf->visSurfaces[j] < rf.numWorldSurfVis );
+					rf.worldSurfVis[leaf->visSurfaces[j]].store( 1, std::memory_order_relaxed );
+				}
 			}
-		}
 
-		rf.worldLeafVis[l] = 1;
+			rf.worldLeafVis[l] = 1;
+		}
 	}
 }
 
 /*
 * R_CullVisSurfaces
+*
+* Partly visible surfaces are frustum culled in groups of 4 using bounds stored in arrays at load time
 */
 static void R_CullVisSurfaces( unsigned firstSurf, unsigned numSurfs, unsigned clipFlags ) {
-	unsigned i;
+	unsigned i, lane;
 	unsigned end;
 	msurface_t *surf;
-	
-	end = firstSurf + numSurfs;
-	surf = rsh.worldBrushModel->surfaces + firstSurf;
+	wsw::FrustumCuller culler;
+	const mbrushmodel_t *bmodel = rsh.worldBrushModel;
 
-	for( i = firstSurf; i < end; i++ ) {
-		if( rf.worldSurfVis[i] ) {
-			// the surface is at partly visible in at least one leaf, frustum cull it
-			if( R_CullSurface( rsc.worldent, surf, clipFlags ) ) {
-				rf.worldSurfVis[i] = 0;
-			}
-			rf.worldSurfFullVis[i] = 0;
-		}
-		else {
-			if( rf.worldSurfFullVis[i] ) {
-				// a fully visible surface, mark as visible
-				rf.worldSurfVis[i] = 1;
+	R_SetupFrustumCuller( &culler, clipFlags );
+
+	end = firstSurf + numSurfs;
+	for( i = firstSurf; i < end; i += 4 ) {
+		const unsigned numLanes = std::min( 4u, end - i );
+		unsigned partlyVisMask = 0;
+		unsigned culledMask = 0, partialMask = 0;
+
+		for( lane = 0; lane < numLanes; lane++ ) {
+			if( rf.worldSurfVis[i + lane].load( std::memory_order_relaxed ) ) {
+				partlyVisMask |= 1u << lane;
 			}
 		}
 
-		if( rf.worldSurfVis[i] ) {
-			if( !surf->drawSurf )
-				rf.worldSurfVis[i] = 0;
-			else
-				rf.worldDrawSurfVis[surf->drawSurf - 1] = 1;
+		// surfaces that are at partly visible in at least one leaf, frustum cull them
+		if( partlyVisMask && culler.size() ) {
+			culler.classify4( bmodel->surfaceMins, bmodel->surfaceMaxs, i, &culledMask, &partialMask );
 		}
 
-		surf++;
+		for( lane = 0; lane < numLanes; lane++ ) {
+			unsigned s = i + lane;
+
+			if( partlyVisMask & ( 1u << lane ) ) {
+				if( culledMask & ( 1u << lane ) ) {
+					rf.worldSurfVis[s].store( 0, std::memory_order_relaxed );
+				}
+				rf.worldSurfFullVis[s].store( 0, std::memory_order_relaxed );
+			}
+			else {
+				if( rf.worldSurfFullVis[s].load( std::memory_order_relaxed ) ) {
+					// a fully visible surface, mark as visible
+					rf.worldSurfVis[s].store( 1, std::memory_order_relaxed );
+				}
+			}
+
+			if( rf.worldSurfVis[s].load( std::memory_order_relaxed ) ) {
+				surf = bmodel->surfaces + s;
+				if( !surf->drawSurf )
+					rf.worldSurfVis[s].store( 0, std::memory_order_relaxed );
+				else
+					rf.worldDrawSurfVis[surf->drawSurf - 1].store( 1, std::memory_order_relaxed );
+			}
+		}
 	}
 }
 
@@ -679,7 +729,7 @@ static void R_AddVisSurfaces( unsigned dlightBits, unsigned shadowBits ) {
 	for( i = 0; i < rsh.worldBrushModel->numModelDrawSurfaces; i++ ) {
 		drawSurfaceBSP_t *drawSurf = rsh.worldBrushModel->drawSurfaces + i;
 
-		if( !rf.worldDrawSurfVis[i] ) {
+		if( !rf.worldDrawSurfVis[i].load( std::memory_order_relaxed ) ) {
 			continue;
 		}
 
@@ -697,11 +747,145 @@ static void R_AddWorldDrawSurfaces( unsigned firstDrawSurf, unsigned numDrawSurf
 		unsigned s = firstDrawSurf + i;
 		drawSurfaceBSP_t *drawSurf = rsh.worldBrushModel->drawSurfaces + s;
 
-		if( !rf.worldDrawSurfVis[s] ) {
+		if( !rf.worldDrawSurfVis[s].load( std::memory_order_relaxed ) ) {
 			continue;
 		}
 
-		R_UpdateSurfaceInDrawList( drawSurf, rn.dlightBits, NULL );
+		R_UpdateSurfaceInDrawList( drawSurf, drawSurf->listSurf, rn.dlightBits, NULL );
+	}
+}
+
+/*
+* R_PrepareWorldDrawSurfaces
+*
+* Does the work of R_AddSurfaceToDrawList and R_UpdateSurfaceInDrawList for visible draw surfaces of the range,
+* but keeps the results in rf.worldDrawSurfsPrepared instead of the draw list.
+* Sky and portal surfaces register themselves in shared lists, so they are deferred to the calling thread.
+*/
+static void R_PrepareWorldDrawSurfaces( unsigned firstDrawSurf, unsigned numDrawSurfs ) {
+	unsigned i;
+	unsigned drawOrder;
+
+	for( i = firstDrawSurf; i < firstDrawSurf + numDrawSurfs; i++ ) {
+		drawSurfaceBSP_t *drawSurf = rsh.worldBrushModel->drawSurfaces + i;
+		preparedWorldDrawSurf_t *prepared = rf.worldDrawSurfsPrepared + i;
+		const shader_t *shader = drawSurf->shader;
+
+		prepared->sds.drawSurf = NULL;
+		prepared->deferred = false;
+
+		if( !rf.worldDrawSurfVis[i].load( std::memory_order_relaxed ) ) {
+			continue;
+		}
+
+		if( drawSurf->visFrame == rf.frameCount || ( shader->flags & ( SHADER_SKY | SHADER_PORTAL ) ) ) {
+			prepared->sds.drawSurf = ( drawSurfaceType_t * )drawSurf;
+			prepared->deferred = true;
+			continue;
+		}
+
+		drawOrder = R_PackOpaqueOrder( drawSurf->fog, shader, drawSurf->numLightmaps, false );
+
+		drawSurf->dlightBits = 0;
+		drawSurf->visFrame = rf.frameCount;
+		drawSurf->listSurf = NULL;
+		if( !R_PrepareSurfForDrawList( &prepared->sds, rsc.worldent, drawSurf->fog, shader, WORLDSURF_DIST, drawOrder, NULL, drawSurf ) ) {
+			continue;
+		}
+
+		// slices of every draw surface have their own indices, and the list has been reserved by the caller
+		R_AddDrawListVBOSlice( rn.meshlist, i, 0, 0, 0, 0 );
+		R_AddDrawListVBOSlice( rn.meshlist, i + rsh.worldBrushModel->numDrawSurfaces, 0, 0, 0, 0 );
+
+		R_UpdateSurfaceInDrawList( drawSurf, &prepared->sds, rn.dlightBits, NULL );
+	}
+}
+
+/*
+* R_AddPreparedWorldDrawSurfaces
+*
+* Merges prepared ranges in the order of draw surfaces, so the draw list is the same as a serially built one
+*/
+static void R_AddPreparedWorldDrawSurfaces( unsigned numDrawSurfs ) {
+	unsigned i;
+	drawSurfaceBSP_t *drawSurf;
+	const preparedWorldDrawSurf_t *prepared;
+
+	for( i = 0, prepared = rf.worldDrawSurfsPrepared; i < numDrawSurfs; i++, prepared++ ) {
+		drawSurf = ( drawSurfaceBSP_t * )prepared->sds.drawSurf;
+		if( !drawSurf ) {
+			continue;
+		}
+
+		if( prepared->deferred ) {
+			R_AddSurfaceToDrawList( rsc.worldent, drawSurf );
+		} else {
+			drawSurf->listSurf = R_AddPreparedSurfToDrawList( rn.meshlist, &prepared->sds );
+			rf.stats.c_world_draw_surfs++;
+		}
+	}
+
+	for( i = 0, prepared = rf.worldDrawSurfsPrepared; i < numDrawSurfs; i++, prepared++ ) {
+		drawSurf = ( drawSurfaceBSP_t * )prepared->sds.drawSurf;
+		if( drawSurf && prepared->deferred ) {
+			R_UpdateSurfaceInDrawList( drawSurf, drawSurf->listSurf, rn.dlightBits, NULL );
+		}
+	}
+}
+
+/*
+* R_SetVisFlags
+*/
+static void R_SetVisFlags( std::atomic<uint8_t> *flags, unsigned numFlags, uint8_t value ) {
+	unsigned i;
+
+	for( i = 0; i < numFlags; i++ ) {
+		flags[i].store( value, std::memory_order_relaxed );
+	}
+}
+
+/*
+* R_CullWorldLeaves
+*
+* Resets visibility of the world and marks surfaces of visible leaves
+*/
+void R_CullWorldLeaves( unsigned clipFlags, bool useJobs ) {
+	const mbrushmodel_t *bmodel = rsh.worldBrushModel;
+
+	R_SetVisFlags( rf.worldSurfFullVis, bmodel->numsurfaces, 0 );
+	R_SetVisFlags( rf.worldDrawSurfVis, bmodel->numDrawSurfaces, 0 );
+
+	if( bmodel->numvisleafs > bmodel->numsurfaces ) {
+		R_SetVisFlags( rf.worldSurfVis, bmodel->numsurfaces, 1 );
+		memset( (void *)rf.worldLeafVis, 1, bmodel->numvisleafs * sizeof( *rf.worldLeafVis ) );
+		return;
+	}
+
+	R_SetVisFlags( rf.worldSurfVis, bmodel->numsurfaces, 0 );
+	memset( (void *)rf.worldLeafVis, 0, bmodel->numvisleafs * sizeof( *rf.worldLeafVis ) );
+
+	if( useJobs ) {
+		// every range marks only its own leaves, surface flags are shared but only get set to 1
+		rf.jobPool->run( bmodel->numvisleafs, 1024, [=]( unsigned first, unsigned count, unsigned ) {
+			R_CullVisLeaves( first, count, clipFlags );
+		});
+	} else {
+		R_CullVisLeaves( 0, bmodel->numvisleafs, clipFlags );
+	}
+}
+
+/*
+* R_CullWorldSurfaces
+*
+* Frustum culls surfaces of visible leaves and marks visible draw surfaces
+*/
+void R_CullWorldSurfaces( unsigned clipFlags, bool useJobs ) {
+	if( useJobs ) {
+		rf.jobPool->run( rsh.worldBrushModel->numModelSurfaces, 1024, [=]( unsigned first, unsigned count, unsigned ) {
+			R_CullVisSurfaces( first, count, clipFlags );
+		});
+	} else {
+		R_CullVisSurfaces( 0, rsh.worldBrushModel->numModelSurfaces, clipFlags );
 	}
 }
 
@@ -716,6 +900,7 @@ void R_DrawWorld( void ) {
 	unsigned int shadowBits;
 	bool worldOutlines;
 	bool speeds = r_speeds->integer != 0;
+	bool useJobs = r_frontend_jobs->integer != 0;
 
 	assert( rf.numWorldSurfVis >= rsh.worldBrushModel->numsurfaces );
 	assert( rf.numWorldLeafVis >= rsh.worldBrushModel->numvisleafs );
@@ -757,29 +942,17 @@ void R_DrawWorld( void ) {
 		msec = Sys_Milliseconds();
 	}
 
-	if( rsh.worldBrushModel->numvisleafs > rsh.worldBrushModel->numsurfaces ) {
-		memset( (void *)rf.worldSurfVis, 1, rsh.worldBrushModel->numsurfaces * sizeof( *rf.worldSurfVis ) );
-		memset( (void *)rf.worldSurfFullVis, 0, rsh.worldBrushModel->numsurfaces * sizeof( *rf.worldSurfVis ) );
-		memset( (void *)rf.worldLeafVis, 1, rsh.worldBrushModel->numvisleafs * sizeof( *rf.worldLeafVis ) );
-		memset( (void *)rf.worldDrawSurfVis, 0, rsh.worldBrushModel->numDrawSurfaces * sizeof( *rf.worldDrawSurfVis ) );
-	} else {
-		memset( (void *)rf.worldSurfVis, 0, rsh.worldBrushModel->numsurfaces * sizeof( *rf.worldSurfVis ) );
-		memset( (void *)rf.worldSurfFullVis, 0, rsh.worldBrushModel->numsurfaces * sizeof( *rf.worldSurfVis ) );
-		memset( (void *)rf.worldLeafVis, 0, rsh.worldBrushModel->numvisleafs * sizeof( *rf.worldLeafVis ) );
-		memset( (void *)rf.worldDrawSurfVis, 0, rsh.worldBrushModel->numDrawSurfaces * sizeof( *rf.worldDrawSurfVis ) );
-
-		if( r_speeds->integer ) {
-			msec2 = Sys_Milliseconds();
-		}
+	//
+	// cull leafs
+	//
+	if( speeds ) {
+		msec2 = Sys_Milliseconds();
+	}
 
-		//
-		// cull leafs
-		//
-		R_CullVisLeaves( 0, rsh.worldBrushModel->numvisleafs, clipFlags );
+	R_CullWorldLeaves( clipFlags, useJobs );
 
-		if( speeds ) {
-			rf.stats.t_cull_world_nodes += Sys_Milliseconds() - msec2;
-		}
+	if( speeds ) {
+		rf.stats.t_cull_world_nodes += Sys_Milliseconds() - msec2;
 	}
 
 	//
@@ -789,7 +962,7 @@ void R_DrawWorld( void ) {
 		msec2 = Sys_Milliseconds();
 	}
 
-	R_CullVisSurfaces( 0, rsh.worldBrushModel->numModelSurfaces, clipFlags );
+	R_CullWorldSurfaces( clipFlags, useJobs );
 
 	R_PostCullVisLeaves();
 
@@ -803,13 +976,22 @@ void R_DrawWorld( void ) {
 	if( speeds ) {
 		msec2 = Sys_Milliseconds();
 	}
-	R_AddVisSurfaces( dlightBits, shadowBits );
 
-	R_AddWorldDrawSurfaces( 0, rsh.worldBrushModel->numModelDrawSurfaces );
+	if( useJobs ) {
+		R_ReserveDrawListVBOSlices( rn.meshlist, 2 * rsh.worldBrushModel->numDrawSurfaces );
+		rf.jobPool->run( rsh.worldBrushModel->numModelDrawSurfaces, 256, []( unsigned first, unsigned count, unsigned ) {
+			R_PrepareWorldDrawSurfaces( first, count );
+		});
+		R_AddPreparedWorldDrawSurfaces( rsh.worldBrushModel->numModelDrawSurfaces );
+	} else {
+		R_AddVisSurfaces( dlightBits, shadowBits );
+
+		R_AddWorldDrawSurfaces( 0, rsh.worldBrushModel->numModelDrawSurfaces );
+	}
 
 	if( speeds ) {
 		for( i = 0; i < rsh.worldBrushModel->numsurfaces; i++ ) {
-			if( rf.worldSurfVis[i] ) {
+			if( rf.worldSurfVis[i].load( std::memory_order_relaxed ) ) {
 				rf.stats.c_brush_polys++;
 			}
 		}
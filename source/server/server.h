@@ -113,6 +113,7 @@ typedef struct {
 	int clientarea;
 	int numareas;
 	int areabytes;
+	int areabits_size;
 	uint8_t *areabits;                  // portalarea visibility bits
 	int numplayers;
 	int ps_size;
@@ -328,6 +329,8 @@ extern cvar_t *sv_port;
 extern cvar_t *sv_ip6;
 extern cvar_t *sv_port6;
 
+extern cvar_t *sv_nonetwork;    // do not open any sockets
+
 extern cvar_t *sv_tcp;
 
 #ifdef HTTP_SUPPORT
@@ -409,6 +412,8 @@ int SVC_FakeConnect( const char *fakeUserinfo, const char *fakeSocketType, const
 
 void SV_UpdateActivity( void );
 
+void SV_Simulate( int64_t msec );
+
 //
 // sv_oob.c
 //
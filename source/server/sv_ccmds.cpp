@@ -319,6 +319,55 @@ static void SV_CvarCheck_f( void ) {
 	SV_SendServerCommand( client, "cvarinfo \"%s\"", Cmd_Argv( 2 ) );
 }
 
+/*
+* SV_Simulate_f
+* Run the game faster than real time, e.g. for bot testing
+*/
+static void SV_Simulate_f( void ) {
+	client_t *client;
+	int i;
+	float seconds;
+
+	if( Cmd_Argc() < 2 || Cmd_Argc() > 3 ) {
+		Com_Printf( "Usage: simulate <seconds> [random seed]\n" );
+		return;
+	}
+
+	if( !svs.initialized || sv.state != ss_game ) {
+		Com_Printf( "No map is running\n" );
+		return;
+	}
+
+	if( !dedicated->integer ) {
+		Com_Printf( "The simulation is available only on a dedicated server\n" );
+		return;
+	}
+
+	// real clients would time out as the server does not read packets during the simulation
+	for( i = 0, client = svs.clients; i < sv_maxclients->integer; i++, client++ ) {
+		if( client->state == CS_FREE || client->state == CS_ZOMBIE ) {
+			continue;
+		}
+		if( !client->edict || !( client->edict->r.svflags & SVF_FAKECLIENT ) ) {
+			Com_Printf( "Can't simulate while there are connected players\n" );
+			return;
+		}
+	}
+
+	seconds = atof( Cmd_Argv( 1 ) );
+	if( seconds <= 0 ) {
+		Com_Printf( "Invalid number of seconds: %s\n", Cmd_Argv( 1 ) );
+		return;
+	}
+
+	// the game module uses the C library generator too
+	if( Cmd_Argc() == 3 ) {
+		srand( (unsigned)atoi( Cmd_Argv( 2 ) ) );
+	}
+
+	SV_Simulate( (int64_t)( seconds * 1000 ) );
+}
+
 //===========================================================
 
 /*
@@ -344,6 +393,8 @@ void SV_InitOperatorCommands( void ) {
 
 	Cmd_AddCommand( "cvarcheck", SV_CvarCheck_f );
 
+	Cmd_AddCommand( "simulate", SV_Simulate_f );
+
 	Cmd_SetCompletionFunc( "map", SV_MapComplete_f );
 	Cmd_SetCompletionFunc( "devmap", SV_MapComplete_f );
 	Cmd_SetCompletionFunc( "gamemap", SV_MapComplete_f );
@@ -371,4 +422,6 @@ void SV_ShutdownOperatorCommands( void ) {
 	Cmd_RemoveCommand( "purelist" );
 
 	Cmd_RemoveCommand( "cvarcheck" );
+
+	Cmd_RemoveCommand( "simulate" );
 }
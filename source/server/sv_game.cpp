@@ -545,6 +545,7 @@ void SV_InitGameProgs( void ) {
 	import.FS_GetFileList = FS_GetFileList;
 	import.FS_FirstExtension = FS_FirstExtension;
 	import.FS_MoveFile = FS_MoveFile;
+	import.FS_MoveCacheFile = FS_MoveCacheFile;
 	import.FS_FileMTime = FS_BaseFileMTime;
 	import.FS_RemoveDirectory = FS_RemoveDirectory;
 
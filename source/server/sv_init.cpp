@@ -316,7 +316,7 @@ void SV_InitGame( void ) {
 	svs.spawncount = rand();
 	svs.clients = (client_t *)Q_malloc( sizeof( client_t ) * sv_maxclients->integer );
 	svs.client_entities.num_entities = sv_maxclients->integer * UPDATE_BACKUP * MAX_SNAP_ENTITIES;
-	svs.client_entities.entities = (entity_state_t *)Q_malloc( sizeof( entity_state_t ) * svs.client_entities.num_entities );
+	svs.client_entities.entities = (entity_state_t *)Q_TagMalloc( sizeof( entity_state_t ) * svs.client_entities.num_entities, MEMTAG_SNAPSHOTS );
 
 	// init network stuff
 
@@ -330,7 +330,7 @@ void SV_InitGame( void ) {
 		}
 	}
 
-	if( dedicated->integer || sv_maxclients->integer > 1 ) {
+	if( ( dedicated->integer || sv_maxclients->integer > 1 ) && !sv_nonetwork->integer ) {
 		// IPv4
 		NET_StringToAddress( sv_ip->string, &address );
 		NET_SetAddressPort( &address, sv_port->integer );
@@ -355,7 +355,7 @@ void SV_InitGame( void ) {
 	}
 
 #ifdef TCP_ALLOW_CONNECT
-	if( sv_tcp->integer && ( dedicated->integer || sv_maxclients->integer > 1 ) ) {
+	if( sv_tcp->integer && ( dedicated->integer || sv_maxclients->integer > 1 ) && !sv_nonetwork->integer ) {
 		bool err = true;
 
 		if( !NET_OpenSocket( &svs.socket_tcp, SOCKET_TCP, &address, true ) ) {
@@ -392,7 +392,7 @@ void SV_InitGame( void ) {
 	}
 #endif
 
-	if( dedicated->integer && !socket_opened ) {
+	if( dedicated->integer && !socket_opened && !sv_nonetwork->integer ) {
 		Com_Error( ERR_FATAL, "Couldn't open any socket\n" );
 	}
 
@@ -493,7 +493,7 @@ void SV_ShutdownGame( const char *finalmsg, bool reconnect ) {
 	}
 
 	if( svs.client_entities.entities ) {
-		Q_free( svs.client_entities.entities );
+		Q_TagFree( svs.client_entities.entities );
 		memset( &svs.client_entities, 0, sizeof( svs.client_entities ) );
 	}
 
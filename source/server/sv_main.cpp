@@ -32,6 +32,8 @@ cvar_t *sv_port;
 cvar_t *sv_ip6;
 cvar_t *sv_port6;
 
+cvar_t *sv_nonetwork;
+
 cvar_t *sv_enforcetime;
 
 cvar_t *sv_timeout;            // seconds without any message
@@ -500,7 +502,11 @@ static bool SV_RunGameFrame( int msec ) {
 			}
 			opened_sockets[open_ind] = NULL;
 
-			NET_Sleep( sleeptime, opened_sockets );
+			if( open_ind ) {
+				NET_Sleep( sleeptime, opened_sockets );
+			} else {
+				Sys_Sleep( sleeptime );
+			}
 		}
 	}
 
@@ -696,6 +702,70 @@ void SV_Frame( unsigned realmsec, unsigned gamemsec ) {
 	}
 }
 
+/*
+* SV_Simulate
+*
+* Runs game frames back to back as fast as possible instead of waiting for the real time to pass.
+* Network clients are not served, so snapshots go only to the server demo recorder.
+*/
+void SV_Simulate( int64_t msec ) {
+	int64_t simulatedTime = 0, lastReportTime = 0;
+	int64_t numFrames = 0, numSnaps = 0;
+	uint64_t gameMicros = 0, maxGameMicros = 0, snapMicros = 0;
+	const uint64_t startMicros = Sys_Microseconds();
+
+	Com_Printf( "Simulating %.1f seconds of the game time...\n", 0.001 * msec );
+
+	while( simulatedTime < msec && sv.state == ss_game ) {
+		svs.realtime += WORLDFRAMETIME;
+		svs.gametime += WORLDFRAMETIME;
+		simulatedTime += WORLDFRAMETIME;
+
+		SV_CheckLatchedUserinfoChanges();
+
+		const uint64_t frameStartMicros = Sys_Microseconds();
+		ge->RunFrame( WORLDFRAMETIME, svs.gametime );
+		const uint64_t frameMicros = Sys_Microseconds() - frameStartMicros;
+		gameMicros += frameMicros;
+		maxGameMicros = std::max( maxGameMicros, frameMicros );
+		numFrames++;
+
+		if( svs.gametime >= sv.nextSnapTime ) {
+			const uint64_t snapStartMicros = Sys_Microseconds();
+			sv.framenum++;
+			ge->SnapFrame();
+
+			SnapVisTable::Instance()->Clear();
+			SnapShadowTable::Instance()->Clear();
+
+			// this only updates frame counters of fake clients
+			SV_SendClientMessages();
+			SV_Demo_WriteSnap();
+
+			ge->ClearSnap();
+			sv.nextSnapTime = svs.gametime + svc.snapFrameTime;
+			snapMicros += Sys_Microseconds() - snapStartMicros;
+			numSnaps++;
+		}
+
+		if( simulatedTime - lastReportTime >= 60 * 1000 ) {
+			lastReportTime = simulatedTime;
+			Com_Printf( "Simulated %.0f of %.0f seconds\n", 0.001 * simulatedTime, 0.001 * msec );
+		}
+	}
+
+	const uint64_t totalMicros = std::max( (uint64_t)1, Sys_Microseconds() - startMicros );
+	Com_Printf( "Simulated %.1f seconds in %.2f seconds (%.1fx real time)\n", 0.001 * simulatedTime,
+				1e-6 * totalMicros, 1000.0 * simulatedTime / (double)totalMicros );
+	if( numFrames ) {
+		Com_Printf( "Game frames: %" PRIi64 ", avg %.1f us, max %" PRIu64 " us\n", numFrames,
+					(double)gameMicros / (double)numFrames, maxGameMicros );
+	}
+	if( numSnaps ) {
+		Com_Printf( "Snapshots: %" PRIi64 ", avg %.1f us\n", numSnaps, (double)snapMicros / (double)numSnaps );
+	}
+}
+
 //============================================================================
 
 /*
@@ -813,6 +883,9 @@ void SV_Init( void ) {
 	sv_ip6 =            Cvar_Get( "sv_ip6", "::", CVAR_ARCHIVE | CVAR_LATCH );
 	sv_port6 =          Cvar_Get( "sv_port6", va( "%i", PORT_SERVER ), CVAR_ARCHIVE | CVAR_LATCH );
 
+	// a headless server (e.g. for simulations) that can be set only from the command line
+	sv_nonetwork =      Cvar_Get( "sv_nonetwork", "0", CVAR_NOSET );
+
 #ifdef TCP_ALLOW_CONNECT
 	sv_tcp =            Cvar_Get( "sv_tcp", "1", CVAR_SERVERINFO | CVAR_ARCHIVE | CVAR_LATCH );
 #endif
@@ -859,6 +932,11 @@ void SV_Init( void ) {
 		sv_public =     Cvar_Get( "sv_public", "0", CVAR_ARCHIVE );
 	}
 
+	// there are no sockets to send heartbeats from
+	if( sv_nonetwork->integer ) {
+		Cvar_ForceSet( "sv_public", "0" );
+	}
+
 	sv_iplimit = Cvar_Get( "sv_iplimit", "3", CVAR_ARCHIVE );
 
 	sv_lastAutoUpdate = Cvar_Get( "sv_lastAutoUpdate", "0", CVAR_READONLY | CVAR_ARCHIVE );
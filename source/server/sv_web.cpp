@@ -1223,7 +1223,7 @@ void SV_Web_Init( void ) {
 
 	SV_Web_InitConnections();
 
-	if( !sv_http->integer ) {
+	if( !sv_http->integer || sv_nonetwork->integer ) {
 		return;
 	}
 
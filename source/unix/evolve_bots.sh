@@ -0,0 +1,82 @@
+#!/bin/sh
+
+# Runs several headless bot-only servers in parallel to evolve AI weight configs.
+# Workers do not open any sockets and run matches via the "simulate" command as fast as possible.
+# Every worker plays the same map over and over
+# and saves a winning mutated weight config to the shared ai/<gametype>_<map>.weights file.
+# Workers pick up improvements of each other on next match start.
+#
+# Usage: evolve_bots.sh <map> [gametype] [number of workers] [number of bots] [extra server args...]
+
+#### Config
+
+# Location of Warsow binaries?
+# Leave empty to use the directory of this script
+
+BINARY_DIR=
+
+# A name of the dedicated server executable (without an architecture suffix)
+
+SERVER_NAME=wsw_server
+
+# A game time in seconds that is simulated by every worker before it quits
+
+SIMULATED_SECONDS=86400
+
+##### Code
+
+if [ "X$1" = "X" ]; then
+	echo "Usage: `basename \"${0}\"` <map> [gametype] [number of workers] [number of bots] [extra server args...]"
+	exit 1
+fi
+
+MAP="$1"
+GAMETYPE="${2:-dm}"
+NUM_WORKERS="${3:-`getconf _NPROCESSORS_ONLN 2>/dev/null || echo 1`}"
+NUM_BOTS="${4:-4}"
+shift
+[ $# -gt 0 ] && shift
+[ $# -gt 0 ] && shift
+[ $# -gt 0 ] && shift
+
+if [ "X$BINARY_DIR" = "X" ]; then
+	BINARY_DIR="`dirname \"${0}\"`"
+fi
+
+base_arch=`uname -m | sed -e s/i.86/i386/ -e s/sun4u/sparc/ -e s/sparc64/sparc/ -e s/arm.*/arm/ -e s/sa110/arm/ -e s/alpha/axp/`
+os=`uname`
+
+if [ "X${os}" = "XFreeBSD" ]; then
+	arch=freebsd_$base_arch
+else
+	arch=$base_arch
+fi
+
+executable="$BINARY_DIR/$SERVER_NAME.$arch"
+
+if [ ! -e "$executable" ]; then
+	echo "Error: Executable for system '$arch' not found"
+	exit 1
+fi
+
+pids=
+trap 'kill $pids 2>/dev/null' INT TERM
+
+# Workers must not play the same matches
+base_seed=`date +%s`
+
+worker=0
+while [ $worker -lt $NUM_WORKERS ]; do
+	seed=`expr $base_seed + $worker`
+	"$executable" \
+		+set dedicated 1 +set sv_nonetwork 1 \
+		+set ai_evolution 1 +set ai_evolutionWorker $worker \
+		+set g_gametype "$GAMETYPE" +set g_numbots $NUM_BOTS \
+		+set g_maplist "$MAP" +set g_maprotation 1 \
+		"${@}" +map "$MAP" +simulate $SIMULATED_SECONDS $seed +quit > "evolution_worker_$worker.log" 2>&1 &
+	pids="$pids $!"
+	worker=`expr $worker + 1`
+done
+
+echo "Started $NUM_WORKERS evolution workers, see evolution_worker_*.log for the throughput reports"
+wait